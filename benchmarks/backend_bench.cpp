@@ -0,0 +1,374 @@
+// Google Benchmark suite for the backend hot paths.
+//
+// Builds on Linux against the mocked PortAudio and WebRTC VAD in tests/mocks
+// and the synthetic recognizer, so regressions show up as numbers without
+// audio hardware or a model.
+// Build with -DBUILD_PYTHON_MODULE=OFF -DBUILD_BENCHMARKS=ON, then run
+// bin/backend_bench (add --benchmark_format=json for machine-readable output).
+
+#include <benchmark/benchmark.h>
+
+#include "audio_stream.h"
+#include "batch_transcriber.h"
+#include "hotword_biaser.h"
+#include "keystroke_tokenizer.h"
+#include "keyword_spotter.h"
+#include "metrics.h"
+#include "model_cache.h"
+#include "noise_filter.h"
+#include "sample_conversion.h"
+#include "vosk_result_parser.h"
+#include "vosk_transcription_engine.h"
+#include "wav_file_stream.h"
+#include "webrtc_vad.h"
+
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+static constexpr int kSampleRate = 16000;
+static constexpr size_t kFrameSamples = 320;  // 20 ms at 16 kHz, the pipeline block size
+
+// Deterministic test signal: a voiced-like tone plus low-level noise
+static std::vector<float> make_signal(size_t count, float amplitude) {
+    std::vector<float> samples(count);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < count; i++) {
+        state = state * 1664525u + 1013904223u;
+        float noise = (static_cast<float>(state >> 8) / 16777216.0f - 0.5f) * 0.01f;
+        samples[i] = amplitude * std::sin(2.0f * 3.14159265f * 220.0f * i / kSampleRate) + noise;
+    }
+    return samples;
+}
+
+static AudioChunk make_chunk(size_t count, float amplitude) {
+    std::vector<float> samples = make_signal(count, amplitude);
+    return AudioChunk(samples.data(), samples.size());
+}
+
+static std::vector<std::string> load_vosk_results() {
+    std::string path = __FILE__;
+    path = path.substr(0, path.find_last_of("/\\") + 1) + "data/vosk_results.jsonl";
+    std::ifstream file(path);
+    std::vector<std::string> results;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            results.push_back(line);
+        }
+    }
+    return results;
+}
+
+// Ring buffer round trip: one callback-sized write and one read of the same size
+static void BM_RingWriteRead(benchmark::State& state) {
+    size_t block = static_cast<size_t>(state.range(0));
+    AudioCallbackContext context;
+    context.frames_per_buffer = static_cast<int>(block);
+    std::vector<float> input = make_signal(block, 0.3f);
+    std::vector<float> output(block);
+
+    for (auto _ : state) {
+        context.write_data(input.data(), block);
+        benchmark::DoNotOptimize(context.read_data(output.data(), block));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(block));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(block * sizeof(float)));
+}
+BENCHMARK(BM_RingWriteRead)->Arg(64)->Arg(160)->Arg(320)->Arg(1024)->Arg(4096);
+
+static void BM_VadIsSpeech(benchmark::State& state) {
+    VADHandler vad(kSampleRate, 20, 2);
+    AudioChunk chunk = make_chunk(kFrameSamples, state.range(0) ? 0.3f : 0.001f);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(vad.is_speech(chunk));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kFrameSamples));
+}
+BENCHMARK(BM_VadIsSpeech)->ArgName("speech")->Arg(0)->Arg(1);
+
+// One speech chunk through the wake-word matcher with the given number of
+// enrolled one-second phrases, the per-chunk cost of listening all day.
+// The phrases never match, so the gate stays closed.
+static void BM_KeywordSpotter(benchmark::State& state) {
+    KeywordSpotter spotter;
+    std::string error;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        std::vector<float> phrase = make_signal(kSampleRate, 0.2f + 0.1f * i);
+        for (size_t s = 0; s < phrase.size(); s++) {
+            phrase[s] *= static_cast<float>(std::sin(0.0004 * (i + 1) * s));
+        }
+        spotter.enroll(phrase.data(), phrase.size(), error);
+    }
+    spotter.set_threshold(0.0f);
+    AudioChunk chunk = make_chunk(kFrameSamples, 0.3f);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(spotter.process(chunk, true));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kFrameSamples));
+}
+BENCHMARK(BM_KeywordSpotter)->ArgName("templates")->Arg(1)->Arg(3)->Arg(5);
+
+static void BM_NoiseFilter(benchmark::State& state) {
+    NoiseFilter filter(0.05f, 10);
+    AudioChunk silence = make_chunk(kFrameSamples, 0.001f);
+    filter.calibrate(silence);
+    std::vector<float> source = make_signal(kFrameSamples, 0.3f);
+    AudioChunk chunk(kFrameSamples);
+
+    for (auto _ : state) {
+        std::copy(source.begin(), source.end(), chunk.data());
+        filter.filter(chunk);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kFrameSamples));
+}
+BENCHMARK(BM_NoiseFilter);
+
+static void BM_FloatToInt16(benchmark::State& state) {
+    size_t count = static_cast<size_t>(state.range(0));
+    std::vector<float> input = make_signal(count, 0.5f);
+    std::vector<int16_t> output(count);
+
+    for (auto _ : state) {
+        float_to_int16(input.data(), output.data(), count);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(count));
+}
+BENCHMARK(BM_FloatToInt16)->Arg(320)->Arg(4096);
+
+// Each iteration parses the whole sample set: partials, finals with word lists, an empty final
+static void BM_ParseVoskResult(benchmark::State& state) {
+    std::vector<std::string> results = load_vosk_results();
+    if (results.empty()) {
+        state.SkipWithError("benchmarks/data/vosk_results.jsonl not found");
+        return;
+    }
+    size_t bytes = 0;
+    for (const auto& json : results) {
+        bytes += json.size();
+    }
+
+    std::string error;
+    for (auto _ : state) {
+        for (const auto& json : results) {
+            TranscriptionResult result;
+            benchmark::DoNotOptimize(parse_vosk_result(json, result, error));
+            benchmark::DoNotOptimize(result.confidence);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(results.size()));
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+}
+BENCHMARK(BM_ParseVoskResult);
+
+// Vocabulary rescoring of one final result: five 12-word N-best hypotheses
+// against a vocabulary of the given size, the work added to every final
+// result once a vocabulary is loaded. Phrases are one to three words, and
+// a tenth of them share a first word with the hypotheses.
+static void BM_HotwordRescore(benchmark::State& state) {
+    const char* const hypotheses[] = {
+        "deploy the cooper netties cluster to the staging region before the demo tomorrow",
+        "deploy the kubernetes cluster to the staging region before the demo tomorrow",
+        "deploy the cooper nettie's cluster to the staging region before the demo tomorrow",
+        "deploy a kubernetes cluster to the staging region before the demo to morrow",
+        "deploy the cube earnest cluster to the staging region before the demo tomorrow",
+    };
+    std::string json = "{\"alternatives\" : [";
+    for (size_t i = 0; i < 5; i++) {
+        json += std::string(i ? ", " : "") + "{\"confidence\" : " + std::to_string(240.0 - i) +
+                ", \"text\" : \"" + hypotheses[i] + "\"}";
+    }
+    json += "]}";
+    TranscriptionResult parsed;
+    std::string error;
+    parse_vosk_result(json, parsed, error);
+
+    HotwordBiaser biaser;
+    std::vector<HotwordEntry> entries;
+    for (int64_t i = 0; i < state.range(0); i++) {
+        std::string first = i % 10 == 0 ? "deploy" : "term" + std::to_string(i);
+        std::string phrase = first;
+        for (int64_t word = 1; word <= i % 3; word++) {
+            phrase += " word" + std::to_string(i + word);
+        }
+        entries.push_back({ phrase, 2.0f });
+    }
+    entries.push_back({ "Kubernetes", 4.0f });
+    biaser.set_phrases(entries);
+
+    for (auto _ : state) {
+        TranscriptionResult result = parsed;
+        benchmark::DoNotOptimize(biaser.apply(result));
+        benchmark::DoNotOptimize(result.raw_text.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HotwordRescore)->ArgName("vocabulary")->Arg(0)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+static void BM_TokenizeKeystrokes(benchmark::State& state) {
+    const std::wstring text =
+        L"Dear team,{ENTER}{ENTER}The quarterly report is attached (see section 3).{ENTER}"
+        L"Please review it by March 5, 2024 at 3:30 PM{CTRL+ENTER}{TAB}Thanks!";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tokenize_keystrokes(text));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_TokenizeKeystrokes);
+
+// Cost the metrics instrumentation adds to each stage
+static void BM_ScopedTimer(benchmark::State& state) {
+    MetricsRegistry::instance().set_enabled(state.range(0) != 0);
+    for (auto _ : state) {
+        ScopedTimer timer(Stage::Vad);
+    }
+    MetricsRegistry::instance().set_enabled(true);
+}
+BENCHMARK(BM_ScopedTimer)->ArgName("enabled")->Arg(0)->Arg(1);
+
+// Script for the synthetic recognizer with the given cost and jitter
+static std::string write_synthetic_model(double cpu_cost, const std::string& jitter, int thread) {
+    std::string path = (std::filesystem::temp_directory_path() /
+        ("synthetic_bench_" + std::to_string(thread) + ".conf")).string();
+    std::ofstream out(path);
+    out << "cpu_cost = " << cpu_cost << "\n"
+        << "jitter = " << jitter << "\n"
+        << "utterance = the quick brown fox jumps over the lazy dog\n";
+    return path;
+}
+
+// Concurrent transcription streams on the synthetic recognizer. The argument
+// is its CPU cost in percent of real time; audio_rate reports how many seconds
+// of audio all streams get through per second, the headroom for scheduling.
+static void BM_SyntheticTranscribe(benchmark::State& state) {
+    std::string model = write_synthetic_model(state.range(0) / 100.0, "exponential 0.2", state.thread_index());
+    VoskTranscriber transcriber(model, static_cast<float>(kSampleRate));
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<float> speech = make_signal(kFrameSamples, 0.3f);
+    std::vector<float> silence = make_signal(kFrameSamples, 0.001f);
+
+    // One-second utterances separated by silence
+    int64_t chunks = 0;
+    for (auto _ : state) {
+        bool is_speech = chunks % 60 < 50;
+        auto chunk = std::make_unique<AudioChunk>((is_speech ? speech : silence).data(), kFrameSamples);
+        benchmark::DoNotOptimize(transcriber.transcribe_with_vad(std::move(chunk), is_speech));
+        chunks++;
+    }
+    state.SetItemsProcessed(chunks);
+    state.counters["audio_rate"] = benchmark::Counter(
+        static_cast<double>(chunks * kFrameSamples) / kSampleRate, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SyntheticTranscribe)->ArgName("cpu_pct")->Arg(0)->Arg(10)->Arg(50)
+    ->Threads(1)->Threads(4)->UseRealTime();
+
+// Offline batch transcription of eight meeting-like recordings (four 0.75 s
+// utterances, each followed by 1.25 s of silence) on the synthetic engine at
+// 5% of real time per recognizer. The arguments are the worker count, with
+// which audio_rate should grow close to linearly given enough cores, and
+// whether silence is skipped.
+static void BM_BatchTranscribe(benchmark::State& state) {
+    std::vector<float> recording;
+    for (int utterance = 0; utterance < 4; utterance++) {
+        std::vector<float> speech = make_signal(kSampleRate * 3 / 4, 0.3f);
+        recording.insert(recording.end(), speech.begin(), speech.end());
+        recording.insert(recording.end(), kSampleRate * 5 / 4, 0.0f);
+    }
+    std::vector<std::string> paths;
+    for (int i = 0; i < 8; i++) {
+        paths.push_back((std::filesystem::temp_directory_path() /
+            ("batch_bench_" + std::to_string(i) + ".wav")).string());
+        WavFileStream::write_wav(paths.back(), recording, kSampleRate);
+    }
+
+    BatchTranscriberConfig config;
+    config.engine = "synthetic";
+    config.model_path = write_synthetic_model(0.05, "none", 0);
+    config.threads = static_cast<int>(state.range(0));
+    config.min_silence_ms = 200;
+    config.skip_silence = state.range(1) != 0;
+    BatchTranscriber transcriber(config);
+    if (!transcriber.load_model()) {
+        state.SkipWithError(transcriber.get_last_error().c_str());
+        return;
+    }
+
+    double audio_seconds = 0.0;
+    for (auto _ : state) {
+        BatchReport report;
+        transcriber.run(paths, report);
+        audio_seconds += report.audio_seconds;
+    }
+    state.counters["audio_rate"] = benchmark::Counter(audio_seconds, benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_BatchTranscribe)->ArgNames({ "threads", "skip_silence" })
+    ->ArgsProduct({ { 1, 2, 4, 8 }, { 0, 1 } })->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Transcribers loading the synthetic engine with 64 MiB of stand-in weights.
+// The arguments are the transcriber count and whether they share one model
+// path. first_ms is the first load from disk; next_ms is the mean of the
+// others, a ModelCache hit when shared and another full load when not. Both
+// include the warm-up decode; model_load_ms is the model_load stage alone,
+// per load from disk. rss_mb is the resident memory all of them add together.
+static void BM_ModelLoad(benchmark::State& state) {
+    const int transcribers = static_cast<int>(state.range(0));
+    const bool shared = state.range(1) != 0;
+    std::vector<std::string> paths;
+    for (int i = 0; i < transcribers; i++) {
+        paths.push_back((std::filesystem::temp_directory_path() /
+            ("model_load_bench_" + std::to_string(shared ? 0 : i) + ".conf")).string());
+        std::ofstream out(paths.back());
+        out << "model_mb = 64\n"
+            << "utterance = the quick brown fox jumps over the lazy dog\n";
+    }
+
+    double first_ms = 0.0;
+    double next_ms = 0.0;
+    double rss_mb = 0.0;
+    ModelCache::Stats cache_before = ModelCache::instance().stats();
+    for (auto _ : state) {
+        int64_t resident_before = static_cast<int64_t>(resident_memory_bytes());
+        std::vector<std::unique_ptr<VoskTranscriber>> loaded;
+        for (int i = 0; i < transcribers; i++) {
+            auto start = std::chrono::steady_clock::now();
+            loaded.push_back(std::make_unique<VoskTranscriber>(paths[i], static_cast<float>(kSampleRate), "synthetic"));
+            while (loaded.back()->is_loading()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            if (i == 0) {
+                first_ms += ms;
+            } else {
+                next_ms += ms / (transcribers - 1);
+            }
+        }
+        rss_mb += (static_cast<int64_t>(resident_memory_bytes()) - resident_before) / (1024.0 * 1024.0);
+    }
+    state.counters["first_ms"] = benchmark::Counter(first_ms, benchmark::Counter::kAvgIterations);
+    state.counters["next_ms"] = benchmark::Counter(next_ms, benchmark::Counter::kAvgIterations);
+    state.counters["rss_mb"] = benchmark::Counter(rss_mb, benchmark::Counter::kAvgIterations);
+    ModelCache::Stats cache_after = ModelCache::instance().stats();
+    if (cache_after.loads > cache_before.loads) {
+        state.counters["model_load_ms"] = (cache_after.load_ms - cache_before.load_ms) /
+            static_cast<double>(cache_after.loads - cache_before.loads);
+    }
+}
+BENCHMARK(BM_ModelLoad)->ArgNames({ "transcribers", "shared" })
+    ->Args({ 1, 1 })->Args({ 2, 1 })->Args({ 2, 0 })->Iterations(10)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+BENCHMARK_MAIN();
\ No newline at end of file
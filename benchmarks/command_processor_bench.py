@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Compare the Python EnhancedCommandProcessor with the native CommandEngine.
+
+Usage: python benchmarks/command_processor_bench.py [corpus] [--iterations N]
+"""
+import argparse
+import sys
+import time
+from pathlib import Path
+
+# Add project path to system path for imports
+project_root = Path(__file__).resolve().parent.parent
+src_path = project_root / "src"
+
+if str(src_path) not in sys.path:
+    sys.path.insert(0, str(src_path))
+
+try:
+    import voice_transcription_backend as backend
+except ImportError:
+    print("Error: voice_transcription_backend module not found.")
+    print("Make sure the C++ backend is compiled and installed correctly.")
+    sys.exit(1)
+
+from utils.enhanced_command_processor import EnhancedCommandProcessor
+from utils.native_command_processor import NativeCommandProcessor
+
+def load_corpus(path):
+    """Load one utterance per line, skipping blanks and comments"""
+    with open(path, "r", encoding="utf-8") as f:
+        return [line.strip() for line in f if line.strip() and not line.startswith("#")]
+
+def time_processor(processor, corpus, iterations):
+    """Return mean microseconds per utterance"""
+    # Warm up caches and lazily compiled patterns
+    for text in corpus:
+        processor.process(text)
+
+    start = time.perf_counter()
+    for _ in range(iterations):
+        for text in corpus:
+            processor.process(text)
+    elapsed = time.perf_counter() - start
+    return elapsed * 1e6 / (iterations * len(corpus))
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark dictation command processing")
+    parser.add_argument("corpus", nargs="?", default=str(Path(__file__).parent / "data" / "dictation_corpus.txt"))
+    parser.add_argument("--iterations", type=int, default=200)
+    args = parser.parse_args()
+
+    corpus = load_corpus(args.corpus)
+    if not corpus:
+        print(f"Error: no utterances in {args.corpus}")
+        return 1
+
+    python_processor = EnhancedCommandProcessor()
+    native_processor = NativeCommandProcessor()
+
+    python_us = time_processor(python_processor, corpus, args.iterations)
+    native_us = time_processor(native_processor, corpus, args.iterations)
+
+    print(f"Utterances: {len(corpus)} x {args.iterations} iterations")
+    print(f"Python:  {python_us:8.2f} us/utterance")
+    print(f"Native:  {native_us:8.2f} us/utterance")
+    print(f"Speedup: {python_us / native_us:8.2f}x")
+
+    # Show where the outputs differ so behaviour changes are visible
+    python_processor = EnhancedCommandProcessor()
+    native_processor = NativeCommandProcessor()
+    differences = 0
+    for text in corpus:
+        expected = python_processor.process(text)
+        actual = native_processor.process(text)
+        if expected != actual:
+            differences += 1
+            print(f"\n  input:  {text}\n  python: {expected}\n  native: {actual}")
+    print(f"\nOutput differences: {differences}/{len(corpus)}")
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file
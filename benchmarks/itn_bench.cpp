@@ -0,0 +1,77 @@
+// Inverse text normalization throughput benchmark.
+//
+// Build: g++ -std=c++17 -O2 -Isrc/backend/include src/backend/inverse_text_normalizer.cpp
+//            benchmarks/itn_bench.cpp -o itn_bench
+// Usage: itn_bench [golden.tsv] [iterations]
+
+#include "inverse_text_normalizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace voice_transcription;
+
+// Typical dictation pace, used to express throughput as a real-time factor
+static constexpr double kSpokenWordsPerSecond = 2.5;
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "tests/data/itn_golden.tsv";
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+    // Spoken side of the golden set is the corpus
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Error: cannot open %s\n", path.c_str());
+        return 1;
+    }
+
+    std::vector<std::string> corpus;
+    size_t words = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::string spoken = line.substr(0, line.find('\t'));
+        words += 1 + std::count(spoken.begin(), spoken.end(), ' ');
+        corpus.push_back(spoken);
+    }
+    if (corpus.empty() || iterations <= 0) {
+        std::fprintf(stderr, "Error: nothing to benchmark\n");
+        return 1;
+    }
+
+    InverseTextNormalizer normalizer;
+    size_t checksum = 0;
+
+    // Warm up
+    for (const auto& utterance : corpus) {
+        checksum += normalizer.normalize(utterance).size();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        for (const auto& utterance : corpus) {
+            checksum += normalizer.normalize(utterance).size();
+        }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double utterances = static_cast<double>(corpus.size()) * iterations;
+    double total_words = static_cast<double>(words) * iterations;
+    double words_per_second = total_words / elapsed;
+
+    std::printf("Utterances:       %zu x %d iterations\n", corpus.size(), iterations);
+    std::printf("Per utterance:    %.3f us\n", elapsed * 1e6 / utterances);
+    std::printf("Per word:         %.1f ns\n", elapsed * 1e9 / total_words);
+    std::printf("Throughput:       %.0f words/s\n", words_per_second);
+    std::printf("Real-time factor: %.0fx faster than speech at %.1f words/s\n",
+                words_per_second / kSpokenWordsPerSecond, kSpokenWordsPerSecond);
+    std::printf("(checksum %zu)\n", checksum);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+// End-to-end latency harness: replays a labeled WAV corpus through VAD,
+// endpointing and VoskTranscriber and writes a JSON latency report.
+//
+// Usage: latency_harness --corpus corpus.tsv --model models/vosk/<model>
+//            [--engine vosk|synthetic|whisper] [--output report.json] [--label name] [--frames 320]
+//            [--vad 2] [--hangover-ms 300] [--noise-filter] [--fast]
+//
+// The corpus format is described in latency_harness.h. Reports from two
+// builds, configurations or engines can be diffed key by key.
+
+#include "latency_harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace voice_transcription;
+
+static void print_usage(const char* program) {
+    std::fprintf(stderr,
+        "Usage: %s --corpus FILE --model DIR [--engine NAME] [--output FILE] [--label NAME]\n"
+        "          [--frames N] [--vad 0-3] [--hangover-ms N] [--noise-filter] [--fast]\n",
+        program);
+}
+
+int main(int argc, char** argv) {
+    LatencyHarnessConfig config;
+    std::string corpus_path;
+    std::string output_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--corpus" && has_value) {
+            corpus_path = argv[++i];
+        } else if (arg == "--model" && has_value) {
+            config.model_path = argv[++i];
+        } else if (arg == "--engine" && has_value) {
+            config.engine = argv[++i];
+        } else if (arg == "--output" && has_value) {
+            output_path = argv[++i];
+        } else if (arg == "--label" && has_value) {
+            config.label = argv[++i];
+        } else if (arg == "--frames" && has_value) {
+            config.frames_per_buffer = std::atoi(argv[++i]);
+        } else if (arg == "--vad" && has_value) {
+            config.vad_aggressiveness = std::atoi(argv[++i]);
+        } else if (arg == "--hangover-ms" && has_value) {
+            config.hangover_ms = std::atoi(argv[++i]);
+        } else if (arg == "--noise-filter") {
+            config.noise_filtering = true;
+        } else if (arg == "--fast") {
+            config.realtime = false;
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if (corpus_path.empty() || config.model_path.empty()) {
+        print_usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<LabeledRecording> corpus;
+    std::string error;
+    if (!load_latency_corpus(corpus_path, corpus, error)) {
+        std::fprintf(stderr, "Error: %s\n", error.c_str());
+        return 1;
+    }
+
+    LatencyHarness harness(config);
+    LatencyReport report;
+    if (!harness.run(corpus, report)) {
+        std::fprintf(stderr, "Error: %s\n", harness.get_last_error().c_str());
+        return 1;
+    }
+
+    if (output_path.empty()) {
+        std::printf("%s\n", report.to_json().c_str());
+    } else if (!report.write_json(output_path)) {
+        std::fprintf(stderr, "Error: cannot write %s\n", output_path.c_str());
+        return 1;
+    } else {
+        std::printf("Wrote %zu utterances from %zu recordings to %s\n",
+                    report.utterances.size(), report.recordings.size(), output_path.c_str());
+    }
+    return 0;
+}
\ No newline at end of file
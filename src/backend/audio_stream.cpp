@@ -1,15 +1,16 @@
 #include "audio_stream.h"
+#include "device_capability_cache.h"
+#include "metrics.h"
+#include "trace_recorder.h"
 #include <chrono>
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <thread>
 #include <condition_variable>
 
 namespace voice_transcription {
 
-// Static initialization
-bool ControlledAudioStream::portaudio_initialized_ = false;
-
 // AudioChunk implementation
 AudioChunk::AudioChunk(size_t size) : size_(size) {
     data_ = std::make_unique<float[]>(size);
@@ -22,7 +23,8 @@ AudioChunk::AudioChunk(const float* data, size_t size) : size_(size) {
 }
 
 AudioChunk::AudioChunk(AudioChunk&& other) noexcept
-    : data_(std::move(other.data_)), size_(other.size_) {
+    : data_(std::move(other.data_)), size_(other.size_), sequence_(other.sequence_),
+      first_sample_(other.first_sample_), capture_time_us_(other.capture_time_us_) {
     other.size_ = 0;
 }
 
@@ -30,6 +32,9 @@ AudioChunk& AudioChunk::operator=(AudioChunk&& other) noexcept {
     if (this != &other) {
         data_ = std::move(other.data_);
         size_ = other.size_;
+        sequence_ = other.sequence_;
+        first_sample_ = other.first_sample_;
+        capture_time_us_ = other.capture_time_us_;
         other.size_ = 0;
     }
     return *this;
@@ -42,8 +47,8 @@ AudioCallbackContext::AudioCallbackContext()
 }
 
 // Write data to the circular buffer
-void AudioCallbackContext::write_data(const float* data, size_t length) {
-    std::lock_guard<std::mutex> lock(buffer_mutex);
+void AudioCallbackContext::write_data(const float* data, size_t length, int64_t capture_time_us) {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
     
     // Check for buffer overflow
     // Calculate available data first
@@ -53,11 +58,16 @@ void AudioCallbackContext::write_data(const float* data, size_t length) {
         
     // Then calculate available space
     size_t available_space = MAX_BUFFER_SIZE - data_available;
+    write_count++;
     if (length > available_space) {
         buffer_overflow = true;
+        overflow_count++;
+        overflow_samples += length - available_space;
+        MetricsRegistry::instance().increment(Counter::AudioOverflows);
         
         // Overwrite old data by advancing read_pos
         read_pos = (read_pos + (length - available_space)) % MAX_BUFFER_SIZE;
+        total_read += length - available_space;
     }
     
     // Write data to the circular buffer
@@ -66,13 +76,24 @@ void AudioCallbackContext::write_data(const float* data, size_t length) {
     }
     
     buffer_pos = (buffer_pos + length) % MAX_BUFFER_SIZE;
+    total_written += length;
+    write_marks[write_mark_count++ % WRITE_MARK_COUNT] = {
+        total_written, std::chrono::steady_clock::now(), capture_time_us, static_cast<uint32_t>(length) };
     
-    // Notify waiting threads that data is ready
-    data_ready_cv.notify_one();
+    // Wake the consumer only once it has what it waits for, so a consumer
+    // waiting on a large block is not woken by every callback
+    if (std::min(data_available + length, MAX_BUFFER_SIZE) >= wake_samples) {
+        data_ready_cv.notify_one();
+        lock.unlock();
+        if (ready) {
+            ready->notify();
+        }
+    }
 }
 
 // Read data from the circular buffer
-size_t AudioCallbackContext::read_data(float* output, size_t length) {
+size_t AudioCallbackContext::read_data(float* output, size_t length, uint64_t* first_sample,
+                                       int64_t* capture_time_us) {
     std::unique_lock<std::mutex> lock(buffer_mutex);
     
     // Calculate available data
@@ -92,6 +113,36 @@ size_t AudioCallbackContext::read_data(float* output, size_t length) {
     
     read_pos = (read_pos + length) % MAX_BUFFER_SIZE;
     
+    // Queueing delay and capture time of the oldest sample in this read, from the write that delivered it
+    if (capture_time_us) {
+        *capture_time_us = 0;
+    }
+    size_t oldest = write_mark_count > WRITE_MARK_COUNT ? write_mark_count - WRITE_MARK_COUNT : 0;
+    for (size_t i = oldest; i < write_mark_count; i++) {
+        const WriteMark& mark = write_marks[i % WRITE_MARK_COUNT];
+        if (mark.end_sample > total_read) {
+            uint64_t mark_first = mark.end_sample - mark.length;
+            if (capture_time_us && mark.capture_time_us != 0 && sample_rate > 0 && total_read >= mark_first) {
+                *capture_time_us = mark.capture_time_us +
+                    static_cast<int64_t>((total_read - mark_first) * 1000000 / static_cast<uint64_t>(sample_rate));
+            }
+            auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - mark.time);
+            MetricsRegistry::instance().record_latency(Stage::RingToChunk,
+                static_cast<uint64_t>(waited.count()) * 1000);
+            if (frames_per_buffer > 0) {
+                int64_t now_us = trace_clock_us();
+                TraceRecorder::instance().record(trace_span::kRingWait, total_read / frames_per_buffer,
+                                                 now_us - waited.count(), now_us);
+            }
+            break;
+        }
+    }
+    if (first_sample) {
+        *first_sample = total_read;
+    }
+    total_read += length;
+    
     // Reset overflow flag
     bool had_overflow = buffer_overflow;
     buffer_overflow = false;
@@ -112,9 +163,15 @@ bool AudioCallbackContext::wait_for_data(size_t min_samples, int timeout_ms) {
         return true;
     }
     
-    // Wait for data with timeout
+    // Wait for data with timeout; every check after the first is a wakeup
+    wake_samples = min_samples;
+    bool woken = false;
     return data_ready_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms),
-        [this, min_samples]() {
+        [this, min_samples, &woken]() {
+            if (woken) {
+                MetricsRegistry::instance().increment(Counter::ConsumerWakeups);
+            }
+            woken = true;
             size_t data_available = (buffer_pos >= read_pos) ? 
                 (buffer_pos - read_pos) : 
                 (MAX_BUFFER_SIZE - read_pos + buffer_pos);
@@ -122,27 +179,43 @@ bool AudioCallbackContext::wait_for_data(size_t min_samples, int timeout_ms) {
         });
 }
 
+bool AudioCallbackContext::has_wake_data() {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    size_t data_available = (buffer_pos >= read_pos) ? 
+        (buffer_pos - read_pos) : 
+        (MAX_BUFFER_SIZE - read_pos + buffer_pos);
+    return data_available >= wake_samples;
+}
+
+void AudioCallbackContext::set_wake_samples(size_t samples) {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    wake_samples = samples;
+}
+
 // Clear buffer
 void AudioCallbackContext::clear() {
     std::lock_guard<std::mutex> lock(buffer_mutex);
     read_pos = buffer_pos;
+    total_read = total_written;
     buffer_overflow = false;
 }
 
 // ControlledAudioStream implementation
 ControlledAudioStream::ControlledAudioStream(int device_id, int sample_rate, int frames_per_buffer)
-    : device_id_(device_id), 
+    : audio_(AudioSubsystem::acquire()),
+      device_id_(device_id), 
       sample_rate_(sample_rate),
       frames_per_buffer_(frames_per_buffer),
       stream_(nullptr),
       callback_context_(std::make_unique<AudioCallbackContext>()),
+      ready_(std::make_unique<ReadinessNotifier>()),
       is_paused_(false) {
     
-    // Initialize PortAudio if needed
-    ensure_portaudio_initialized();
-    
     // Set up callback context
     callback_context_->frames_per_buffer = frames_per_buffer;
+    callback_context_->sample_rate = sample_rate;
+    callback_context_->wake_samples = static_cast<size_t>(frames_per_buffer);
+    callback_context_->ready = ready_.get();
 }
 
 ControlledAudioStream::~ControlledAudioStream() {
@@ -153,13 +226,20 @@ ControlledAudioStream::~ControlledAudioStream() {
 }
 
 ControlledAudioStream::ControlledAudioStream(ControlledAudioStream&& other) noexcept
-    : device_id_(other.device_id_),
+    : audio_(std::move(other.audio_)),
+      device_id_(other.device_id_),
       sample_rate_(other.sample_rate_),
       frames_per_buffer_(other.frames_per_buffer_),
       stream_(other.stream_),
       callback_context_(std::move(other.callback_context_)),
+      ready_(std::move(other.ready_)),
       last_error_(std::move(other.last_error_)),
-      is_paused_(other.is_paused_) {
+      is_paused_(other.is_paused_),
+      idle_policy_(other.idle_policy_),
+      idle_(other.idle_),
+      quiet_ms_(other.quiet_ms_),
+      held_chunk_(std::move(other.held_chunk_)),
+      chunks_delivered_(other.chunks_delivered_) {
     
     other.stream_ = nullptr;
 }
@@ -171,13 +251,20 @@ ControlledAudioStream& ControlledAudioStream::operator=(ControlledAudioStream&&
             stop();
         }
         
+        audio_ = std::move(other.audio_);
         device_id_ = other.device_id_;
         sample_rate_ = other.sample_rate_;
         frames_per_buffer_ = other.frames_per_buffer_;
         stream_ = other.stream_;
         callback_context_ = std::move(other.callback_context_);
+        ready_ = std::move(other.ready_);
         last_error_ = std::move(other.last_error_);
         is_paused_ = other.is_paused_;
+        idle_policy_ = other.idle_policy_;
+        idle_ = other.idle_;
+        quiet_ms_ = other.quiet_ms_;
+        held_chunk_ = std::move(other.held_chunk_);
+        chunks_delivered_ = other.chunks_delivered_;
         
         other.stream_ = nullptr;
     }
@@ -198,6 +285,17 @@ bool ControlledAudioStream::start() {
         // Reset audio context
         callback_context_ = std::make_unique<AudioCallbackContext>();
         callback_context_->frames_per_buffer = frames_per_buffer_;
+        callback_context_->sample_rate = sample_rate_;
+        callback_context_->wake_samples = static_cast<size_t>(frames_per_buffer_);
+        callback_context_->ready = ready_.get();
+        ready_->clear();
+        idle_ = false;
+        quiet_ms_ = 0;
+        held_chunk_.reset();
+        chunks_delivered_ = 0;
+        
+        // PortAudio is not thread-safe; streams on other threads wait here
+        std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
         
         // Input parameters
         PaStreamParameters inputParams;
@@ -258,6 +356,7 @@ bool ControlledAudioStream::start() {
             stream_ = nullptr;
             return false;
         }
+        audio_lock.unlock();
         
         // Let the stream run for a short time to prime the buffer
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -274,6 +373,8 @@ bool ControlledAudioStream::start() {
 void ControlledAudioStream::stop() {
     try {
         if (stream_) {
+            std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
+            
             // Stop the stream if it's active
             if (Pa_IsStreamActive(stream_) == 1) {
                 PaError err = Pa_StopStream(stream_);
@@ -295,6 +396,9 @@ void ControlledAudioStream::stop() {
         if (callback_context_) {
             callback_context_->clear();
         }
+        if (ready_) {
+            ready_->clear();
+        }
         
         is_paused_ = false;
     }
@@ -315,28 +419,65 @@ bool ControlledAudioStream::is_active() const {
     return stream_ && Pa_IsStreamActive(stream_) == 1;
 }
 
+static float chunk_rms(const AudioChunk& chunk) {
+    double sum = 0.0;
+    for (size_t i = 0; i < chunk.size(); i++) {
+        sum += chunk.data()[i] * chunk.data()[i];
+    }
+    return chunk.size() ? static_cast<float>(std::sqrt(sum / chunk.size())) : 0.0f;
+}
+
 // Enhanced method to get the next audio chunk with better latency
 std::optional<AudioChunk> ControlledAudioStream::get_next_chunk(int timeout_ms) {
     if (!is_active() || is_paused_) {
         return std::nullopt;
     }
     
+    // Clear before reading and re-arm if more is waiting, so the descriptor
+    // stays readable exactly while get_next_chunk() has something to return
+    ready_->clear();
+    std::optional<AudioChunk> chunk = next_chunk(timeout_ms);
+    if (held_chunk_ || callback_context_->has_wake_data()) {
+        ready_->notify();
+    }
+    if (chunk) {
+        chunks_delivered_++;
+    }
+    return chunk;
+}
+
+std::optional<AudioChunk> ControlledAudioStream::next_chunk(int timeout_ms) {
     try {
+        // The chunk that ended the idle state follows the one before it
+        if (held_chunk_) {
+            std::optional<AudioChunk> chunk = std::move(held_chunk_);
+            held_chunk_.reset();
+            MetricsRegistry::instance().increment(Counter::AudioChunks);
+            return chunk;
+        }
+        if (idle_) {
+            return next_idle_chunk(timeout_ms);
+        }
+        
         // Wait for enough data with timeout
         if (!callback_context_->wait_for_data(frames_per_buffer_, timeout_ms)) {
             return std::nullopt;
         }
         
-        // Create a new chunk to hold the data
-        auto chunk = std::make_optional<AudioChunk>(frames_per_buffer_);
-        
-        // Read data from the circular buffer
-        size_t bytes_read = callback_context_->read_data(chunk->data(), frames_per_buffer_);
-        
-        if (bytes_read != frames_per_buffer_) {
+        std::optional<AudioChunk> chunk = read_chunk();
+        if (!chunk) {
             return std::nullopt;
         }
         
+        if (idle_policy_.enabled) {
+            if (chunk_rms(*chunk) < idle_policy_.wake_rms) {
+                quiet_ms_ += frames_per_buffer_ * 1000 / sample_rate_;
+                idle_ = quiet_ms_ >= idle_policy_.idle_after_ms;
+            } else {
+                quiet_ms_ = 0;
+            }
+        }
+        MetricsRegistry::instance().increment(Counter::AudioChunks);
         return chunk;
     }
     catch (const std::exception& e) {
@@ -345,98 +486,89 @@ std::optional<AudioChunk> ControlledAudioStream::get_next_chunk(int timeout_ms)
     }
 }
 
-void ControlledAudioStream::ensure_portaudio_initialized() {
-    if (!portaudio_initialized_) {
-        PaError err = Pa_Initialize();
-        if (err != paNoError) {
-            throw AudioStreamException(std::string("Failed to initialize PortAudio: ") + Pa_GetErrorText(err));
-        }
-        portaudio_initialized_ = true;
-    }
-}
-
-std::vector<AudioDevice> ControlledAudioStream::enumerate_devices() {
-    // Make sure PortAudio is initialized
-    ensure_portaudio_initialized();
+std::optional<AudioChunk> ControlledAudioStream::read_chunk() {
+    // Create a new chunk to hold the data
+    auto chunk = std::make_optional<AudioChunk>(frames_per_buffer_);
     
-    std::vector<AudioDevice> devices;
-    int numDevices = Pa_GetDeviceCount();
+    // Read data from the circular buffer
+    uint64_t first_sample = 0;
+    int64_t capture_time_us = 0;
+    size_t bytes_read = callback_context_->read_data(chunk->data(), frames_per_buffer_, &first_sample,
+                                                     &capture_time_us);
     
-    if (numDevices < 0) {
-        // Error occurred
-        return devices;
+    if (bytes_read != static_cast<size_t>(frames_per_buffer_)) {
+        return std::nullopt;
     }
     
-    // Default input device
-    int defaultInputDevice = Pa_GetDefaultInputDevice();
+    chunk->set_sequence(first_sample / frames_per_buffer_);
+    chunk->set_first_sample(first_sample);
+    chunk->set_capture_time_us(capture_time_us);
+    return chunk;
+}
+
+std::optional<AudioChunk> ControlledAudioStream::next_idle_chunk(int timeout_ms) {
+    // Whole chunks, at most half the ring so a block never overflows it
+    size_t block = static_cast<size_t>(idle_policy_.idle_block_ms) * sample_rate_ / 1000;
+    block = std::min(block, AudioCallbackContext::MAX_BUFFER_SIZE / 2);
+    block = std::max<size_t>(1, block / frames_per_buffer_) * frames_per_buffer_;
+    if (!callback_context_->wait_for_data(block, timeout_ms)) {
+        return std::nullopt;
+    }
     
-    // Iterate through all devices
-    for (int i = 0; i < numDevices; i++) {
-        const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(i);
-        
-        if (deviceInfo && deviceInfo->maxInputChannels > 0) {
-            // This device has input channels, add it to the list
-            AudioDevice device;
-            device.id = i;
-            device.raw_name = deviceInfo->name;
-            
-            // Create a more user-friendly label
-            const PaHostApiInfo* hostInfo = Pa_GetHostApiInfo(deviceInfo->hostApi);
-            std::string hostName = hostInfo ? hostInfo->name : "Unknown";
-            
-            device.label = deviceInfo->name;
-            
-            // Check if it's the default device
-            device.is_default = (i == defaultInputDevice);
-            
-            // Add some common sample rates to check
-            const int sampleRates[] = { 8000, 16000, 22050, 32000, 44100, 48000, 96000 };
-            
-            for (int rate : sampleRates) {
-                // Check if the device supports this sample rate
-                PaStreamParameters params;
-                params.device = i;
-                params.channelCount = 1;
-                params.sampleFormat = paFloat32;
-                params.suggestedLatency = deviceInfo->defaultLowInputLatency;
-                params.hostApiSpecificStreamInfo = nullptr;
-                
-                PaError err = Pa_IsFormatSupported(&params, nullptr, rate);
-                if (err == paFormatIsSupported) {
-                    device.supported_sample_rates.push_back(rate);
-                }
+    // Only the energy gate runs on the block; the rest of the pipeline sees
+    // nothing until a chunk is loud enough
+    std::optional<AudioChunk> previous;
+    while (std::optional<AudioChunk> chunk = read_chunk()) {
+        if (chunk_rms(*chunk) >= idle_policy_.wake_rms) {
+            idle_ = false;
+            quiet_ms_ = 0;
+            // Back to one wakeup per chunk; otherwise the descriptor only
+            // fires once a whole idle block is buffered again
+            callback_context_->set_wake_samples(static_cast<size_t>(frames_per_buffer_));
+            MetricsRegistry::instance().increment(Counter::AudioChunks);
+            if (previous) {
+                held_chunk_ = std::move(chunk);
+                return previous;
             }
-            
-            devices.push_back(device);
+            return chunk;
         }
+        MetricsRegistry::instance().increment(Counter::IdleChunksSkipped);
+        previous = std::move(chunk);
     }
-    
-    return devices;
+    return std::nullopt;
 }
 
-bool ControlledAudioStream::check_device_compatibility(int device_id, int sample_rate) {
-    // Make sure PortAudio is initialized
-    ensure_portaudio_initialized();
-    
-    if (device_id < 0 || device_id >= Pa_GetDeviceCount()) {
-        return false;
+void ControlledAudioStream::set_idle_policy(const IdlePolicy& policy) {
+    idle_policy_ = policy;
+    quiet_ms_ = 0;
+    if (!policy.enabled) {
+        idle_ = false;
+        if (callback_context_) {
+            callback_context_->set_wake_samples(static_cast<size_t>(frames_per_buffer_));
+        }
     }
-    
-    const PaDeviceInfo* deviceInfo = Pa_GetDeviceInfo(device_id);
-    if (!deviceInfo || deviceInfo->maxInputChannels <= 0) {
-        return false;
+}
+
+AudioStreamStats ControlledAudioStream::get_stats() const {
+    AudioStreamStats stats;
+    stats.chunks_delivered = chunks_delivered_;
+    if (callback_context_) {
+        std::lock_guard<std::mutex> lock(callback_context_->buffer_mutex);
+        stats.callbacks = callback_context_->write_count;
+        stats.samples_captured = callback_context_->total_written;
+        stats.overflows = callback_context_->overflow_count;
+        stats.samples_dropped = callback_context_->overflow_samples;
+        stats.buffered_samples = callback_context_->total_written - callback_context_->total_read;
     }
-    
-    // Check if the device supports the required sample rate
-    PaStreamParameters params;
-    params.device = device_id;
-    params.channelCount = 1;
-    params.sampleFormat = paFloat32;
-    params.suggestedLatency = deviceInfo->defaultLowInputLatency;
-    params.hostApiSpecificStreamInfo = nullptr;
-    
-    PaError err = Pa_IsFormatSupported(&params, nullptr, sample_rate);
-    return (err == paFormatIsSupported);
+    return stats;
+}
+
+std::vector<AudioDevice> ControlledAudioStream::enumerate_devices(bool wait_for_probes) {
+    return DeviceCapabilityCache::instance().enumerate(wait_for_probes);
+}
+
+bool ControlledAudioStream::check_device_compatibility(int device_id, int sample_rate) {
+    return DeviceCapabilityCache::instance().supports(device_id, sample_rate);
 }
 
 // Improved audio callback function for PortAudio
@@ -455,12 +587,30 @@ int ControlledAudioStream::audio_callback(
         return paContinue;
     }
     
+    // Keep latency-triggered trace dumps (file IO) off this thread
+    TraceRecorder::instance().mark_realtime_thread();
+    
     // Get the input buffer
     const float* in = static_cast<const float*>(input_buffer);
     
     if (in) {
-        // Write data to the circular buffer
-        context->write_data(in, frames_per_buffer);
+        // PortAudio reports the ADC time on the stream clock; its distance
+        // from the stream's current time carries over to the trace clock.
+        // Hosts that leave it 0 get the buffer's duration before now.
+        int64_t now_us = trace_clock_us();
+        int64_t capture_time_us = context->sample_rate > 0
+            ? now_us - static_cast<int64_t>(frames_per_buffer * 1000000ull / context->sample_rate)
+            : now_us;
+        if (time_info && time_info->inputBufferAdcTime > 0.0 && time_info->currentTime >= time_info->inputBufferAdcTime) {
+            capture_time_us = now_us - static_cast<int64_t>((time_info->currentTime - time_info->inputBufferAdcTime) * 1e6);
+        }
+
+        // Write data to the circular buffer; the span is keyed by the chunk these samples start
+        ScopedTimer timer(Stage::CallbackToRing);
+        TraceSpan span(trace_span::kCapture,
+                       context->frames_per_buffer > 0 ? context->total_written / context->frames_per_buffer : 0);
+        context->write_data(in, frames_per_buffer, capture_time_us);
+        MetricsRegistry::instance().increment(Counter::AudioCallbacks);
     }
     
     return paContinue;
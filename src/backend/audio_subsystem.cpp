@@ -0,0 +1,43 @@
+#include "audio_subsystem.h"
+#include "audio_stream.h"
+#include <portaudio.h>
+
+namespace voice_transcription {
+
+static std::mutex& api_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// Guarded by api_mutex()
+static int references = 0;
+
+std::shared_ptr<AudioSubsystem> AudioSubsystem::acquire() {
+    std::lock_guard<std::mutex> lock(api_mutex());
+    if (references == 0) {
+        PaError err = Pa_Initialize();
+        if (err != paNoError) {
+            throw AudioStreamException(std::string("Failed to initialize PortAudio: ") + Pa_GetErrorText(err));
+        }
+    }
+    references++;
+    return std::shared_ptr<AudioSubsystem>(new AudioSubsystem());
+}
+
+AudioSubsystem::~AudioSubsystem() {
+    std::lock_guard<std::mutex> lock(api_mutex());
+    if (--references == 0) {
+        Pa_Terminate();
+    }
+}
+
+std::unique_lock<std::mutex> AudioSubsystem::lock() {
+    return std::unique_lock<std::mutex>(api_mutex());
+}
+
+int AudioSubsystem::reference_count() {
+    std::lock_guard<std::mutex> lock(api_mutex());
+    return references;
+}
+
+} // namespace voice_transcription
@@ -0,0 +1,433 @@
+#include "batch_transcriber.h"
+#include "json_escape.h"
+#include "model_cache.h"
+#include "wav_file_stream.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace voice_transcription {
+
+using Clock = std::chrono::steady_clock;
+
+std::string BatchFileResult::text() const {
+    std::string joined;
+    for (const auto& segment : segments) {
+        if (!joined.empty()) {
+            joined += ' ';
+        }
+        joined += segment.text;
+    }
+    return joined;
+}
+
+BatchTranscriber::BatchTranscriber(const BatchTranscriberConfig& config)
+    : config_(config) {
+}
+
+BatchTranscriber::~BatchTranscriber() = default;
+
+int BatchTranscriber::get_thread_count() const {
+    if (config_.threads > 0) {
+        return config_.threads;
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+bool BatchTranscriber::load_model() {
+    if (model_) {
+        return true;
+    }
+    model_ = ModelCache::instance().acquire(config_.engine, config_.model_path, last_error_);
+    return model_ != nullptr;
+}
+
+std::vector<SampleRange> BatchTranscriber::split_at_silence(const std::vector<float>& samples, int sample_rate,
+                                                            const BatchTranscriberConfig& config) {
+    VadSegmenterConfig vad_config;
+    vad_config.vad_aggressiveness = config.vad_aggressiveness;
+    VadSegmenter segmenter(vad_config, sample_rate);
+    return split_frames(segmenter.classify(samples.data(), samples.size()), segmenter.get_frame_size(),
+                        samples.size(), sample_rate, config);
+}
+
+std::vector<SampleRange> BatchTranscriber::split_frames(const std::vector<uint8_t>& speech, size_t frame,
+                                                        size_t total, int sample_rate,
+                                                        const BatchTranscriberConfig& config) {
+    std::vector<SampleRange> ranges;
+    if (total == 0) {
+        return ranges;
+    }
+    size_t max_samples = static_cast<size_t>(std::max(1, config.max_segment_ms)) * sample_rate / 1000;
+    if (frame == 0 || max_samples < frame) {
+        ranges.push_back({ 0, total });
+        return ranges;
+    }
+    size_t frames = speech.size();
+
+    // Cut in the middle of pauses between speech
+    size_t min_silence_frames = static_cast<size_t>(std::max(1, config.min_silence_ms / VadSegmenter::kFrameMs));
+    std::vector<size_t> cuts;
+    size_t f = 0;
+    while (f < frames) {
+        if (speech[f]) {
+            f++;
+            continue;
+        }
+        size_t run_start = f;
+        while (f < frames && !speech[f]) {
+            f++;
+        }
+        if (run_start > 0 && f < frames && f - run_start >= min_silence_frames) {
+            cuts.push_back((run_start + f) / 2 * frame);
+        }
+    }
+    cuts.push_back(total);
+
+    // Split overlong segments, preferring a silent frame in their second half
+    size_t start = 0;
+    for (size_t cut : cuts) {
+        while (cut - start > max_samples) {
+            size_t limit = start + max_samples;
+            size_t split = limit;
+            size_t earliest = (start + max_samples / 2) / frame;
+            for (size_t g = std::min(limit / frame, frames); g-- > earliest;) {
+                if (!speech[g]) {
+                    split = g * frame + frame / 2;
+                    break;
+                }
+            }
+            ranges.push_back({ start, split });
+            start = split;
+        }
+        ranges.push_back({ start, cut });
+        start = cut;
+    }
+    return ranges;
+}
+
+bool BatchTranscriber::collect_audio_files(const std::vector<std::string>& inputs,
+                                           std::vector<std::string>& files, std::string& error) {
+    namespace fs = std::filesystem;
+    for (const auto& input : inputs) {
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            std::vector<std::string> found;
+            for (fs::recursive_directory_iterator it(input, ec), end; !ec && it != end; it.increment(ec)) {
+                std::string extension = it->path().extension().string();
+                std::transform(extension.begin(), extension.end(), extension.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                if (it->is_regular_file(ec) && extension == ".wav") {
+                    found.push_back(it->path().string());
+                }
+            }
+            if (ec) {
+                error = "cannot list " + input + ": " + ec.message();
+                return false;
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else if (fs::path(input).extension() == ".txt" || fs::path(input).extension() == ".lst") {
+            std::ifstream list(input);
+            if (!list.is_open()) {
+                error = "cannot read file list " + input;
+                return false;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                if (!line.empty() && line[0] != '#') {
+                    files.push_back(line);
+                }
+            }
+        } else {
+            files.push_back(input);
+        }
+    }
+    return true;
+}
+
+bool BatchTranscriber::run(const std::vector<std::string>& paths, BatchReport& report) {
+    if (!load_model()) {
+        return false;
+    }
+
+    struct FileJob {
+        BatchFileResult result;
+        std::shared_ptr<const std::vector<float>> samples;
+        std::vector<std::vector<BatchSegment>> segments;    // One slot per range
+        size_t remaining = 0;
+        bool done = false;
+    };
+    struct Segment {
+        size_t file;
+        size_t index;
+        SpeechTimeline timeline;    // Audio of this segment to decode
+    };
+
+    const int threads = get_thread_count();
+    // Enough files read ahead to keep the queue full across file boundaries
+    const size_t max_files_in_flight = static_cast<size_t>(threads) + 1;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable file_done;
+    std::deque<Segment> queue;
+    std::vector<std::unique_ptr<FileJob>> jobs(paths.size());
+    size_t files_in_flight = 0;
+    size_t next_emit = 0;
+    bool producer_done = false;
+    std::mutex model_mutex;
+
+    report = BatchReport();
+    report.config = config_;
+    report.threads = threads;
+    report.files.resize(paths.size());
+
+    // Called with mutex held once every segment of a file is decoded
+    auto complete = [&](size_t index) {
+        FileJob& job = *jobs[index];
+        job.done = true;
+        job.samples.reset();
+        for (auto& decoded : job.segments) {
+            for (auto& segment : decoded) {
+                job.result.segments.push_back(std::move(segment));
+            }
+        }
+        job.segments.clear();
+        files_in_flight--;
+        file_done.notify_all();
+
+        // Hand files out in input order
+        while (next_emit < jobs.size() && jobs[next_emit] && jobs[next_emit]->done) {
+            report.files[next_emit] = std::move(jobs[next_emit]->result);
+            jobs[next_emit].reset();
+            if (file_callback_) {
+                file_callback_(report.files[next_emit]);
+            }
+            next_emit++;
+        }
+    };
+
+    auto worker = [&]() {
+        std::map<int, std::unique_ptr<StreamingRecognizer>> recognizers;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            work_ready.wait(lock, [&] { return !queue.empty() || producer_done; });
+            if (queue.empty()) {
+                return;
+            }
+            Segment segment = queue.front();
+            queue.pop_front();
+            FileJob& job = *jobs[segment.file];
+            std::shared_ptr<const std::vector<float>> samples = job.samples;
+            int sample_rate = job.result.sample_rate;
+            lock.unlock();
+
+            // Recognizers are per worker and per sample rate; decoding needs no lock
+            std::string error;
+            auto& recognizer = recognizers[sample_rate];
+            if (!recognizer) {
+                std::lock_guard<std::mutex> model_lock(model_mutex);
+                recognizer = model_->create_recognizer(static_cast<float>(sample_rate), error);
+            }
+
+            // Regions are fed back to back; positions in that stream map back
+            // to the file through the timeline
+            const SpeechTimeline& timeline = segment.timeline;
+            std::vector<BatchSegment> decoded;
+            size_t utterance_start = 0;
+            size_t position = 0;
+            auto collect = [&](const TranscriptionResult& result) {
+                if (!result.raw_text.empty()) {
+                    BatchSegment utterance;
+                    utterance.start_sample = timeline.to_original(utterance_start);
+                    utterance.end_sample = timeline.to_original_end(position);
+                    utterance.start_ms = utterance.start_sample * 1000.0 / sample_rate;
+                    utterance.end_ms = utterance.end_sample * 1000.0 / sample_rate;
+                    utterance.raw_text = result.raw_text;
+                    utterance.text = config_.inverse_text_normalization ? normalizer_.normalize(result.raw_text)
+                                                                        : result.raw_text;
+                    utterance.confidence = result.confidence;
+                    decoded.push_back(std::move(utterance));
+                }
+                utterance_start = position;
+            };
+
+            auto started = Clock::now();
+            if (recognizer) {
+                recognizer->reset();
+                size_t feed = std::max<size_t>(1, static_cast<size_t>(sample_rate) * config_.feed_ms / 1000);
+                for (const auto& region : timeline.regions()) {
+                    for (size_t pos = region.start_sample; pos < region.end_sample; pos += feed) {
+                        size_t count = std::min(feed, region.end_sample - pos);
+                        bool endpoint = recognizer->accept_waveform(samples->data() + pos, count);
+                        position += count;
+                        if (endpoint) {
+                            collect(recognizer->result());
+                        }
+                    }
+                }
+                collect(recognizer->final_result());
+            }
+            double decode_ms = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+
+            lock.lock();
+            if (!recognizer && job.result.error.empty()) {
+                job.result.error = error;
+            }
+            job.result.decode_ms += decode_ms;
+            job.result.speech_ms += timeline.kept_samples() * 1000.0 / sample_rate;
+            job.segments[segment.index] = std::move(decoded);
+            if (--job.remaining == 0) {
+                complete(segment.file);
+            }
+        }
+    };
+
+    auto started = Clock::now();
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; i++) {
+        pool.emplace_back(worker);
+    }
+
+    // Read and split files on this thread while the workers decode
+    for (size_t i = 0; i < paths.size(); i++) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            file_done.wait(lock, [&] { return files_in_flight < max_files_in_flight; });
+        }
+
+        auto job = std::make_unique<FileJob>();
+        job->result.path = paths[i];
+        auto samples = std::make_shared<std::vector<float>>();
+        std::vector<SampleRange> ranges;
+        SpeechTimeline speech;
+        if (WavFileStream::read_wav(paths[i], *samples, job->result.sample_rate, job->result.error)) {
+            job->result.sample_count = samples->size();
+            job->result.duration_ms = samples->size() * 1000.0 / job->result.sample_rate;
+
+            // One VAD pass gives both the cut points and the speech regions
+            VadSegmenterConfig vad_config;
+            vad_config.vad_aggressiveness = config_.vad_aggressiveness;
+            vad_config.padding_ms = config_.speech_padding_ms;
+            VadSegmenter segmenter(vad_config, job->result.sample_rate);
+            std::vector<uint8_t> frames = segmenter.classify(samples->data(), samples->size());
+            ranges = split_frames(frames, segmenter.get_frame_size(), samples->size(),
+                                  job->result.sample_rate, config_);
+            if (config_.skip_silence) {
+                speech = segmenter.regions_from_frames(frames, samples->size());
+            } else {
+                speech.add({ 0, samples->size() });
+            }
+        }
+        job->samples = std::move(samples);
+        job->segments.resize(ranges.size());
+        job->remaining = ranges.size();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        report.audio_seconds += job->result.duration_ms / 1000.0;
+        if (job->result.sample_rate > 0) {
+            report.decoded_seconds += speech.kept_samples() / static_cast<double>(job->result.sample_rate);
+        }
+        jobs[i] = std::move(job);
+        files_in_flight++;
+        if (ranges.empty()) {
+            complete(i);
+            continue;
+        }
+        for (size_t r = 0; r < ranges.size(); r++) {
+            queue.push_back({ i, r, speech.slice(ranges[r]) });
+        }
+        work_ready.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        producer_done = true;
+    }
+    work_ready.notify_all();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    report.wall_seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    return true;
+}
+
+std::string BatchReport::to_json() const {
+    size_t failed = 0;
+    size_t segments = 0;
+    for (const auto& file : files) {
+        failed += file.error.empty() ? 0 : 1;
+        segments += file.segments.size();
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"config\":{\"engine\":\"" << escape_json(config.engine) << "\""
+        << ",\"model_path\":\"" << escape_json(config.model_path) << "\""
+        << ",\"threads\":" << threads
+        << ",\"vad_aggressiveness\":" << config.vad_aggressiveness
+        << ",\"min_silence_ms\":" << config.min_silence_ms
+        << ",\"max_segment_ms\":" << config.max_segment_ms
+        << ",\"skip_silence\":" << (config.skip_silence ? "true" : "false")
+        << ",\"speech_padding_ms\":" << config.speech_padding_ms << "}";
+
+    out << ",\"summary\":{\"files\":" << files.size()
+        << ",\"failed\":" << failed
+        << ",\"segments\":" << segments
+        << ",\"audio_seconds\":" << audio_seconds
+        << ",\"decoded_seconds\":" << decoded_seconds
+        << ",\"skipped_fraction\":" << (audio_seconds > 0.0 ? 1.0 - decoded_seconds / audio_seconds : 0.0)
+        << ",\"wall_seconds\":" << wall_seconds
+        << ",\"speed\":" << speed() << "}";
+
+    out << ",\"files\":[";
+    for (size_t i = 0; i < files.size(); i++) {
+        const auto& file = files[i];
+        out << (i ? "," : "") << "{\"path\":\"" << escape_json(file.path) << "\""
+            << ",\"sample_rate\":" << file.sample_rate
+            << ",\"duration_ms\":" << file.duration_ms
+            << ",\"speech_ms\":" << file.speech_ms
+            << ",\"decode_ms\":" << file.decode_ms;
+        if (!file.error.empty()) {
+            out << ",\"error\":\"" << escape_json(file.error) << "\"";
+        }
+        out << ",\"text\":\"" << escape_json(file.text()) << "\",\"segments\":[";
+        for (size_t s = 0; s < file.segments.size(); s++) {
+            const auto& segment = file.segments[s];
+            out << (s ? "," : "") << "{\"start_sample\":" << segment.start_sample
+                << ",\"end_sample\":" << segment.end_sample
+                << ",\"start_ms\":" << segment.start_ms
+                << ",\"end_ms\":" << segment.end_ms
+                << ",\"text\":\"" << escape_json(segment.text) << "\""
+                << ",\"raw_text\":\"" << escape_json(segment.raw_text) << "\""
+                << ",\"confidence\":" << segment.confidence << "}";
+        }
+        out << "]}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+bool BatchReport::write_json(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << to_json() << "\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace voice_transcription
\ No newline at end of file
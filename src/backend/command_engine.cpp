@@ -0,0 +1,504 @@
+#include "command_engine.h"
+#include "command_tokenize.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+namespace voice_transcription {
+
+static inline char to_upper(char c) {
+    return static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+}
+
+CommandEngine::CommandEngine()
+    : CommandEngine(std::vector<CommandDefinition>()) {
+}
+
+CommandEngine::CommandEngine(const std::vector<CommandDefinition>& commands)
+    : snapshot_(CompiledCommandSet::compile(commands)),
+      snapshot_version_(1),
+      loaded_from_cache_(false),
+      commands_(commands),
+      requested_revision_(0),
+      published_revision_(0),
+      stop_(false),
+      capitalization_mode_(CapitalizationMode::Auto) {
+}
+
+CommandEngine::~CommandEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    reload_cv_.notify_all();
+    if (reload_thread_.joinable()) {
+        reload_thread_.join();
+    }
+}
+
+bool CommandEngine::parse_commands(const std::string& json, std::vector<CommandDefinition>& commands,
+                                   std::string& error) {
+    rapidjson::Document doc;
+    // settings.json carries comments and trailing commas, so accept both
+    doc.Parse<rapidjson::kParseCommentsFlag | rapidjson::kParseTrailingCommasFlag>(json.c_str());
+
+    if (doc.HasParseError()) {
+        error = "JSON parse error: " + std::string(rapidjson::GetParseError_En(doc.GetParseError()));
+        return false;
+    }
+
+    // Locate the command list
+    const rapidjson::Value* list = nullptr;
+    if (doc.IsArray()) {
+        list = &doc;
+    } else if (doc.IsObject()) {
+        if (doc.HasMember("dictation_commands") && doc["dictation_commands"].IsObject()) {
+            const rapidjson::Value& dictation = doc["dictation_commands"];
+            if (dictation.HasMember("supported_commands") && dictation["supported_commands"].IsArray()) {
+                list = &dictation["supported_commands"];
+            }
+        } else if (doc.HasMember("supported_commands") && doc["supported_commands"].IsArray()) {
+            list = &doc["supported_commands"];
+        }
+    }
+
+    if (!list) {
+        error = "No supported_commands array found";
+        return false;
+    }
+
+    commands.clear();
+    for (rapidjson::SizeType i = 0; i < list->Size(); i++) {
+        const rapidjson::Value& entry = (*list)[i];
+        if (!entry.IsObject() ||
+            !entry.HasMember("phrase") || !entry["phrase"].IsString() ||
+            !entry.HasMember("action") || !entry["action"].IsString()) {
+            continue;
+        }
+
+        CommandDefinition command;
+        command.phrase = entry["phrase"].GetString();
+        command.action = entry["action"].GetString();
+
+        if (entry.HasMember("aliases") && entry["aliases"].IsArray()) {
+            const rapidjson::Value& aliases = entry["aliases"];
+            for (rapidjson::SizeType j = 0; j < aliases.Size(); j++) {
+                if (aliases[j].IsString()) {
+                    command.aliases.push_back(aliases[j].GetString());
+                }
+            }
+        }
+
+        commands.push_back(std::move(command));
+    }
+    return true;
+}
+
+bool CommandEngine::load_json(const std::string& json) {
+    std::vector<CommandDefinition> commands;
+    std::string error;
+    if (!parse_commands(json, commands, error)) {
+        set_last_error(error);
+        return false;
+    }
+
+    load_commands(commands);
+    return true;
+}
+
+void CommandEngine::load_commands(const std::vector<CommandDefinition>& commands) {
+    uint64_t revision;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_ = commands;
+        revision = ++requested_revision_;
+    }
+
+    bool from_cache = false;
+    std::shared_ptr<const CompiledCommandSet> set = build(commands, from_cache);
+    publish(std::move(set), revision, from_cache);
+}
+
+bool CommandEngine::reload_json(const std::string& json) {
+    std::vector<CommandDefinition> commands;
+    std::string error;
+    if (!parse_commands(json, commands, error)) {
+        set_last_error(error);
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_ = std::move(commands);
+    }
+    request_reload();
+    return true;
+}
+
+bool CommandEngine::add_command(const std::string& phrase, const std::string& action,
+                                const std::vector<std::string>& aliases) {
+    if (split_phrase(phrase).empty() || action.empty()) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back({phrase, action, aliases});
+    }
+    request_reload();
+    return true;
+}
+
+bool CommandEngine::remove_command(const std::string& phrase) {
+    std::vector<std::string> words = split_phrase(phrase);
+    if (words.empty()) {
+        return false;
+    }
+
+    // Remove the phrase wherever it appears, as a primary phrase or an alias
+    bool removed = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = commands_.begin(); it != commands_.end();) {
+            auto& aliases = it->aliases;
+            size_t alias_count = aliases.size();
+            aliases.erase(std::remove_if(aliases.begin(), aliases.end(),
+                [&](const std::string& alias) { return split_phrase(alias) == words; }), aliases.end());
+            removed |= aliases.size() != alias_count;
+
+            if (split_phrase(it->phrase) == words) {
+                removed = true;
+                if (aliases.empty()) {
+                    it = commands_.erase(it);
+                    continue;
+                }
+                // Promote the first alias so the remaining aliases keep working
+                it->phrase = aliases.front();
+                aliases.erase(aliases.begin());
+            }
+            ++it;
+        }
+    }
+
+    if (removed) {
+        request_reload();
+    }
+    return removed;
+}
+
+std::vector<CommandDefinition> CommandEngine::get_commands() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_;
+}
+
+std::vector<std::string> CommandEngine::get_phrases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> phrases;
+    auto add = [&phrases](const std::string& phrase) {
+        std::string lowered = phrase;
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (!lowered.empty() && std::find(phrases.begin(), phrases.end(), lowered) == phrases.end()) {
+            phrases.push_back(std::move(lowered));
+        }
+    };
+    for (const CommandDefinition& command : commands_) {
+        add(command.phrase);
+        for (const std::string& alias : command.aliases) {
+            add(alias);
+        }
+    }
+    return phrases;
+}
+
+bool CommandEngine::wait_for_reload(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return published_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                  [this]() { return published_revision_ >= requested_revision_; });
+}
+
+void CommandEngine::set_cache_path(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_path_ = path;
+}
+
+std::string CommandEngine::get_last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+void CommandEngine::set_last_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_error_ = error;
+}
+
+std::shared_ptr<const CompiledCommandSet> CommandEngine::build(const std::vector<CommandDefinition>& commands,
+                                                               bool& from_cache) {
+    std::string cache_path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_path = cache_path_;
+    }
+
+    from_cache = false;
+    if (cache_path.empty()) {
+        return CompiledCommandSet::compile(commands);
+    }
+
+    // A missing or stale cache is expected, so only write failures are reported
+    std::string error;
+    std::shared_ptr<const CompiledCommandSet> set =
+        CompiledCommandSet::load(cache_path, CompiledCommandSet::hash_commands(commands), error);
+    if (set) {
+        from_cache = true;
+        return set;
+    }
+
+    set = CompiledCommandSet::compile(commands);
+    if (!set->save(cache_path, error)) {
+        set_last_error(error);
+    }
+    return set;
+}
+
+void CommandEngine::publish(std::shared_ptr<const CompiledCommandSet> set, uint64_t revision, bool from_cache) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // A newer synchronous load may already have been published
+        if (revision <= published_revision_) {
+            return;
+        }
+        std::atomic_store(&snapshot_, std::move(set));
+        published_revision_ = revision;
+        loaded_from_cache_ = from_cache;
+        snapshot_version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    published_cv_.notify_all();
+}
+
+void CommandEngine::request_reload() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++requested_revision_;
+        if (!reload_thread_.joinable()) {
+            reload_thread_ = std::thread(&CommandEngine::reload_thread, this);
+        }
+    }
+    reload_cv_.notify_one();
+}
+
+void CommandEngine::reload_thread() {
+    uint64_t compiled_revision = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        reload_cv_.wait(lock, [&]() {
+            return stop_ || (requested_revision_ > published_revision_ && requested_revision_ > compiled_revision);
+        });
+        if (stop_) {
+            break;
+        }
+
+        // Compile the latest command list; changes made meanwhile are coalesced into the next pass
+        uint64_t revision = requested_revision_;
+        std::vector<CommandDefinition> commands = commands_;
+        lock.unlock();
+
+        bool from_cache = false;
+        std::shared_ptr<const CompiledCommandSet> set = build(commands, from_cache);
+        publish(std::move(set), revision, from_cache);
+        compiled_revision = revision;
+
+        lock.lock();
+    }
+}
+
+bool CommandEngine::set_capitalization_mode(const std::string& mode) {
+    std::lock_guard<std::mutex> lock(process_mutex_);
+    if (mode == "auto") {
+        capitalization_mode_ = CapitalizationMode::Auto;
+    } else if (mode == "all_caps") {
+        capitalization_mode_ = CapitalizationMode::AllCaps;
+    } else if (mode == "none") {
+        capitalization_mode_ = CapitalizationMode::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string CommandEngine::get_capitalization_mode() const {
+    std::lock_guard<std::mutex> lock(process_mutex_);
+    switch (capitalization_mode_) {
+        case CapitalizationMode::AllCaps: return "all_caps";
+        case CapitalizationMode::None: return "none";
+        default: return "auto";
+    }
+}
+
+std::string CommandEngine::process(const std::string& text) {
+    // Hold one snapshot for the whole call; a concurrent reload swaps in the next one
+    std::shared_ptr<const CompiledCommandSet> set = snapshot();
+    if (text.empty() || set->empty()) {
+        return text;
+    }
+
+    // The bindings release the GIL here, so Python threads may call in at once
+    std::lock_guard<std::mutex> lock(process_mutex_);
+
+    // Tokenize on whitespace, looking each lower-cased word up in the phrase vocabulary
+    tokens_.clear();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && is_space(text[pos])) {
+            pos++;
+        }
+        size_t begin = pos;
+        lowered_.clear();
+        while (pos < text.size() && !is_space(text[pos])) {
+            lowered_.push_back(to_lower(text[pos]));
+            pos++;
+        }
+        if (pos > begin) {
+            tokens_.push_back({begin, pos - begin, set->lookup_token(lowered_)});
+        }
+    }
+
+    // Run the automaton and keep the longest phrase starting at each token
+    const size_t count = tokens_.size();
+    match_length_.assign(count, 0);
+    match_action_.assign(count, 0);
+
+    int32_t state = 0;
+    for (size_t i = 0; i < count; i++) {
+        state = set->next_state(state, tokens_[i].id);
+        set->for_each_match(state, [&](uint32_t length, uint32_t action) {
+            size_t start = i + 1 - length;
+            if (length > match_length_[start]) {
+                match_length_[start] = length;
+                match_action_[start] = action;
+            }
+        });
+    }
+
+    // Emit words and actions left to right, applying capitalization and spacing
+    std::string output;
+    output.reserve(text.size() + 16);
+    bool need_space = false;
+    bool quote_open = false;
+    bool capitalize_next = true;
+
+    auto trim_trailing_spaces = [&output]() {
+        while (!output.empty() && output.back() == ' ') {
+            output.pop_back();
+        }
+    };
+
+    auto emit_word = [&](const char* data, size_t length) {
+        if (need_space && !output.empty()) {
+            output.push_back(' ');
+        }
+        size_t start = output.size();
+        output.append(data, length);
+
+        if (capitalization_mode_ == CapitalizationMode::AllCaps) {
+            for (size_t i = start; i < output.size(); i++) {
+                output[i] = to_upper(output[i]);
+            }
+        } else if (capitalization_mode_ == CapitalizationMode::Auto && capitalize_next &&
+                   std::isalpha(static_cast<unsigned char>(output[start]))) {
+            output[start] = to_upper(output[start]);
+        }
+
+        capitalize_next = false;
+        need_space = true;
+    };
+
+    size_t i = 0;
+    while (i < count) {
+        if (match_length_[i] == 0) {
+            emit_word(text.data() + tokens_[i].begin, tokens_[i].length);
+            i++;
+            continue;
+        }
+
+        const CompiledCommandSet::Action& action = set->action(match_action_[i]);
+        i += match_length_[i];
+
+        switch (action.kind) {
+            case ActionKind::Punctuation:
+                trim_trailing_spaces();
+                output += action.text;
+                need_space = true;
+                if (action.text[0] == '.' || action.text[0] == '!' || action.text[0] == '?') {
+                    capitalize_next = true;
+                }
+                break;
+
+            case ActionKind::Closer:
+                trim_trailing_spaces();
+                output += action.text;
+                need_space = true;
+                break;
+
+            case ActionKind::Opener:
+                if (need_space && !output.empty()) {
+                    output.push_back(' ');
+                }
+                output += action.text;
+                need_space = false;
+                break;
+
+            case ActionKind::Quote:
+                if (quote_open) {
+                    trim_trailing_spaces();
+                    output += action.text;
+                    need_space = true;
+                } else {
+                    if (need_space && !output.empty()) {
+                        output.push_back(' ');
+                    }
+                    output += action.text;
+                    need_space = false;
+                }
+                quote_open = !quote_open;
+                break;
+
+            case ActionKind::Keystroke:
+                output += action.text;
+                need_space = false;
+                break;
+
+            case ActionKind::Space:
+                if (output.empty() || output.back() != ' ') {
+                    output.push_back(' ');
+                }
+                need_space = false;
+                break;
+
+            case ActionKind::CapsOn:
+                capitalization_mode_ = CapitalizationMode::AllCaps;
+                break;
+
+            case ActionKind::CapsOff:
+                capitalization_mode_ = CapitalizationMode::Auto;
+                break;
+
+            case ActionKind::Word: {
+                // Custom text actions are spaced like words, ignoring padding in the config
+                size_t first = action.text.find_first_not_of(" \t");
+                size_t last = action.text.find_last_not_of(" \t");
+                if (first != std::string::npos) {
+                    emit_word(action.text.data() + first, last - first + 1);
+                }
+                break;
+            }
+        }
+    }
+
+    return output;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
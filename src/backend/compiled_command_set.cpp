@@ -0,0 +1,451 @@
+#include "compiled_command_set.h"
+#include "command_tokenize.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace voice_transcription {
+
+// Binary cache header
+static constexpr uint32_t kCacheMagic = 0x53435456;    // "VTCS" little-endian
+static constexpr uint32_t kCacheVersion = 1;
+
+static constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+static constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+static inline uint64_t transition_key(int32_t state, uint32_t token) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(state)) << 32) | token;
+}
+
+static uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * kFnvPrime;
+    }
+    return hash;
+}
+
+// Append-only writer for the cache payload
+class BinaryWriter {
+public:
+    template <typename T>
+    void write(const T& value) {
+        data_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write_string(const std::string& value) {
+        write(static_cast<uint32_t>(value.size()));
+        data_.append(value);
+    }
+
+    std::string& data() { return data_; }
+
+private:
+    std::string data_;
+};
+
+// Bounds-checked reader; any overrun latches the failed flag
+class BinaryReader {
+public:
+    BinaryReader(const std::string& data, size_t offset) : data_(data), pos_(offset) {}
+
+    template <typename T>
+    T read() {
+        T value{};
+        if (failed_ || data_.size() - pos_ < sizeof(T)) {
+            failed_ = true;
+            return value;
+        }
+        std::memcpy(&value, data_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string read_string() {
+        uint32_t size = read<uint32_t>();
+        if (failed_ || data_.size() - pos_ < size) {
+            failed_ = true;
+            return std::string();
+        }
+        std::string value = data_.substr(pos_, size);
+        pos_ += size;
+        return value;
+    }
+
+    // Guard element counts so a corrupt file cannot trigger huge allocations
+    uint32_t read_count(size_t min_element_size) {
+        uint32_t count = read<uint32_t>();
+        if (!failed_ && static_cast<uint64_t>(count) * min_element_size > data_.size() - pos_) {
+            failed_ = true;
+        }
+        return failed_ ? 0 : count;
+    }
+
+    bool failed() const { return failed_; }
+    bool at_end() const { return pos_ == data_.size(); }
+
+private:
+    const std::string& data_;
+    size_t pos_;
+    bool failed_ = false;
+};
+
+uint64_t CompiledCommandSet::hash_commands(const std::vector<CommandDefinition>& commands) {
+    uint64_t hash = kFnvOffset;
+    auto mix = [&hash](const std::string& value) {
+        uint32_t size = static_cast<uint32_t>(value.size());
+        hash = fnv1a(hash, &size, sizeof(size));
+        hash = fnv1a(hash, value.data(), value.size());
+    };
+
+    for (const auto& command : commands) {
+        mix(command.phrase);
+        mix(command.action);
+        uint32_t alias_count = static_cast<uint32_t>(command.aliases.size());
+        hash = fnv1a(hash, &alias_count, sizeof(alias_count));
+        for (const auto& alias : command.aliases) {
+            mix(alias);
+        }
+    }
+    return hash;
+}
+
+ActionKind CompiledCommandSet::classify_action(const std::string& action) {
+    if (action == "{ALLCAPS_ON}") {
+        return ActionKind::CapsOn;
+    }
+    if (action == "{ALLCAPS_OFF}") {
+        return ActionKind::CapsOff;
+    }
+    if (!action.empty() && std::all_of(action.begin(), action.end(), is_space)) {
+        return ActionKind::Space;
+    }
+    if (action.size() > 2 && action.front() == '{' && action.back() == '}') {
+        return ActionKind::Keystroke;
+    }
+    if (action.size() == 1) {
+        switch (action[0]) {
+            case '.': case ',': case ';': case ':': case '!': case '?':
+                return ActionKind::Punctuation;
+            case '(': case '[': case '{':
+                return ActionKind::Opener;
+            case ')': case ']': case '}':
+                return ActionKind::Closer;
+            case '"':
+                return ActionKind::Quote;
+            default:
+                break;
+        }
+    }
+    return ActionKind::Word;
+}
+
+uint32_t CompiledCommandSet::intern_token(const std::string& token) {
+    auto it = token_ids_.find(token);
+    if (it != token_ids_.end()) {
+        return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(token_ids_.size());
+    token_ids_.emplace(token, id);
+    return id;
+}
+
+uint32_t CompiledCommandSet::lookup_token(const std::string& token) const {
+    auto it = token_ids_.find(token);
+    return it != token_ids_.end() ? it->second : kUnknownToken;
+}
+
+int32_t CompiledCommandSet::child(int32_t state, uint32_t token) const {
+    auto it = transitions_.find(transition_key(state, token));
+    return it != transitions_.end() ? it->second : -1;
+}
+
+int32_t CompiledCommandSet::next_state(int32_t state, uint32_t token) const {
+    if (token == kUnknownToken) {
+        return 0;
+    }
+    while (true) {
+        int32_t next = child(state, token);
+        if (next >= 0) {
+            return next;
+        }
+        if (state == 0) {
+            return 0;
+        }
+        state = nodes_[state].fail;
+    }
+}
+
+std::shared_ptr<const CompiledCommandSet> CompiledCommandSet::compile(const std::vector<CommandDefinition>& commands) {
+    std::shared_ptr<CompiledCommandSet> set(new CompiledCommandSet());
+    set->source_hash_ = hash_commands(commands);
+    set->nodes_.assign(1, Node());
+
+    auto& nodes = set->nodes_;
+    auto& phrases = set->phrases_;
+    auto& actions = set->actions_;
+
+    // Children per node, only needed while computing failure links
+    std::vector<std::vector<std::pair<uint32_t, int32_t>>> edges(1);
+
+    for (const auto& command : commands) {
+        uint32_t action_index = static_cast<uint32_t>(actions.size());
+        actions.push_back({command.action, classify_action(command.action)});
+
+        auto insert_phrase = [&](const std::string& phrase) {
+            std::vector<std::string> words = split_phrase(phrase);
+            if (words.empty()) {
+                return;
+            }
+
+            int32_t state = 0;
+            for (const auto& word : words) {
+                uint32_t token = set->intern_token(word);
+                int32_t next = set->child(state, token);
+                if (next < 0) {
+                    next = static_cast<int32_t>(nodes.size());
+                    Node node;
+                    node.depth = nodes[state].depth + 1;
+                    nodes.push_back(node);
+                    edges.emplace_back();
+                    edges[state].emplace_back(token, next);
+                    set->transitions_.emplace(transition_key(state, token), next);
+                }
+                state = next;
+            }
+
+            // Later definitions of the same phrase win, as with the Python dict
+            if (nodes[state].phrase >= 0) {
+                phrases[nodes[state].phrase].action = action_index;
+            } else {
+                nodes[state].phrase = static_cast<int32_t>(phrases.size());
+                phrases.push_back({action_index, static_cast<uint32_t>(words.size())});
+            }
+        };
+
+        insert_phrase(command.phrase);
+        for (const auto& alias : command.aliases) {
+            insert_phrase(alias);
+        }
+    }
+
+    // Breadth-first pass computing failure and dictionary links
+    std::vector<int32_t> queue;
+    queue.reserve(nodes.size());
+    for (const auto& edge : edges[0]) {
+        nodes[edge.second].fail = 0;
+        queue.push_back(edge.second);
+    }
+
+    for (size_t head = 0; head < queue.size(); head++) {
+        int32_t state = queue[head];
+        for (const auto& edge : edges[state]) {
+            int32_t target = edge.second;
+            int32_t fallback = nodes[state].fail;
+            while (fallback != 0 && set->child(fallback, edge.first) < 0) {
+                fallback = nodes[fallback].fail;
+            }
+            int32_t fail = set->child(fallback, edge.first);
+            nodes[target].fail = (fail >= 0 && fail != target) ? fail : 0;
+
+            const Node& fail_node = nodes[nodes[target].fail];
+            nodes[target].dict_link = fail_node.phrase >= 0 ? nodes[target].fail : fail_node.dict_link;
+            queue.push_back(target);
+        }
+    }
+
+    return set;
+}
+
+std::string CompiledCommandSet::serialize() const {
+    BinaryWriter payload;
+
+    // Tokens in id order so ids are implied by position
+    std::vector<const std::string*> tokens(token_ids_.size());
+    for (const auto& entry : token_ids_) {
+        tokens[entry.second] = &entry.first;
+    }
+    payload.write(static_cast<uint32_t>(tokens.size()));
+    for (const std::string* token : tokens) {
+        payload.write_string(*token);
+    }
+
+    // Sorted so identical sets always produce identical bytes
+    std::vector<std::pair<uint64_t, int32_t>> transitions(transitions_.begin(), transitions_.end());
+    std::sort(transitions.begin(), transitions.end());
+    payload.write(static_cast<uint32_t>(transitions.size()));
+    for (const auto& entry : transitions) {
+        payload.write(entry.first);
+        payload.write(entry.second);
+    }
+
+    payload.write(static_cast<uint32_t>(nodes_.size()));
+    for (const auto& node : nodes_) {
+        payload.write(node.fail);
+        payload.write(node.dict_link);
+        payload.write(node.phrase);
+        payload.write(node.depth);
+    }
+
+    payload.write(static_cast<uint32_t>(phrases_.size()));
+    for (const auto& phrase : phrases_) {
+        payload.write(phrase.action);
+        payload.write(phrase.length);
+    }
+
+    payload.write(static_cast<uint32_t>(actions_.size()));
+    for (const auto& action : actions_) {
+        payload.write_string(action.text);
+        payload.write(static_cast<uint8_t>(action.kind));
+    }
+
+    // Header: magic, version, source hash, payload checksum
+    BinaryWriter out;
+    out.write(kCacheMagic);
+    out.write(kCacheVersion);
+    out.write(source_hash_);
+    out.write(fnv1a(kFnvOffset, payload.data().data(), payload.data().size()));
+    out.data() += payload.data();
+    return std::move(out.data());
+}
+
+std::shared_ptr<const CompiledCommandSet> CompiledCommandSet::deserialize(const std::string& data, std::string& error) {
+    BinaryReader header(data, 0);
+    uint32_t magic = header.read<uint32_t>();
+    uint32_t version = header.read<uint32_t>();
+    uint64_t source_hash = header.read<uint64_t>();
+    uint64_t checksum = header.read<uint64_t>();
+
+    if (header.failed() || magic != kCacheMagic) {
+        error = "Not a compiled command set";
+        return nullptr;
+    }
+    if (version != kCacheVersion) {
+        error = "Unsupported command set version " + std::to_string(version);
+        return nullptr;
+    }
+
+    const size_t header_size = 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+    if (fnv1a(kFnvOffset, data.data() + header_size, data.size() - header_size) != checksum) {
+        error = "Command set checksum mismatch";
+        return nullptr;
+    }
+
+    std::shared_ptr<CompiledCommandSet> set(new CompiledCommandSet());
+    set->source_hash_ = source_hash;
+    BinaryReader reader(data, header_size);
+
+    uint32_t token_count = reader.read_count(sizeof(uint32_t));
+    set->token_ids_.reserve(token_count);
+    for (uint32_t i = 0; i < token_count; i++) {
+        set->token_ids_.emplace(reader.read_string(), i);
+    }
+
+    uint32_t transition_count = reader.read_count(sizeof(uint64_t) + sizeof(int32_t));
+    set->transitions_.reserve(transition_count);
+    for (uint32_t i = 0; i < transition_count; i++) {
+        uint64_t key = reader.read<uint64_t>();
+        set->transitions_.emplace(key, reader.read<int32_t>());
+    }
+
+    uint32_t node_count = reader.read_count(sizeof(Node));
+    set->nodes_.resize(node_count);
+    for (auto& node : set->nodes_) {
+        node.fail = reader.read<int32_t>();
+        node.dict_link = reader.read<int32_t>();
+        node.phrase = reader.read<int32_t>();
+        node.depth = reader.read<uint32_t>();
+    }
+
+    uint32_t phrase_count = reader.read_count(sizeof(Phrase));
+    set->phrases_.resize(phrase_count);
+    for (auto& phrase : set->phrases_) {
+        phrase.action = reader.read<uint32_t>();
+        phrase.length = reader.read<uint32_t>();
+    }
+
+    uint32_t action_count = reader.read_count(sizeof(uint32_t) + 1);
+    set->actions_.resize(action_count);
+    for (auto& action : set->actions_) {
+        action.text = reader.read_string();
+        action.kind = static_cast<ActionKind>(reader.read<uint8_t>());
+    }
+
+    if (reader.failed() || !reader.at_end() || set->nodes_.empty()) {
+        error = "Truncated or malformed command set";
+        return nullptr;
+    }
+
+    // Validate indices so a stale or hand-edited file cannot read out of bounds
+    const int32_t nodes = static_cast<int32_t>(set->nodes_.size());
+    const int32_t phrases = static_cast<int32_t>(set->phrases_.size());
+    for (const auto& node : set->nodes_) {
+        if (node.fail < 0 || node.fail >= nodes || node.dict_link < -1 || node.dict_link >= nodes ||
+            node.phrase < -1 || node.phrase >= phrases) {
+            error = "Command set contains invalid node links";
+            return nullptr;
+        }
+    }
+    for (const auto& entry : set->transitions_) {
+        if (entry.second <= 0 || entry.second >= nodes) {
+            error = "Command set contains invalid transitions";
+            return nullptr;
+        }
+    }
+    for (const auto& phrase : set->phrases_) {
+        if (phrase.action >= set->actions_.size() || phrase.length == 0) {
+            error = "Command set contains invalid phrases";
+            return nullptr;
+        }
+    }
+
+    return set;
+}
+
+bool CompiledCommandSet::save(const std::string& path, std::string& error) const {
+    // Write to a temporary file and rename so readers never see a partial cache
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            error = "Failed to open " + temp_path + " for writing";
+            return false;
+        }
+        std::string data = serialize();
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            error = "Failed to write " + temp_path;
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        error = "Failed to rename " + temp_path + " to " + path;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const CompiledCommandSet> CompiledCommandSet::load(const std::string& path, uint64_t expected_hash,
+                                                                   std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = "No command set cache at " + path;
+        return nullptr;
+    }
+
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    std::shared_ptr<const CompiledCommandSet> set = deserialize(buffer.str(), error);
+    if (set && set->source_hash() != expected_hash) {
+        error = "Command set cache is out of date";
+        return nullptr;
+    }
+    return set;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,384 @@
+#include "device_capability_cache.h"
+#include "audio_subsystem.h"
+#include "json_escape.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <sstream>
+
+namespace voice_transcription {
+
+const std::vector<int>& DeviceCapabilityCache::candidate_rates() {
+    static const std::vector<int> rates = { 8000, 16000, 22050, 32000, 44100, 48000, 96000 };
+    return rates;
+}
+
+DeviceCapabilityCache& DeviceCapabilityCache::instance() {
+    static DeviceCapabilityCache cache;
+    return cache;
+}
+
+DeviceCapabilityCache::DeviceCapabilityCache() {
+    // The probe thread uses the subsystem's lock until it is joined in our
+    // destructor, so that lock must be constructed first and destroyed last
+    AudioSubsystem::reference_count();
+}
+
+DeviceCapabilityCache::~DeviceCapabilityCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        update_callback_ = nullptr;
+    }
+    work_available_.notify_all();
+    if (prober_.joinable()) {
+        prober_.join();
+    }
+}
+
+// Same parameters as a ControlledAudioStream opens with
+static PaError probe_rate(int device_id, const PaDeviceInfo* info, int sample_rate) {
+    PaStreamParameters params;
+    params.device = device_id;
+    params.channelCount = 1;
+    params.sampleFormat = paFloat32;
+    params.suggestedLatency = info->defaultLowInputLatency;
+    params.hostApiSpecificStreamInfo = nullptr;
+    return Pa_IsFormatSupported(&params, nullptr, sample_rate);
+}
+
+static std::string host_api_name(const PaDeviceInfo* info) {
+    const PaHostApiInfo* host = Pa_GetHostApiInfo(info->hostApi);
+    return host ? host->name : "Unknown";
+}
+
+std::vector<AudioDevice> DeviceCapabilityCache::enumerate(bool wait) {
+    std::vector<AudioDevice> devices;
+    {
+        // A reference of its own, so the list is fresh when no stream is open
+        std::shared_ptr<AudioSubsystem> audio = AudioSubsystem::acquire();
+        std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
+        int count = Pa_GetDeviceCount();
+        int default_input = Pa_GetDefaultInputDevice();
+        for (int i = 0; i < count; i++) {
+            const PaDeviceInfo* info = Pa_GetDeviceInfo(i);
+            if (!info || info->maxInputChannels <= 0) {
+                continue;
+            }
+            AudioDevice device;
+            device.id = i;
+            device.raw_name = info->name;
+            device.label = info->name;
+            device.host_api = host_api_name(info);
+            device.is_default = (i == default_input);
+            devices.push_back(device);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool missing = false;
+    for (AudioDevice& device : devices) {
+        DeviceKey key(device.raw_name, device.host_api);
+        auto entry = capabilities_.find(key);
+        if (entry != capabilities_.end()) {
+            device.supported_sample_rates = entry->second;
+            device.capabilities_known = true;
+            stats_.hits++;
+            continue;
+        }
+        device.capabilities_known = false;
+        stats_.misses++;
+        missing = true;
+        if (std::find(pending_.begin(), pending_.end(), key) == pending_.end()) {
+            pending_.push_back(key);
+        }
+    }
+    if (!missing) {
+        return devices;
+    }
+    start_probing();
+    if (!wait) {
+        return devices;
+    }
+
+    probes_done_.wait(lock, [this]() { return !probing_; });
+    for (AudioDevice& device : devices) {
+        auto entry = capabilities_.find(DeviceKey(device.raw_name, device.host_api));
+        if (entry != capabilities_.end()) {
+            device.supported_sample_rates = entry->second;
+            device.capabilities_known = true;
+        }
+    }
+    return devices;
+}
+
+bool DeviceCapabilityCache::supports(int device_id, int sample_rate) {
+    std::shared_ptr<AudioSubsystem> audio = AudioSubsystem::acquire();
+    std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
+    if (device_id < 0 || device_id >= Pa_GetDeviceCount()) {
+        return false;
+    }
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(device_id);
+    if (!info || info->maxInputChannels <= 0) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto entry = capabilities_.find(DeviceKey(info->name, host_api_name(info)));
+        if (entry != capabilities_.end()) {
+            stats_.hits++;
+            return std::find(entry->second.begin(), entry->second.end(), sample_rate) != entry->second.end();
+        }
+        stats_.probes++;
+    }
+    return probe_rate(device_id, info, sample_rate) == paFormatIsSupported;
+}
+
+void DeviceCapabilityCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capabilities_.clear();
+    generation_++;
+}
+
+bool DeviceCapabilityCache::wait_for_probes(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (timeout_ms < 0) {
+        probes_done_.wait(lock, [this]() { return !probing_; });
+        return true;
+    }
+    return probes_done_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return !probing_; });
+}
+
+void DeviceCapabilityCache::set_update_callback(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    update_callback_ = std::move(callback);
+}
+
+void DeviceCapabilityCache::start_probing() {
+    if (stopping_) {
+        return;
+    }
+    probing_ = true;
+    if (!prober_.joinable()) {
+        prober_ = std::thread(&DeviceCapabilityCache::run_prober, this);
+    }
+    work_available_.notify_one();
+}
+
+void DeviceCapabilityCache::run_prober() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_available_.wait(lock, [this]() { return stopping_ || !pending_.empty(); });
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        probe_pending();
+        lock.lock();
+    }
+}
+
+bool DeviceCapabilityCache::probe_device(const DeviceKey& key, std::vector<int>& rates) {
+    // Indices are only stable while PortAudio stays initialized, so find the device again
+    int device_id = -1;
+    {
+        std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
+        int count = Pa_GetDeviceCount();
+        for (int i = 0; i < count && device_id < 0; i++) {
+            const PaDeviceInfo* info = Pa_GetDeviceInfo(i);
+            if (info && info->maxInputChannels > 0 && key.first == info->name && key.second == host_api_name(info)) {
+                device_id = i;
+            }
+        }
+    }
+    if (device_id < 0) {
+        return false;
+    }
+
+    for (int rate : candidate_rates()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                return false;
+            }
+            stats_.probes++;
+        }
+        std::unique_lock<std::mutex> audio_lock = AudioSubsystem::lock();
+        const PaDeviceInfo* info = Pa_GetDeviceInfo(device_id);
+        if (!info) {
+            return false;
+        }
+        if (probe_rate(device_id, info, rate) == paFormatIsSupported) {
+            rates.push_back(rate);
+        }
+    }
+    return true;
+}
+
+void DeviceCapabilityCache::probe_pending() {
+    std::shared_ptr<AudioSubsystem> audio;
+    bool unsaved = false;
+    std::function<void()> callback;
+    while (true) {
+        if (!audio) {
+            try {
+                audio = AudioSubsystem::acquire();
+            } catch (const AudioStreamException&) {
+                // Nothing can be probed; the devices stay unknown until the next enumerate
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_.clear();
+            }
+        }
+        DeviceKey key;
+        uint64_t generation = 0;
+        bool have_key = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (audio && !stopping_ && !pending_.empty()) {
+                key = pending_.front();
+                pending_.pop_front();
+                generation = generation_;
+                have_key = true;
+            }
+        }
+        if (!have_key) {
+            // Let PortAudio terminate before anyone sees the round end
+            audio.reset();
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!stopping_ && !pending_.empty()) {
+                    continue;
+                }
+                if (!unsaved || stopping_) {
+                    probing_ = false;
+                    if (!stopping_) {
+                        callback = update_callback_;
+                    }
+                    break;
+                }
+                path = cache_path_;
+            }
+            // Also before the round ends, so waiters find the file current
+            if (!path.empty()) {
+                std::string error;
+                save(path, error);
+            }
+            unsaved = false;
+            continue;
+        }
+
+        std::vector<int> rates;
+        bool found = probe_device(key, rates);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (found && generation == generation_) {
+            capabilities_[key] = rates;
+            unsaved = true;
+        }
+    }
+    probes_done_.notify_all();
+
+    if (callback) {
+        callback();
+    }
+}
+
+bool DeviceCapabilityCache::set_cache_path(const std::string& path, std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cache_path_ = path;
+    }
+    std::ifstream probe(path);
+    if (!probe) {
+        return true;
+    }
+    return load(path, error);
+}
+
+bool DeviceCapabilityCache::load(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Cannot open device cache: " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string json = buffer.str();
+
+    rapidjson::Document doc;
+    doc.Parse(json.c_str());
+    if (doc.HasParseError()) {
+        error = "Device cache JSON parse error: " + std::string(rapidjson::GetParseError_En(doc.GetParseError()));
+        return false;
+    }
+    auto entries = doc.IsObject() ? doc.FindMember("devices") : doc.MemberEnd();
+    if (!doc.IsObject() || entries == doc.MemberEnd() || !entries->value.IsArray()) {
+        error = "Device cache has no \"devices\" array";
+        return false;
+    }
+
+    std::map<DeviceKey, std::vector<int>> loaded;
+    for (const auto& item : entries->value.GetArray()) {
+        if (!item.IsObject()) {
+            continue;
+        }
+        auto name = item.FindMember("name");
+        auto host_api = item.FindMember("host_api");
+        auto rates = item.FindMember("sample_rates");
+        if (name == item.MemberEnd() || !name->value.IsString() ||
+            host_api == item.MemberEnd() || !host_api->value.IsString() ||
+            rates == item.MemberEnd() || !rates->value.IsArray()) {
+            continue;
+        }
+        std::vector<int>& supported = loaded[DeviceKey(name->value.GetString(), host_api->value.GetString())];
+        for (const auto& rate : rates->value.GetArray()) {
+            if (rate.IsInt()) {
+                supported.push_back(rate.GetInt());
+            }
+        }
+    }
+
+    // Probes made since are fresher than the file
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : loaded) {
+        capabilities_.insert(std::move(entry));
+    }
+    return true;
+}
+
+bool DeviceCapabilityCache::save(const std::string& path, std::string& error) const {
+    std::ostringstream out;
+    out << "{\n  \"devices\": [";
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool first = true;
+        for (const auto& entry : capabilities_) {
+            out << (first ? "\n    " : ",\n    ") << "{ \"name\": \"" << escape_json(entry.first.first)
+                << "\", \"host_api\": \"" << escape_json(entry.first.second) << "\", \"sample_rates\": [";
+            for (size_t i = 0; i < entry.second.size(); i++) {
+                out << (i ? ", " : "") << entry.second[i];
+            }
+            out << "] }";
+            first = false;
+        }
+        out << (first ? "]\n}\n" : "\n  ]\n}\n");
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !(file << out.str())) {
+        error = "Cannot write device cache: " + path;
+        return false;
+    }
+    return true;
+}
+
+DeviceCapabilityCache::Stats DeviceCapabilityCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.cached_devices = capabilities_.size();
+    return stats;
+}
+
+} // namespace voice_transcription
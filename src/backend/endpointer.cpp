@@ -0,0 +1,36 @@
+#include "endpointer.h"
+
+namespace voice_transcription {
+
+Endpointer::Endpointer(int hangover_ms, int chunk_ms)
+    : hangover_ms_(hangover_ms),
+      chunk_ms_(chunk_ms > 0 ? chunk_ms : 20) {
+}
+
+Endpointer::Event Endpointer::update(bool is_speech) {
+    if (is_speech) {
+        silence_ms_ = 0;
+        if (!in_utterance_) {
+            in_utterance_ = true;
+            return Event::SpeechStart;
+        }
+        return Event::None;
+    }
+
+    if (in_utterance_) {
+        silence_ms_ += chunk_ms_;
+        if (silence_ms_ > hangover_ms_) {
+            in_utterance_ = false;
+            silence_ms_ = 0;
+            return Event::SpeechEnd;
+        }
+    }
+    return Event::None;
+}
+
+void Endpointer::reset() {
+    silence_ms_ = 0;
+    in_utterance_ = false;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,459 @@
+#include "focus_tracker.h"
+#include <chrono>
+#include <cstdlib>
+#include <future>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(__linux__) && defined(HAVE_X11)
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace voice_transcription {
+
+// FocusTracker implementation
+FocusedWindow FocusTracker::current() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return snapshot_;
+}
+
+std::string FocusTracker::current_title() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return snapshot_.title;
+}
+
+void FocusTracker::set_focus_change_callback(FocusChangeCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callback_ = std::move(callback);
+}
+
+std::string FocusTracker::get_last_error() const {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    return last_error_;
+}
+
+void FocusTracker::set_last_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(snapshot_mutex_);
+    last_error_ = error;
+}
+
+void FocusTracker::publish(uint64_t window_id, const std::string& title) {
+    FocusedWindow changed;
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+
+        // Ignore repeated notifications for the same window and title
+        if (snapshot_.generation != 0 && snapshot_.window_id == window_id && snapshot_.title == title) {
+            return;
+        }
+
+        snapshot_.window_id = window_id;
+        snapshot_.title = title;
+        snapshot_.generation = generation_.load(std::memory_order_relaxed) + 1;
+        changed = snapshot_;
+
+        // Publish the id before the generation so a reader that observes the
+        // new generation also observes the new window id
+        window_id_.store(window_id, std::memory_order_release);
+        generation_.store(changed.generation, std::memory_order_release);
+    }
+
+    // Notify outside the snapshot lock so callbacks may query the tracker
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (callback_) {
+        callback_(changed);
+    }
+}
+
+std::unique_ptr<FocusTracker> FocusTracker::create_default() {
+#ifdef _WIN32
+    return std::make_unique<WindowsFocusTracker>();
+#else
+#if defined(__linux__) && defined(HAVE_X11)
+    if (std::getenv("DISPLAY")) {
+        return std::make_unique<X11FocusTracker>();
+    }
+#endif
+    // No focus events available (headless or Wayland session)
+    return std::make_unique<FakeFocusTracker>();
+#endif
+}
+
+// FakeFocusTracker implementation
+FakeFocusTracker::~FakeFocusTracker() {
+    stop();
+}
+
+bool FakeFocusTracker::start() {
+    if (running_.exchange(true)) {
+        return true;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(script_mutex_);
+        script_done_ = script_.empty();
+    }
+
+    script_thread_ = std::thread(&FakeFocusTracker::play_script, this);
+    return true;
+}
+
+void FakeFocusTracker::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    script_cv_.notify_all();
+    if (script_thread_.joinable()) {
+        script_thread_.join();
+    }
+}
+
+void FakeFocusTracker::simulate_focus_change(uint64_t window_id, const std::string& title) {
+    publish(window_id, title);
+}
+
+void FakeFocusTracker::load_script(const std::vector<FocusScriptStep>& steps) {
+    std::lock_guard<std::mutex> lock(script_mutex_);
+    script_ = steps;
+}
+
+bool FakeFocusTracker::wait_for_script(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(script_mutex_);
+    return script_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+        [this]() { return script_done_; });
+}
+
+void FakeFocusTracker::play_script() {
+    std::vector<FocusScriptStep> steps;
+    {
+        std::lock_guard<std::mutex> lock(script_mutex_);
+        steps = script_;
+    }
+
+    for (const auto& step : steps) {
+        // Sleep for the step delay, waking early if stopped
+        {
+            std::unique_lock<std::mutex> lock(script_mutex_);
+            if (script_cv_.wait_for(lock, std::chrono::milliseconds(step.delay_ms),
+                    [this]() { return !running_.load(); })) {
+                break;
+            }
+        }
+        publish(step.window_id, step.title);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(script_mutex_);
+        script_done_ = true;
+    }
+    script_cv_.notify_all();
+}
+
+#ifdef _WIN32
+// WinEvent hooks are delivered on the thread that installed them, so each
+// tracker thread keeps its own instance pointer
+static thread_local WindowsFocusTracker* t_windows_tracker = nullptr;
+
+static void CALLBACK win_event_proc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+                                    LONG id_object, LONG id_child,
+                                    DWORD event_thread, DWORD event_time) {
+    if (id_object != OBJID_WINDOW || id_child != CHILDID_SELF || !hwnd) {
+        return;
+    }
+
+    // Title changes are only interesting for the foreground window
+    if (event == EVENT_OBJECT_NAMECHANGE && hwnd != GetForegroundWindow()) {
+        return;
+    }
+
+    if (t_windows_tracker) {
+        t_windows_tracker->on_foreground_event(hwnd);
+    }
+}
+
+static std::string get_window_title_utf8(HWND hwnd) {
+    wchar_t title[256] = { 0 };
+    int length = GetWindowTextW(hwnd, title, 256);
+    if (length <= 0) {
+        return "";
+    }
+
+    int bytes = WideCharToMultiByte(CP_UTF8, 0, title, length, nullptr, 0, nullptr, nullptr);
+    std::string utf8(bytes, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, title, length, &utf8[0], bytes, nullptr, nullptr);
+    return utf8;
+}
+
+WindowsFocusTracker::~WindowsFocusTracker() {
+    stop();
+}
+
+bool WindowsFocusTracker::start() {
+    if (running_.exchange(true)) {
+        return true;
+    }
+
+    std::promise<bool> started;
+    auto started_future = started.get_future();
+
+    thread_ = std::thread([this, &started]() {
+        // Force creation of the thread message queue before anyone posts to it
+        MSG msg;
+        PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+        thread_id_ = GetCurrentThreadId();
+        t_windows_tracker = this;
+
+        HWINEVENTHOOK foreground_hook = SetWinEventHook(
+            EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
+            NULL, win_event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+        HWINEVENTHOOK name_hook = SetWinEventHook(
+            EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE,
+            NULL, win_event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+
+        if (!foreground_hook) {
+            set_last_error("SetWinEventHook failed");
+            if (name_hook) {
+                UnhookWinEvent(name_hook);
+            }
+            t_windows_tracker = nullptr;
+            started.set_value(false);
+            return;
+        }
+
+        // Publish the window that already has focus
+        on_foreground_event(GetForegroundWindow());
+        started.set_value(true);
+
+        event_thread();
+
+        UnhookWinEvent(foreground_hook);
+        if (name_hook) {
+            UnhookWinEvent(name_hook);
+        }
+        t_windows_tracker = nullptr;
+    });
+
+    if (!started_future.get()) {
+        thread_.join();
+        running_ = false;
+        return false;
+    }
+    return true;
+}
+
+void WindowsFocusTracker::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (thread_id_) {
+        PostThreadMessage(thread_id_, WM_QUIT, 0, 0);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    thread_id_ = 0;
+}
+
+void WindowsFocusTracker::event_thread() {
+    MSG msg;
+    while (GetMessage(&msg, NULL, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+}
+
+void WindowsFocusTracker::on_foreground_event(void* hwnd) {
+    HWND window = static_cast<HWND>(hwnd);
+    if (!window) {
+        return;
+    }
+    publish(reinterpret_cast<uint64_t>(window), get_window_title_utf8(window));
+}
+#endif
+
+#if defined(__linux__) && defined(HAVE_X11)
+// The watched window can disappear at any moment; swallow BadWindow instead
+// of letting Xlib terminate the process, and chain everything else
+static XErrorHandler previous_x_error_handler = nullptr;
+
+static int ignore_bad_window(Display* display, XErrorEvent* error) {
+    if (error->error_code == BadWindow) {
+        return 0;
+    }
+    return previous_x_error_handler ? previous_x_error_handler(display, error) : 0;
+}
+
+static Window read_active_window(Display* display, Window root, Atom active_atom) {
+    Atom type;
+    int format;
+    unsigned long items = 0;
+    unsigned long bytes_after = 0;
+    unsigned char* property = nullptr;
+    Window active = None;
+
+    if (XGetWindowProperty(display, root, active_atom, 0, 1, False, XA_WINDOW,
+                           &type, &format, &items, &bytes_after, &property) == Success) {
+        if (property && items > 0) {
+            active = *reinterpret_cast<Window*>(property);
+        }
+    }
+    if (property) {
+        XFree(property);
+    }
+    return active;
+}
+
+static std::string read_window_title(Display* display, Window window, Atom name_atom, Atom utf8_atom) {
+    if (window == None) {
+        return "";
+    }
+
+    Atom type;
+    int format;
+    unsigned long items = 0;
+    unsigned long bytes_after = 0;
+    unsigned char* property = nullptr;
+    std::string title;
+
+    // Prefer the EWMH UTF-8 title, fall back to the legacy WM_NAME
+    if (XGetWindowProperty(display, window, name_atom, 0, 1024, False, utf8_atom,
+                           &type, &format, &items, &bytes_after, &property) == Success &&
+        property && items > 0) {
+        title.assign(reinterpret_cast<char*>(property), items);
+    } else {
+        char* name = nullptr;
+        if (XFetchName(display, window, &name) && name) {
+            title = name;
+            XFree(name);
+        }
+    }
+    if (property) {
+        XFree(property);
+    }
+    return title;
+}
+
+X11FocusTracker::~X11FocusTracker() {
+    stop();
+}
+
+bool X11FocusTracker::start() {
+    if (running_.exchange(true)) {
+        return true;
+    }
+
+    if (pipe(wake_pipe_) != 0) {
+        set_last_error("Failed to create wake pipe");
+        running_ = false;
+        return false;
+    }
+
+    std::promise<bool> started;
+    auto started_future = started.get_future();
+
+    thread_ = std::thread([this, &started]() {
+        Display* display = XOpenDisplay(nullptr);
+        if (!display) {
+            set_last_error("Failed to open X display");
+            started.set_value(false);
+            return;
+        }
+
+        static std::once_flag handler_installed;
+        std::call_once(handler_installed, []() {
+            previous_x_error_handler = XSetErrorHandler(ignore_bad_window);
+        });
+
+        Window root = DefaultRootWindow(display);
+        Atom active_atom = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+        Atom name_atom = XInternAtom(display, "_NET_WM_NAME", False);
+        Atom utf8_atom = XInternAtom(display, "UTF8_STRING", False);
+        Window watched = None;
+
+        auto refresh = [&]() {
+            Window active = read_active_window(display, root, active_atom);
+            if (active != watched) {
+                // Follow title changes of the focused window only
+                if (watched != None) {
+                    XSelectInput(display, watched, NoEventMask);
+                }
+                watched = active;
+                if (watched != None) {
+                    XSelectInput(display, watched, PropertyChangeMask);
+                }
+            }
+            publish(static_cast<uint64_t>(active), read_window_title(display, active, name_atom, utf8_atom));
+        };
+
+        XSelectInput(display, root, PropertyChangeMask);
+        refresh();
+        XFlush(display);
+        started.set_value(true);
+
+        while (running_.load()) {
+            while (XPending(display) > 0) {
+                XEvent event;
+                XNextEvent(display, &event);
+                if (event.type != PropertyNotify) {
+                    continue;
+                }
+
+                const XPropertyEvent& property = event.xproperty;
+                if ((property.window == root && property.atom == active_atom) ||
+                    (property.window == watched && (property.atom == name_atom || property.atom == XA_WM_NAME))) {
+                    refresh();
+                }
+            }
+
+            // Sleep until X sends something or stop() writes to the wake pipe
+            pollfd fds[2] = {
+                { ConnectionNumber(display), POLLIN, 0 },
+                { wake_pipe_[0], POLLIN, 0 }
+            };
+            if (poll(fds, 2, -1) < 0 || (fds[1].revents & POLLIN)) {
+                break;
+            }
+        }
+
+        XCloseDisplay(display);
+    });
+
+    if (!started_future.get()) {
+        thread_.join();
+        close(wake_pipe_[0]);
+        close(wake_pipe_[1]);
+        wake_pipe_[0] = wake_pipe_[1] = -1;
+        running_ = false;
+        return false;
+    }
+    return true;
+}
+
+void X11FocusTracker::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    if (wake_pipe_[1] >= 0) {
+        char wake = 1;
+        (void)write(wake_pipe_[1], &wake, 1);
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    close(wake_pipe_[0]);
+    close(wake_pipe_[1]);
+    wake_pipe_[0] = wake_pipe_[1] = -1;
+}
+#endif
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "hotword_biaser.h"
+#include "json_escape.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <sstream>
+
+namespace voice_transcription {
+
+static std::vector<std::string> split_words(std::string_view text) {
+    std::vector<std::string> words;
+    size_t i = 0;
+    while (i < text.size()) {
+        while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) {
+            i++;
+        }
+        size_t begin = i;
+        while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i]))) {
+            i++;
+        }
+        if (i > begin) {
+            words.emplace_back(text.substr(begin, i - begin));
+        }
+    }
+    return words;
+}
+
+static std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+static std::vector<std::string> tokenize(std::string_view text) {
+    std::vector<std::string> tokens = split_words(text);
+    for (std::string& token : tokens) {
+        token = lower(std::move(token));
+    }
+    return tokens;
+}
+
+static std::string normalize_phrase(const std::string& phrase) {
+    std::string joined;
+    for (const std::string& word : split_words(phrase)) {
+        joined += (joined.empty() ? "" : " ") + word;
+    }
+    return joined;
+}
+
+HotwordBiaser::HotwordBiaser()
+    : compiled_(std::make_shared<const Compiled>()) {
+}
+
+void HotwordBiaser::set_phrase(const std::string& phrase, float boost) {
+    std::string normalized = normalize_phrase(phrase);
+    if (normalized.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HotwordEntry> entries = entries_;
+    // The latest spelling of a phrase wins
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const HotwordEntry& entry) {
+        return lower(entry.phrase) == lower(normalized);
+    });
+    if (boost <= 0.0f) {
+        if (it != entries.end()) {
+            entries.erase(it);
+        }
+    } else if (it != entries.end()) {
+        *it = { normalized, boost };
+    } else {
+        entries.push_back({ normalized, boost });
+    }
+    publish(entries);
+}
+
+bool HotwordBiaser::remove_phrase(const std::string& phrase) {
+    std::string key = lower(normalize_phrase(phrase));
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HotwordEntry> entries = entries_;
+    auto it = std::find_if(entries.begin(), entries.end(), [&](const HotwordEntry& entry) {
+        return lower(entry.phrase) == key;
+    });
+    if (it == entries.end()) {
+        return false;
+    }
+    entries.erase(it);
+    publish(entries);
+    return true;
+}
+
+void HotwordBiaser::set_phrases(const std::vector<HotwordEntry>& entries) {
+    std::vector<HotwordEntry> cleaned;
+    std::unordered_map<std::string, size_t> index;
+    for (const HotwordEntry& entry : entries) {
+        std::string normalized = normalize_phrase(entry.phrase);
+        if (normalized.empty() || entry.boost <= 0.0f) {
+            continue;
+        }
+        auto inserted = index.emplace(lower(normalized), cleaned.size());
+        if (inserted.second) {
+            cleaned.push_back({ normalized, entry.boost });
+        } else {
+            cleaned[inserted.first->second] = { normalized, entry.boost };
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    publish(cleaned);
+}
+
+std::vector<HotwordEntry> HotwordBiaser::get_phrases() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_;
+}
+
+void HotwordBiaser::publish(const std::vector<HotwordEntry>& entries) {
+    auto compiled = std::make_shared<Compiled>();
+    compiled->phrases.reserve(entries.size());
+    for (const HotwordEntry& entry : entries) {
+        Phrase phrase;
+        phrase.spelling = split_words(entry.phrase);
+        phrase.tokens = tokenize(entry.phrase);
+        phrase.boost = entry.boost;
+        compiled->by_first_token[phrase.tokens.front()].push_back(static_cast<uint32_t>(compiled->phrases.size()));
+        compiled->phrases.push_back(std::move(phrase));
+    }
+    // Longest phrases first, so "new york city" wins over "new york"
+    for (auto& bucket : compiled->by_first_token) {
+        std::stable_sort(bucket.second.begin(), bucket.second.end(), [&](uint32_t a, uint32_t b) {
+            return compiled->phrases[a].tokens.size() > compiled->phrases[b].tokens.size();
+        });
+    }
+    entries_ = entries;
+    std::atomic_store(&compiled_, std::shared_ptr<const Compiled>(std::move(compiled)));
+}
+
+bool HotwordBiaser::load(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Cannot open vocabulary file: " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string json = buffer.str();
+
+    rapidjson::Document doc;
+    doc.Parse(json.c_str());
+    if (doc.HasParseError()) {
+        error = "Vocabulary JSON parse error: " + std::string(rapidjson::GetParseError_En(doc.GetParseError()));
+        return false;
+    }
+    auto phrases = doc.IsObject() ? doc.FindMember("phrases") : doc.MemberEnd();
+    if (!doc.IsObject() || phrases == doc.MemberEnd() || !phrases->value.IsArray()) {
+        error = "Vocabulary file has no \"phrases\" array";
+        return false;
+    }
+
+    std::vector<HotwordEntry> entries;
+    for (const auto& item : phrases->value.GetArray()) {
+        if (!item.IsObject()) {
+            continue;
+        }
+        auto phrase = item.FindMember("phrase");
+        if (phrase == item.MemberEnd() || !phrase->value.IsString()) {
+            continue;
+        }
+        HotwordEntry entry;
+        entry.phrase.assign(phrase->value.GetString(), phrase->value.GetStringLength());
+        auto boost = item.FindMember("boost");
+        if (boost != item.MemberEnd() && boost->value.IsNumber()) {
+            entry.boost = static_cast<float>(boost->value.GetDouble());
+        }
+        entries.push_back(std::move(entry));
+    }
+    set_phrases(entries);
+    return true;
+}
+
+bool HotwordBiaser::save(const std::string& path, std::string& error) const {
+    std::ostringstream out;
+    out << "{\n  \"phrases\": [";
+    std::vector<HotwordEntry> entries = get_phrases();
+    for (size_t i = 0; i < entries.size(); i++) {
+        out << (i ? ",\n    " : "\n    ") << "{ \"phrase\": \"" << escape_json(entries[i].phrase)
+            << "\", \"boost\": " << entries[i].boost << " }";
+    }
+    out << (entries.empty() ? "]\n}\n" : "\n  ]\n}\n");
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file || !(file << out.str())) {
+        error = "Cannot write vocabulary file: " + path;
+        return false;
+    }
+    return true;
+}
+
+const HotwordBiaser::Phrase* HotwordBiaser::match(const Compiled& compiled, const std::vector<std::string>& tokens,
+                                                  size_t at) const {
+    auto bucket = compiled.by_first_token.find(tokens[at]);
+    if (bucket == compiled.by_first_token.end()) {
+        return nullptr;
+    }
+    for (uint32_t index : bucket->second) {
+        const Phrase& phrase = compiled.phrases[index];
+        if (at + phrase.tokens.size() <= tokens.size() &&
+            std::equal(phrase.tokens.begin(), phrase.tokens.end(), tokens.begin() + at)) {
+            return &phrase;
+        }
+    }
+    return nullptr;
+}
+
+float HotwordBiaser::bonus(const Compiled& compiled, const std::vector<std::string>& tokens) const {
+    float total = 0.0f;
+    size_t at = 0;
+    while (at < tokens.size()) {
+        const Phrase* phrase = match(compiled, tokens, at);
+        if (phrase) {
+            total += phrase->boost;
+            at += phrase->tokens.size();
+        } else {
+            at++;
+        }
+    }
+    return total;
+}
+
+bool HotwordBiaser::respell(const Compiled& compiled, TranscriptionResult& result) const {
+    std::vector<std::string> words = split_words(result.raw_text);
+    std::vector<std::string> tokens = words;
+    for (std::string& token : tokens) {
+        token = lower(std::move(token));
+    }
+    // Word details line up with the text when both came from the same hypothesis
+    bool aligned = result.words.size() == words.size();
+
+    bool changed = false;
+    size_t at = 0;
+    while (at < tokens.size()) {
+        const Phrase* phrase = match(compiled, tokens, at);
+        if (!phrase) {
+            at++;
+            continue;
+        }
+        for (size_t i = 0; i < phrase->spelling.size(); i++) {
+            if (words[at + i] != phrase->spelling[i]) {
+                words[at + i] = phrase->spelling[i];
+                if (aligned) {
+                    WordInfo& word = result.words[at + i];
+                    word.text_length = static_cast<uint32_t>(phrase->spelling[i].size());
+                    word.text_offset = result.add_text(phrase->spelling[i]);
+                }
+                changed = true;
+            }
+        }
+        at += phrase->tokens.size();
+    }
+
+    if (changed) {
+        std::string text;
+        for (const std::string& word : words) {
+            text += (text.empty() ? "" : " ") + word;
+        }
+        result.raw_text = std::move(text);
+        result.processed_text = result.raw_text;
+    }
+    return changed;
+}
+
+bool HotwordBiaser::apply(TranscriptionResult& result) const {
+    std::shared_ptr<const Compiled> compiled = snapshot();
+    if (compiled->phrases.empty() || !result.is_final) {
+        return false;
+    }
+
+    bool changed = false;
+    if (result.alternatives.size() > 1) {
+        for (Alternative& alternative : result.alternatives) {
+            alternative.score += bonus(*compiled, tokenize(result.text_of(alternative)));
+        }
+        std::stable_sort(result.alternatives.begin(), result.alternatives.end(),
+                         [](const Alternative& a, const Alternative& b) { return a.score > b.score; });
+
+        const Alternative& best = result.alternatives.front();
+        if (result.text_of(best) != result.raw_text) {
+            result.raw_text.assign(result.text_of(best));
+            result.processed_text = result.raw_text;
+            result.words.assign(result.alternative_words.begin() + best.word_begin,
+                                result.alternative_words.begin() + best.word_begin + best.word_count);
+            changed = true;
+        }
+    }
+    return respell(*compiled, result) || changed;
+}
+
+} // namespace voice_transcription
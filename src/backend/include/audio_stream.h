@@ -1,6 +1,9 @@
 #ifndef AUDIO_STREAM_H
 #define AUDIO_STREAM_H
 
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <vector>
 #include <string>
@@ -8,6 +11,8 @@
 #include <optional>
 #include <functional>
 #include <portaudio.h>
+#include "audio_subsystem.h"
+#include "readiness_notifier.h"
 
 namespace voice_transcription {
 
@@ -23,8 +28,10 @@ struct AudioDevice {
     int id;
     std::string raw_name;
     std::string label;
+    std::string host_api;
     bool is_default;
     std::vector<int> supported_sample_rates;
+    bool capabilities_known = true;     // False while the rates are still being probed
 };
 
 // Audio chunk class for handling blocks of audio data
@@ -51,9 +58,32 @@ public:
     float* data() { return data_.get(); }
     const float* data() const { return data_.get(); }
     
+    // Position of this chunk in the capture stream, used to key trace spans
+    uint64_t sequence() const { return sequence_; }
+    void set_sequence(uint64_t sequence) { sequence_ = sequence; }
+    
+    // Index of the first sample in the capture stream, counting from 0 when
+    // the stream started; never goes backwards, even across overflows
+    uint64_t first_sample() const { return first_sample_; }
+    void set_first_sample(uint64_t first_sample) { first_sample_ = first_sample; }
+    
+    // When the ADC captured the first sample, on the trace clock; 0 if unknown
+    int64_t capture_time_us() const { return capture_time_us_; }
+    void set_capture_time_us(int64_t capture_time_us) { capture_time_us_ = capture_time_us; }
+    
+    // Copy sequence, first sample and capture time, for derived chunks
+    void copy_timeline(const AudioChunk& other) {
+        sequence_ = other.sequence_;
+        first_sample_ = other.first_sample_;
+        capture_time_us_ = other.capture_time_us_;
+    }
+    
 private:
     std::unique_ptr<float[]> data_;
     size_t size_;
+    uint64_t sequence_ = 0;
+    uint64_t first_sample_ = 0;
+    int64_t capture_time_us_ = 0;
 };
 
 // Audio callback context structure
@@ -64,29 +94,101 @@ struct AudioCallbackContext {
     size_t read_pos = 0;
     std::mutex buffer_mutex;
     std::condition_variable data_ready_cv;
+    size_t wake_samples = 1;    // Writes only wake the consumer once this much is buffered
+    ReadinessNotifier* ready = nullptr;     // Set alongside the condition variable, outside the lock
     bool is_paused = false;
     bool buffer_overflow = false;
     
-    const size_t MAX_BUFFER_SIZE = 100 * 320;
+    // Per-stream counts since start(), guarded by buffer_mutex
+    uint64_t write_count = 0;
+    uint64_t overflow_count = 0;
+    uint64_t overflow_samples = 0;
+    
+    static constexpr size_t MAX_BUFFER_SIZE = 100 * 320;
+    
+    int sample_rate = 0;
+    
+    // Recent writes: arrival time, to measure how long samples wait in the
+    // ring, and the ADC time of their first sample, to date each chunk
+    struct WriteMark {
+        uint64_t end_sample;
+        std::chrono::steady_clock::time_point time;
+        int64_t capture_time_us;
+        uint32_t length;
+    };
+    static constexpr size_t WRITE_MARK_COUNT = 64;
+    std::array<WriteMark, WRITE_MARK_COUNT> write_marks{};
+    size_t write_mark_count = 0;
+    uint64_t total_written = 0;
+    uint64_t total_read = 0;
     
     // Just declare the constructor, don't define it
     AudioCallbackContext();
     
     // Other method declarations...
-    void write_data(const float* data, size_t length);
-    size_t read_data(float* output, size_t length);
+    // capture_time_us is the ADC time of data[0] on the trace clock, 0 if unknown
+    void write_data(const float* data, size_t length, int64_t capture_time_us = 0);
+    size_t read_data(float* output, size_t length, uint64_t* first_sample = nullptr,
+                     int64_t* capture_time_us = nullptr);
     bool wait_for_data(size_t min_samples, int timeout_ms);
+    bool has_wake_data();
+    void set_wake_samples(size_t samples);
     void clear();
 };
 
-// PortAudio stream wrapper with controlled buffering
-class ControlledAudioStream {
+// Source of fixed-size audio chunks: a live device or a replayed recording.
+// The transcription loop and the latency harness only depend on this.
+class AudioInputStream {
+public:
+    virtual ~AudioInputStream() = default;
+
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool is_active() const = 0;
+
+    // Next chunk of get_frames_per_buffer() samples, waiting up to timeout_ms
+    virtual std::optional<AudioChunk> get_next_chunk(int timeout_ms = 0) = 0;
+
+    virtual int get_sample_rate() const = 0;
+    virtual int get_frames_per_buffer() const = 0;
+    virtual std::string get_last_error() const = 0;
+};
+
+// Downshift for a stream left open while nobody speaks. After idle_after_ms
+// of chunks below wake_rms the consumer is only woken once per idle_block_ms
+// of audio, and the block is checked with a cheap RMS gate instead of being
+// handed out; quiet chunks are dropped. The first chunk at or above wake_rms
+// restores full rate and is delivered, together with the chunk before it, so
+// the VAD still sees the onset.
+struct IdlePolicy {
+    bool enabled = false;
+    int idle_after_ms = 30000;
+    int idle_block_ms = 500;
+    float wake_rms = 0.01f;     // About -40 dBFS; speech at a desk is -30 to -20
+};
+
+// One stream's capture counts since it was last started. The global
+// audio_* counters in MetricsRegistry add up every stream; these tell
+// the microphones of a multi-device setup apart.
+struct AudioStreamStats {
+    uint64_t callbacks = 0;             // Blocks delivered by the audio callback
+    uint64_t samples_captured = 0;
+    uint64_t overflows = 0;             // Callbacks that overwrote unread audio
+    uint64_t samples_dropped = 0;       // Overwritten before they were read
+    uint64_t chunks_delivered = 0;      // Returned by get_next_chunk()
+    size_t buffered_samples = 0;        // Waiting in the ring buffer now
+};
+
+// PortAudio stream wrapper with controlled buffering. Each stream has its
+// own ring buffer and stats, and any number can run at once on different
+// devices, each read from its own thread.
+class ControlledAudioStream : public AudioInputStream {
 public:
     // Constructor
     ControlledAudioStream(int device_id, int sample_rate, int frames_per_buffer);
     
     // Destructor
-    ~ControlledAudioStream();
+    ~ControlledAudioStream() override;
     
     // Move operations
     ControlledAudioStream(ControlledAudioStream&& other) noexcept;
@@ -97,29 +199,39 @@ public:
     ControlledAudioStream& operator=(const ControlledAudioStream&) = delete;
     
     // Stream control
-    bool start();
-    void stop();
+    bool start() override;
+    void stop() override;
     void pause();
     void resume();
-    bool is_active() const;
+    bool is_active() const override;
     
     // Buffer access
-    std::optional<AudioChunk> get_next_chunk(int timeout_ms = 0);
+    std::optional<AudioChunk> get_next_chunk(int timeout_ms = 0) override;
+    
+    // Descriptor that polls readable while a chunk is waiting, for
+    // QSocketNotifier or asyncio's add_reader; -1 if unsupported
+    intptr_t get_ready_fd() const { return ready_->fd(); }
+    
+    // Idle downshift; off by default
+    void set_idle_policy(const IdlePolicy& policy);
+    const IdlePolicy& get_idle_policy() const { return idle_policy_; }
+    bool is_idle() const { return idle_; }
+    
+    AudioStreamStats get_stats() const;
     
     // Device information
     int get_device_id() const { return device_id_; }
-    int get_sample_rate() const { return sample_rate_; }
-    int get_frames_per_buffer() const { return frames_per_buffer_; }
-    std::string get_last_error() const { return last_error_; }
+    int get_sample_rate() const override { return sample_rate_; }
+    int get_frames_per_buffer() const override { return frames_per_buffer_; }
+    std::string get_last_error() const override { return last_error_; }
     
     // Static methods
-    static std::vector<AudioDevice> enumerate_devices();
+    // Rates come from DeviceCapabilityCache; without wait_for_probes, devices
+    // not probed yet are returned at once with capabilities_known false
+    static std::vector<AudioDevice> enumerate_devices(bool wait_for_probes = true);
     static bool check_device_compatibility(int device_id, int sample_rate);
     
 private:
-    // PortAudio initialize/terminate
-    static void ensure_portaudio_initialized();
-    
     // Audio callback function
     static int audio_callback(const void* input_buffer, void* output_buffer,
                              unsigned long frames_per_buffer,
@@ -127,17 +239,28 @@ private:
                              PaStreamCallbackFlags status_flags,
                              void* user_data);
     
+    // One chunk from the ring buffer, dated; nullopt if not enough is buffered
+    std::optional<AudioChunk> next_chunk(int timeout_ms);
+    std::optional<AudioChunk> read_chunk();
+    std::optional<AudioChunk> next_idle_chunk(int timeout_ms);
+    
     // Member variables
+    std::shared_ptr<AudioSubsystem> audio_;     // Keeps PortAudio initialized; declared first, released last
     int device_id_;
     int sample_rate_;
     int frames_per_buffer_;
     PaStream* stream_;
     std::unique_ptr<AudioCallbackContext> callback_context_;
+    std::unique_ptr<ReadinessNotifier> ready_;     // Outlives every context the callback sees
     std::string last_error_;
     bool is_paused_;
     
-    // Static PortAudio initialization flag
-    static bool portaudio_initialized_;
+    // Idle downshift state, owned by the consumer thread
+    IdlePolicy idle_policy_;
+    bool idle_ = false;
+    int quiet_ms_ = 0;
+    std::optional<AudioChunk> held_chunk_;     // Woke the stream; delivered after the chunk before it
+    uint64_t chunks_delivered_ = 0;
 };
 
 } // namespace voice_transcription
@@ -0,0 +1,41 @@
+#ifndef AUDIO_SUBSYSTEM_H
+#define AUDIO_SUBSYSTEM_H
+
+#include <memory>
+#include <mutex>
+
+namespace voice_transcription {
+
+// Reference-counted PortAudio lifetime, shared by every stream.
+//
+// The first acquire() calls Pa_Initialize and releasing the last reference
+// calls Pa_Terminate, so PortAudio is shut down once nothing uses it and
+// picks up new devices the next time it starts. PortAudio's own calls are
+// not thread-safe, so initialization, device queries and opening, starting,
+// stopping and closing streams all go through lock(); the audio callbacks
+// never take it. With that, streams on several devices can be opened and
+// run from different threads at once.
+class AudioSubsystem {
+public:
+    // A reference that keeps PortAudio initialized while held; throws
+    // AudioStreamException if PortAudio cannot be initialized
+    static std::shared_ptr<AudioSubsystem> acquire();
+
+    ~AudioSubsystem();
+
+    AudioSubsystem(const AudioSubsystem&) = delete;
+    AudioSubsystem& operator=(const AudioSubsystem&) = delete;
+
+    // Hold while calling into PortAudio
+    static std::unique_lock<std::mutex> lock();
+
+    // Live references; PortAudio is initialized while this is above zero
+    static int reference_count();
+
+private:
+    AudioSubsystem() = default;
+};
+
+} // namespace voice_transcription
+
+#endif // AUDIO_SUBSYSTEM_H
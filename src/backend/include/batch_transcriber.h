@@ -0,0 +1,128 @@
+#ifndef BATCH_TRANSCRIBER_H
+#define BATCH_TRANSCRIBER_H
+
+#include "inverse_text_normalizer.h"
+#include "speech_recognizer.h"
+#include "vad_segmenter.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+struct BatchTranscriberConfig {
+    std::string engine = "vosk";        // One of available_speech_engines()
+    std::string model_path;
+    int threads = 0;                    // Recognizer threads; 0 uses every hardware thread
+    int vad_aggressiveness = 2;
+    int min_silence_ms = 500;           // Silence long enough to split a file at
+    int max_segment_ms = 30000;         // Longer speech is split without a pause
+    int feed_ms = 200;                  // Audio handed to the recognizer per call
+    bool skip_silence = true;           // Decode only padded speech regions
+    int speech_padding_ms = 300;        // Audio kept around speech when skipping silence
+    bool inverse_text_normalization = true;
+};
+
+// One recognized utterance. Timestamps are exact sample positions in the
+// source file, mapped back past any skipped silence; the millisecond values
+// are derived from them.
+struct BatchSegment {
+    size_t start_sample = 0;
+    size_t end_sample = 0;
+    double start_ms = 0.0;
+    double end_ms = 0.0;
+    std::string raw_text;
+    std::string text;                   // After inverse text normalization
+    double confidence = 0.0;
+};
+
+struct BatchFileResult {
+    std::string path;
+    int sample_rate = 0;
+    size_t sample_count = 0;
+    double duration_ms = 0.0;
+    double speech_ms = 0.0;             // Audio passed to the recognizer
+    double decode_ms = 0.0;             // Recognizer time summed over its segments
+    std::vector<BatchSegment> segments; // In file order; empty results are dropped
+    std::string error;                  // Set if the file could not be read
+
+    // Segment texts joined with spaces
+    std::string text() const;
+};
+
+struct BatchReport {
+    BatchTranscriberConfig config;
+    int threads = 0;
+    double audio_seconds = 0.0;
+    double decoded_seconds = 0.0;       // Audio left after skipping silence
+    double wall_seconds = 0.0;
+    std::vector<BatchFileResult> files;
+
+    // Seconds of audio transcribed per wall-clock second
+    double speed() const { return wall_seconds > 0.0 ? audio_seconds / wall_seconds : 0.0; }
+
+    std::string to_json() const;
+    bool write_json(const std::string& path) const;
+};
+
+// Offline transcription of recorded files on a pool of recognizers that
+// share one loaded model.
+//
+// The calling thread reads each file, runs the VAD over it and cuts it in
+// the middle of pauses of at least min_silence_ms, so every segment starts
+// and ends in silence and decodes independently. With skip_silence, only
+// the padded speech regions of a segment reach the recognizer. Segments from all files
+// go into one queue that the workers drain, which keeps every core busy
+// across file boundaries. Files are read ahead only a few at a time, so
+// memory stays bounded however long the list is.
+class BatchTranscriber {
+public:
+    explicit BatchTranscriber(const BatchTranscriberConfig& config);
+    ~BatchTranscriber();
+
+    BatchTranscriber(const BatchTranscriber&) = delete;
+    BatchTranscriber& operator=(const BatchTranscriber&) = delete;
+
+    // Load the model; run() calls this if needed
+    bool load_model();
+
+    // Transcribe the files; report.files keeps their order
+    bool run(const std::vector<std::string>& paths, BatchReport& report);
+
+    // Called with each finished file, in input order, from whichever thread
+    // finished it (a worker, or the caller for files that could not be read)
+    using FileCallback = std::function<void(const BatchFileResult&)>;
+    void set_file_callback(FileCallback callback) { file_callback_ = std::move(callback); }
+
+    int get_thread_count() const;
+    std::string get_last_error() const { return last_error_; }
+
+    // Cut points for a mono recording: the middle of every pause of at least
+    // min_silence_ms, plus forced cuts that keep segments under max_segment_ms.
+    // The ranges cover every sample.
+    static std::vector<SampleRange> split_at_silence(const std::vector<float>& samples, int sample_rate,
+                                                     const BatchTranscriberConfig& config);
+
+    // The same cut points from VAD flags, one per frame of frame_size samples
+    static std::vector<SampleRange> split_frames(const std::vector<uint8_t>& speech, size_t frame_size,
+                                                 size_t total, int sample_rate,
+                                                 const BatchTranscriberConfig& config);
+
+    // Expand directories (recursively, to their .wav files) and list files
+    // (one path per line) into audio paths; other paths are kept as they are
+    static bool collect_audio_files(const std::vector<std::string>& inputs,
+                                    std::vector<std::string>& files, std::string& error);
+
+private:
+    BatchTranscriberConfig config_;
+    std::shared_ptr<SpeechModel> model_;
+    InverseTextNormalizer normalizer_;
+    FileCallback file_callback_;
+    std::string last_error_;
+};
+
+} // namespace voice_transcription
+
+#endif // BATCH_TRANSCRIBER_H
\ No newline at end of file
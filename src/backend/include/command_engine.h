@@ -0,0 +1,130 @@
+#ifndef COMMAND_ENGINE_H
+#define COMMAND_ENGINE_H
+
+#include "compiled_command_set.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace voice_transcription {
+
+// Capitalization applied while emitting text
+enum class CapitalizationMode {
+    Auto,       // Capitalize the first word of each sentence
+    AllCaps,    // Upper-case everything
+    None        // Leave words as recognized
+};
+
+// Native dictation command processor.
+//
+// Matching runs against an immutable CompiledCommandSet snapshot. Command
+// changes are compiled on a background thread and published with an atomic
+// pointer swap, so process() never waits for a reload; it keeps using the
+// previous snapshot until the new one is ready. Replacement, capitalization
+// and smart spacing are applied in a single pass over the text.
+class CommandEngine {
+public:
+    CommandEngine();
+    explicit CommandEngine(const std::vector<CommandDefinition>& commands);
+    ~CommandEngine();
+
+    CommandEngine(const CommandEngine&) = delete;
+    CommandEngine& operator=(const CommandEngine&) = delete;
+
+    // Compile from JSON: either the supported_commands array itself, an object
+    // with "supported_commands", or a full settings object with "dictation_commands".
+    // Compiles on the caller's thread, or loads the binary cache when it matches.
+    bool load_json(const std::string& json);
+    void load_commands(const std::vector<CommandDefinition>& commands);
+
+    // Same as load_json, but compiles in the background; returns false only if the JSON is invalid
+    bool reload_json(const std::string& json);
+
+    // Command management; recompiles in the background
+    bool add_command(const std::string& phrase, const std::string& action,
+                     const std::vector<std::string>& aliases = {});
+    bool remove_command(const std::string& phrase);
+    std::vector<CommandDefinition> get_commands() const;
+    // Every phrase and alias, lower-cased, e.g. as the grammar of a command recognizer
+    std::vector<std::string> get_phrases() const;
+    size_t get_phrase_count() const { return snapshot()->phrase_count(); }
+
+    // Block until every requested change has been published
+    bool wait_for_reload(int timeout_ms = 5000);
+
+    // Incremented each time a new snapshot is published
+    uint64_t get_snapshot_version() const { return snapshot_version_.load(std::memory_order_acquire); }
+
+    // Compiled sets are persisted here and reused when the commands are unchanged
+    void set_cache_path(const std::string& path);
+    bool loaded_from_cache() const { return loaded_from_cache_.load(); }
+
+    // Current snapshot; safe to call from any thread
+    std::shared_ptr<const CompiledCommandSet> snapshot() const { return std::atomic_load(&snapshot_); }
+
+    // Replace command phrases with their actions and apply smart formatting.
+    // Calls from several threads are serialized.
+    std::string process(const std::string& text);
+
+    // Capitalization state persists across process() calls, like the Python processor
+    bool set_capitalization_mode(const std::string& mode);
+    std::string get_capitalization_mode() const;
+
+    std::string get_last_error() const;
+
+private:
+    // Token span into the input text
+    struct Token {
+        size_t begin;
+        size_t length;
+        uint32_t id;
+    };
+
+    static bool parse_commands(const std::string& json, std::vector<CommandDefinition>& commands,
+                               std::string& error);
+
+    // Build a snapshot, going through the binary cache when configured
+    std::shared_ptr<const CompiledCommandSet> build(const std::vector<CommandDefinition>& commands,
+                                                    bool& from_cache);
+    void publish(std::shared_ptr<const CompiledCommandSet> set, uint64_t revision, bool from_cache);
+    void request_reload();
+    void reload_thread();
+    void set_last_error(const std::string& error);
+
+    // Published snapshot, swapped with std::atomic_store
+    std::shared_ptr<const CompiledCommandSet> snapshot_;
+    std::atomic<uint64_t> snapshot_version_;
+    std::atomic<bool> loaded_from_cache_;
+
+    // Source commands and reload bookkeeping, guarded by mutex_
+    mutable std::mutex mutex_;
+    std::condition_variable reload_cv_;
+    std::condition_variable published_cv_;
+    std::vector<CommandDefinition> commands_;
+    std::string cache_path_;
+    std::string last_error_;
+    uint64_t requested_revision_;
+    uint64_t published_revision_;
+    bool stop_;
+    std::thread reload_thread_;
+
+    // Processing state, guarded by process_mutex_ along with the scratch buffers
+    mutable std::mutex process_mutex_;
+    CapitalizationMode capitalization_mode_;
+
+    // Scratch buffers reused across process() calls
+    std::vector<Token> tokens_;
+    std::vector<uint32_t> match_length_;
+    std::vector<uint32_t> match_action_;
+    std::string lowered_;
+};
+
+} // namespace voice_transcription
+
+#endif // COMMAND_ENGINE_H
\ No newline at end of file
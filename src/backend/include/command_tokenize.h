@@ -0,0 +1,43 @@
+#ifndef COMMAND_TOKENIZE_H
+#define COMMAND_TOKENIZE_H
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// Tokenizing shared by CommandEngine and CompiledCommandSet. Both must split
+// a phrase the same way, or compiled triggers stop matching spoken text.
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+inline char to_lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+// Split on whitespace and lower-case each word
+inline std::vector<std::string> split_phrase(const std::string& phrase) {
+    std::vector<std::string> words;
+    std::string word;
+    for (char c : phrase) {
+        if (is_space(c)) {
+            if (!word.empty()) {
+                words.push_back(word);
+                word.clear();
+            }
+        } else {
+            word.push_back(to_lower(c));
+        }
+    }
+    if (!word.empty()) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+} // namespace voice_transcription
+
+#endif // COMMAND_TOKENIZE_H
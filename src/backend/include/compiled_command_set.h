@@ -0,0 +1,114 @@
+#ifndef COMPILED_COMMAND_SET_H
+#define COMPILED_COMMAND_SET_H
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace voice_transcription {
+
+// Dictation command as configured in settings.json
+struct CommandDefinition {
+    std::string phrase;                 // e.g. "question mark"
+    std::string action;                 // e.g. "?" or "{ENTER}"
+    std::vector<std::string> aliases;   // Alternative phrases for the same action
+};
+
+// How an action behaves during smart spacing
+enum class ActionKind : uint8_t {
+    Word,           // Literal text, spaced like a word
+    Punctuation,    // . , ; : ! ? - no space before, space after
+    Opener,         // ( [ { - space before, no space after
+    Closer,         // ) ] } - no space before, space after
+    Quote,          // " - alternates between opener and closer
+    Keystroke,      // {ENTER}, {CTRL+ENTER} - glued, no surrounding spaces
+    Space,          // Explicit single space
+    CapsOn,         // {ALLCAPS_ON}
+    CapsOff         // {ALLCAPS_OFF}
+};
+
+// Immutable, compiled form of a command list.
+//
+// Phrases and aliases are compiled into an Aho-Corasick automaton over word
+// tokens. Once built a set is never modified, so readers can hold a
+// shared_ptr to it while a newer set is compiled and published elsewhere.
+class CompiledCommandSet {
+public:
+    // Token id used for words that do not occur in any command phrase
+    static constexpr uint32_t kUnknownToken = std::numeric_limits<uint32_t>::max();
+
+    struct Action {
+        std::string text;
+        ActionKind kind;
+    };
+
+    // Build the automaton for a command list
+    static std::shared_ptr<const CompiledCommandSet> compile(const std::vector<CommandDefinition>& commands);
+
+    // Stable hash of a command list, used to validate cached sets
+    static uint64_t hash_commands(const std::vector<CommandDefinition>& commands);
+
+    // Binary cache. Loading returns nullptr if the file is missing, corrupt,
+    // from another format version, or was built from different commands.
+    std::string serialize() const;
+    static std::shared_ptr<const CompiledCommandSet> deserialize(const std::string& data, std::string& error);
+    bool save(const std::string& path, std::string& error) const;
+    static std::shared_ptr<const CompiledCommandSet> load(const std::string& path, uint64_t expected_hash,
+                                                          std::string& error);
+
+    uint64_t source_hash() const { return source_hash_; }
+    size_t phrase_count() const { return phrases_.size(); }
+    bool empty() const { return phrases_.empty(); }
+
+    // Matching
+    uint32_t lookup_token(const std::string& token) const;
+    int32_t next_state(int32_t state, uint32_t token) const;
+    const Action& action(uint32_t index) const { return actions_[index]; }
+
+    // Call f(length, action_index) for every phrase ending in the given state
+    template <typename F>
+    void for_each_match(int32_t state, F&& f) const {
+        int32_t node = nodes_[state].phrase >= 0 ? state : nodes_[state].dict_link;
+        while (node >= 0) {
+            const Phrase& phrase = phrases_[nodes_[node].phrase];
+            f(phrase.length, phrase.action);
+            node = nodes_[node].dict_link;
+        }
+    }
+
+    static ActionKind classify_action(const std::string& action);
+
+private:
+    CompiledCommandSet() = default;
+
+    // Automaton node; transitions live in a flat hash map keyed by (node, token)
+    struct Node {
+        int32_t fail = 0;           // Longest proper suffix that is also a trie path
+        int32_t dict_link = -1;     // Nearest node on the fail chain that ends a phrase
+        int32_t phrase = -1;        // Phrase ending at this node, or -1
+        uint32_t depth = 0;         // Number of tokens from the root
+    };
+
+    // Compiled phrase: action index and token length
+    struct Phrase {
+        uint32_t action;
+        uint32_t length;
+    };
+
+    uint32_t intern_token(const std::string& token);
+    int32_t child(int32_t state, uint32_t token) const;
+
+    uint64_t source_hash_ = 0;
+    std::unordered_map<std::string, uint32_t> token_ids_;
+    std::unordered_map<uint64_t, int32_t> transitions_;
+    std::vector<Node> nodes_;
+    std::vector<Phrase> phrases_;
+    std::vector<Action> actions_;
+};
+
+} // namespace voice_transcription
+
+#endif // COMPILED_COMMAND_SET_H
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef DEVICE_CAPABILITY_CACHE_H
+#define DEVICE_CAPABILITY_CACHE_H
+
+#include "audio_stream.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace voice_transcription {
+
+// Sample rates of input devices, probed once and remembered.
+//
+// Probing means one Pa_IsFormatSupported per candidate rate, and some host
+// APIs open the device for each, so a full probe of every microphone is
+// slow. Listing devices is cheap, so enumerate() lists them right away and
+// fills in the rates it already knows. Devices not seen before are probed
+// on a background thread, and the update callback fires when the round is
+// done. Entries are keyed by device name and host API rather than
+// PortAudio index, because indices shift when devices come and go. They can
+// be kept in a JSON file between runs. invalidate() drops them all, for
+// device-change events.
+//
+// PortAudio is not thread-safe, so the probes run one at a time under
+// AudioSubsystem::lock(). Each probe holds the lock on its own, so a stream
+// can open between two probes.
+class DeviceCapabilityCache {
+public:
+    static DeviceCapabilityCache& instance();
+    ~DeviceCapabilityCache();
+
+    DeviceCapabilityCache(const DeviceCapabilityCache&) = delete;
+    DeviceCapabilityCache& operator=(const DeviceCapabilityCache&) = delete;
+
+    // Input devices with their cached rates. Devices with no entry come
+    // back with capabilities_known false and go to the background prober;
+    // with wait, this returns only after they are probed.
+    std::vector<AudioDevice> enumerate(bool wait = false);
+
+    // Whether a device supports a rate, from the cache when the device has
+    // an entry, otherwise with a single live probe
+    bool supports(int device_id, int sample_rate);
+
+    // Forget every entry; the next enumerate() probes again
+    void invalidate();
+
+    // Wait for background probes; false on timeout, negative waits forever
+    bool wait_for_probes(int timeout_ms = -1);
+
+    // Called on the probe thread after each round of probes
+    void set_update_callback(std::function<void()> callback);
+
+    // Entries persisted as JSON. With a cache path set, the file is loaded
+    // now (a missing file is not an error) and rewritten after each round.
+    bool set_cache_path(const std::string& path, std::string& error);
+    bool load(const std::string& path, std::string& error);
+    bool save(const std::string& path, std::string& error) const;
+
+    struct Stats {
+        uint64_t probes = 0;            // Pa_IsFormatSupported calls made
+        uint64_t hits = 0;              // Devices enumerated with a cached entry
+        uint64_t misses = 0;            // Devices enumerated without one
+        size_t cached_devices = 0;
+    };
+    Stats stats() const;
+
+    // The rates every device is probed for
+    static const std::vector<int>& candidate_rates();
+
+private:
+    DeviceCapabilityCache();
+
+    // Name and host API name
+    using DeviceKey = std::pair<std::string, std::string>;
+
+    void start_probing();       // Call with mutex_ held
+    void run_prober();          // Probe thread: one round per batch of new devices
+    void probe_pending();
+    bool probe_device(const DeviceKey& key, std::vector<int>& rates);
+
+    mutable std::mutex mutex_;
+    std::condition_variable probes_done_;
+    std::condition_variable work_available_;
+    std::map<DeviceKey, std::vector<int>> capabilities_;
+    std::deque<DeviceKey> pending_;
+    uint64_t generation_ = 0;           // Bumped by invalidate(), so stale probes are dropped
+    bool probing_ = false;
+    bool stopping_ = false;
+    std::thread prober_;
+    std::function<void()> update_callback_;
+    std::string cache_path_;
+    Stats stats_;
+};
+
+} // namespace voice_transcription
+
+#endif // DEVICE_CAPABILITY_CACHE_H
@@ -0,0 +1,42 @@
+#ifndef ENDPOINTER_H
+#define ENDPOINTER_H
+
+namespace voice_transcription {
+
+// Utterance boundaries from per-chunk VAD decisions.
+//
+// An utterance starts on the first speech chunk and ends once hangover_ms
+// of consecutive non-speech has passed. Time is counted in chunks rather
+// than read from a clock, so replayed audio endpoints exactly like live
+// audio regardless of processing speed.
+class Endpointer {
+public:
+    enum class Event {
+        None,
+        SpeechStart,    // This chunk opened an utterance
+        SpeechEnd       // The hangover ran out on this chunk
+    };
+
+    Endpointer(int hangover_ms, int chunk_ms);
+
+    // Feed one chunk's VAD decision
+    Event update(bool is_speech);
+
+    // Whether the chunk just fed belongs to an utterance (including its hangover)
+    bool in_utterance() const { return in_utterance_; }
+
+    void reset();
+
+    int get_hangover_ms() const { return hangover_ms_; }
+    void set_hangover_ms(int hangover_ms) { hangover_ms_ = hangover_ms; }
+
+private:
+    int hangover_ms_;
+    int chunk_ms_;
+    int silence_ms_ = 0;
+    bool in_utterance_ = false;
+};
+
+} // namespace voice_transcription
+
+#endif // ENDPOINTER_H
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef FOCUS_TRACKER_H
+#define FOCUS_TRACKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace voice_transcription {
+
+// Identity of the window that currently has keyboard focus
+struct FocusedWindow {
+    uint64_t window_id = 0;     // Native handle (HWND / X11 Window) or scripted id
+    std::string title;          // Window title when the focus change was observed
+    uint64_t generation = 0;    // Incremented on every published focus change
+};
+
+// Callback function type for focus change notifications
+using FocusChangeCallback = std::function<void(const FocusedWindow&)>;
+
+// Event-driven foreground window tracker.
+//
+// Backends subscribe to the platform's focus-change events on their own thread
+// and publish into an atomically readable cache. The transcription loop only
+// needs one atomic load of generation() per chunk to find out whether the
+// focused window changed; the title is fetched only when it did.
+class FocusTracker {
+public:
+    FocusTracker() = default;
+    virtual ~FocusTracker() = default;
+
+    // No copy operations
+    FocusTracker(const FocusTracker&) = delete;
+    FocusTracker& operator=(const FocusTracker&) = delete;
+
+    // Tracking control
+    virtual bool start() = 0;
+    virtual void stop() = 0;
+    virtual bool is_running() const = 0;
+    virtual std::string get_backend_name() const = 0;
+
+    // Lock-free reads for the per-chunk path
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+    uint64_t current_window_id() const { return window_id_.load(std::memory_order_acquire); }
+
+    // Full snapshot (takes a short lock, call only when generation() changed)
+    FocusedWindow current() const;
+    std::string current_title() const;
+
+    // Set callback for focus change notifications (invoked on the tracker thread)
+    void set_focus_change_callback(FocusChangeCallback callback);
+
+    std::string get_last_error() const;
+
+    // Create the best backend for this platform, falling back to a fake tracker
+    static std::unique_ptr<FocusTracker> create_default();
+
+protected:
+    // Called by backends whenever the platform reports a focus change
+    void publish(uint64_t window_id, const std::string& title);
+    void set_last_error(const std::string& error);
+
+private:
+    std::atomic<uint64_t> generation_{0};
+    std::atomic<uint64_t> window_id_{0};
+
+    mutable std::mutex snapshot_mutex_;
+    FocusedWindow snapshot_;
+    std::string last_error_;
+
+    std::mutex callback_mutex_;
+    FocusChangeCallback callback_;
+};
+
+// Step of a scripted focus sequence for FakeFocusTracker
+struct FocusScriptStep {
+    int delay_ms = 0;           // Delay after the previous step
+    uint64_t window_id = 0;
+    std::string title;
+};
+
+// Scriptable tracker for tests and headless environments.
+// Focus changes are either pushed directly with simulate_focus_change() or
+// replayed from a script on a background thread once start() is called.
+class FakeFocusTracker : public FocusTracker {
+public:
+    FakeFocusTracker() = default;
+    ~FakeFocusTracker() override;
+
+    bool start() override;
+    void stop() override;
+    bool is_running() const override { return running_.load(); }
+    std::string get_backend_name() const override { return "fake"; }
+
+    // Publish a focus change immediately on the caller's thread
+    void simulate_focus_change(uint64_t window_id, const std::string& title);
+
+    // Script replayed by start(); replaces any previously loaded script
+    void load_script(const std::vector<FocusScriptStep>& steps);
+
+    // Block until the loaded script finished playing (or timeout)
+    bool wait_for_script(int timeout_ms);
+
+private:
+    void play_script();
+
+    std::vector<FocusScriptStep> script_;
+    std::thread script_thread_;
+    std::atomic<bool> running_{false};
+    bool script_done_ = true;
+    std::mutex script_mutex_;
+    std::condition_variable script_cv_;
+};
+
+#ifdef _WIN32
+// Windows backend using SetWinEventHook(EVENT_SYSTEM_FOREGROUND)
+class WindowsFocusTracker : public FocusTracker {
+public:
+    WindowsFocusTracker() = default;
+    ~WindowsFocusTracker() override;
+
+    bool start() override;
+    void stop() override;
+    bool is_running() const override { return running_.load(); }
+    std::string get_backend_name() const override { return "win32"; }
+
+    // Entry point used by the static WinEvent hook procedure
+    void on_foreground_event(void* hwnd);
+
+private:
+    void event_thread();
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<unsigned long> thread_id_{0};
+};
+#endif
+
+#if defined(__linux__) && defined(HAVE_X11)
+// Linux backend watching _NET_ACTIVE_WINDOW on the X11 root window
+class X11FocusTracker : public FocusTracker {
+public:
+    X11FocusTracker() = default;
+    ~X11FocusTracker() override;
+
+    bool start() override;
+    void stop() override;
+    bool is_running() const override { return running_.load(); }
+    std::string get_backend_name() const override { return "x11"; }
+
+private:
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    int wake_pipe_[2] = { -1, -1 };
+};
+#endif
+
+} // namespace voice_transcription
+
+#endif // FOCUS_TRACKER_H
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef HOTWORD_BIASER_H
+#define HOTWORD_BIASER_H
+
+#include "speech_recognizer.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace voice_transcription {
+
+// A phrase to favor, as the user wants it written ("Kubernetes", "gRPC")
+struct HotwordEntry {
+    std::string phrase;
+    float boost = 1.0f;     // Added to an N-best score per occurrence
+};
+
+// Runtime vocabulary biasing for product names and jargon.
+//
+// The engines take their vocabulary from the model, and libvosk has no
+// runtime boosting, so biasing works on the N-best list instead: each
+// alternative's decoder score is raised by the boost of every listed phrase
+// it contains, the best one after boosting becomes the result, and matched
+// phrases are respelled the way they were entered. Boosts are in the
+// engine's score units; Vosk's are log-likelihoods, where 1 to 10 moves a
+// phrase past close competitors without overriding clear audio.
+//
+// The phrase list is compiled into an immutable snapshot and swapped in, so
+// updates never wait for, or stall, a decode in progress.
+class HotwordBiaser {
+public:
+    HotwordBiaser();
+
+    // Add a phrase or change its boost; a boost of 0 or less removes it
+    void set_phrase(const std::string& phrase, float boost);
+    bool remove_phrase(const std::string& phrase);
+    void set_phrases(const std::vector<HotwordEntry>& entries);
+    std::vector<HotwordEntry> get_phrases() const;
+    size_t size() const { return snapshot()->phrases.size(); }
+    bool empty() const { return size() == 0; }
+
+    // A user's vocabulary as JSON: {"phrases": [{"phrase": "Kubernetes", "boost": 4}]}
+    bool load(const std::string& path, std::string& error);
+    bool save(const std::string& path, std::string& error) const;
+
+    // Rescore a final result's alternatives and respell matched phrases.
+    // Results without alternatives are only respelled. Returns true if the
+    // text changed.
+    bool apply(TranscriptionResult& result) const;
+
+private:
+    struct Phrase {
+        std::vector<std::string> tokens;    // Lower-cased words to match
+        std::vector<std::string> spelling;  // Words as entered
+        float boost;
+    };
+
+    // Compiled list; phrases are indexed by their first token
+    struct Compiled {
+        std::vector<Phrase> phrases;
+        std::unordered_map<std::string, std::vector<uint32_t>> by_first_token;
+    };
+
+    // Phrase matched at a token position, longest first
+    const Phrase* match(const Compiled& compiled, const std::vector<std::string>& tokens, size_t at) const;
+    float bonus(const Compiled& compiled, const std::vector<std::string>& tokens) const;
+    bool respell(const Compiled& compiled, TranscriptionResult& result) const;
+
+    void publish(const std::vector<HotwordEntry>& entries);
+    std::shared_ptr<const Compiled> snapshot() const { return std::atomic_load(&compiled_); }
+
+    mutable std::mutex mutex_;              // Serializes updates
+    std::vector<HotwordEntry> entries_;     // Guarded by mutex_
+    std::shared_ptr<const Compiled> compiled_;
+};
+
+} // namespace voice_transcription
+
+#endif // HOTWORD_BIASER_H
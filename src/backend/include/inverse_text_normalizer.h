@@ -0,0 +1,123 @@
+#ifndef INVERSE_TEXT_NORMALIZER_H
+#define INVERSE_TEXT_NORMALIZER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace voice_transcription {
+
+// Inverse text normalization for finalized transcripts.
+//
+// Rewrites spoken forms into written forms: "twenty three point five percent"
+// becomes "23.5%", "march fifth twenty twenty four" becomes "March 5, 2024".
+// Covers cardinals, ordinals, decimals, percentages, currency, times, dates
+// and units.
+//
+// The vocabulary is compiled once into a lexicon of token classes. Each
+// position is scanned by a small set of deterministic transducers (number,
+// time, date) that only move forward. Each candidate rewrite is scored by the
+// tokens it consumes minus a rule penalty, and the best-scoring candidate wins
+// over leaving the words as they are. A rewrite consumes its tokens, so
+// normalization is linear in the number of tokens.
+class InverseTextNormalizer {
+public:
+    InverseTextNormalizer();
+
+    // Normalize a whole utterance; safe to call concurrently
+    std::string normalize(const std::string& text) const;
+
+private:
+    // Token classes; a word may belong to several
+    enum LexemeFlags : uint32_t {
+        kDigit          = 1u << 0,  // zero .. nine
+        kTeen           = 1u << 1,  // ten .. nineteen
+        kTens           = 1u << 2,  // twenty .. ninety
+        kHundred        = 1u << 3,
+        kScale          = 1u << 4,  // thousand, million, billion, trillion
+        kOrdinal        = 1u << 5,  // first .. ninetieth, hundredth, thousandth ...
+        kOh             = 1u << 6,  // "oh" as zero in times, years and decimals
+        kPoint          = 1u << 7,
+        kPercent        = 1u << 8,
+        kCurrency       = 1u << 9,  // dollars, euros
+        kCents          = 1u << 10,
+        kUnit           = 1u << 11, // First word of a unit phrase
+        kMonth          = 1u << 12,
+        kMeridiem       = 1u << 13, // am, pm, a.m., p.m.
+        kOclock         = 1u << 14,
+        kMinus          = 1u << 15,
+        kAnd            = 1u << 16,
+        kArticle        = 1u << 17, // "a" in "a hundred"
+        kThe            = 1u << 18,
+        kOf             = 1u << 19,
+        kTimeContext    = 1u << 20, // at, by, until ... before a bare clock time
+        kAmbiguousMonth = 1u << 21  // may, march - need an ordinal day or a year
+    };
+
+    struct Lexeme {
+        uint32_t flags = 0;
+        int64_t value = 0;          // Numeric value, or month number
+        uint32_t ordinal_flags = 0; // For ordinals, the cardinal class it stands in for
+        std::string symbol;         // Currency symbol or meridiem text
+    };
+
+    // Unit phrase such as "kilometers per hour" -> "km/h"
+    struct UnitRule {
+        std::vector<std::string> words;
+        std::string symbol;
+        bool attach;                // Written without a space, as in 20°C
+    };
+
+    struct Token {
+        size_t begin;               // Span in the original text
+        size_t length;
+        std::string lowered;
+        const Lexeme* lexeme;       // nullptr for words outside the lexicon
+    };
+
+    // Result of the number transducer
+    struct NumberMatch {
+        size_t end = 0;             // One past the last consumed token
+        int64_t value = 0;
+        bool ordinal = false;
+        bool valid = false;
+    };
+
+    // A candidate rewrite of tokens [start, end)
+    struct Candidate {
+        size_t end = 0;
+        float score = 0.0f;
+        std::string output;
+        bool keep_words = false;    // Claim the span but leave it as spoken
+    };
+
+    void add_word(const std::string& word, uint32_t flags, int64_t value = 0,
+                  const std::string& symbol = std::string(), uint32_t ordinal_flags = 0);
+    void add_unit(const std::string& phrase, const std::string& symbol, bool attach = false);
+
+    bool has(const std::vector<Token>& tokens, size_t i, uint32_t flags) const;
+
+    // Transducers; each returns an invalid match or an empty candidate when nothing applies
+    NumberMatch match_cardinal(const std::vector<Token>& tokens, size_t i) const;
+    NumberMatch match_two_digit(const std::vector<Token>& tokens, size_t i) const;
+    NumberMatch match_year(const std::vector<Token>& tokens, size_t i) const;
+    size_t match_fraction(const std::vector<Token>& tokens, size_t i, std::string& digits) const;
+    size_t match_meridiem(const std::vector<Token>& tokens, size_t i, std::string& text) const;
+    const UnitRule* match_unit(const std::vector<Token>& tokens, size_t i, size_t& end) const;
+
+    Candidate match_number_expression(const std::vector<Token>& tokens, size_t i) const;
+    Candidate match_time(const std::vector<Token>& tokens, size_t i) const;
+    Candidate match_date(const std::vector<Token>& tokens, size_t i) const;
+
+    static std::string format_cardinal(int64_t value);
+    static std::string format_ordinal(int64_t value);
+
+    std::unordered_map<std::string, Lexeme> lexicon_;
+    std::unordered_map<std::string, std::vector<UnitRule>> units_;  // Keyed by first word, longest first
+    std::vector<std::string> month_names_;
+};
+
+} // namespace voice_transcription
+
+#endif // INVERSE_TEXT_NORMALIZER_H
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef JSON_ESCAPE_H
+#define JSON_ESCAPE_H
+
+#include <cstdio>
+#include <string>
+
+namespace voice_transcription {
+
+// Minimal JSON string escaping for hand-written reports
+inline std::string escape_json(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace voice_transcription
+
+#endif // JSON_ESCAPE_H
\ No newline at end of file
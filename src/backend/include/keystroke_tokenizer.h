@@ -0,0 +1,28 @@
+#ifndef KEYSTROKE_TOKENIZER_H
+#define KEYSTROKE_TOKENIZER_H
+
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// One unit of simulated typing: a literal character or a special key
+// command such as ENTER or CTRL+ENTER (written "{ENTER}" in the text)
+struct KeystrokeToken {
+    enum class Kind { Character, SpecialKey };
+
+    Kind kind;
+    wchar_t character;      // Kind::Character
+    std::wstring command;   // Kind::SpecialKey, without the braces
+};
+
+// Split output text into keystrokes. A brace group with at least one
+// character inside becomes a special key; anything else, including stray
+// or empty braces, is typed literally. This matches the old
+// "\{([^}]+)\}" regex search but scans the text once without allocating per
+// character.
+std::vector<KeystrokeToken> tokenize_keystrokes(const std::wstring& text);
+
+} // namespace voice_transcription
+
+#endif // KEYSTROKE_TOKENIZER_H
\ No newline at end of file
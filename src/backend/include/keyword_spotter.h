@@ -0,0 +1,133 @@
+#ifndef KEYWORD_SPOTTER_H
+#define KEYWORD_SPOTTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+class AudioChunk;
+
+struct KeywordSpotterConfig {
+    int sample_rate = 16000;
+    float threshold = 6.0f;     // Highest mean MFCC distance per frame that counts as the phrase
+    int awake_ms = 8000;        // Back to listening after this much non-speech once awake
+    int max_gap_ms = 300;       // Non-speech inside the phrase before the match restarts
+};
+
+// Wake-word gate between VADHandler and the recognizer.
+//
+// A template matcher small enough to run all day: the user enrolls the
+// phrase by saying it a few times, each recording is stored as 12 MFCCs per
+// 10 ms frame, and live speech is matched against every template with an
+// open-begin DTW that advances one frame at a time, so the cost per frame
+// is one FFT plus one pass over each template. Non-speech chunks are not
+// even analyzed. Only after a match does process() start letting audio
+// through, until awake_ms of silence puts the gate back to listening.
+//
+// Two metrics come with it: keyword_spotting times each chunk through the
+// matcher, and wake_latency measures from the ADC capture of the phrase's
+// last frame to the wake. keyword_wakes counts wakes, keyword_false_accepts
+// counts wakes reported wrong with report_false_accept() plus those that
+// timed out with next to no speech after the phrase.
+//
+// Not thread-safe; feed it from the thread that runs the VAD.
+class KeywordSpotter {
+public:
+    enum class State {
+        Listening,      // Matching speech against the wake phrase
+        Awake           // Passing audio to the recognizer
+    };
+
+    explicit KeywordSpotter(const KeywordSpotterConfig& config = KeywordSpotterConfig());
+
+    // Add a recording of the wake phrase; leading and trailing quiet is trimmed
+    bool enroll(const float* samples, size_t count, std::string& error);
+    void clear_templates();
+    size_t template_count() const { return templates_.size(); }
+
+    // Enrolled templates in a small binary file, so users enroll once
+    bool load_templates(const std::string& path, std::string& error);
+    bool save_templates(const std::string& path, std::string& error) const;
+
+    // Feed every chunk with its VAD decision. Returns true if the chunk
+    // should go to the recognizer; the chunk that completes the phrase does not.
+    bool process(const AudioChunk& chunk, bool is_speech);
+
+    State get_state() const { return state_; }
+    bool is_awake() const { return state_ == State::Awake; }
+
+    // Open or close the gate by hand, e.g. from the global hotkey
+    void wake();
+    void sleep();
+
+    // The app decided the last wake was not meant (say, nothing useful followed)
+    void report_false_accept();
+
+    // Lowest distance seen since the last reset, for choosing a threshold
+    float get_best_score() const { return best_score_; }
+    void reset_best_score();
+
+    float get_threshold() const { return config_.threshold; }
+    void set_threshold(float threshold) { config_.threshold = threshold; }
+    int get_awake_ms() const { return config_.awake_ms; }
+    void set_awake_ms(int awake_ms) { config_.awake_ms = awake_ms; }
+
+    // MFCCs of a recording, one row of kCoefficients per 10 ms frame
+    static constexpr size_t kCoefficients = 12;
+    std::vector<float> extract_features(const float* samples, size_t count) const;
+
+private:
+    struct Template {
+        std::vector<float> features;    // frames x kCoefficients
+        size_t frames = 0;
+    };
+
+    // Open-begin DTW state for one template: cost and start frame per template frame
+    struct Match {
+        std::vector<float> cost;
+        std::vector<uint32_t> start;
+        std::vector<float> next_cost;
+        std::vector<uint32_t> next_start;
+    };
+
+    void compute_frame(const float* frame, float* coefficients) const;
+    bool add_frame(const float* coefficients);  // True when a template matched
+    void restart_matching();
+    bool add_template(std::vector<float> features, std::string& error);
+
+    KeywordSpotterConfig config_;
+    State state_ = State::Listening;
+
+    // Analysis setup, fixed by the sample rate
+    size_t frame_length_;
+    size_t hop_length_;
+    size_t fft_size_;
+    std::vector<float> window_;
+    std::vector<float> mel_weights_;        // Mel bands x (fft_size_ / 2 + 1)
+    std::vector<float> dct_;                // kCoefficients x mel bands
+    size_t mel_bands_;
+    std::vector<float> twiddle_cos_;
+    std::vector<float> twiddle_sin_;
+    std::vector<uint32_t> bit_reverse_;
+    mutable std::vector<float> real_;       // FFT scratch
+    mutable std::vector<float> imag_;
+    mutable std::vector<float> bands_;
+
+    std::vector<Template> templates_;
+    std::vector<Match> matches_;
+    std::vector<float> pending_;            // Samples not yet framed
+    uint32_t frame_index_ = 0;              // Frames since matching restarted
+    int gap_ms_ = 0;
+    float best_score_;
+
+    // Awake bookkeeping
+    int silence_ms_ = 0;
+    int speech_ms_since_wake_ = 0;
+};
+
+} // namespace voice_transcription
+
+#endif // KEYWORD_SPOTTER_H
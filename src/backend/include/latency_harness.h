@@ -0,0 +1,119 @@
+#ifndef LATENCY_HARNESS_H
+#define LATENCY_HARNESS_H
+
+#include "audio_stream.h"
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+class VoskTranscriber;
+class VADHandler;
+
+// Hand-labeled utterance, times in milliseconds from the start of the recording
+struct LabeledUtterance {
+    double start_ms = 0.0;
+    double end_ms = 0.0;
+    std::string text;
+};
+
+struct LabeledRecording {
+    std::string path;
+    std::vector<LabeledUtterance> utterances;
+};
+
+// Load a corpus manifest. Each line is "wav<TAB>start_ms<TAB>end_ms<TAB>text";
+// consecutive lines naming the same file are one recording. Relative paths are
+// resolved against the manifest's directory; '#' starts a comment line.
+bool load_latency_corpus(const std::string& manifest_path,
+                         std::vector<LabeledRecording>& corpus, std::string& error);
+
+// Pipeline configuration under test
+struct LatencyHarnessConfig {
+    std::string engine = "vosk";    // One of available_speech_engines()
+    std::string model_path;
+    std::string label;              // Free-form build or configuration name copied into the report
+    int frames_per_buffer = 320;
+    int vad_aggressiveness = 2;
+    int hangover_ms = 300;
+    bool noise_filtering = false;
+    bool realtime = true;           // Replay at capture pace; otherwise as fast as possible
+    int model_load_timeout_ms = 120000;
+};
+
+// Measurements for one labeled utterance. A latency is empty when the event
+// never happened; it can be negative when the label is later than the audio.
+struct UtteranceLatency {
+    std::string recording;
+    size_t index = 0;
+    std::string reference;
+    std::string hypothesis;         // Final texts attributed to this utterance
+    double start_ms = 0.0;
+    double end_ms = 0.0;
+    std::optional<double> onset_latency_ms;         // Labeled onset -> endpointer opens the utterance
+    std::optional<double> first_partial_latency_ms; // Labeled onset -> first non-empty partial
+    std::optional<double> final_latency_ms;         // Labeled end -> last final result
+    size_t word_errors = 0;
+    size_t reference_words = 0;
+};
+
+struct RecordingLatency {
+    std::string path;
+    double duration_ms = 0.0;
+    double processing_ms = 0.0;     // Time spent in VAD and the transcriber
+    double real_time_factor = 0.0;  // processing_ms / duration_ms
+    double max_backlog_ms = 0.0;    // Furthest a chunk was read behind its capture time
+    size_t chunks = 0;
+    size_t false_starts = 0;        // Utterances opened before any labeled onset
+};
+
+struct LatencyReport {
+    LatencyHarnessConfig config;
+    int sample_rate = 0;
+    std::vector<RecordingLatency> recordings;
+    std::vector<UtteranceLatency> utterances;
+
+    std::string to_json() const;
+    bool write_json(const std::string& path) const;
+};
+
+// Replays labeled recordings through VAD, endpointing and VoskTranscriber the
+// way the transcription loop runs them, and times when each labeled utterance
+// is detected, first shown as a partial and emitted as final text.
+//
+// Latencies are measured from when the labeled audio was captured: in
+// real-time mode that is the replay start plus the label time, in fast mode it
+// is when the chunk holding the label was read, so both modes include
+// algorithmic delay (chunking, hangover, decoder lookahead) plus processing.
+class LatencyHarness {
+public:
+    explicit LatencyHarness(const LatencyHarnessConfig& config);
+    ~LatencyHarness();
+
+    // Replay every WAV in the corpus; the model is loaded once
+    bool run(const std::vector<LabeledRecording>& corpus, LatencyReport& report);
+
+    // Replay a single stream that carries the given labels
+    bool run_stream(AudioInputStream& stream, const LabeledRecording& labels, LatencyReport& report);
+
+    std::string get_last_error() const { return last_error_; }
+
+    // Word-level edit distance between reference and hypothesis, ignoring case
+    static size_t word_errors(const std::string& reference, const std::string& hypothesis,
+                              size_t* reference_words = nullptr);
+
+private:
+    bool ensure_transcriber(int sample_rate);
+
+    LatencyHarnessConfig config_;
+    std::unique_ptr<VoskTranscriber> transcriber_;
+    std::unique_ptr<VADHandler> vad_;
+    int sample_rate_ = 0;
+    std::string last_error_;
+};
+
+} // namespace voice_transcription
+
+#endif // LATENCY_HARNESS_H
\ No newline at end of file
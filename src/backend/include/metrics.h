@@ -0,0 +1,207 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// Pipeline stages with latency histograms
+enum class Stage : uint8_t {
+    CallbackToRing,             // PortAudio callback copying into the ring buffer
+    RingToChunk,                // Queueing delay from ring write to get_next_chunk
+    Vad,                        // VADHandler::is_speech
+    NoiseFilter,                // Noise filter on one chunk
+    AcceptWaveform,             // vosk_recognizer_accept_waveform and result fetch
+    JsonParse,                  // Parsing the recognizer JSON
+    TextNormalization,          // Inverse text normalization of final results
+    CommandProcessing,          // Dictation command processing (recorded from Python)
+    Output,                     // Typing or pasting the text (recorded from Python)
+    CaptureToFinal,             // ADC capture of an utterance's last sample to its final result
+    ModelLoad,                  // Reading a speech model from disk
+    ModelWarmup,                // Decoding the warm-up utterance after a load
+    KeywordSpotting,            // One chunk through the wake-word matcher
+    WakeLatency,                // ADC capture of the wake phrase's end to the wake
+    Count
+};
+
+// Event counters
+enum class Counter : uint8_t {
+    AudioCallbacks,
+    AudioOverflows,
+    AudioChunks,
+    SpeechChunks,
+    PartialResults,
+    FinalResults,
+    KeywordWakes,
+    KeywordFalseAccepts,
+    ConsumerWakeups,            // Times the chunk consumer woke from waiting on the ring buffer
+    IdleChunksSkipped,          // Quiet chunks dropped by the idle downshift
+    Count
+};
+
+// Log-linear latency histogram in nanoseconds, in the style of HdrHistogram.
+//
+// Each power of two is split into kSubBuckets linear buckets, so any recorded
+// value is known to within 1/kSubBuckets (12.5%) of its true value.
+// Values up to 2^kMaxExponent ns (about 18 minutes) are tracked; larger
+// values land in the last bucket.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    static size_t bucket_index(uint64_t value);
+    static uint64_t bucket_lower_bound(size_t index);
+    static uint64_t bucket_upper_bound(size_t index);
+
+    // Single writer only: the owning thread updates with plain load/store pairs
+    void record(uint64_t value);
+    void reset();
+    // Fold another histogram's counts in; same single-writer rule
+    void add(const LatencyHistogram& other);
+
+    // Add this histogram's counts into plain arrays
+    void merge_into(std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum, uint64_t& max) const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Latency summary for one stage
+struct StageStats {
+    std::string stage;
+    uint64_t count = 0;
+    double total_ms = 0.0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double max_us = 0.0;
+};
+
+struct MetricsSnapshot {
+    double uptime_seconds = 0.0;
+    uint64_t resident_bytes = 0;    // Process resident set size, 0 where unsupported
+    double cpu_seconds = 0.0;       // Process user plus system CPU time
+    std::vector<StageStats> stages;
+    std::vector<std::pair<std::string, uint64_t>> counters;
+};
+
+// Process-wide metrics registry.
+//
+// Every thread records into its own shard, so the hot path is a thread_local
+// lookup and a few uncontended relaxed stores with no locks or shared cache
+// lines. Snapshots merge all shards under the registry lock. When a thread
+// exits, its counts are folded into a retired total and its shard goes on a
+// free list for the next new thread, so short-lived threads do not add up.
+//
+// Only a shard's owner writes to it, so reset() does not clear live shards
+// itself: it bumps an epoch, and each owner clears its shard the next time it
+// records. Until then snapshots leave that shard out.
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    void record_latency(Stage stage, uint64_t nanoseconds);
+    void increment(Counter counter, uint64_t delta = 1);
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+    // Shards allocated so far, in use or free
+    size_t shard_count() const;
+
+    // Prometheus text exposition format
+    std::string to_prometheus() const;
+    bool write_prometheus(const std::string& path) const;
+
+    // Recording can be switched off entirely; ScopedTimer then skips the clock reads
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    static const char* stage_name(Stage stage);
+    static const char* counter_name(Counter counter);
+    static bool stage_from_name(const std::string& name, Stage& stage);
+
+private:
+    MetricsRegistry();
+
+    struct Shard {
+        std::array<LatencyHistogram, static_cast<size_t>(Stage::Count)> stages;
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters{};
+        std::atomic<uint64_t> epoch{0};     // Last reset applied; written by the owner
+        void clear();
+        void add(const Shard& other);
+    };
+
+    // Hands its thread's shard back when the thread exits
+    struct ShardOwner {
+        Shard* shard = nullptr;
+        ~ShardOwner();
+    };
+
+    Shard& local_shard();
+    void release_shard(Shard* shard);
+
+    // Call with mutex_ held; shards not yet reset by their owner are left out
+    void merge_stage(size_t stage, std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum,
+                     uint64_t& max) const;
+    uint64_t counter_total(size_t counter) const;
+
+    std::atomic<bool> enabled_;
+    std::atomic<uint64_t> reset_epoch_;
+    std::chrono::steady_clock::time_point start_time_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;    // Every shard, in use or free
+    std::vector<Shard*> free_shards_;
+    Shard retired_;                                 // Counts of exited threads, guarded by mutex_
+};
+
+// Resident set size of this process in bytes, 0 where unsupported
+uint64_t resident_memory_bytes();
+
+// User plus system CPU time of this process in seconds, 0 where unsupported
+double process_cpu_seconds();
+
+// Records the lifetime of a scope as one latency sample
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Stage stage)
+        : stage_(stage), active_(MetricsRegistry::instance().is_enabled()) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (active_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            MetricsRegistry::instance().record_latency(
+                stage_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Stage stage_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace voice_transcription
+
+#endif // METRICS_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef MODEL_CACHE_H
+#define MODEL_CACHE_H
+
+#include "speech_recognizer.h"
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace voice_transcription {
+
+// Bytes of model files read so far, and the total
+using ModelReadProgress = std::function<void(uint64_t bytes_read, uint64_t total_bytes)>;
+
+// Read every file of a model (a directory, recursively, or a single file)
+// once, so the engine's own load is served from the page cache. The engines
+// give no progress of their own; this makes the disk part measurable.
+// Returns the bytes read.
+uint64_t prefetch_model_files(const std::string& model_path, const ModelReadProgress& progress);
+
+// Loaded models shared by every transcriber in the process.
+//
+// Neither libvosk nor whisper.cpp can map a model read-only; both
+// deserialize it into private heap memory. So the weights are shared
+// within a process instead: every VoskTranscriber and BatchTranscriber on
+// the same engine and model path gets the same SpeechModel, and each only
+// adds its own recognizer state. A model is loaded once even when several
+// callers ask for it at the same time, and is freed with its last user.
+class ModelCache {
+public:
+    static ModelCache& instance();
+
+    // The loaded model for engine and model_path, loading it if no one holds
+    // it. With reload, the files are read again even if the model is in
+    // memory (after an update); current holders keep the old copy. nullptr
+    // with error set if it cannot be loaded; failures are not cached.
+    // progress follows the file reads when this call does the load.
+    std::shared_ptr<SpeechModel> acquire(const std::string& engine, const std::string& model_path,
+                                         std::string& error, bool reload = false,
+                                         const ModelReadProgress& progress = nullptr);
+
+    struct Stats {
+        uint64_t loads = 0;             // Models read from disk
+        uint64_t hits = 0;              // Acquires served by a model already in memory
+        double load_ms = 0.0;           // Time spent loading, summed
+        size_t resident_models = 0;     // Models currently held by someone
+    };
+    Stats stats() const;
+
+private:
+    ModelCache() = default;
+
+    struct LoadResult {
+        std::shared_ptr<SpeechModel> model;
+        std::string error;
+    };
+
+    struct Entry {
+        std::weak_ptr<SpeechModel> model;
+        std::shared_future<LoadResult> loading;     // Valid while a load is running
+    };
+
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+    uint64_t loads_ = 0;
+    uint64_t hits_ = 0;
+    double load_ms_ = 0.0;
+};
+
+} // namespace voice_transcription
+
+#endif // MODEL_CACHE_H
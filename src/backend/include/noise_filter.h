@@ -0,0 +1,50 @@
+#ifndef NOISE_FILTER_H
+#define NOISE_FILTER_H
+
+#include <deque>
+
+namespace voice_transcription {
+
+class AudioChunk;
+
+// Simple noise filter: an energy-based soft noise gate followed by a
+// simplified spectral subtraction against a running noise floor estimate
+class NoiseFilter {
+public:
+    NoiseFilter(float threshold = 0.05f, int window_size = 10);
+
+    // Process an audio chunk to remove background noise
+    void filter(AudioChunk& chunk);
+
+    // Calibrate the noise filter with background noise
+    void calibrate(const AudioChunk& chunk);
+
+    // Auto-calibrate the noise filter with running energy estimates
+    void auto_calibrate(const AudioChunk& chunk, bool is_speech);
+
+    // Check if the filter is calibrated
+    bool is_calibrated() const { return calibrated_; }
+
+    // Get the current noise floor
+    float get_noise_floor() const { return noise_floor_; }
+
+    // Set the noise threshold directly
+    void set_noise_threshold(float threshold) { noise_threshold_ = threshold; }
+
+private:
+    // Calculate energy of a frame
+    float calculate_energy(const AudioChunk& chunk) const;
+
+    // Update noise floor estimate
+    void update_noise_floor(float frame_energy);
+
+    float noise_threshold_;
+    float noise_floor_;
+    bool calibrated_;
+    int window_size_;
+    std::deque<float> noise_energy_history_;
+};
+
+} // namespace voice_transcription
+
+#endif // NOISE_FILTER_H
\ No newline at end of file
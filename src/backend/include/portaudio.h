@@ -10,7 +10,11 @@ typedef int PaDeviceIndex;
 typedef double PaTime;
 typedef unsigned long PaStreamFlags;
 typedef void PaStream;
-typedef struct PaStreamCallbackTimeInfo PaStreamCallbackTimeInfo;
+typedef struct PaStreamCallbackTimeInfo {
+    PaTime inputBufferAdcTime;
+    PaTime currentTime;
+    PaTime outputBufferDacTime;
+} PaStreamCallbackTimeInfo;
 typedef unsigned long PaStreamCallbackFlags;
 typedef int (PaStreamCallback)(const void *input, void *output, unsigned long frameCount, const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags, void *userData);
 
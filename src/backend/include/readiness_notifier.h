@@ -0,0 +1,45 @@
+#ifndef READINESS_NOTIFIER_H
+#define READINESS_NOTIFIER_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace voice_transcription {
+
+// A readiness flag that event loops can wait on.
+//
+// The flag is mirrored into a descriptor that polls readable while it is
+// set: an eventfd on Linux, a pipe on other POSIX systems and a loopback
+// socket pair on Windows, where QSocketNotifier and asyncio's selector loop
+// only watch sockets. Qt and asyncio wait on fd() with no polling; others can
+// keep using the blocking calls.
+//
+// notify() is lock-free and safe to call from the audio callback: only the
+// notify that sets the flag makes a system call, so a consumer that is
+// behind costs the producer one atomic exchange per write. Consumers call
+// clear() before looking at the source, so a notify racing with that check
+// leaves the descriptor readable rather than being lost.
+class ReadinessNotifier {
+public:
+    ReadinessNotifier();
+    ~ReadinessNotifier();
+
+    ReadinessNotifier(const ReadinessNotifier&) = delete;
+    ReadinessNotifier& operator=(const ReadinessNotifier&) = delete;
+
+    // Descriptor to poll for reading; -1 if none could be created
+    intptr_t fd() const { return read_fd_; }
+
+    void notify();
+    void clear();
+    bool is_set() const { return signaled_.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<bool> signaled_{false};
+    intptr_t read_fd_ = -1;
+    intptr_t write_fd_ = -1;    // Same as read_fd_ for an eventfd
+};
+
+} // namespace voice_transcription
+
+#endif // READINESS_NOTIFIER_H
@@ -0,0 +1,58 @@
+#ifndef RESULT_QUEUE_H
+#define RESULT_QUEUE_H
+
+#include "readiness_notifier.h"
+#include "speech_recognizer.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace voice_transcription {
+
+// Hand-off of transcription results from the thread that decodes to the
+// one that consumes them.
+//
+// Threads can block in wait_pop(); event loops watch ready_fd(), which
+// polls readable while results are queued or once the queue is closed, and
+// drain it with pop(). A full queue drops its oldest result, so a stalled
+// consumer costs results rather than unbounded memory.
+class ResultQueue {
+public:
+    explicit ResultQueue(size_t capacity = 256);
+
+    // False if the queue is closed
+    bool push(TranscriptionResult result);
+
+    // Next result without waiting
+    std::optional<TranscriptionResult> pop();
+
+    // Next result, waiting up to timeout_ms; nothing once closed and empty
+    std::optional<TranscriptionResult> wait_pop(int timeout_ms);
+
+    // No more results; waiters wake and the descriptor stays readable
+    void close();
+    bool is_closed() const;
+
+    intptr_t ready_fd() const { return notifier_.fd(); }
+    size_t size() const;
+    uint64_t dropped() const;
+
+private:
+    // Keep the descriptor readable while there is something to see; called with mutex_ held
+    void rearm();
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<TranscriptionResult> results_;
+    size_t capacity_;
+    bool closed_ = false;
+    uint64_t dropped_ = 0;
+    ReadinessNotifier notifier_;
+};
+
+} // namespace voice_transcription
+
+#endif // RESULT_QUEUE_H
@@ -0,0 +1,23 @@
+#ifndef SAMPLE_CONVERSION_H
+#define SAMPLE_CONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace voice_transcription {
+
+// Convert float samples in [-1, 1] to 16-bit PCM for WebRTC VAD and Vosk.
+// Out-of-range input is clipped instead of wrapping around. The loop has no
+// branches, so compilers vectorize it.
+inline void float_to_int16(const float* input, int16_t* output, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float scaled = input[i] * 32767.0f;
+        scaled = scaled > 32767.0f ? 32767.0f : scaled;
+        scaled = scaled < -32768.0f ? -32768.0f : scaled;
+        output[i] = static_cast<int16_t>(scaled);
+    }
+}
+
+} // namespace voice_transcription
+
+#endif // SAMPLE_CONVERSION_H
\ No newline at end of file
@@ -0,0 +1,161 @@
+#ifndef SPEECH_RECOGNIZER_H
+#define SPEECH_RECOGNIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace voice_transcription {
+
+// One recognized word. The text is a span of TranscriptionResult::text_arena;
+// times are seconds of audio since the recognizer was created or reset.
+struct WordInfo {
+    uint32_t text_offset;
+    uint32_t text_length;
+    float start;
+    float end;
+    float confidence;             // 0.0 to 1.0; the result confidence when the engine gives none
+};
+
+// One entry of an N-best list. Its words are
+// alternative_words[word_begin, word_begin + word_count).
+struct Alternative {
+    uint32_t text_offset;         // Span of text_arena
+    uint32_t text_length;
+    uint32_t word_begin;
+    uint32_t word_count;
+    float score;                  // Decoder score, higher is better; not a probability
+};
+
+// Transcription result structure
+struct TranscriptionResult {
+    std::string raw_text;         // Raw text from the transcription engine
+    std::string processed_text;   // Text after inverse text normalization and command processing
+    bool is_final;                // Whether this is a final result
+    double confidence;            // Confidence score (0.0 to 1.0)
+    int64_t timestamp_ms;         // Timestamp of when the transcription was generated, on the trace clock
+    uint64_t chunk_sequence = 0;  // Sequence number of the chunk that produced this result
+    bool command_mode = false;    // Decoded by the command grammar rather than open dictation
+
+    // Audio of the utterance so far: capture-stream samples [start_sample,
+    // end_sample) and when those bounds were captured, on the trace clock.
+    // The capture times are 0 when the audio source does not know them.
+    uint64_t start_sample = 0;
+    uint64_t end_sample = 0;
+    int64_t start_capture_us = 0;
+    int64_t end_capture_us = 0;
+
+    // Word detail of final results. All word and alternative texts live back
+    // to back in one arena, so the arrays below are flat and can be handed to
+    // Python as numpy views without copying.
+    std::string text_arena;
+    std::vector<WordInfo> words;              // Best hypothesis
+    std::vector<Alternative> alternatives;    // N-best, best first; empty unless requested
+    std::vector<WordInfo> alternative_words;
+
+    std::string_view text_of(const WordInfo& word) const {
+        return std::string_view(text_arena).substr(word.text_offset, word.text_length);
+    }
+    std::string_view text_of(const Alternative& alternative) const {
+        return std::string_view(text_arena).substr(alternative.text_offset, alternative.text_length);
+    }
+
+    // Append text to the arena and return its offset
+    uint32_t add_text(std::string_view text) {
+        uint32_t offset = static_cast<uint32_t>(text_arena.size());
+        text_arena.append(text.data(), text.size());
+        return offset;
+    }
+};
+
+// What an engine can do, so callers can adapt instead of checking its name
+struct RecognizerCapabilities {
+    std::string engine;                 // Name accepted by load_speech_model
+    bool streaming_partials = false;    // Partials change while audio arrives
+    bool endpointing = false;           // Finalizes utterances on its own
+    bool word_timings = false;
+    bool alternatives = false;          // Can return N-best lists
+    bool grammar = false;               // Can decode against a fixed phrase list
+    std::vector<int> sample_rates;      // Accepted rates; empty means any
+};
+
+// One decoding stream. Not thread-safe; VoskTranscriber serializes calls.
+//
+// Results carry raw_text, is_final and confidence, plus words and
+// alternatives when the engine has them; the caller fills in timestamps and
+// sequence numbers and applies text normalization.
+class StreamingRecognizer {
+public:
+    virtual ~StreamingRecognizer() = default;
+
+    // Feed mono samples in [-1, 1]. Returns true when the engine ended an
+    // utterance; result() then holds its final text.
+    virtual bool accept_waveform(const float* samples, size_t count) = 0;
+
+    // Text of the utterance so far
+    virtual TranscriptionResult partial_result() = 0;
+
+    // Final text after accept_waveform returned true
+    virtual TranscriptionResult result() = 0;
+
+    // Force the current utterance final, e.g. when the VAD heard it end
+    virtual TranscriptionResult final_result() = 0;
+
+    // Drop the utterance in progress
+    virtual void reset() = 0;
+
+    virtual RecognizerCapabilities capabilities() const = 0;
+
+    // Request up to max_alternatives N-best entries with each final result;
+    // 0 disables the list. Returns false if the engine has no N-best output.
+    virtual bool set_max_alternatives(int max_alternatives) { return max_alternatives == 0; }
+
+    // Set when a call could not produce a result
+    std::string get_last_error() const { return last_error_; }
+
+    // Chunk sequence that keys trace spans recorded inside the engine
+    void set_trace_sequence(uint64_t sequence) { trace_sequence_ = sequence; }
+
+protected:
+    std::string last_error_;
+    uint64_t trace_sequence_ = 0;
+};
+
+// Loaded model weights, shared by the recognizers created from it
+class SpeechModel {
+public:
+    virtual ~SpeechModel() = default;
+
+    // nullptr with error set if this model cannot decode at sample_rate
+    virtual std::unique_ptr<StreamingRecognizer> create_recognizer(float sample_rate, std::string& error) = 0;
+
+    // Recognizer that only hears the given phrases, for short commands. The
+    // search is far smaller than open dictation, so it is faster and cannot
+    // drift into similar-sounding words. Speech outside the list comes out
+    // as "[unk]". nullptr with error set if the engine has no grammar mode.
+    virtual std::unique_ptr<StreamingRecognizer> create_grammar_recognizer(
+        float sample_rate, const std::vector<std::string>& phrases, std::string& error) {
+        (void)sample_rate;
+        (void)phrases;
+        error = "Engine has no grammar mode";
+        return nullptr;
+    }
+
+    virtual RecognizerCapabilities capabilities() const = 0;
+};
+
+// Load a model for the named engine ("vosk", "whisper", "synthetic").
+// Returns nullptr with error set if the engine is unknown, not compiled in,
+// or the model cannot be loaded.
+std::unique_ptr<SpeechModel> load_speech_model(const std::string& engine, const std::string& model_path,
+                                               std::string& error);
+
+// Engines compiled into this build
+std::vector<std::string> available_speech_engines();
+
+} // namespace voice_transcription
+
+#endif // SPEECH_RECOGNIZER_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+#ifndef SYNTHETIC_RECOGNIZER_H
+#define SYNTHETIC_RECOGNIZER_H
+
+#include "speech_recognizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// Delay distribution added to each accept_waveform call
+struct JitterDistribution {
+    enum class Kind { None, Uniform, Normal, LogNormal, Exponential };
+
+    Kind kind = Kind::None;
+    double a_ms = 0.0;      // Uniform: min; Normal/LogNormal: mean; Exponential: mean
+    double b_ms = 0.0;      // Uniform: max; Normal/LogNormal: standard deviation
+
+    // Draw a delay from a uniform variate in (0, 1) and a standard normal variate
+    double sample_ms(double uniform, double normal) const;
+};
+
+// Behavior of the synthetic recognizer, read from "synthetic_asr.conf" in
+// the model directory (or from the model path itself if it is a file):
+//
+//   # Seconds of CPU work per second of audio, i.e. the real-time factor
+//   cpu_cost = 0.15
+//   # none | uniform MIN MAX | normal MEAN SD | lognormal MEAN SD | exponential MEAN
+//   jitter = lognormal 4 2
+//   words_per_second = 2.5
+//   endpoint_silence_ms = 500
+//   speech_threshold = 0.02
+//   confidence = 0.9
+//   seed = 1
+//   # Heap a loaded model holds, standing in for a real model's weights
+//   model_mb = 0
+//   utterance = the quick brown fox jumps over the lazy dog
+//   utterance = set a timer for ten minutes
+//   # N-best hypotheses, best first, each scoring 1.0 below the previous
+//   utterance = deploy to cooper netties | deploy to kubernetes
+//
+// Utterances are emitted in order and repeat once the script runs out.
+struct SyntheticRecognizerConfig {
+    std::vector<std::string> script = { "the quick brown fox jumps over the lazy dog" };
+    double cpu_cost = 0.0;
+    JitterDistribution jitter;
+    double words_per_second = 2.5;      // Pace at which partials reveal words
+    double endpoint_silence_ms = 500.0; // Trailing silence that ends an utterance on its own
+    double speech_threshold = 0.02;     // RMS level (full scale 1.0) that counts as speech
+    double confidence = 1.0;            // Per-word confidence in results
+    uint32_t seed = 1;
+    double model_mb = 0.0;              // Memory held by each loaded model
+
+    static bool parse(const std::string& text, SyntheticRecognizerConfig& config, std::string& error);
+    static bool load(const std::string& path, SyntheticRecognizerConfig& config, std::string& error);
+};
+
+// Deterministic stand-in for libvosk, exported through the Vosk C API so
+// VoskTranscriber runs on it unchanged. It is linked when libvosk is missing
+// and in the test and benchmark builds.
+//
+// Every recognizer tracks speech by signal level. While speech lasts, partials
+// reveal the current scripted utterance word by word. The utterance is final
+// after endpoint_silence_ms of trailing silence, or when the final result is
+// requested. Each accept_waveform call spins for cpu_cost times the audio
+// duration, then sleeps for one draw from the jitter distribution. Both use
+// a recognizer-local generator, so runs with the same seed and audio match.
+class SyntheticRecognizer {
+public:
+    SyntheticRecognizer(const SyntheticRecognizerConfig& config, float sample_rate);
+
+    void set_max_alternatives(int max_alternatives) { max_alternatives_ = max_alternatives; }
+    void set_words(bool words) { words_ = words; }
+    // Restrict results to these phrases, like a Vosk grammar: a scripted
+    // utterance outside the list finalizes as "[unk]". Empty lifts the limit.
+    void set_grammar(const std::vector<std::string>& phrases);
+
+    // Returns true when the audio ended an utterance
+    bool accept_waveform(const int16_t* samples, size_t count);
+    const std::string& result();
+    const std::string& partial_result();
+    const std::string& final_result();
+    void reset();
+
+    // Next delay from the jitter distribution; accept_waveform sleeps for one draw
+    double draw_jitter_ms();
+
+    // Utterances finalized so far, across resets
+    uint64_t get_utterance_count() const { return utterance_count_; }
+
+private:
+    std::string finalize();
+    std::string format_words(const std::vector<std::string>& words, bool with_confidence) const;
+    std::string format_final(const std::vector<std::vector<std::string>>& hypotheses) const;
+    double next_uniform();
+    double next_normal();
+    void burn_cpu(double seconds) const;
+
+    SyntheticRecognizerConfig config_;
+    double sample_rate_;
+    int max_alternatives_ = 0;
+    bool words_ = false;
+    std::vector<std::string> grammar_;  // Space-joined phrases, empty for open dictation
+
+    uint64_t rng_state_;
+    size_t script_index_ = 0;
+    uint64_t utterance_count_ = 0;
+
+    double stream_time_s_ = 0.0;        // Audio accepted since creation
+    double speech_ms_ = 0.0;            // Speech in the current utterance
+    double trailing_silence_ms_ = 0.0;
+    double utterance_start_s_ = -1.0;   // Stream time of the first speech, or -1
+    std::string pending_final_;         // Set when accept_waveform found an endpoint
+    std::string last_result_;
+};
+
+// The synthetic recognizer as the "synthetic" engine, without going through
+// the Vosk C API. Lets benchmarks compare it against libvosk in one build.
+class SyntheticSpeechModel : public SpeechModel {
+public:
+    explicit SyntheticSpeechModel(const SyntheticRecognizerConfig& config);
+
+    std::unique_ptr<StreamingRecognizer> create_recognizer(float sample_rate, std::string& error) override;
+    std::unique_ptr<StreamingRecognizer> create_grammar_recognizer(
+        float sample_rate, const std::vector<std::string>& phrases, std::string& error) override;
+    RecognizerCapabilities capabilities() const override;
+
+private:
+    SyntheticRecognizerConfig config_;
+    std::vector<uint8_t> weights_;      // model_mb of touched memory, never read
+};
+
+class SyntheticStreamingRecognizer : public StreamingRecognizer {
+public:
+    SyntheticStreamingRecognizer(const SyntheticRecognizerConfig& config, float sample_rate);
+
+    bool accept_waveform(const float* samples, size_t count) override;
+    TranscriptionResult partial_result() override;
+    TranscriptionResult result() override;
+    TranscriptionResult final_result() override;
+    void reset() override;
+    RecognizerCapabilities capabilities() const override;
+    bool set_max_alternatives(int max_alternatives) override;
+    void set_grammar(const std::vector<std::string>& phrases);
+
+private:
+    TranscriptionResult parse(const std::string& json, bool is_final);
+
+    SyntheticRecognizer recognizer_;
+    std::vector<int16_t> pcm_;
+};
+
+} // namespace voice_transcription
+
+#endif // SYNTHETIC_RECOGNIZER_H
\ No newline at end of file
@@ -0,0 +1,155 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// Span names used by the pipeline. They are static strings, so a trace event
+// stores a pointer rather than a copy.
+namespace trace_span {
+    inline constexpr char kCapture[] = "capture";                      // PortAudio callback
+    inline constexpr char kRingWait[] = "ring_wait";                   // Samples waiting in the ring buffer
+    inline constexpr char kVad[] = "vad";
+    inline constexpr char kNoiseFilter[] = "noise_filter";
+    inline constexpr char kDecode[] = "decode";                        // accept_waveform and result fetch
+    inline constexpr char kFinalize[] = "finalize";                    // final_result at the end of an utterance
+    inline constexpr char kJsonParse[] = "json_parse";
+    inline constexpr char kTextNormalization[] = "text_normalization";
+    inline constexpr char kCommandProcessing[] = "command_processing"; // Recorded from Python
+    inline constexpr char kOutput[] = "output";                        // Recorded from Python
+}
+
+// Trace clock in microseconds since the Unix epoch. It is steady (it never
+// goes backwards), and it is aligned with the system clock once at startup,
+// so it matches TranscriptionResult::timestamp_ms.
+int64_t trace_clock_us();
+
+// Optional span recorder producing Chrome trace-event JSON, viewable in
+// chrome://tracing or ui.perfetto.dev.
+//
+// Every thread writes complete events into its own fixed-size ring, and the
+// newest events overwrite the oldest. The writer never locks or allocates
+// after the first event on a thread. Dumps copy each ring while it is being
+// written, then drop any slot the writer may have overwritten during the copy.
+// When a thread exits its ring goes on a free list. Its spans stay in dumps
+// until a new thread takes the ring over, so there are only ever as many
+// rings as threads tracing at once.
+//
+// Each span carries the sequence number of the audio chunk it belongs to,
+// so one chunk can be followed from capture to output.
+class TraceRecorder {
+public:
+    static constexpr size_t kEventsPerThread = 8192;
+
+    static TraceRecorder& instance();
+
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool is_enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Record a finished span; name must be a static string
+    void record(const char* name, uint64_t sequence, int64_t begin_us, int64_t end_us);
+
+    // Label the calling thread in the trace viewer
+    void set_thread_name(const std::string& name);
+
+    // Audio callback threads never run the latency trigger, since dumping does file IO
+    void mark_realtime_thread();
+
+    // Write a trace automatically when a span takes at least threshold_us.
+    // A threshold of 0 disables the trigger. Repeat dumps are rate limited.
+    void set_dump_trigger(int64_t threshold_us, const std::string& path);
+    uint64_t get_triggered_dump_count() const { return triggered_dumps_.load(); }
+
+    // Chrome trace-event JSON of everything still buffered
+    std::string to_json() const;
+    bool write_json(const std::string& path) const;
+    void clear();
+
+    // Maps a span name from Python onto the static name, or nullptr if unknown
+    static const char* intern_span_name(const std::string& name);
+
+    // Rings allocated so far, in use or free
+    size_t buffer_count() const;
+
+private:
+    TraceRecorder();
+
+    struct Event {
+        const char* name;
+        uint64_t sequence;
+        int64_t begin_us;
+        int64_t end_us;
+    };
+
+    // Slot fields are atomics so a dump can read them while the owner writes
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> begin_us{0};
+        std::atomic<int64_t> end_us{0};
+    };
+
+    struct ThreadBuffer {
+        uint32_t thread_id = 0;
+        std::string thread_name;            // Guarded by the recorder mutex
+        std::atomic<uint64_t> head{0};      // Events ever written
+        std::atomic<uint64_t> cleared{0};   // Events before this index were cleared
+        std::array<Slot, kEventsPerThread> slots;
+    };
+
+    // Hands its thread's ring back when the thread exits
+    struct BufferOwner {
+        ThreadBuffer* buffer = nullptr;
+        ~BufferOwner();
+    };
+
+    ThreadBuffer& local_buffer();
+    void release_buffer(ThreadBuffer* buffer);
+    void collect(std::vector<std::pair<uint32_t, Event>>& events) const;
+    void check_trigger(int64_t duration_us);
+
+    std::atomic<bool> enabled_;
+    std::atomic<int64_t> trigger_threshold_us_;
+    std::atomic<int64_t> last_trigger_us_;
+    std::atomic<uint64_t> triggered_dumps_;
+    std::string trigger_path_;              // Guarded by mutex_
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+    std::vector<ThreadBuffer*> free_buffers_;
+    uint32_t next_thread_id_ = 0;
+};
+
+// Records the lifetime of a scope as one span when tracing is enabled
+class TraceSpan {
+public:
+    TraceSpan(const char* name, uint64_t sequence)
+        : name_(name), sequence_(sequence),
+          begin_us_(TraceRecorder::instance().is_enabled() ? trace_clock_us() : -1) {
+    }
+
+    ~TraceSpan() {
+        if (begin_us_ >= 0) {
+            TraceRecorder::instance().record(name_, sequence_, begin_us_, trace_clock_us());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    uint64_t sequence_;
+    int64_t begin_us_;
+};
+
+} // namespace voice_transcription
+
+#endif // TRACE_RECORDER_H
\ No newline at end of file
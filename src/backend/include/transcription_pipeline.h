@@ -0,0 +1,79 @@
+#ifndef TRANSCRIPTION_PIPELINE_H
+#define TRANSCRIPTION_PIPELINE_H
+
+#include "audio_stream.h"
+#include "result_queue.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace voice_transcription {
+
+class VoskTranscriber;
+class VADHandler;
+
+struct TranscriptionPipelineConfig {
+    int vad_aggressiveness = 2;
+    int hangover_ms = 300;
+    bool partial_results = true;    // Queue partials as well as finals
+    size_t queue_capacity = 256;
+};
+
+// The transcription loop on a native thread: chunks from the stream go
+// through the VAD and the endpointer to the transcriber, and non-empty
+// results go into a ResultQueue. Nothing on that thread touches Python, so
+// an event loop can serve many sessions by watching each queue's
+// descriptor, with no Python thread per session and no GIL contention.
+//
+// The stream and transcriber are borrowed and must outlive the pipeline;
+// configure the transcriber (noise filtering, mode, vocabulary) before
+// start(). The queue closes when the stream ends or after stop(); speech
+// still open at that point is finalized first, as when dictation stops.
+class TranscriptionPipeline {
+public:
+    TranscriptionPipeline(AudioInputStream& stream, VoskTranscriber& transcriber,
+                          const TranscriptionPipelineConfig& config = TranscriptionPipelineConfig());
+    ~TranscriptionPipeline();
+
+    TranscriptionPipeline(const TranscriptionPipeline&) = delete;
+    TranscriptionPipeline& operator=(const TranscriptionPipeline&) = delete;
+
+    // Start the stream if needed and the decode thread; false with
+    // get_last_error() set if the model is not loaded or the stream fails
+    bool start();
+
+    // Ask the decode thread to finish without waiting for it; the queue
+    // closes once the last result is in
+    void request_stop();
+
+    // Finish and join the decode thread
+    void stop();
+
+    bool is_running() const { return running_.load(); }
+
+    // Results of the current or last run; start() replaces a closed queue
+    std::shared_ptr<ResultQueue> get_results() const;
+
+    std::string get_last_error() const;
+
+private:
+    void run(int chunk_ms);
+    void publish(const TranscriptionResult& result);
+
+    AudioInputStream& stream_;
+    VoskTranscriber& transcriber_;
+    TranscriptionPipelineConfig config_;
+    std::unique_ptr<VADHandler> vad_;
+    std::shared_ptr<ResultQueue> results_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_requested_{false};
+    mutable std::mutex mutex_;      // Guards results_ and last_error_
+    std::string last_error_;
+};
+
+} // namespace voice_transcription
+
+#endif // TRANSCRIPTION_PIPELINE_H
@@ -0,0 +1,77 @@
+#ifndef VAD_SEGMENTER_H
+#define VAD_SEGMENTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace voice_transcription {
+
+// Samples [start_sample, end_sample) of one recording
+struct SampleRange {
+    size_t start_sample = 0;
+    size_t end_sample = 0;
+};
+
+// Speech regions of a recording, in order and not overlapping. Decoding only
+// these means the recognizer sees them back to back, so positions in that
+// compacted stream are mapped back to the recording here.
+class SpeechTimeline {
+public:
+    // Regions must be added in increasing order; touching regions are merged
+    void add(const SampleRange& region);
+
+    const std::vector<SampleRange>& regions() const { return regions_; }
+    size_t kept_samples() const { return kept_samples_; }
+
+    // Recording position of a compacted position. A position where two
+    // regions meet maps to the start of the later one; to_original_end maps
+    // it to the end of the earlier one instead, for the end of a span.
+    size_t to_original(size_t position) const;
+    size_t to_original_end(size_t position) const;
+
+    // The part of this timeline inside range
+    SpeechTimeline slice(const SampleRange& range) const;
+
+private:
+    std::vector<SampleRange> regions_;
+    std::vector<size_t> kept_before_;   // Compacted position where each region starts
+    size_t kept_samples_ = 0;
+};
+
+struct VadSegmenterConfig {
+    int vad_aggressiveness = 2;
+    int padding_ms = 300;       // Audio kept on each side of detected speech
+    int min_speech_ms = 60;     // Shorter bursts are treated as noise
+};
+
+// Finds the speech in a whole recording before it is decoded, so offline
+// decoding can skip long silences. The VAD runs over the recording in one
+// batch; speech runs are padded so word onsets and decays survive, and
+// regions whose padding meets are merged.
+class VadSegmenter {
+public:
+    static constexpr int kFrameMs = 20;
+
+    VadSegmenter(const VadSegmenterConfig& config, int sample_rate);
+
+    // Speech flag per kFrameMs frame
+    std::vector<uint8_t> classify(const float* samples, size_t count) const;
+
+    // Padded speech regions of a recording
+    SpeechTimeline segment(const float* samples, size_t count) const;
+
+    // Padded speech regions from per-frame flags of a recording of total samples
+    SpeechTimeline regions_from_frames(const std::vector<uint8_t>& speech, size_t total) const;
+
+    size_t get_frame_size() const { return frame_size_; }
+
+private:
+    VadSegmenterConfig config_;
+    int sample_rate_;
+    size_t frame_size_;
+};
+
+} // namespace voice_transcription
+
+#endif // VAD_SEGMENTER_H
\ No newline at end of file
@@ -15,6 +15,8 @@ void vosk_model_free(VoskModel *model);
 
 // Recognizer functions
 VoskRecognizer *vosk_recognizer_new(VoskModel *model, float sample_rate);
+// grammar is a JSON array of phrases, e.g. ["new line", "caps on", "[unk]"]
+VoskRecognizer *vosk_recognizer_new_grm(VoskModel *model, float sample_rate, const char *grammar);
 void vosk_recognizer_free(VoskRecognizer *recognizer);
 void vosk_recognizer_set_max_alternatives(VoskRecognizer *recognizer, int max_alternatives);
 void vosk_recognizer_set_words(VoskRecognizer *recognizer, int words);
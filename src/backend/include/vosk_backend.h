@@ -0,0 +1,59 @@
+#ifndef VOSK_BACKEND_H
+#define VOSK_BACKEND_H
+
+#include "speech_recognizer.h"
+#include <vosk_api.h>
+#include <vector>
+
+namespace voice_transcription {
+
+// Kaldi-based streaming recognition through the Vosk C API. Without libvosk
+// the same API is served by the synthetic recognizer.
+class VoskSpeechModel : public SpeechModel {
+public:
+    // On failure is_loaded() is false and error is set
+    VoskSpeechModel(const std::string& model_path, std::string& error);
+    ~VoskSpeechModel() override;
+
+    VoskSpeechModel(const VoskSpeechModel&) = delete;
+    VoskSpeechModel& operator=(const VoskSpeechModel&) = delete;
+
+    bool is_loaded() const { return model_ != nullptr; }
+
+    std::unique_ptr<StreamingRecognizer> create_recognizer(float sample_rate, std::string& error) override;
+    // Needs a model with a dynamic graph (the small models); libvosk ignores
+    // the grammar of models built with a static HCLG.fst
+    std::unique_ptr<StreamingRecognizer> create_grammar_recognizer(
+        float sample_rate, const std::vector<std::string>& phrases, std::string& error) override;
+    RecognizerCapabilities capabilities() const override;
+
+private:
+    VoskModel* model_;
+};
+
+class VoskStreamingRecognizer : public StreamingRecognizer {
+public:
+    explicit VoskStreamingRecognizer(VoskRecognizer* recognizer);
+    ~VoskStreamingRecognizer() override;
+
+    VoskStreamingRecognizer(const VoskStreamingRecognizer&) = delete;
+    VoskStreamingRecognizer& operator=(const VoskStreamingRecognizer&) = delete;
+
+    bool accept_waveform(const float* samples, size_t count) override;
+    TranscriptionResult partial_result() override;
+    TranscriptionResult result() override;
+    TranscriptionResult final_result() override;
+    void reset() override;
+    RecognizerCapabilities capabilities() const override;
+    bool set_max_alternatives(int max_alternatives) override;
+
+private:
+    TranscriptionResult parse(const char* json, bool is_final);
+
+    VoskRecognizer* recognizer_;
+    std::vector<int16_t> pcm_;
+};
+
+} // namespace voice_transcription
+
+#endif // VOSK_BACKEND_H
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef VOSK_RESULT_PARSER_H
+#define VOSK_RESULT_PARSER_H
+
+#include "speech_recognizer.h"
+#include <string>
+
+namespace voice_transcription {
+
+// Parse a Vosk recognizer JSON result into result.
+//
+// Final results ({"text": ..., "result": [...]}) set is_final, the word list
+// and the mean word confidence. N-best results ({"alternatives": [...]}) fill
+// alternatives and alternative_words; the best entry also becomes raw_text
+// and words. Partial results ({"partial": ...}) get a fixed 0.5 confidence.
+// processed_text is set to the raw text; normalization and command
+// processing happen later. Returns false and sets error if the JSON is
+// malformed.
+bool parse_vosk_result(const std::string& json, TranscriptionResult& result, std::string& error);
+
+} // namespace voice_transcription
+
+#endif // VOSK_RESULT_PARSER_H
@@ -2,12 +2,15 @@
 #define VOSK_TRANSCRIPTION_ENGINE_H
 
 #include "audio_stream.h"
-#include <vosk_api.h>
+#include "hotword_biaser.h"
+#include "inverse_text_normalizer.h"
+#include "speech_recognizer.h"
 #include <string>
 #include <memory>
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <future>
 #include <deque>
 
@@ -17,19 +20,12 @@ namespace voice_transcription {
 class NoiseFilter;
 class VADHandler;  // Forward declare, don't redefine
 
-// Transcription result structure
-struct TranscriptionResult {
-    std::string raw_text;         // Raw text from the transcription engine
-    std::string processed_text;   // Text after command processing
-    bool is_final;                // Whether this is a final result
-    double confidence;            // Confidence score (0.0 to 1.0)
-    int64_t timestamp_ms;         // Timestamp of when the transcription was generated
-};
-
-// Vosk transcription engine
+// Streaming transcription on a pluggable engine. The name predates the
+// engine interface; "vosk" stays the default.
 class VoskTranscriber {
 public:
-    VoskTranscriber(const std::string& model_path, float sample_rate);
+    // engine is one of available_speech_engines()
+    VoskTranscriber(const std::string& model_path, float sample_rate, const std::string& engine = "vosk");
     ~VoskTranscriber();
 
     // No copy operations
@@ -47,6 +43,44 @@ public:
     TranscriptionResult transcribe_with_noise_filtering(
         std::unique_ptr<AudioChunk> chunk, bool is_speech);
 
+    // Inverse text normalization of final results ("twenty three percent" -> "23%")
+    void enable_inverse_text_normalization(bool enable);
+    bool is_inverse_text_normalization_enabled() const;
+
+    // N-best entries attached to each final result, 0 for none. Returns false
+    // if the loaded engine has no N-best output.
+    bool set_max_alternatives(int max_alternatives);
+    int get_max_alternatives() const { return max_alternatives_; }
+
+    // Vocabulary biasing toward product names and jargon, applied to final
+    // dictation results (see HotwordBiaser). Changes apply from the next
+    // final result, without reloading the model. While the list is not
+    // empty, the recognizer keeps an N-best list of at least
+    // kVocabularyAlternatives for rescoring, so Vosk words lose their
+    // confidence as with set_max_alternatives().
+    static constexpr int kVocabularyAlternatives = 5;
+    void set_vocabulary_phrase(const std::string& phrase, float boost) { vocabulary_->set_phrase(phrase, boost); }
+    bool remove_vocabulary_phrase(const std::string& phrase) { return vocabulary_->remove_phrase(phrase); }
+    void set_vocabulary(const std::vector<HotwordEntry>& entries) { vocabulary_->set_phrases(entries); }
+    std::vector<HotwordEntry> get_vocabulary() const { return vocabulary_->get_phrases(); }
+    // A user's vocabulary file; false with get_last_error() set on failure
+    bool load_vocabulary(const std::string& path);
+    bool save_vocabulary(const std::string& path);
+
+    // Command mode decodes with a second recognizer on the same model that
+    // only hears the command phrases: a much smaller search, so short
+    // commands finalize faster and are not misheard as dictation. Speech
+    // outside the phrases gives empty results. A mode change takes effect at
+    // the next utterance boundary; without phrases or grammar support,
+    // command mode falls back to dictation.
+    enum class RecognitionMode { Dictation, Commands };
+    void set_recognition_mode(RecognitionMode mode) { requested_mode_ = mode; }
+    RecognitionMode get_recognition_mode() const { return requested_mode_; }
+
+    // Phrases the command recognizer accepts, e.g. CommandEngine::get_phrases().
+    // Returns false if the loaded engine has no grammar mode.
+    bool set_command_phrases(const std::vector<std::string>& phrases);
+
     // Process an audio chunk and return transcription
     TranscriptionResult transcribe(std::unique_ptr<AudioChunk> chunk);
     
@@ -60,20 +94,59 @@ public:
     bool is_model_loaded() const;
     std::string get_last_error() const { return last_error_; }
     
-    // Background loading status
+    // Background loading status. Loading reads the model files (progress by
+    // bytes), lets the engine build the model, then decodes a short built-in
+    // utterance so the first real one runs at steady-state latency.
+    enum class LoadingPhase { ReadingFiles, LoadingModel, WarmingUp, Ready, Failed };
     bool is_loading() const;
     float get_loading_progress() const;
+    LoadingPhase get_loading_phase() const { return loading_phase_.load(); }
+    // Seconds until loading finishes, extrapolated from the progress so far;
+    // negative while there is no progress to go on, 0 once done
+    double get_loading_eta_seconds() const;
+
+    // Load another model in the background while the current one keeps
+    // decoding. The new model takes over at the next utterance boundary, so
+    // no audio is dropped; if it fails to load, the current one stays and
+    // get_last_error() says why. An empty engine keeps the current engine.
+    // Returns false if a load or swap is already in progress.
+    bool swap_model(const std::string& model_path, const std::string& engine = "");
+    bool is_swap_pending() const;
+    std::string get_model_path() const;
+
+    // Engine in use and what it supports; capabilities are empty until the model loads
+    std::string get_engine_name() const;
+    RecognizerCapabilities get_capabilities() const;
 
 private:
     // Noise filtering
     std::unique_ptr<NoiseFilter> noise_filter_;
     bool use_noise_filtering_ = false;
+
+    // Inverse text normalization, applied to processed_text of final results
+    InverseTextNormalizer normalizer_;
+    bool use_inverse_text_normalization_ = true;
+
+    // Requested N-best size, and the size the recognizer was last given
+    std::atomic<int> max_alternatives_{0};
+    int applied_max_alternatives_ = 0;
+
+    // Vocabulary biasing; a pointer so the transcriber stays movable
+    std::unique_ptr<HotwordBiaser> vocabulary_ = std::make_unique<HotwordBiaser>();
     
-    // Parse json result to TranscriptionResult
-    TranscriptionResult parse_result(const std::string& json_result);
-    
-    // Extract text from JSON
-    std::string extract_text_from_json(const std::string& json);
+    // Stamp an engine result and normalize final text
+    TranscriptionResult finish_result(TranscriptionResult result, uint64_t sequence);
+
+    // Extend the open utterance by a chunk fed to the recognizer
+    void extend_utterance(const AudioChunk& chunk);
+
+    // Span of the open utterance in sample time and capture time; the
+    // utterance closes when a final result ends it or on reset
+    bool utterance_open_ = false;
+    uint64_t utterance_start_sample_ = 0;
+    uint64_t utterance_end_sample_ = 0;
+    int64_t utterance_start_us_ = 0;
+    int64_t utterance_end_us_ = 0;
     
     // Create empty result
     TranscriptionResult create_empty_result() const;
@@ -81,19 +154,56 @@ private:
     // Background loading method
     bool load_model_background();
 
+    // A model loaded by swap_model, with its first recognizer
+    struct LoadedModel {
+        std::string engine;
+        std::string model_path;
+        std::shared_ptr<SpeechModel> model;
+        std::unique_ptr<StreamingRecognizer> recognizer;
+        std::string error;
+    };
+
+    // Take over a swapped-in model once it is ready; call between utterances
+    // with recognizer_mutex_ held
+    void adopt_swapped_model();
+
+    // Rebuild the command recognizer if the phrases changed and apply the
+    // requested mode; call between utterances with recognizer_mutex_ held
+    void update_recognition_mode();
+
+    // Recognizer for the current utterance
+    StreamingRecognizer* active_recognizer() const;
+
+    // Command mode: the grammar recognizer and the phrases it was asked for
+    std::unique_ptr<StreamingRecognizer> command_recognizer_;
+    std::mutex command_mutex_;
+    std::vector<std::string> command_phrases_;      // Guarded by command_mutex_
+    bool command_phrases_changed_ = false;          // Guarded by command_mutex_
+    std::atomic<RecognitionMode> requested_mode_{RecognitionMode::Dictation};
+    RecognitionMode active_mode_ = RecognitionMode::Dictation;
+
     // Member variables
-    VoskModel* model_;
-    VoskRecognizer* recognizer_;
+    std::string engine_;
+    std::shared_ptr<SpeechModel> model_;      // Shared through ModelCache
+    std::unique_ptr<StreamingRecognizer> recognizer_;
     float sample_rate_;
     std::string last_error_;
-    std::mutex recognizer_mutex_;
+    // Guards model_ and recognizer_ against adopt_swapped_model(); the
+    // accessors take it on the caller's thread
+    mutable std::mutex recognizer_mutex_;
     bool has_speech_started_;
     
     // Background loading members
     std::atomic<bool> is_loading_;
     std::atomic<float> loading_progress_;
+    std::atomic<LoadingPhase> loading_phase_{LoadingPhase::ReadingFiles};
+    std::chrono::steady_clock::time_point loading_started_;
     std::future<bool> loading_future_;
     std::string model_path_;
+    std::future<LoadedModel> swap_future_;
+    // Guards engine_, model_path_ and swap_future_: swap_model() and the
+    // getters run on the caller's thread, adopt_swapped_model() on the decode thread
+    mutable std::mutex swap_mutex_;
 };
 
 } // namespace voice_transcription
@@ -0,0 +1,68 @@
+#ifndef WAV_FILE_STREAM_H
+#define WAV_FILE_STREAM_H
+
+#include "audio_stream.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace voice_transcription {
+
+// Replays a WAV file through the AudioInputStream interface.
+//
+// 16-bit PCM and 32-bit float files are supported; multi-channel audio is
+// mixed down to mono. In real-time mode each chunk is held back until the
+// moment its last sample would have been captured, so downstream stages see
+// the same pacing as with a microphone, and its capture time follows that
+// schedule. Otherwise chunks are returned as fast as they are read. The last
+// chunk is padded with silence.
+class WavFileStream : public AudioInputStream {
+public:
+    // Throws AudioStreamException if the file cannot be read
+    WavFileStream(const std::string& path, int frames_per_buffer, bool realtime = true);
+
+    bool start() override;
+    void stop() override;
+    bool is_active() const override;
+
+    std::optional<AudioChunk> get_next_chunk(int timeout_ms = 0) override;
+
+    int get_sample_rate() const override { return sample_rate_; }
+    int get_frames_per_buffer() const override { return frames_per_buffer_; }
+    std::string get_last_error() const override { return last_error_; }
+
+    // Recording information
+    const std::string& get_path() const { return path_; }
+    size_t get_sample_count() const { return samples_.size(); }
+    double get_duration_ms() const;
+    bool is_realtime() const { return realtime_; }
+
+    // When start() was called, the capture time of sample 0 in real-time mode
+    std::chrono::steady_clock::time_point get_start_time() const { return start_time_; }
+
+    // Decode a whole file to mono float samples; false with error set on failure
+    static bool read_wav(const std::string& path, std::vector<float>& samples,
+                         int& sample_rate, std::string& error);
+
+    // Write mono float samples as 16-bit PCM
+    static bool write_wav(const std::string& path, const std::vector<float>& samples,
+                          int sample_rate);
+
+private:
+    std::string path_;
+    int frames_per_buffer_;
+    bool realtime_;
+    int sample_rate_ = 0;
+    std::vector<float> samples_;
+    size_t position_ = 0;
+    uint64_t next_sequence_ = 0;
+    bool active_ = false;
+    std::chrono::steady_clock::time_point start_time_;
+    int64_t start_trace_us_ = 0;
+    std::string last_error_;
+};
+
+} // namespace voice_transcription
+
+#endif // WAV_FILE_STREAM_H
\ No newline at end of file
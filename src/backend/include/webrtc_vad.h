@@ -1,6 +1,8 @@
 #ifndef VOICE_TRANSCRIPTION_WEBRTC_VAD_H
 #define VOICE_TRANSCRIPTION_WEBRTC_VAD_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 // Forward declaration to avoid circular includes
@@ -38,6 +40,20 @@ public:
      */
     bool is_speech(const AudioChunk& chunk);
     
+    /**
+     * Classify a whole recording in one pass, for offline decoding
+     * 
+     * @param samples Mono samples in [-1, 1]
+     * @param count Number of samples; a partial frame at the end is ignored
+     * @return One flag per frame, nonzero where speech is detected
+     */
+    std::vector<uint8_t> classify_frames(const float* samples, size_t count);
+    
+    /**
+     * Samples per VAD frame
+     */
+    size_t get_frame_size() const { return temp_buffer_.size(); }
+    
     /**
      * Adjust VAD aggressiveness level
      * 
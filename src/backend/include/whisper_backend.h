@@ -0,0 +1,70 @@
+#ifndef WHISPER_BACKEND_H
+#define WHISPER_BACKEND_H
+
+#include "speech_recognizer.h"
+#include <vector>
+
+struct whisper_context;
+struct whisper_state;
+
+namespace voice_transcription {
+
+// whisper.cpp on the CPU. Compiled only when libs/whisper is present.
+//
+// Whisper decodes whole windows rather than streaming, so the recognizer
+// buffers the current utterance and re-decodes it for a partial once enough
+// new audio has arrived. It has no endpointer of its own: utterances end when
+// the caller asks for the final result, which VoskTranscriber does when the
+// VAD hears the speech end.
+class WhisperSpeechModel : public SpeechModel {
+public:
+    // model_path is a ggml model file; on failure is_loaded() is false and error is set
+    WhisperSpeechModel(const std::string& model_path, std::string& error);
+    ~WhisperSpeechModel() override;
+
+    WhisperSpeechModel(const WhisperSpeechModel&) = delete;
+    WhisperSpeechModel& operator=(const WhisperSpeechModel&) = delete;
+
+    bool is_loaded() const { return context_ != nullptr; }
+
+    // Whisper only decodes 16 kHz audio
+    std::unique_ptr<StreamingRecognizer> create_recognizer(float sample_rate, std::string& error) override;
+    RecognizerCapabilities capabilities() const override;
+
+private:
+    whisper_context* context_;
+};
+
+class WhisperStreamingRecognizer : public StreamingRecognizer {
+public:
+    static constexpr int kSampleRate = 16000;
+    static constexpr size_t kPartialIntervalSamples = kSampleRate;     // Re-decode every second of new audio
+    static constexpr size_t kMaxUtteranceSamples = 30 * kSampleRate;   // Whisper's window
+
+    WhisperStreamingRecognizer(whisper_context* context, whisper_state* state);
+    ~WhisperStreamingRecognizer() override;
+
+    WhisperStreamingRecognizer(const WhisperStreamingRecognizer&) = delete;
+    WhisperStreamingRecognizer& operator=(const WhisperStreamingRecognizer&) = delete;
+
+    bool accept_waveform(const float* samples, size_t count) override;
+    TranscriptionResult partial_result() override;
+    TranscriptionResult result() override;
+    TranscriptionResult final_result() override;
+    void reset() override;
+    RecognizerCapabilities capabilities() const override;
+
+private:
+    // Decode the buffered utterance; false with last_error_ set on failure
+    bool decode(std::string& text, double& confidence);
+
+    whisper_context* context_;
+    whisper_state* state_;
+    std::vector<float> audio_;
+    size_t decoded_samples_ = 0;    // Buffer length at the last partial decode
+    std::string partial_text_;
+};
+
+} // namespace voice_transcription
+
+#endif // WHISPER_BACKEND_H
\ No newline at end of file
@@ -0,0 +1,677 @@
+#include "inverse_text_normalizer.h"
+#include <algorithm>
+#include <cctype>
+#include <limits>
+
+namespace voice_transcription {
+
+// Rule penalties, subtracted from the number of tokens a candidate consumes.
+// A candidate is applied only if its score stays above zero.
+static constexpr float kBareSmallNumberPenalty = 1.0f;  // "one of them", "second place" stay as words
+static constexpr float kYearPenalty = 0.5f;             // "nineteen eighty four" as a year
+static constexpr float kBareTimePenalty = 0.5f;         // "at nine thirty" without am/pm
+
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+InverseTextNormalizer::InverseTextNormalizer() {
+    static const char* digits[] = {
+        "zero", "one", "two", "three", "four", "five", "six", "seven", "eight", "nine"
+    };
+    static const char* teens[] = {
+        "ten", "eleven", "twelve", "thirteen", "fourteen", "fifteen",
+        "sixteen", "seventeen", "eighteen", "nineteen"
+    };
+    static const char* tens[] = {
+        "twenty", "thirty", "forty", "fifty", "sixty", "seventy", "eighty", "ninety"
+    };
+    static const char* digit_ordinals[] = {
+        "first", "second", "third", "fourth", "fifth", "sixth", "seventh", "eighth", "ninth"
+    };
+    static const char* teen_ordinals[] = {
+        "tenth", "eleventh", "twelfth", "thirteenth", "fourteenth", "fifteenth",
+        "sixteenth", "seventeenth", "eighteenth", "nineteenth"
+    };
+    static const char* tens_ordinals[] = {
+        "twentieth", "thirtieth", "fortieth", "fiftieth", "sixtieth", "seventieth", "eightieth", "ninetieth"
+    };
+
+    for (int i = 0; i < 10; i++) {
+        add_word(digits[i], kDigit, i);
+        add_word(teens[i], kTeen, 10 + i);
+    }
+    for (int i = 0; i < 9; i++) {
+        add_word(digit_ordinals[i], kOrdinal, i + 1, std::string(), kDigit);
+    }
+    for (int i = 0; i < 10; i++) {
+        add_word(teen_ordinals[i], kOrdinal, 10 + i, std::string(), kTeen);
+    }
+    for (int i = 0; i < 8; i++) {
+        add_word(tens[i], kTens, 20 + i * 10);
+        add_word(tens_ordinals[i], kOrdinal, 20 + i * 10, std::string(), kTens);
+    }
+
+    add_word("hundred", kHundred, 100);
+    add_word("hundredth", kOrdinal, 100, std::string(), kHundred);
+    add_word("thousand", kScale, 1000LL);
+    add_word("million", kScale, 1000000LL);
+    add_word("billion", kScale, 1000000000LL);
+    add_word("trillion", kScale, 1000000000000LL);
+    add_word("thousandth", kOrdinal, 1000LL, std::string(), kScale);
+    add_word("millionth", kOrdinal, 1000000LL, std::string(), kScale);
+    add_word("billionth", kOrdinal, 1000000000LL, std::string(), kScale);
+
+    add_word("oh", kOh);
+    add_word("point", kPoint);
+    add_word("percent", kPercent);
+    add_word("minus", kMinus);
+    add_word("negative", kMinus);
+    add_word("and", kAnd);
+    add_word("a", kArticle);
+    add_word("the", kThe);
+    add_word("of", kOf);
+
+    add_word("dollar", kCurrency, 0, "$");
+    add_word("dollars", kCurrency, 0, "$");
+    add_word("euro", kCurrency, 0, "\xE2\x82\xAC");
+    add_word("euros", kCurrency, 0, "\xE2\x82\xAC");
+    add_word("cent", kCents);
+    add_word("cents", kCents);
+
+    // Times
+    add_word("o'clock", kOclock);
+    add_word("am", kMeridiem, 0, "AM");
+    add_word("a.m.", kMeridiem, 0, "AM");
+    add_word("pm", kMeridiem, 0, "PM");
+    add_word("p.m.", kMeridiem, 0, "PM");
+    for (const char* word : { "at", "by", "until", "till", "around", "before", "after" }) {
+        add_word(word, kTimeContext);
+    }
+
+    // Dates
+    month_names_ = {
+        "January", "February", "March", "April", "May", "June",
+        "July", "August", "September", "October", "November", "December"
+    };
+    for (size_t i = 0; i < month_names_.size(); i++) {
+        std::string word = month_names_[i];
+        std::transform(word.begin(), word.end(), word.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        uint32_t flags = kMonth;
+        if (word == "may" || word == "march") {
+            flags |= kAmbiguousMonth;
+        }
+        add_word(word, flags, static_cast<int64_t>(i + 1));
+    }
+
+    // Units, longest phrases first within each first word
+    add_unit("kilometers per hour", "km/h");
+    add_unit("kilometres per hour", "km/h");
+    add_unit("miles per hour", "mph");
+    add_unit("degrees celsius", "\xC2\xB0" "C", true);
+    add_unit("degrees fahrenheit", "\xC2\xB0" "F", true);
+    add_unit("degrees", "\xC2\xB0", true);
+    add_unit("degree", "\xC2\xB0", true);
+    for (const char* word : { "kilometers", "kilometer", "kilometres", "kilometre" }) add_unit(word, "km");
+    for (const char* word : { "meters", "meter", "metres", "metre" }) add_unit(word, "m");
+    for (const char* word : { "centimeters", "centimeter", "centimetres", "centimetre" }) add_unit(word, "cm");
+    for (const char* word : { "millimeters", "millimeter", "millimetres", "millimetre" }) add_unit(word, "mm");
+    for (const char* word : { "kilograms", "kilogram" }) add_unit(word, "kg");
+    for (const char* word : { "grams", "gram" }) add_unit(word, "g");
+    for (const char* word : { "milligrams", "milligram" }) add_unit(word, "mg");
+    for (const char* word : { "liters", "liter", "litres", "litre" }) add_unit(word, "L");
+    for (const char* word : { "milliliters", "milliliter", "millilitres", "millilitre" }) add_unit(word, "mL");
+    for (const char* word : { "miles", "mile" }) add_unit(word, "mi");
+    for (const char* word : { "feet", "foot" }) add_unit(word, "ft");
+    for (const char* word : { "inches", "inch" }) add_unit(word, "in");
+    for (const char* word : { "kilobytes", "kilobyte" }) add_unit(word, "KB");
+    for (const char* word : { "megabytes", "megabyte" }) add_unit(word, "MB");
+    for (const char* word : { "gigabytes", "gigabyte" }) add_unit(word, "GB");
+    for (const char* word : { "terabytes", "terabyte" }) add_unit(word, "TB");
+    add_unit("hertz", "Hz");
+    add_unit("kilohertz", "kHz");
+    add_unit("megahertz", "MHz");
+    add_unit("gigahertz", "GHz");
+    for (const char* word : { "milliseconds", "millisecond" }) add_unit(word, "ms");
+}
+
+void InverseTextNormalizer::add_word(const std::string& word, uint32_t flags, int64_t value,
+                                     const std::string& symbol, uint32_t ordinal_flags) {
+    Lexeme& lexeme = lexicon_[word];
+    lexeme.flags |= flags;
+    if (value != 0) {
+        lexeme.value = value;
+    }
+    if (!symbol.empty()) {
+        lexeme.symbol = symbol;
+    }
+    if (ordinal_flags != 0) {
+        lexeme.ordinal_flags = ordinal_flags;
+    }
+}
+
+void InverseTextNormalizer::add_unit(const std::string& phrase, const std::string& symbol, bool attach) {
+    UnitRule rule;
+    size_t pos = 0;
+    while (pos < phrase.size()) {
+        size_t end = phrase.find(' ', pos);
+        if (end == std::string::npos) {
+            end = phrase.size();
+        }
+        rule.words.push_back(phrase.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    rule.symbol = symbol;
+    rule.attach = attach;
+
+    add_word(rule.words.front(), kUnit);
+    units_[rule.words.front()].push_back(std::move(rule));
+}
+
+bool InverseTextNormalizer::has(const std::vector<Token>& tokens, size_t i, uint32_t flags) const {
+    return i < tokens.size() && tokens[i].lexeme && (tokens[i].lexeme->flags & flags);
+}
+
+InverseTextNormalizer::NumberMatch InverseTextNormalizer::match_cardinal(const std::vector<Token>& tokens,
+                                                                         size_t i) const {
+    // States of the number transducer, named after the last token consumed
+    enum class State { Start, Article, Digit, Teen, Tens, Hundred, Scale, And };
+
+    NumberMatch match;
+    State state = State::Start;
+    int64_t total = 0;                  // Completed scale groups
+    int64_t current = 0;                // Group being built, below the last scale
+    int64_t last_scale = std::numeric_limits<int64_t>::max();
+    bool group_has_hundred = false;
+
+    for (size_t j = i; j < tokens.size(); j++) {
+        const Lexeme* lexeme = tokens[j].lexeme;
+        if (!lexeme) {
+            break;
+        }
+
+        const bool ordinal = (lexeme->flags & kOrdinal) != 0;
+        const uint32_t cls = ordinal ? lexeme->ordinal_flags : lexeme->flags;
+        const int64_t value = lexeme->value;
+
+        // Units and tens can only be added while the group's last two digits are empty
+        const bool group_open = state == State::Start || state == State::Hundred ||
+                                state == State::Scale || state == State::And;
+        const bool low_digits_free = current % 100 == 0;
+        const bool has_quantity = state == State::Article || state == State::Digit ||
+                                  state == State::Teen || state == State::Tens;
+
+        if ((cls & kDigit) && ((group_open && low_digits_free) || state == State::Tens)) {
+            current += value;
+            state = State::Digit;
+        } else if ((cls & kTeen) && group_open && low_digits_free) {
+            current += value;
+            state = State::Teen;
+        } else if ((cls & kTens) && group_open && low_digits_free) {
+            current += value;
+            state = State::Tens;
+        } else if ((cls & kHundred) && has_quantity && !group_has_hundred && current > 0 && current < 100) {
+            current *= 100;
+            group_has_hundred = true;
+            state = State::Hundred;
+        } else if ((cls & kScale) && (has_quantity || state == State::Hundred) &&
+                   current > 0 && value < last_scale) {
+            total += current * value;
+            current = 0;
+            last_scale = value;
+            group_has_hundred = false;
+            state = State::Scale;
+        } else if (!ordinal && (lexeme->flags & kAnd) && (state == State::Hundred || state == State::Scale)) {
+            // "one hundred and five"; only kept if a number follows
+            state = State::And;
+            continue;
+        } else if (!ordinal && (lexeme->flags & kArticle) && state == State::Start &&
+                   has(tokens, j + 1, kHundred | kScale)) {
+            // "a hundred", "a thousand"
+            current = 1;
+            state = State::Article;
+            continue;
+        } else {
+            break;
+        }
+
+        match.end = j + 1;
+        match.value = total + current;
+        match.valid = true;
+
+        // An ordinal always ends the number
+        if (ordinal) {
+            match.ordinal = true;
+            break;
+        }
+    }
+
+    return match;
+}
+
+InverseTextNormalizer::NumberMatch InverseTextNormalizer::match_two_digit(const std::vector<Token>& tokens,
+                                                                          size_t i) const {
+    NumberMatch match;
+    if (has(tokens, i, kOrdinal)) {
+        return match;
+    }
+    if (has(tokens, i, kTeen)) {
+        match.value = tokens[i].lexeme->value;
+        match.end = i + 1;
+        match.valid = true;
+    } else if (has(tokens, i, kTens)) {
+        match.value = tokens[i].lexeme->value;
+        match.end = i + 1;
+        match.valid = true;
+        if (has(tokens, i + 1, kDigit) && !has(tokens, i + 1, kOrdinal) && tokens[i + 1].lexeme->value > 0) {
+            match.value += tokens[i + 1].lexeme->value;
+            match.end = i + 2;
+        }
+    }
+    return match;
+}
+
+InverseTextNormalizer::NumberMatch InverseTextNormalizer::match_year(const std::vector<Token>& tokens,
+                                                                     size_t i) const {
+    // Years spoken as two pairs: "nineteen eighty four", "twenty oh five", "twenty twenty"
+    NumberMatch match;
+    NumberMatch century = match_two_digit(tokens, i);
+    if (!century.valid) {
+        return match;
+    }
+
+    size_t j = century.end;
+    if (has(tokens, j, kOh) && has(tokens, j + 1, kDigit) && !has(tokens, j + 1, kOrdinal)) {
+        match.value = century.value * 100 + tokens[j + 1].lexeme->value;
+        match.end = j + 2;
+        match.valid = true;
+        return match;
+    }
+
+    NumberMatch rest = match_two_digit(tokens, j);
+    if (rest.valid) {
+        match.value = century.value * 100 + rest.value;
+        match.end = rest.end;
+        match.valid = true;
+    }
+    return match;
+}
+
+size_t InverseTextNormalizer::match_fraction(const std::vector<Token>& tokens, size_t i, std::string& digits) const {
+    digits.clear();
+    if (!has(tokens, i, kPoint)) {
+        return i;
+    }
+
+    size_t j = i + 1;
+    // "point twenty five" reads the pair as two digits
+    NumberMatch pair = match_two_digit(tokens, j);
+    if (pair.valid) {
+        digits = std::to_string(pair.value);
+        return pair.end;
+    }
+
+    // "point o five", "point three three three"
+    while (j < tokens.size() && tokens[j].lexeme && !has(tokens, j, kOrdinal)) {
+        if (has(tokens, j, kOh)) {
+            digits.push_back('0');
+        } else if (has(tokens, j, kDigit)) {
+            digits.push_back(static_cast<char>('0' + tokens[j].lexeme->value));
+        } else {
+            break;
+        }
+        j++;
+    }
+    return digits.empty() ? i : j;
+}
+
+size_t InverseTextNormalizer::match_meridiem(const std::vector<Token>& tokens, size_t i, std::string& text) const {
+    if (has(tokens, i, kMeridiem)) {
+        text = tokens[i].lexeme->symbol;
+        return i + 1;
+    }
+    // Recognizers often split "a m" / "p m"
+    if (i + 1 < tokens.size() && tokens[i + 1].lowered == "m") {
+        if (tokens[i].lowered == "a") {
+            text = "AM";
+            return i + 2;
+        }
+        if (tokens[i].lowered == "p") {
+            text = "PM";
+            return i + 2;
+        }
+    }
+    return i;
+}
+
+const InverseTextNormalizer::UnitRule* InverseTextNormalizer::match_unit(const std::vector<Token>& tokens,
+                                                                         size_t i, size_t& end) const {
+    if (!has(tokens, i, kUnit)) {
+        return nullptr;
+    }
+    auto it = units_.find(tokens[i].lowered);
+    if (it == units_.end()) {
+        return nullptr;
+    }
+
+    for (const UnitRule& rule : it->second) {
+        if (i + rule.words.size() > tokens.size()) {
+            continue;
+        }
+        bool matched = true;
+        for (size_t k = 1; k < rule.words.size() && matched; k++) {
+            matched = tokens[i + k].lowered == rule.words[k];
+        }
+        if (matched) {
+            end = i + rule.words.size();
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+InverseTextNormalizer::Candidate InverseTextNormalizer::match_number_expression(const std::vector<Token>& tokens,
+                                                                               size_t i) const {
+    Candidate candidate;
+    size_t j = i;
+
+    bool negative = false;
+    if (has(tokens, j, kMinus)) {
+        negative = true;
+        j++;
+    }
+
+    NumberMatch number = match_cardinal(tokens, j);
+    NumberMatch year = match_year(tokens, j);
+
+    std::string text;
+    bool is_year = false;
+    int64_t value = 0;
+    if (year.valid && (!number.valid || year.end > number.end)) {
+        text = std::to_string(year.value);
+        value = year.value;
+        is_year = true;
+        j = year.end;
+    } else if (number.valid) {
+        value = number.value;
+        j = number.end;
+        if (number.ordinal) {
+            candidate.end = j;
+            candidate.output = (negative ? "-" : "") + format_ordinal(value);
+            candidate.score = static_cast<float>(j - i);
+            if (j - i == 1 && value < 10) {
+                candidate.score -= kBareSmallNumberPenalty;
+            }
+            return candidate;
+        }
+        text = format_cardinal(value);
+    } else if (!has(tokens, j, kPoint)) {
+        return candidate;
+    }
+
+    // Decimal part; "point five" on its own reads as 0.5
+    std::string digits;
+    size_t fraction_end = match_fraction(tokens, j, digits);
+    bool is_decimal = fraction_end > j;
+    if (is_decimal) {
+        text = (text.empty() ? "0" : text) + "." + digits;
+        j = fraction_end;
+        // "two point four billion" keeps the scale as a word
+        if (has(tokens, j, kScale) && !has(tokens, j, kOrdinal)) {
+            text += " " + tokens[j].lowered;
+            j++;
+        }
+    } else if (text.empty()) {
+        return candidate;
+    }
+
+    const std::string sign = negative ? "-" : "";
+    bool has_suffix = true;
+    size_t unit_end = 0;
+
+    if (has(tokens, j, kPercent)) {
+        text = sign + text + "%";
+        j++;
+    } else if (has(tokens, j, kCurrency)) {
+        const std::string& symbol = tokens[j].lexeme->symbol;
+        std::string amount = text;
+        j++;
+        // "five dollars and twenty cents"
+        if (!is_decimal && has(tokens, j, kAnd)) {
+            NumberMatch cents = match_cardinal(tokens, j + 1);
+            if (cents.valid && !cents.ordinal && cents.value < 100 && has(tokens, cents.end, kCents)) {
+                amount += cents.value < 10 ? ".0" : ".";
+                amount += std::to_string(cents.value);
+                j = cents.end + 1;
+            }
+        }
+        text = sign + symbol + amount;
+    } else if (!is_decimal && has(tokens, j, kCents)) {
+        text = sign + text + "\xC2\xA2";
+        j++;
+    } else if (const UnitRule* unit = match_unit(tokens, j, unit_end)) {
+        text = sign + text + (unit->attach ? "" : " ") + unit->symbol;
+        j = unit_end;
+    } else {
+        text = sign + text;
+        has_suffix = false;
+    }
+
+    candidate.end = j;
+    candidate.output = text;
+    candidate.score = static_cast<float>(j - i);
+    if (!has_suffix && !is_decimal) {
+        if (is_year) {
+            candidate.score -= kYearPenalty;
+        } else if (j - i == 1 && value < 10) {
+            candidate.score -= kBareSmallNumberPenalty;
+        }
+    }
+    return candidate;
+}
+
+InverseTextNormalizer::Candidate InverseTextNormalizer::match_time(const std::vector<Token>& tokens,
+                                                                  size_t i) const {
+    Candidate candidate;
+    if (!has(tokens, i, kDigit | kTeen) || has(tokens, i, kOrdinal)) {
+        return candidate;
+    }
+    int64_t hour = tokens[i].lexeme->value;
+    if (hour < 1 || hour > 12) {
+        return candidate;
+    }
+
+    size_t j = i + 1;
+    std::string minutes;
+    bool oclock = false;
+    if (has(tokens, j, kOclock)) {
+        minutes = ":00";
+        oclock = true;
+        j++;
+    } else if (has(tokens, j, kOh) && has(tokens, j + 1, kDigit) && !has(tokens, j + 1, kOrdinal)) {
+        minutes = ":0" + std::to_string(tokens[j + 1].lexeme->value);
+        j += 2;
+    } else {
+        NumberMatch pair = match_two_digit(tokens, j);
+        if (pair.valid && pair.value >= 10 && pair.value < 60) {
+            minutes = ":" + std::to_string(pair.value);
+            j = pair.end;
+        }
+    }
+
+    std::string meridiem;
+    j = match_meridiem(tokens, j, meridiem);
+
+    // A bare "nine thirty" is only a time after "at", "by" and similar
+    bool context = i > 0 && has(tokens, i - 1, kTimeContext) && !minutes.empty();
+    if (!oclock && meridiem.empty() && !context) {
+        return candidate;
+    }
+
+    candidate.end = j;
+    candidate.output = std::to_string(hour) + minutes + (meridiem.empty() ? "" : " " + meridiem);
+    candidate.score = static_cast<float>(j - i);
+    if (!oclock && meridiem.empty()) {
+        candidate.score -= kBareTimePenalty;
+    }
+    return candidate;
+}
+
+InverseTextNormalizer::Candidate InverseTextNormalizer::match_date(const std::vector<Token>& tokens,
+                                                                  size_t i) const {
+    Candidate candidate;
+    size_t month_index;
+    NumberMatch day;
+    size_t j;
+
+    if (has(tokens, i, kMonth)) {
+        // "march fifth", "june twenty first twenty twenty four"
+        month_index = i;
+        day = match_cardinal(tokens, i + 1);
+        j = day.end;
+    } else {
+        // "the fifth of march"
+        size_t k = has(tokens, i, kThe) ? i + 1 : i;
+        day = match_cardinal(tokens, k);
+        if (!day.valid || !day.ordinal || !has(tokens, day.end, kOf) || !has(tokens, day.end + 1, kMonth)) {
+            return candidate;
+        }
+        month_index = day.end + 1;
+        j = month_index + 1;
+    }
+
+    if (!day.valid || day.value < 1 || day.value > 31) {
+        return candidate;
+    }
+
+    // Days in each month, allowing February 29. An impossible date such as
+    // "february thirtieth" stays as words rather than becoming "february 30th".
+    static const int kDaysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (day.value > kDaysInMonth[tokens[month_index].lexeme->value - 1]) {
+        candidate.end = j;
+        candidate.score = static_cast<float>(j - i);
+        candidate.keep_words = true;
+        return candidate;
+    }
+
+    // Optional year: "twenty twenty four" or "two thousand twenty four"
+    std::string year_text;
+    NumberMatch year = match_year(tokens, j);
+    NumberMatch cardinal_year = match_cardinal(tokens, j);
+    if (cardinal_year.valid && !cardinal_year.ordinal && cardinal_year.value >= 1000 && cardinal_year.value < 3000 &&
+        (!year.valid || cardinal_year.end >= year.end)) {
+        year = cardinal_year;
+    }
+    if (year.valid && year.value >= 1000) {
+        year_text = ", " + std::to_string(year.value);
+        j = year.end;
+    }
+
+    // "may five" and "march ten" are too likely to be ordinary words
+    if (has(tokens, month_index, kAmbiguousMonth) && !day.ordinal && year_text.empty()) {
+        return candidate;
+    }
+
+    candidate.end = j;
+    candidate.output = month_names_[tokens[month_index].lexeme->value - 1] + " " +
+                       std::to_string(day.value) + year_text;
+    candidate.score = static_cast<float>(j - i);
+    return candidate;
+}
+
+std::string InverseTextNormalizer::format_cardinal(int64_t value) {
+    std::string digits = std::to_string(value);
+    // Group thousands from five digits up; four-digit numbers are often years
+    if (digits.size() < 5) {
+        return digits;
+    }
+    std::string grouped;
+    grouped.reserve(digits.size() + digits.size() / 3);
+    for (size_t i = 0; i < digits.size(); i++) {
+        if (i > 0 && (digits.size() - i) % 3 == 0) {
+            grouped.push_back(',');
+        }
+        grouped.push_back(digits[i]);
+    }
+    return grouped;
+}
+
+std::string InverseTextNormalizer::format_ordinal(int64_t value) {
+    const char* suffix = "th";
+    int64_t last_two = value % 100;
+    if (last_two < 11 || last_two > 13) {
+        switch (value % 10) {
+            case 1: suffix = "st"; break;
+            case 2: suffix = "nd"; break;
+            case 3: suffix = "rd"; break;
+            default: break;
+        }
+    }
+    return format_cardinal(value) + suffix;
+}
+
+std::string InverseTextNormalizer::normalize(const std::string& text) const {
+    // Tokenize on whitespace and attach lexicon entries
+    std::vector<Token> tokens;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && is_space(text[pos])) {
+            pos++;
+        }
+        size_t begin = pos;
+        while (pos < text.size() && !is_space(text[pos])) {
+            pos++;
+        }
+        if (pos > begin) {
+            Token token;
+            token.begin = begin;
+            token.length = pos - begin;
+            token.lowered.reserve(token.length);
+            for (size_t k = begin; k < pos; k++) {
+                token.lowered.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(text[k]))));
+            }
+            auto it = lexicon_.find(token.lowered);
+            token.lexeme = it != lexicon_.end() ? &it->second : nullptr;
+            tokens.push_back(std::move(token));
+        }
+    }
+
+    std::string output;
+    output.reserve(text.size());
+    auto append = [&output](const char* data, size_t length) {
+        if (!output.empty()) {
+            output.push_back(' ');
+        }
+        output.append(data, length);
+    };
+
+    size_t i = 0;
+    while (i < tokens.size()) {
+        Candidate best;
+        if (tokens[i].lexeme) {
+            for (Candidate candidate : { match_time(tokens, i), match_date(tokens, i),
+                                         match_number_expression(tokens, i) }) {
+                if (candidate.end > i && candidate.score > best.score) {
+                    best = std::move(candidate);
+                }
+            }
+        }
+
+        if (best.score > 0.0f && best.keep_words) {
+            for (; i < best.end; i++) {
+                append(text.data() + tokens[i].begin, tokens[i].length);
+            }
+        } else if (best.score > 0.0f) {
+            append(best.output.data(), best.output.size());
+            i = best.end;
+        } else {
+            append(text.data() + tokens[i].begin, tokens[i].length);
+            i++;
+        }
+    }
+
+    return output;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
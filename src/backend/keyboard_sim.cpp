@@ -1,4 +1,5 @@
 #include "keyboard_sim.h"
+#include "keystroke_tokenizer.h"
 #include <unordered_map>
 #include <thread>
 #include <chrono>
@@ -102,40 +103,11 @@ bool KeyboardSimulator::simulate_keypresses(const std::wstring& text, int delay_
     }
     
     // Process special key sequences like {ENTER}, {CTRL+ENTER}, etc.
-    std::wregex special_key_regex(L"\\{([^}]+)\\}");
-    std::wregex modifier_key_regex(L"([A-Za-z]+)\\+([A-Za-z]+)");
-    
-    size_t pos = 0;
-    while (pos < text.length()) {
-        // Check for special key sequence
-        std::wsmatch match;
-        if (std::regex_search(text.begin() + pos, text.end(), match, special_key_regex)) {
-            // Send text before the special key
-            if (match.position() > 0) {
-                std::wstring prefix = text.substr(pos, match.position());
-                for (wchar_t c : prefix) {
-                    if (!send_unicode_character(c)) {
-                        return false;
-                    }
-                    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-                }
-            }
-            
-            // Process the special key
-            std::wstring key_command = match.str(1);
-            bool success = simulate_special_key(key_command);
-            if (!success) {
-                return false;
-            }
-            
-            // Skip past the special key
-            pos += match.position() + match.length();
-        } else {
-            // No special key, just send the character
-            if (!send_unicode_character(text[pos])) {
-                return false;
-            }
-            pos++;
+    for (const auto& token : tokenize_keystrokes(text)) {
+        bool success = token.kind == KeystrokeToken::Kind::SpecialKey ?
+            simulate_special_key(token.command) : send_unicode_character(token.character);
+        if (!success) {
+            return false;
         }
         
         std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
@@ -0,0 +1,27 @@
+#include "keystroke_tokenizer.h"
+
+namespace voice_transcription {
+
+std::vector<KeystrokeToken> tokenize_keystrokes(const std::wstring& text) {
+    std::vector<KeystrokeToken> tokens;
+    tokens.reserve(text.size());
+
+    size_t pos = 0;
+    while (pos < text.size()) {
+        if (text[pos] == L'{') {
+            // Need at least one character before the closing brace
+            size_t close = text.find(L'}', pos + 1);
+            if (close != std::wstring::npos && close > pos + 1) {
+                tokens.push_back({KeystrokeToken::Kind::SpecialKey, L'\0', text.substr(pos + 1, close - pos - 1)});
+                pos = close + 1;
+                continue;
+            }
+        }
+        tokens.push_back({KeystrokeToken::Kind::Character, text[pos], std::wstring()});
+        pos++;
+    }
+
+    return tokens;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,440 @@
+#include "keyword_spotter.h"
+#include "audio_stream.h"
+#include "metrics.h"
+#include "trace_recorder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace voice_transcription {
+
+static const double kPi = 3.14159265358979323846;
+static const size_t kMelBands = 24;
+static const float kMinFrequency = 60.0f;
+static const float kMaxFrequency = 7600.0f;
+static const float kPreEmphasis = 0.97f;
+static const size_t kMinTemplateFrames = 10;    // 100 ms
+static const size_t kMaxTemplateFrames = 300;   // 3 s
+static const int kMinFollowUpSpeechMs = 200;    // Speech after a wake that makes it a real one
+static const char kTemplateMagic[4] = { 'K', 'W', 'S', '1' };
+
+static float hz_to_mel(float hz) {
+    return 2595.0f * std::log10(1.0f + hz / 700.0f);
+}
+
+static float mel_to_hz(float mel) {
+    return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+KeywordSpotter::KeywordSpotter(const KeywordSpotterConfig& config)
+    : config_(config),
+      mel_bands_(kMelBands),
+      best_score_(std::numeric_limits<float>::infinity()) {
+    if (config_.sample_rate <= 0) {
+        config_.sample_rate = 16000;
+    }
+    // 25 ms Hamming frames every 10 ms
+    frame_length_ = static_cast<size_t>(config_.sample_rate) * 25 / 1000;
+    hop_length_ = static_cast<size_t>(config_.sample_rate) / 100;
+    fft_size_ = 1;
+    while (fft_size_ < frame_length_) {
+        fft_size_ <<= 1;
+    }
+
+    window_.resize(frame_length_);
+    for (size_t i = 0; i < frame_length_; i++) {
+        window_[i] = static_cast<float>(0.54 - 0.46 * std::cos(2.0 * kPi * i / (frame_length_ - 1)));
+    }
+
+    size_t bins = fft_size_ / 2 + 1;
+    float bin_hz = static_cast<float>(config_.sample_rate) / fft_size_;
+    float low = hz_to_mel(kMinFrequency);
+    float high = hz_to_mel(std::min(kMaxFrequency, config_.sample_rate / 2.0f));
+    mel_weights_.assign(mel_bands_ * bins, 0.0f);
+    for (size_t band = 0; band < mel_bands_; band++) {
+        float left = mel_to_hz(low + (high - low) * band / (mel_bands_ + 1));
+        float center = mel_to_hz(low + (high - low) * (band + 1) / (mel_bands_ + 1));
+        float right = mel_to_hz(low + (high - low) * (band + 2) / (mel_bands_ + 1));
+        for (size_t bin = 0; bin < bins; bin++) {
+            float hz = bin * bin_hz;
+            float weight = 0.0f;
+            if (hz > left && hz <= center) {
+                weight = (hz - left) / (center - left);
+            } else if (hz > center && hz < right) {
+                weight = (right - hz) / (right - center);
+            }
+            mel_weights_[band * bins + bin] = weight;
+        }
+    }
+
+    // Orthonormal DCT-II without c0, so the features ignore the input level
+    dct_.resize(kCoefficients * mel_bands_);
+    for (size_t k = 0; k < kCoefficients; k++) {
+        for (size_t band = 0; band < mel_bands_; band++) {
+            dct_[k * mel_bands_ + band] = static_cast<float>(
+                std::sqrt(2.0 / mel_bands_) * std::cos(kPi * (k + 1) * (band + 0.5) / mel_bands_));
+        }
+    }
+
+    twiddle_cos_.resize(fft_size_ / 2);
+    twiddle_sin_.resize(fft_size_ / 2);
+    for (size_t i = 0; i < fft_size_ / 2; i++) {
+        twiddle_cos_[i] = static_cast<float>(std::cos(2.0 * kPi * i / fft_size_));
+        twiddle_sin_[i] = static_cast<float>(-std::sin(2.0 * kPi * i / fft_size_));
+    }
+    bit_reverse_.resize(fft_size_);
+    size_t bits = 0;
+    while ((size_t(1) << bits) < fft_size_) {
+        bits++;
+    }
+    for (size_t i = 0; i < fft_size_; i++) {
+        uint32_t reversed = 0;
+        for (size_t b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        bit_reverse_[i] = reversed;
+    }
+    real_.resize(fft_size_);
+    imag_.resize(fft_size_);
+    bands_.resize(mel_bands_);
+}
+
+void KeywordSpotter::compute_frame(const float* frame, float* coefficients) const {
+    std::fill(real_.begin(), real_.end(), 0.0f);
+    std::fill(imag_.begin(), imag_.end(), 0.0f);
+    float previous = frame[0];
+    for (size_t i = 0; i < frame_length_; i++) {
+        real_[bit_reverse_[i]] = (frame[i] - kPreEmphasis * previous) * window_[i];
+        previous = frame[i];
+    }
+
+    // Iterative radix-2 FFT on the bit-reversed input
+    for (size_t span = 1; span < fft_size_; span <<= 1) {
+        size_t stride = fft_size_ / (span * 2);
+        for (size_t group = 0; group < fft_size_; group += span * 2) {
+            for (size_t k = 0; k < span; k++) {
+                float wr = twiddle_cos_[k * stride];
+                float wi = twiddle_sin_[k * stride];
+                size_t a = group + k;
+                size_t b = a + span;
+                float tr = real_[b] * wr - imag_[b] * wi;
+                float ti = real_[b] * wi + imag_[b] * wr;
+                real_[b] = real_[a] - tr;
+                imag_[b] = imag_[a] - ti;
+                real_[a] += tr;
+                imag_[a] += ti;
+            }
+        }
+    }
+
+    size_t bins = fft_size_ / 2 + 1;
+    for (size_t band = 0; band < mel_bands_; band++) {
+        const float* weights = &mel_weights_[band * bins];
+        float energy = 0.0f;
+        for (size_t bin = 0; bin < bins; bin++) {
+            if (weights[bin] > 0.0f) {
+                energy += weights[bin] * (real_[bin] * real_[bin] + imag_[bin] * imag_[bin]);
+            }
+        }
+        bands_[band] = std::log(energy + 1e-10f);
+    }
+
+    for (size_t k = 0; k < kCoefficients; k++) {
+        const float* basis = &dct_[k * mel_bands_];
+        float value = 0.0f;
+        for (size_t band = 0; band < mel_bands_; band++) {
+            value += basis[band] * bands_[band];
+        }
+        coefficients[k] = value;
+    }
+}
+
+std::vector<float> KeywordSpotter::extract_features(const float* samples, size_t count) const {
+    std::vector<float> features;
+    if (count < frame_length_) {
+        return features;
+    }
+    size_t frames = (count - frame_length_) / hop_length_ + 1;
+    features.resize(frames * kCoefficients);
+    for (size_t f = 0; f < frames; f++) {
+        compute_frame(samples + f * hop_length_, &features[f * kCoefficients]);
+    }
+    return features;
+}
+
+bool KeywordSpotter::enroll(const float* samples, size_t count, std::string& error) {
+    // Trim quiet to the first and last 10 ms block within 20 dB of the loudest
+    std::vector<float> levels;
+    for (size_t at = 0; at + hop_length_ <= count; at += hop_length_) {
+        float energy = 0.0f;
+        for (size_t i = at; i < at + hop_length_; i++) {
+            energy += samples[i] * samples[i];
+        }
+        levels.push_back(energy / hop_length_);
+    }
+    float loudest = levels.empty() ? 0.0f : *std::max_element(levels.begin(), levels.end());
+    if (loudest < 1e-8f) {
+        error = "Wake phrase recording is silent";
+        return false;
+    }
+    size_t first = 0;
+    while (levels[first] < loudest * 0.01f) {
+        first++;
+    }
+    size_t last = levels.size() - 1;
+    while (levels[last] < loudest * 0.01f) {
+        last--;
+    }
+    size_t begin = first * hop_length_;
+    size_t end = std::min(count, (last + 1) * hop_length_ + frame_length_);
+    return add_template(extract_features(samples + begin, end - begin), error);
+}
+
+bool KeywordSpotter::add_template(std::vector<float> features, std::string& error) {
+    size_t frames = features.size() / kCoefficients;
+    if (frames < kMinTemplateFrames) {
+        error = "Wake phrase recording is too short";
+        return false;
+    }
+    if (frames > kMaxTemplateFrames) {
+        error = "Wake phrase recording is longer than 3 seconds";
+        return false;
+    }
+    templates_.push_back({ std::move(features), frames });
+    matches_.emplace_back();
+    restart_matching();
+    return true;
+}
+
+void KeywordSpotter::clear_templates() {
+    templates_.clear();
+    matches_.clear();
+    restart_matching();
+}
+
+bool KeywordSpotter::load_templates(const std::string& path, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "Cannot open wake phrase file: " + path;
+        return false;
+    }
+    char magic[4];
+    uint32_t sample_rate = 0;
+    uint32_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&sample_rate), sizeof(sample_rate));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || std::memcmp(magic, kTemplateMagic, sizeof(magic)) != 0) {
+        error = "Not a wake phrase file: " + path;
+        return false;
+    }
+    if (sample_rate != static_cast<uint32_t>(config_.sample_rate)) {
+        error = "Wake phrase was enrolled at " + std::to_string(sample_rate) + " Hz, not " +
+                std::to_string(config_.sample_rate) + " Hz";
+        return false;
+    }
+
+    std::vector<std::vector<float>> loaded;
+    for (uint32_t t = 0; t < count; t++) {
+        uint32_t frames = 0;
+        in.read(reinterpret_cast<char*>(&frames), sizeof(frames));
+        if (!in || frames < kMinTemplateFrames || frames > kMaxTemplateFrames) {
+            error = "Wake phrase file is damaged: " + path;
+            return false;
+        }
+        std::vector<float> features(frames * kCoefficients);
+        in.read(reinterpret_cast<char*>(features.data()), features.size() * sizeof(float));
+        if (!in) {
+            error = "Wake phrase file is damaged: " + path;
+            return false;
+        }
+        loaded.push_back(std::move(features));
+    }
+
+    clear_templates();
+    for (std::vector<float>& features : loaded) {
+        add_template(std::move(features), error);
+    }
+    return true;
+}
+
+bool KeywordSpotter::save_templates(const std::string& path, std::string& error) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    uint32_t sample_rate = static_cast<uint32_t>(config_.sample_rate);
+    uint32_t count = static_cast<uint32_t>(templates_.size());
+    out.write(kTemplateMagic, sizeof(kTemplateMagic));
+    out.write(reinterpret_cast<const char*>(&sample_rate), sizeof(sample_rate));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    for (const Template& keyword : templates_) {
+        uint32_t frames = static_cast<uint32_t>(keyword.frames);
+        out.write(reinterpret_cast<const char*>(&frames), sizeof(frames));
+        out.write(reinterpret_cast<const char*>(keyword.features.data()),
+                  keyword.features.size() * sizeof(float));
+    }
+    if (!out) {
+        error = "Cannot write wake phrase file: " + path;
+        return false;
+    }
+    return true;
+}
+
+void KeywordSpotter::restart_matching() {
+    const float unreachable = std::numeric_limits<float>::infinity();
+    for (size_t t = 0; t < templates_.size(); t++) {
+        Match& match = matches_[t];
+        match.cost.assign(templates_[t].frames, unreachable);
+        match.start.assign(templates_[t].frames, 0);
+        match.next_cost.assign(templates_[t].frames, unreachable);
+        match.next_start.assign(templates_[t].frames, 0);
+    }
+    pending_.clear();
+    frame_index_ = 0;
+    gap_ms_ = 0;
+}
+
+bool KeywordSpotter::add_frame(const float* coefficients) {
+    const float unreachable = std::numeric_limits<float>::infinity();
+    uint32_t now = frame_index_++;
+    bool matched = false;
+
+    for (size_t t = 0; t < templates_.size(); t++) {
+        const Template& keyword = templates_[t];
+        Match& match = matches_[t];
+        // Paths cost their mean distance per input frame, so their lengths compare fairly
+        auto mean = [&](size_t j) {
+            return match.cost[j] / static_cast<float>(now - match.start[j]);
+        };
+
+        for (size_t j = 0; j < keyword.frames; j++) {
+            const float* reference = &keyword.features[j * kCoefficients];
+            float distance = 0.0f;
+            for (size_t k = 0; k < kCoefficients; k++) {
+                float d = coefficients[k] - reference[k];
+                distance += d * d;
+            }
+            distance = std::sqrt(distance);
+
+            // Every input frame advances the template by 0, 1 or 2 frames;
+            // the phrase may begin on any frame
+            float best_cost = j == 0 ? 0.0f : unreachable;
+            uint32_t best_start = now;
+            float best_mean = j == 0 ? 0.0f : unreachable;
+            for (size_t step = 0; step <= 2 && step <= j; step++) {
+                size_t from = j - step;
+                if (match.cost[from] == unreachable) {
+                    continue;
+                }
+                float candidate = mean(from);
+                if (candidate < best_mean) {
+                    best_mean = candidate;
+                    best_cost = match.cost[from];
+                    best_start = match.start[from];
+                }
+            }
+
+            // Drop paths stretched past twice the template's length
+            if (best_cost == unreachable || now - best_start >= 2 * keyword.frames) {
+                match.next_cost[j] = unreachable;
+                continue;
+            }
+            match.next_cost[j] = best_cost + distance;
+            match.next_start[j] = best_start;
+        }
+        std::swap(match.cost, match.next_cost);
+        std::swap(match.start, match.next_start);
+
+        size_t last = keyword.frames - 1;
+        if (match.cost[last] != unreachable) {
+            float score = match.cost[last] / static_cast<float>(now + 1 - match.start[last]);
+            best_score_ = std::min(best_score_, score);
+            if (score <= config_.threshold) {
+                matched = true;
+            }
+        }
+    }
+    return matched;
+}
+
+bool KeywordSpotter::process(const AudioChunk& chunk, bool is_speech) {
+    ScopedTimer timer(Stage::KeywordSpotting);
+    int chunk_ms = static_cast<int>(chunk.size() * 1000 / config_.sample_rate);
+
+    if (state_ == State::Awake) {
+        if (is_speech) {
+            silence_ms_ = 0;
+            speech_ms_since_wake_ += chunk_ms;
+            return true;
+        }
+        silence_ms_ += chunk_ms;
+        if (silence_ms_ >= config_.awake_ms) {
+            if (speech_ms_since_wake_ < kMinFollowUpSpeechMs) {
+                report_false_accept();
+            }
+            sleep();
+            return false;
+        }
+        return true;
+    }
+
+    if (templates_.empty()) {
+        return false;
+    }
+    if (!is_speech) {
+        gap_ms_ += chunk_ms;
+        if (gap_ms_ > config_.max_gap_ms) {
+            restart_matching();
+        }
+        return false;
+    }
+    gap_ms_ = 0;
+
+    size_t carried = pending_.size();
+    pending_.insert(pending_.end(), chunk.data(), chunk.data() + chunk.size());
+    float coefficients[kCoefficients];
+    size_t at = 0;
+    for (; at + frame_length_ <= pending_.size(); at += hop_length_) {
+        compute_frame(&pending_[at], coefficients);
+        if (!add_frame(coefficients)) {
+            continue;
+        }
+
+        // The phrase ended with this frame; time the wake from its capture
+        if (chunk.capture_time_us() != 0) {
+            size_t end_in_chunk = at + frame_length_ > carried ? at + frame_length_ - carried : 0;
+            int64_t end_us = chunk.capture_time_us() +
+                             static_cast<int64_t>(end_in_chunk * 1000000 / config_.sample_rate);
+            int64_t latency_us = std::max<int64_t>(0, trace_clock_us() - end_us);
+            MetricsRegistry::instance().record_latency(Stage::WakeLatency,
+                                                       static_cast<uint64_t>(latency_us) * 1000);
+        }
+        MetricsRegistry::instance().increment(Counter::KeywordWakes);
+        wake();
+        return false;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + at);
+    return false;
+}
+
+void KeywordSpotter::wake() {
+    state_ = State::Awake;
+    silence_ms_ = 0;
+    speech_ms_since_wake_ = 0;
+    restart_matching();
+}
+
+void KeywordSpotter::sleep() {
+    state_ = State::Listening;
+    restart_matching();
+}
+
+void KeywordSpotter::report_false_accept() {
+    MetricsRegistry::instance().increment(Counter::KeywordFalseAccepts);
+}
+
+void KeywordSpotter::reset_best_score() {
+    best_score_ = std::numeric_limits<float>::infinity();
+}
+
+} // namespace voice_transcription
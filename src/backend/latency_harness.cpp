@@ -0,0 +1,448 @@
+#include "latency_harness.h"
+#include "endpointer.h"
+#include "json_escape.h"
+#include "vosk_transcription_engine.h"
+#include "wav_file_stream.h"
+#include "webrtc_vad.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace voice_transcription {
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+static bool is_absolute_path(const std::string& path) {
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+}
+
+bool load_latency_corpus(const std::string& manifest_path,
+                         std::vector<LabeledRecording>& corpus, std::string& error) {
+    std::ifstream file(manifest_path);
+    if (!file.is_open()) {
+        error = "Cannot open corpus manifest: " + manifest_path;
+        return false;
+    }
+    size_t slash = manifest_path.find_last_of("/\\");
+    std::string base = slash == std::string::npos ? "" : manifest_path.substr(0, slash + 1);
+
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 3) {
+            error = manifest_path + ":" + std::to_string(line_number) + ": expected wav, start_ms, end_ms, text";
+            return false;
+        }
+
+        LabeledUtterance utterance;
+        try {
+            utterance.start_ms = std::stod(fields[1]);
+            utterance.end_ms = std::stod(fields[2]);
+        } catch (const std::exception&) {
+            error = manifest_path + ":" + std::to_string(line_number) + ": invalid time";
+            return false;
+        }
+        if (fields.size() > 3) {
+            utterance.text = fields[3];
+        }
+
+        std::string path = is_absolute_path(fields[0]) ? fields[0] : base + fields[0];
+        if (corpus.empty() || corpus.back().path != path) {
+            corpus.push_back(LabeledRecording{path, {}});
+        }
+        corpus.back().utterances.push_back(utterance);
+    }
+
+    // Attribution of results relies on utterances being in time order
+    for (auto& recording : corpus) {
+        std::sort(recording.utterances.begin(), recording.utterances.end(),
+                  [](const LabeledUtterance& a, const LabeledUtterance& b) { return a.start_ms < b.start_ms; });
+    }
+    return true;
+}
+
+// Lowercase words with punctuation stripped, so "Hello," matches "hello"
+static std::vector<std::string> normalized_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::string word;
+    for (char c : text + " ") {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (std::isspace(u)) {
+            if (!word.empty()) {
+                words.push_back(word);
+                word.clear();
+            }
+        } else if (std::isalnum(u) || c == '\'' || u >= 0x80) {
+            word += static_cast<char>(std::tolower(u));
+        }
+    }
+    return words;
+}
+
+size_t LatencyHarness::word_errors(const std::string& reference, const std::string& hypothesis,
+                                   size_t* reference_words) {
+    std::vector<std::string> ref = normalized_words(reference);
+    std::vector<std::string> hyp = normalized_words(hypothesis);
+    if (reference_words) {
+        *reference_words = ref.size();
+    }
+
+    // Two-row Levenshtein distance over words
+    std::vector<size_t> previous(hyp.size() + 1);
+    std::vector<size_t> current(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); j++) {
+        previous[j] = j;
+    }
+    for (size_t i = 1; i <= ref.size(); i++) {
+        current[0] = i;
+        for (size_t j = 1; j <= hyp.size(); j++) {
+            size_t substitution = previous[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            current[j] = std::min({ substitution, previous[j] + 1, current[j - 1] + 1 });
+        }
+        std::swap(previous, current);
+    }
+    return previous[hyp.size()];
+}
+
+LatencyHarness::LatencyHarness(const LatencyHarnessConfig& config)
+    : config_(config) {
+}
+
+LatencyHarness::~LatencyHarness() = default;
+
+bool LatencyHarness::ensure_transcriber(int sample_rate) {
+    if (transcriber_ && sample_rate == sample_rate_) {
+        return true;
+    }
+    if (sample_rate <= 0) {
+        last_error_ = "Invalid sample rate";
+        return false;
+    }
+
+    // The VAD looks at one 10, 20 or 30 ms frame at the start of each chunk
+    int chunk_ms = config_.frames_per_buffer * 1000 / sample_rate;
+    int vad_frame_ms = chunk_ms >= 30 ? 30 : (chunk_ms >= 20 ? 20 : 10);
+    vad_ = std::make_unique<VADHandler>(sample_rate, vad_frame_ms, config_.vad_aggressiveness);
+
+    transcriber_ = std::make_unique<VoskTranscriber>(config_.model_path, static_cast<float>(sample_rate),
+                                                     config_.engine);
+    auto deadline = Clock::now() + std::chrono::milliseconds(config_.model_load_timeout_ms);
+    while (transcriber_->is_loading() && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!transcriber_->is_model_loaded()) {
+        last_error_ = transcriber_->is_loading() ? "Timed out loading model: " + config_.model_path
+                                                 : transcriber_->get_last_error();
+        transcriber_.reset();
+        return false;
+    }
+    sample_rate_ = sample_rate;
+    return true;
+}
+
+bool LatencyHarness::run(const std::vector<LabeledRecording>& corpus, LatencyReport& report) {
+    report.config = config_;
+    for (const auto& recording : corpus) {
+        try {
+            WavFileStream stream(recording.path, config_.frames_per_buffer, config_.realtime);
+            if (!run_stream(stream, recording, report)) {
+                return false;
+            }
+        } catch (const AudioStreamException& e) {
+            last_error_ = e.what();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LatencyHarness::run_stream(AudioInputStream& stream, const LabeledRecording& labels, LatencyReport& report) {
+    const int sample_rate = stream.get_sample_rate();
+    const int frames = stream.get_frames_per_buffer();
+    if (!ensure_transcriber(sample_rate) || frames <= 0) {
+        if (frames <= 0) {
+            last_error_ = "Invalid frames_per_buffer";
+        }
+        return false;
+    }
+    report.config = config_;
+    report.sample_rate = sample_rate;
+
+    transcriber_->reset();
+    transcriber_->enable_noise_filtering(config_.noise_filtering);
+    const double chunk_ms = frames * 1000.0 / sample_rate;
+    Endpointer endpointer(config_.hangover_ms, static_cast<int>(std::lround(chunk_ms)));
+
+    const size_t first = report.utterances.size();
+    for (size_t i = 0; i < labels.utterances.size(); i++) {
+        UtteranceLatency utterance;
+        utterance.recording = labels.path;
+        utterance.index = i;
+        utterance.reference = labels.utterances[i].text;
+        utterance.start_ms = labels.utterances[i].start_ms;
+        utterance.end_ms = labels.utterances[i].end_ms;
+        report.utterances.push_back(utterance);
+    }
+    const size_t count = labels.utterances.size();
+
+    // Results belong to the latest labeled utterance that started by the end of their chunk
+    auto label_for = [&](double media_ms) -> UtteranceLatency* {
+        UtteranceLatency* match = nullptr;
+        for (size_t i = first; i < first + count; i++) {
+            if (report.utterances[i].start_ms > media_ms) {
+                break;
+            }
+            match = &report.utterances[i];
+        }
+        return match;
+    };
+
+    RecordingLatency recording;
+    recording.path = labels.path;
+    double processing_ms = 0.0;
+    uint64_t last_sequence = 0;
+
+    auto handle_result = [&](const TranscriptionResult& result, double chunk_end_ms,
+                             Clock::time_point captured, Clock::time_point emitted) {
+        if (result.raw_text.empty()) {
+            return;
+        }
+        UtteranceLatency* target = label_for(chunk_end_ms);
+        if (!target) {
+            return;
+        }
+        double since_capture = elapsed_ms(captured, emitted);
+        if (result.is_final) {
+            target->hypothesis += (target->hypothesis.empty() ? "" : " ") + result.raw_text;
+            target->final_latency_ms = since_capture + chunk_end_ms - target->end_ms;
+        } else if (!target->first_partial_latency_ms) {
+            target->first_partial_latency_ms = since_capture + chunk_end_ms - target->start_ms;
+        }
+    };
+
+    const Clock::time_point start = Clock::now();
+    if (!stream.start()) {
+        last_error_ = stream.get_last_error();
+        return false;
+    }
+
+    while (stream.is_active()) {
+        std::optional<AudioChunk> chunk = stream.get_next_chunk(100);
+        if (!chunk) {
+            continue;
+        }
+        const Clock::time_point read = Clock::now();
+        last_sequence = chunk->sequence();
+        const double chunk_end_ms = (chunk->sequence() + 1) * chunk_ms;
+
+        // When the chunk's last sample was captured
+        Clock::time_point captured = read;
+        if (config_.realtime) {
+            captured = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double, std::milli>(chunk_end_ms));
+            recording.max_backlog_ms = std::max(recording.max_backlog_ms, elapsed_ms(captured, read));
+        }
+        recording.chunks++;
+
+        bool is_speech = vad_->is_speech(*chunk);
+        Endpointer::Event event = endpointer.update(is_speech);
+        if (event == Endpointer::Event::SpeechStart) {
+            UtteranceLatency* target = label_for(chunk_end_ms);
+            if (!target) {
+                recording.false_starts++;
+            } else if (!target->onset_latency_ms) {
+                target->onset_latency_ms = elapsed_ms(captured, Clock::now()) + chunk_end_ms - target->start_ms;
+            }
+        }
+
+        // Same gating as the transcription loop: utterance chunks and their hangover
+        if (endpointer.in_utterance()) {
+            auto owned = std::make_unique<AudioChunk>(std::move(*chunk));
+            TranscriptionResult result = config_.noise_filtering
+                ? transcriber_->transcribe_with_noise_filtering(std::move(owned), is_speech)
+                : transcriber_->transcribe_with_vad(std::move(owned), is_speech);
+            handle_result(result, chunk_end_ms, captured, Clock::now());
+        }
+        processing_ms += elapsed_ms(read, Clock::now());
+    }
+
+    // Speech running into the end of the file is finalized, as when dictation stops
+    if (endpointer.in_utterance()) {
+        const Clock::time_point read = Clock::now();
+        auto silence = std::make_unique<AudioChunk>(static_cast<size_t>(frames));
+        silence->set_sequence(last_sequence + 1);
+        silence->set_first_sample((last_sequence + 1) * static_cast<uint64_t>(frames));
+        TranscriptionResult result = transcriber_->transcribe_with_vad(std::move(silence), false);
+        handle_result(result, (last_sequence + 1) * chunk_ms, read, Clock::now());
+        processing_ms += elapsed_ms(read, Clock::now());
+    }
+    stream.stop();
+
+    recording.duration_ms = recording.chunks * chunk_ms;
+    recording.processing_ms = processing_ms;
+    recording.real_time_factor = recording.duration_ms > 0.0 ? processing_ms / recording.duration_ms : 0.0;
+    for (size_t i = first; i < first + count; i++) {
+        UtteranceLatency& utterance = report.utterances[i];
+        utterance.word_errors = word_errors(utterance.reference, utterance.hypothesis, &utterance.reference_words);
+    }
+    report.recordings.push_back(recording);
+    return true;
+}
+
+// Distribution of one latency over the utterances where the event happened
+static void write_distribution(std::ostringstream& out, std::vector<double> values) {
+    out << "{\"count\":" << values.size();
+    if (!values.empty()) {
+        std::sort(values.begin(), values.end());
+        double sum = 0.0;
+        for (double value : values) {
+            sum += value;
+        }
+        // Nearest-rank percentiles
+        auto percentile = [&](double p) {
+            size_t rank = static_cast<size_t>(std::ceil(p * values.size()));
+            return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+        };
+        out << ",\"mean\":" << sum / values.size()
+            << ",\"p50\":" << percentile(0.50)
+            << ",\"p90\":" << percentile(0.90)
+            << ",\"p99\":" << percentile(0.99)
+            << ",\"max\":" << values.back();
+    }
+    out << "}";
+}
+
+static void write_latency(std::ostringstream& out, const std::optional<double>& value) {
+    if (value) {
+        out << *value;
+    } else {
+        out << "null";
+    }
+}
+
+std::string LatencyReport::to_json() const {
+    std::vector<double> onset;
+    std::vector<double> partial;
+    std::vector<double> finals;
+    size_t errors = 0;
+    size_t words = 0;
+    for (const auto& utterance : utterances) {
+        if (utterance.onset_latency_ms) {
+            onset.push_back(*utterance.onset_latency_ms);
+        }
+        if (utterance.first_partial_latency_ms) {
+            partial.push_back(*utterance.first_partial_latency_ms);
+        }
+        if (utterance.final_latency_ms) {
+            finals.push_back(*utterance.final_latency_ms);
+        }
+        errors += utterance.word_errors;
+        words += utterance.reference_words;
+    }
+    double duration_ms = 0.0;
+    double processing_ms = 0.0;
+    double max_backlog_ms = 0.0;
+    size_t false_starts = 0;
+    for (const auto& recording : recordings) {
+        duration_ms += recording.duration_ms;
+        processing_ms += recording.processing_ms;
+        max_backlog_ms = std::max(max_backlog_ms, recording.max_backlog_ms);
+        false_starts += recording.false_starts;
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"label\":\"" << escape_json(config.label) << "\""
+        << ",\"config\":{\"engine\":\"" << escape_json(config.engine) << "\""
+        << ",\"model_path\":\"" << escape_json(config.model_path) << "\""
+        << ",\"sample_rate\":" << sample_rate
+        << ",\"frames_per_buffer\":" << config.frames_per_buffer
+        << ",\"vad_aggressiveness\":" << config.vad_aggressiveness
+        << ",\"hangover_ms\":" << config.hangover_ms
+        << ",\"noise_filtering\":" << (config.noise_filtering ? "true" : "false")
+        << ",\"realtime\":" << (config.realtime ? "true" : "false") << "}";
+
+    out << ",\"summary\":{\"recordings\":" << recordings.size()
+        << ",\"utterances\":" << utterances.size()
+        << ",\"audio_ms\":" << duration_ms
+        << ",\"processing_ms\":" << processing_ms
+        << std::setprecision(6)
+        << ",\"real_time_factor\":" << (duration_ms > 0.0 ? processing_ms / duration_ms : 0.0)
+        << std::setprecision(3)
+        << ",\"max_backlog_ms\":" << max_backlog_ms
+        << ",\"false_starts\":" << false_starts
+        << ",\"word_error_rate\":" << (words > 0 ? static_cast<double>(errors) / words : 0.0)
+        << ",\"onset_latency_ms\":";
+    write_distribution(out, onset);
+    out << ",\"first_partial_latency_ms\":";
+    write_distribution(out, partial);
+    out << ",\"final_latency_ms\":";
+    write_distribution(out, finals);
+    out << "}";
+
+    out << ",\"recordings\":[";
+    for (size_t i = 0; i < recordings.size(); i++) {
+        const RecordingLatency& recording = recordings[i];
+        out << (i ? "," : "") << "{\"path\":\"" << escape_json(recording.path) << "\""
+            << ",\"duration_ms\":" << recording.duration_ms
+            << ",\"processing_ms\":" << recording.processing_ms
+            << std::setprecision(6) << ",\"real_time_factor\":" << recording.real_time_factor << std::setprecision(3)
+            << ",\"max_backlog_ms\":" << recording.max_backlog_ms
+            << ",\"chunks\":" << recording.chunks
+            << ",\"false_starts\":" << recording.false_starts << "}";
+    }
+    out << "],\"utterances\":[";
+    for (size_t i = 0; i < utterances.size(); i++) {
+        const UtteranceLatency& utterance = utterances[i];
+        out << (i ? "," : "") << "{\"recording\":\"" << escape_json(utterance.recording) << "\""
+            << ",\"index\":" << utterance.index
+            << ",\"start_ms\":" << utterance.start_ms
+            << ",\"end_ms\":" << utterance.end_ms
+            << ",\"reference\":\"" << escape_json(utterance.reference) << "\""
+            << ",\"hypothesis\":\"" << escape_json(utterance.hypothesis) << "\""
+            << ",\"onset_latency_ms\":";
+        write_latency(out, utterance.onset_latency_ms);
+        out << ",\"first_partial_latency_ms\":";
+        write_latency(out, utterance.first_partial_latency_ms);
+        out << ",\"final_latency_ms\":";
+        write_latency(out, utterance.final_latency_ms);
+        out << ",\"word_errors\":" << utterance.word_errors
+            << ",\"reference_words\":" << utterance.reference_words << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+bool LatencyReport::write_json(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << to_json() << "\n";
+    return static_cast<bool>(file);
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,447 @@
+#include "metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#endif
+
+namespace voice_transcription {
+
+static const char* const kStageNames[] = {
+    "callback_to_ring",
+    "ring_to_chunk",
+    "vad",
+    "noise_filter",
+    "accept_waveform",
+    "json_parse",
+    "text_normalization",
+    "command_processing",
+    "output",
+    "capture_to_final",
+    "model_load",
+    "model_warmup",
+    "keyword_spotting",
+    "wake_latency"
+};
+static_assert(sizeof(kStageNames) / sizeof(kStageNames[0]) == static_cast<size_t>(Stage::Count),
+              "Every stage needs a name");
+
+static const char* const kCounterNames[] = {
+    "audio_callbacks",
+    "audio_overflows",
+    "audio_chunks",
+    "speech_chunks",
+    "partial_results",
+    "final_results",
+    "keyword_wakes",
+    "keyword_false_accepts",
+    "consumer_wakeups",
+    "idle_chunks_skipped"
+};
+static_assert(sizeof(kCounterNames) / sizeof(kCounterNames[0]) == static_cast<size_t>(Counter::Count),
+              "Every counter needs a name");
+
+// Index of the highest set bit; value must be non-zero
+static inline int highest_bit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+// Owner-thread increment; cheaper than fetch_add and other threads only read
+static inline void add_relaxed(std::atomic<uint64_t>& target, uint64_t delta) {
+    target.store(target.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucket_index(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<size_t>(value);
+    }
+    int exponent = highest_bit(value);
+    if (exponent > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    uint64_t sub = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>((exponent - kSubBucketBits + 1) * kSubBuckets) + static_cast<size_t>(sub);
+}
+
+uint64_t LatencyHistogram::bucket_lower_bound(size_t index) {
+    if (index < static_cast<size_t>(kSubBuckets)) {
+        return index;
+    }
+    size_t group = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << (group - 1);
+}
+
+uint64_t LatencyHistogram::bucket_upper_bound(size_t index) {
+    if (index < static_cast<size_t>(kSubBuckets)) {
+        return index + 1;
+    }
+    return bucket_lower_bound(index) + (uint64_t(1) << (index / kSubBuckets - 1));
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    add_relaxed(buckets_[bucket_index(value)], 1);
+    add_relaxed(count_, 1);
+    add_relaxed(sum_, value);
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (size_t i = 0; i < buckets_.size(); i++) {
+        add_relaxed(buckets_[i], other.buckets_[i].load(std::memory_order_relaxed));
+    }
+    add_relaxed(count_, other.count_.load(std::memory_order_relaxed));
+    add_relaxed(sum_, other.sum_.load(std::memory_order_relaxed));
+    uint64_t other_max = other.max_.load(std::memory_order_relaxed);
+    if (other_max > max_.load(std::memory_order_relaxed)) {
+        max_.store(other_max, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::merge_into(std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum,
+                                  uint64_t& max) const {
+    buckets.resize(kBucketCount, 0);
+    for (size_t i = 0; i < buckets_.size(); i++) {
+        buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+    }
+    count += count_.load(std::memory_order_relaxed);
+    sum += sum_.load(std::memory_order_relaxed);
+    max = std::max(max, max_.load(std::memory_order_relaxed));
+}
+
+void MetricsRegistry::Shard::clear() {
+    for (auto& histogram : stages) {
+        histogram.reset();
+    }
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MetricsRegistry::Shard::add(const Shard& other) {
+    for (size_t s = 0; s < stages.size(); s++) {
+        stages[s].add(other.stages[s]);
+    }
+    for (size_t c = 0; c < counters.size(); c++) {
+        add_relaxed(counters[c], other.counters[c].load(std::memory_order_relaxed));
+    }
+}
+
+MetricsRegistry::MetricsRegistry()
+    : enabled_(true),
+      reset_epoch_(0),
+      start_time_(std::chrono::steady_clock::now()) {
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // Never destroyed, so threads still running at exit can keep recording
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+MetricsRegistry::ShardOwner::~ShardOwner() {
+    if (shard) {
+        MetricsRegistry::instance().release_shard(shard);
+    }
+}
+
+MetricsRegistry::Shard& MetricsRegistry::local_shard() {
+    thread_local ShardOwner owner;
+    Shard* shard = owner.shard;
+    if (!shard) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_shards_.empty()) {
+            shards_.push_back(std::make_unique<Shard>());
+            shard = shards_.back().get();
+        } else {
+            shard = free_shards_.back();
+            free_shards_.pop_back();
+        }
+        shard->epoch.store(reset_epoch_.load(std::memory_order_relaxed), std::memory_order_release);
+        owner.shard = shard;
+        return *shard;
+    }
+    // Apply a reset() made since this thread last recorded
+    uint64_t epoch = reset_epoch_.load(std::memory_order_acquire);
+    if (shard->epoch.load(std::memory_order_relaxed) != epoch) {
+        shard->clear();
+        shard->epoch.store(epoch, std::memory_order_release);
+    }
+    return *shard;
+}
+
+void MetricsRegistry::release_shard(Shard* shard) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Counts from before a reset the thread never applied are dropped
+    if (shard->epoch.load(std::memory_order_relaxed) == reset_epoch_.load(std::memory_order_relaxed)) {
+        retired_.add(*shard);
+    }
+    shard->clear();
+    free_shards_.push_back(shard);
+}
+
+void MetricsRegistry::merge_stage(size_t stage, std::vector<uint64_t>& buckets, uint64_t& count, uint64_t& sum,
+                                  uint64_t& max) const {
+    uint64_t epoch = reset_epoch_.load(std::memory_order_relaxed);
+    retired_.stages[stage].merge_into(buckets, count, sum, max);
+    for (const auto& shard : shards_) {
+        if (shard->epoch.load(std::memory_order_acquire) == epoch) {
+            shard->stages[stage].merge_into(buckets, count, sum, max);
+        }
+    }
+}
+
+uint64_t MetricsRegistry::counter_total(size_t counter) const {
+    uint64_t epoch = reset_epoch_.load(std::memory_order_relaxed);
+    uint64_t total = retired_.counters[counter].load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        if (shard->epoch.load(std::memory_order_acquire) == epoch) {
+            total += shard->counters[counter].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+void MetricsRegistry::record_latency(Stage stage, uint64_t nanoseconds) {
+    if (!is_enabled() || stage >= Stage::Count) {
+        return;
+    }
+    local_shard().stages[static_cast<size_t>(stage)].record(nanoseconds);
+}
+
+void MetricsRegistry::increment(Counter counter, uint64_t delta) {
+    if (!is_enabled() || counter >= Counter::Count) {
+        return;
+    }
+    add_relaxed(local_shard().counters[static_cast<size_t>(counter)], delta);
+}
+
+// Value at quantile q, taken as the midpoint of the bucket that contains it
+static double quantile_ns(const std::vector<uint64_t>& buckets, uint64_t count, double q) {
+    if (count == 0) {
+        return 0.0;
+    }
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return 0.5 * static_cast<double>(LatencyHistogram::bucket_lower_bound(i) +
+                                             LatencyHistogram::bucket_upper_bound(i) - 1);
+        }
+    }
+    return static_cast<double>(LatencyHistogram::bucket_lower_bound(buckets.size() - 1));
+}
+
+MetricsSnapshot MetricsRegistry::snapshot() const {
+    MetricsSnapshot snapshot;
+    std::lock_guard<std::mutex> lock(mutex_);
+    snapshot.uptime_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+    snapshot.resident_bytes = resident_memory_bytes();
+    snapshot.cpu_seconds = process_cpu_seconds();
+
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); s++) {
+        std::vector<uint64_t> buckets;
+        uint64_t count = 0, sum = 0, max = 0;
+        merge_stage(s, buckets, count, sum, max);
+
+        StageStats stats;
+        stats.stage = kStageNames[s];
+        stats.count = count;
+        stats.total_ms = static_cast<double>(sum) / 1e6;
+        if (count > 0) {
+            stats.mean_us = static_cast<double>(sum) / static_cast<double>(count) / 1e3;
+            stats.p50_us = quantile_ns(buckets, count, 0.50) / 1e3;
+            stats.p90_us = quantile_ns(buckets, count, 0.90) / 1e3;
+            stats.p99_us = quantile_ns(buckets, count, 0.99) / 1e3;
+            stats.max_us = static_cast<double>(max) / 1e3;
+        }
+        snapshot.stages.push_back(stats);
+    }
+
+    for (size_t c = 0; c < static_cast<size_t>(Counter::Count); c++) {
+        snapshot.counters.emplace_back(kCounterNames[c], counter_total(c));
+    }
+
+    return snapshot;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Owners clear their own shards; see local_shard()
+    reset_epoch_.fetch_add(1, std::memory_order_acq_rel);
+    retired_.clear();
+    start_time_ = std::chrono::steady_clock::now();
+}
+
+size_t MetricsRegistry::shard_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return shards_.size();
+}
+
+std::string MetricsRegistry::to_prometheus() const {
+    std::ostringstream out;
+
+    // Exported bucket bounds are powers of two from ~1us to ~8.6s. They line up
+    // with histogram bucket edges, so the cumulative counts are exact.
+    constexpr int kFirstExponent = 10;
+    constexpr int kLastExponent = 33;
+
+    out << "# HELP voice_transcription_stage_latency_seconds Latency of each pipeline stage.\n";
+    out << "# TYPE voice_transcription_stage_latency_seconds histogram\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); s++) {
+        std::vector<uint64_t> buckets;
+        uint64_t count = 0, sum = 0, max = 0;
+        merge_stage(s, buckets, count, sum, max);
+
+        const std::string label = std::string("stage=\"") + kStageNames[s] + "\"";
+        uint64_t cumulative = 0;
+        size_t next = 0;
+        for (int exponent = kFirstExponent; exponent <= kLastExponent; exponent++) {
+            uint64_t bound = uint64_t(1) << exponent;
+            while (next < buckets.size() && LatencyHistogram::bucket_upper_bound(next) <= bound) {
+                cumulative += buckets[next++];
+            }
+            out << "voice_transcription_stage_latency_seconds_bucket{" << label
+                << ",le=\"" << static_cast<double>(bound) / 1e9 << "\"} " << cumulative << "\n";
+        }
+        out << "voice_transcription_stage_latency_seconds_bucket{" << label << ",le=\"+Inf\"} " << count << "\n";
+        out << "voice_transcription_stage_latency_seconds_sum{" << label << "} "
+            << static_cast<double>(sum) / 1e9 << "\n";
+        out << "voice_transcription_stage_latency_seconds_count{" << label << "} " << count << "\n";
+    }
+
+    for (size_t c = 0; c < static_cast<size_t>(Counter::Count); c++) {
+        uint64_t total = counter_total(c);
+        out << "# TYPE voice_transcription_" << kCounterNames[c] << "_total counter\n";
+        out << "voice_transcription_" << kCounterNames[c] << "_total " << total << "\n";
+    }
+
+    out << "# TYPE voice_transcription_resident_memory_bytes gauge\n";
+    out << "voice_transcription_resident_memory_bytes " << resident_memory_bytes() << "\n";
+    out << "# TYPE voice_transcription_process_cpu_seconds_total counter\n";
+    out << "voice_transcription_process_cpu_seconds_total " << process_cpu_seconds() << "\n";
+
+    return out.str();
+}
+
+uint64_t resident_memory_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__linux__)
+    // Second field of statm: resident pages
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size_pages = 0, resident_pages = 0;
+    if (!(statm >> size_pages >> resident_pages)) {
+        return 0;
+    }
+    return resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS) {
+        return 0;
+    }
+    return info.resident_size;
+#else
+    return 0;
+#endif
+}
+
+double process_cpu_seconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0.0;
+    }
+    // FILETIMEs count 100 ns ticks
+    auto ticks = [](const FILETIME& time) {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (ticks(kernel) + ticks(user)) / 1e7;
+#elif defined(__linux__) || defined(__APPLE__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0.0;
+    }
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+#else
+    return 0.0;
+#endif
+}
+
+bool MetricsRegistry::write_prometheus(const std::string& path) const {
+    // Write then rename, so a scraper never reads a half-written file
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << to_prometheus();
+        if (!file) {
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+const char* MetricsRegistry::stage_name(Stage stage) {
+    return stage < Stage::Count ? kStageNames[static_cast<size_t>(stage)] : "unknown";
+}
+
+const char* MetricsRegistry::counter_name(Counter counter) {
+    return counter < Counter::Count ? kCounterNames[static_cast<size_t>(counter)] : "unknown";
+}
+
+bool MetricsRegistry::stage_from_name(const std::string& name, Stage& stage) {
+    for (size_t s = 0; s < static_cast<size_t>(Stage::Count); s++) {
+        if (name == kStageNames[s]) {
+            stage = static_cast<Stage>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,134 @@
+#include "model_cache.h"
+#include "metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace voice_transcription {
+
+uint64_t prefetch_model_files(const std::string& model_path, const ModelReadProgress& progress) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::pair<fs::path, uint64_t>> files;
+    if (fs::is_directory(model_path, ec)) {
+        for (auto it = fs::recursive_directory_iterator(model_path, ec);
+             !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec)) {
+                files.emplace_back(it->path(), it->file_size(ec));
+            }
+        }
+    } else if (fs::is_regular_file(model_path, ec)) {
+        files.emplace_back(model_path, fs::file_size(model_path, ec));
+    }
+
+    uint64_t total = 0;
+    for (const auto& file : files) {
+        total += file.second;
+    }
+
+    // Sizes may change under us; report against the listed total
+    std::vector<char> buffer(1 << 20);
+    uint64_t done = 0;
+    for (const auto& file : files) {
+        std::ifstream in(file.first, std::ios::binary);
+        while (in) {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            done += static_cast<uint64_t>(in.gcount());
+            if (progress) {
+                progress(std::min(done, total), total);
+            }
+        }
+    }
+    return done;
+}
+
+ModelCache& ModelCache::instance() {
+    static ModelCache cache;
+    return cache;
+}
+
+std::shared_ptr<SpeechModel> ModelCache::acquire(const std::string& engine, const std::string& model_path,
+                                                 std::string& error, bool reload,
+                                                 const ModelReadProgress& progress) {
+    // Different spellings of one path share an entry
+    std::error_code ec;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(model_path, ec);
+    const std::string key = engine + '\n' + (ec ? model_path : canonical.string());
+
+    std::promise<LoadResult> promise;
+    std::shared_future<LoadResult> loading;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[key];
+        if (auto model = entry.model.lock(); model && !reload) {
+            hits_++;
+            return model;
+        }
+        if (entry.loading.valid()) {
+            loading = entry.loading;
+        } else {
+            entry.loading = promise.get_future().share();
+        }
+    }
+
+    // Someone else is loading it; wait for their result
+    if (loading.valid()) {
+        LoadResult result = loading.get();
+        if (!result.model) {
+            error = result.error;
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        hits_++;
+        return result.model;
+    }
+
+    LoadResult result;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        prefetch_model_files(model_path, progress);
+        result.model = load_speech_model(engine, model_path, result.error);
+    } catch (const std::exception& e) {
+        result.error = "Exception during model loading: " + std::string(e.what());
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    MetricsRegistry::instance().record_latency(Stage::ModelLoad,
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Entry& entry = entries_[key];
+        entry.model = result.model;
+        entry.loading = std::shared_future<LoadResult>();
+        if (result.model) {
+            loads_++;
+            load_ms_ += std::chrono::duration<double, std::milli>(elapsed).count();
+        } else {
+            entries_.erase(key);
+        }
+    }
+    promise.set_value(result);
+
+    if (!result.model) {
+        error = result.error;
+    }
+    return result.model;
+}
+
+ModelCache::Stats ModelCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.loads = loads_;
+    stats.hits = hits_;
+    stats.load_ms = load_ms_;
+    for (const auto& entry : entries_) {
+        if (!entry.second.model.expired()) {
+            stats.resident_models++;
+        }
+    }
+    return stats;
+}
+
+} // namespace voice_transcription
@@ -0,0 +1,130 @@
+#include "noise_filter.h"
+#include "audio_stream.h"
+#include <algorithm>
+#include <cmath>
+
+namespace voice_transcription {
+
+NoiseFilter::NoiseFilter(float threshold, int window_size)
+    : noise_threshold_(threshold),
+      noise_floor_(0.0f),
+      calibrated_(false),
+      window_size_(window_size) {
+}
+
+// Process an audio chunk to remove background noise
+void NoiseFilter::filter(AudioChunk& chunk) {
+    if (!chunk.data() || chunk.size() == 0) {
+        return;
+    }
+
+    // Calculate current frame energy
+    float frame_energy = calculate_energy(chunk);
+
+    // Update noise floor estimate during silence periods
+    update_noise_floor(frame_energy);
+
+    // Apply noise gate if energy is below threshold
+    if (frame_energy < noise_floor_ * 1.5f) {
+        // Apply soft noise gate (reduce amplitude rather than silence completely)
+        float reduction_factor = std::min(1.0f, frame_energy / (noise_floor_ * 1.5f));
+        reduction_factor = reduction_factor * reduction_factor; // Squared for more aggressive reduction
+
+        // Apply reduction
+        for (size_t i = 0; i < chunk.size(); i++) {
+            chunk.data()[i] *= reduction_factor;
+        }
+    }
+
+    // Apply spectral subtraction (simplified)
+    if (calibrated_) {
+        // Subtract estimated noise floor from each sample
+        for (size_t i = 0; i < chunk.size(); i++) {
+            float sample = chunk.data()[i];
+            float sign = sample >= 0 ? 1.0f : -1.0f;
+            float abs_sample = std::abs(sample);
+
+            // Subtract noise floor (with flooring to avoid negative values)
+            float filtered = sign * std::max(0.0f, abs_sample - noise_floor_ * 0.5f);
+
+            // Apply soft-decision filter
+            float gain = abs_sample < noise_floor_ ? 0.1f : 1.0f;
+            chunk.data()[i] = filtered * gain;
+        }
+    }
+}
+
+// Calibrate the noise filter with background noise
+void NoiseFilter::calibrate(const AudioChunk& chunk) {
+    if (!chunk.data() || chunk.size() == 0) {
+        return;
+    }
+
+    // Calculate energy of the calibration frame
+    float frame_energy = calculate_energy(chunk);
+
+    // Initialize noise floor with this energy
+    noise_floor_ = frame_energy;
+    noise_energy_history_.clear();
+    calibrated_ = true;
+}
+
+// Auto-calibrate the noise filter with running energy estimates
+void NoiseFilter::auto_calibrate(const AudioChunk& chunk, bool is_speech) {
+    if (!chunk.data() || chunk.size() == 0) {
+        return;
+    }
+
+    // If this is silence (not speech), use it to calibrate
+    if (!is_speech) {
+        float frame_energy = calculate_energy(chunk);
+
+        // Add to history
+        noise_energy_history_.push_back(frame_energy);
+        if (noise_energy_history_.size() > static_cast<size_t>(window_size_)) {
+            noise_energy_history_.pop_front();
+        }
+
+        // Update noise floor with average of recent silence frames
+        if (noise_energy_history_.size() >= 3) {
+            float avg_energy = 0.0f;
+            for (float e : noise_energy_history_) {
+                avg_energy += e;
+            }
+            avg_energy /= noise_energy_history_.size();
+
+            // Smooth transition for noise floor updates
+            if (!calibrated_) {
+                noise_floor_ = avg_energy;
+                calibrated_ = true;
+            } else {
+                noise_floor_ = 0.9f * noise_floor_ + 0.1f * avg_energy;
+            }
+        }
+    }
+}
+
+// Calculate energy of a frame
+float NoiseFilter::calculate_energy(const AudioChunk& chunk) const {
+    float energy = 0.0f;
+    for (size_t i = 0; i < chunk.size(); i++) {
+        energy += chunk.data()[i] * chunk.data()[i];
+    }
+    return energy / chunk.size();
+}
+
+// Update noise floor estimate
+void NoiseFilter::update_noise_floor(float frame_energy) {
+    // If energy is very low, it's likely silence - use it to update noise floor
+    if (!calibrated_ || frame_energy < noise_floor_ * 1.2f) {
+        if (!calibrated_) {
+            noise_floor_ = frame_energy;
+            calibrated_ = true;
+        } else {
+            // Slowly adapt noise floor (90% old, 10% new)
+            noise_floor_ = 0.95f * noise_floor_ + 0.05f * frame_energy;
+        }
+    }
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "readiness_notifier.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+namespace voice_transcription {
+
+#ifdef _WIN32
+// Connected loopback TCP pair, the way socket.socketpair() does it on Windows
+static bool create_socket_pair(SOCKET& read_socket, SOCKET& write_socket) {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) {
+        return false;
+    }
+
+    SOCKET listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET) {
+        return false;
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int length = sizeof(address);
+    read_socket = write_socket = INVALID_SOCKET;
+    if (bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0 &&
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) == 0 &&
+        listen(listener, 1) == 0) {
+        write_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (write_socket != INVALID_SOCKET &&
+            connect(write_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            read_socket = accept(listener, nullptr, nullptr);
+        }
+    }
+    closesocket(listener);
+    if (read_socket == INVALID_SOCKET) {
+        if (write_socket != INVALID_SOCKET) {
+            closesocket(write_socket);
+        }
+        return false;
+    }
+
+    // Never block the notifying thread or the draining one
+    u_long non_blocking = 1;
+    ioctlsocket(read_socket, FIONBIO, &non_blocking);
+    ioctlsocket(write_socket, FIONBIO, &non_blocking);
+    BOOL no_delay = TRUE;
+    setsockopt(write_socket, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+    return true;
+}
+#endif
+
+ReadinessNotifier::ReadinessNotifier() {
+#if defined(_WIN32)
+    SOCKET read_socket, write_socket;
+    if (create_socket_pair(read_socket, write_socket)) {
+        read_fd_ = static_cast<intptr_t>(read_socket);
+        write_fd_ = static_cast<intptr_t>(write_socket);
+    }
+#elif defined(__linux__)
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd >= 0) {
+        read_fd_ = write_fd_ = fd;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        for (int fd : fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        read_fd_ = fds[0];
+        write_fd_ = fds[1];
+    }
+#endif
+}
+
+ReadinessNotifier::~ReadinessNotifier() {
+#ifdef _WIN32
+    if (read_fd_ != -1) {
+        closesocket(static_cast<SOCKET>(read_fd_));
+        closesocket(static_cast<SOCKET>(write_fd_));
+    }
+#else
+    if (read_fd_ != -1) {
+        close(static_cast<int>(read_fd_));
+    }
+    if (write_fd_ != -1 && write_fd_ != read_fd_) {
+        close(static_cast<int>(write_fd_));
+    }
+#endif
+}
+
+void ReadinessNotifier::notify() {
+    if (signaled_.exchange(true, std::memory_order_acq_rel) || write_fd_ == -1) {
+        return;
+    }
+#if defined(_WIN32)
+    const char byte = 1;
+    send(static_cast<SOCKET>(write_fd_), &byte, 1, 0);
+#elif defined(__linux__)
+    uint64_t one = 1;
+    ssize_t written = write(static_cast<int>(write_fd_), &one, sizeof(one));
+    (void)written;
+#else
+    const char byte = 1;
+    ssize_t written = write(static_cast<int>(write_fd_), &byte, 1);
+    (void)written;
+#endif
+}
+
+void ReadinessNotifier::clear() {
+    if (read_fd_ == -1) {
+        signaled_.store(false, std::memory_order_release);
+        return;
+    }
+    // Drain first, then drop the flag. A notify in between finds the flag
+    // still set and writes nothing, but its data is already in the source
+    // the caller is about to check; a write that lands after the store only
+    // causes one spurious wakeup.
+#if defined(_WIN32)
+    char buffer[64];
+    while (recv(static_cast<SOCKET>(read_fd_), buffer, sizeof(buffer), 0) > 0) {
+    }
+#elif defined(__linux__)
+    uint64_t count;
+    ssize_t drained = read(static_cast<int>(read_fd_), &count, sizeof(count));
+    (void)drained;
+#else
+    char buffer[64];
+    while (read(static_cast<int>(read_fd_), buffer, sizeof(buffer)) > 0) {
+    }
+#endif
+    signaled_.store(false, std::memory_order_release);
+}
+
+} // namespace voice_transcription
@@ -0,0 +1,84 @@
+#include "result_queue.h"
+#include <chrono>
+
+namespace voice_transcription {
+
+ResultQueue::ResultQueue(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1) {
+}
+
+bool ResultQueue::push(TranscriptionResult result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        if (results_.size() >= capacity_) {
+            results_.pop_front();
+            dropped_++;
+        }
+        results_.push_back(std::move(result));
+    }
+    available_.notify_one();
+    notifier_.notify();
+    return true;
+}
+
+std::optional<TranscriptionResult> ResultQueue::pop() {
+    // Clear before looking, so a push racing with the check re-arms the descriptor
+    notifier_.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::optional<TranscriptionResult> result;
+    if (!results_.empty()) {
+        result = std::move(results_.front());
+        results_.pop_front();
+    }
+    rearm();
+    return result;
+}
+
+std::optional<TranscriptionResult> ResultQueue::wait_pop(int timeout_ms) {
+    notifier_.clear();
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                        [this]() { return !results_.empty() || closed_; });
+    std::optional<TranscriptionResult> result;
+    if (!results_.empty()) {
+        result = std::move(results_.front());
+        results_.pop_front();
+    }
+    rearm();
+    return result;
+}
+
+void ResultQueue::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    available_.notify_all();
+    notifier_.notify();
+}
+
+bool ResultQueue::is_closed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return closed_;
+}
+
+size_t ResultQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_.size();
+}
+
+uint64_t ResultQueue::dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+void ResultQueue::rearm() {
+    if (!results_.empty() || closed_) {
+        notifier_.notify();
+    }
+}
+
+} // namespace voice_transcription
@@ -0,0 +1,50 @@
+#include "speech_recognizer.h"
+#include "synthetic_recognizer.h"
+#include "vosk_backend.h"
+#ifdef USE_WHISPER
+#include "whisper_backend.h"
+#endif
+
+namespace voice_transcription {
+
+std::unique_ptr<SpeechModel> load_speech_model(const std::string& engine, const std::string& model_path,
+                                               std::string& error) {
+    if (engine == "vosk") {
+        auto model = std::make_unique<VoskSpeechModel>(model_path, error);
+        if (!model->is_loaded()) {
+            return nullptr;
+        }
+        return model;
+    }
+    if (engine == "synthetic") {
+        SyntheticRecognizerConfig config;
+        if (!SyntheticRecognizerConfig::load(model_path, config, error)) {
+            return nullptr;
+        }
+        return std::make_unique<SyntheticSpeechModel>(config);
+    }
+    if (engine == "whisper") {
+#ifdef USE_WHISPER
+        auto model = std::make_unique<WhisperSpeechModel>(model_path, error);
+        if (!model->is_loaded()) {
+            return nullptr;
+        }
+        return model;
+#else
+        error = "Engine 'whisper' is not compiled into this build (libs/whisper not found)";
+        return nullptr;
+#endif
+    }
+    error = "Unknown speech engine: " + engine;
+    return nullptr;
+}
+
+std::vector<std::string> available_speech_engines() {
+    std::vector<std::string> engines = { "vosk", "synthetic" };
+#ifdef USE_WHISPER
+    engines.push_back("whisper");
+#endif
+    return engines;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,477 @@
+#include "synthetic_recognizer.h"
+#include "json_escape.h"
+#include "metrics.h"
+#include "sample_conversion.h"
+#include "trace_recorder.h"
+#include "vosk_result_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+namespace voice_transcription {
+
+static constexpr char kConfigFileName[] = "synthetic_asr.conf";
+
+static std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+static std::vector<std::string> split_words(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word) {
+        words.push_back(word);
+    }
+    return words;
+}
+
+// Hypotheses of a script entry, best first: "deploy to cooper netties | deploy to kubernetes"
+static std::vector<std::vector<std::string>> split_hypotheses(const std::string& entry) {
+    std::vector<std::vector<std::string>> hypotheses;
+    size_t begin = 0;
+    while (true) {
+        size_t bar = entry.find('|', begin);
+        hypotheses.push_back(split_words(entry.substr(begin, bar == std::string::npos ? bar : bar - begin)));
+        if (bar == std::string::npos) {
+            return hypotheses;
+        }
+        begin = bar + 1;
+    }
+}
+
+static std::string join_words(const std::vector<std::string>& words, size_t count) {
+    std::string text;
+    for (size_t i = 0; i < count && i < words.size(); i++) {
+        if (i > 0) {
+            text += ' ';
+        }
+        text += words[i];
+    }
+    return text;
+}
+
+double JitterDistribution::sample_ms(double uniform, double normal) const {
+    switch (kind) {
+        case Kind::Uniform:
+            return a_ms + (b_ms - a_ms) * uniform;
+        case Kind::Normal:
+            return std::max(0.0, a_ms + b_ms * normal);
+        case Kind::LogNormal: {
+            // Parameterized by the mean and deviation of the delay itself
+            if (a_ms <= 0.0) {
+                return 0.0;
+            }
+            double variance = std::log(1.0 + (b_ms * b_ms) / (a_ms * a_ms));
+            double mu = std::log(a_ms) - variance / 2.0;
+            return std::exp(mu + std::sqrt(variance) * normal);
+        }
+        case Kind::Exponential:
+            return -a_ms * std::log(uniform);
+        case Kind::None:
+        default:
+            return 0.0;
+    }
+}
+
+bool SyntheticRecognizerConfig::parse(const std::string& text, SyntheticRecognizerConfig& config,
+                                      std::string& error) {
+    std::istringstream input(text);
+    std::string line;
+    size_t line_number = 0;
+    bool script_replaced = false;
+
+    while (std::getline(input, line)) {
+        line_number++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = "line " + std::to_string(line_number) + ": expected key = value";
+            return false;
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        try {
+            if (key == "utterance") {
+                if (!script_replaced) {
+                    config.script.clear();
+                    script_replaced = true;
+                }
+                config.script.push_back(value);
+            } else if (key == "cpu_cost") {
+                config.cpu_cost = std::stod(value);
+            } else if (key == "words_per_second") {
+                config.words_per_second = std::stod(value);
+            } else if (key == "endpoint_silence_ms") {
+                config.endpoint_silence_ms = std::stod(value);
+            } else if (key == "speech_threshold") {
+                config.speech_threshold = std::stod(value);
+            } else if (key == "confidence") {
+                config.confidence = std::stod(value);
+            } else if (key == "seed") {
+                config.seed = static_cast<uint32_t>(std::stoul(value));
+            } else if (key == "model_mb") {
+                config.model_mb = std::stod(value);
+            } else if (key == "jitter") {
+                std::istringstream fields(value);
+                std::string kind;
+                double a = 0.0;
+                double b = 0.0;
+                fields >> kind >> a >> b;
+                if (kind == "none") {
+                    config.jitter.kind = JitterDistribution::Kind::None;
+                } else if (kind == "uniform") {
+                    config.jitter.kind = JitterDistribution::Kind::Uniform;
+                } else if (kind == "normal") {
+                    config.jitter.kind = JitterDistribution::Kind::Normal;
+                } else if (kind == "lognormal") {
+                    config.jitter.kind = JitterDistribution::Kind::LogNormal;
+                } else if (kind == "exponential") {
+                    config.jitter.kind = JitterDistribution::Kind::Exponential;
+                } else {
+                    error = "line " + std::to_string(line_number) + ": unknown jitter distribution '" + kind + "'";
+                    return false;
+                }
+                config.jitter.a_ms = a;
+                config.jitter.b_ms = b;
+            } else {
+                error = "line " + std::to_string(line_number) + ": unknown key '" + key + "'";
+                return false;
+            }
+        } catch (const std::exception&) {
+            error = "line " + std::to_string(line_number) + ": invalid value for '" + key + "'";
+            return false;
+        }
+    }
+
+    if (config.script.empty()) {
+        config.script.push_back("");
+    }
+    return true;
+}
+
+bool SyntheticRecognizerConfig::load(const std::string& path, SyntheticRecognizerConfig& config,
+                                     std::string& error) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        error = "no such model path: " + path;
+        return false;
+    }
+
+    // A directory without a script runs with the defaults
+    std::filesystem::path file_path = path;
+    if (std::filesystem::is_directory(file_path, ec)) {
+        file_path /= kConfigFileName;
+        if (!std::filesystem::exists(file_path, ec)) {
+            return true;
+        }
+    }
+
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        error = "cannot read " + file_path.string();
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    if (!parse(text.str(), config, error)) {
+        error = file_path.string() + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+SyntheticRecognizer::SyntheticRecognizer(const SyntheticRecognizerConfig& config, float sample_rate)
+    : config_(config),
+      sample_rate_(sample_rate > 0.0f ? sample_rate : 16000.0),
+      rng_state_(0x9E3779B97F4A7C15ull ^ config.seed) {
+    if (config_.script.empty()) {
+        config_.script.push_back("");
+    }
+}
+
+// splitmix64, so the sequence is the same with every standard library
+double SyntheticRecognizer::next_uniform() {
+    uint64_t z = (rng_state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (static_cast<double>(z >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double SyntheticRecognizer::next_normal() {
+    // Box-Muller transform
+    double u1 = next_uniform();
+    double u2 = next_uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * 3.14159265358979323846 * u2);
+}
+
+double SyntheticRecognizer::draw_jitter_ms() {
+    if (config_.jitter.kind == JitterDistribution::Kind::None) {
+        return 0.0;
+    }
+    double uniform = next_uniform();
+    return config_.jitter.sample_ms(uniform, next_normal());
+}
+
+void SyntheticRecognizer::burn_cpu(double seconds) const {
+    if (seconds <= 0.0) {
+        return;
+    }
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds));
+    volatile uint64_t work = 0;
+    while (std::chrono::steady_clock::now() < until) {
+        for (int i = 0; i < 256; i++) {
+            work = work + i;
+        }
+    }
+}
+
+bool SyntheticRecognizer::accept_waveform(const int16_t* samples, size_t count) {
+    double duration_s = count / sample_rate_;
+    burn_cpu(config_.cpu_cost * duration_s);
+
+    double delay_ms = draw_jitter_ms();
+    if (delay_ms > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(delay_ms));
+    }
+
+    double energy = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double sample = samples[i] / 32768.0;
+        energy += sample * sample;
+    }
+    bool speech = count > 0 && std::sqrt(energy / count) >= config_.speech_threshold;
+
+    double duration_ms = duration_s * 1000.0;
+    if (speech) {
+        if (utterance_start_s_ < 0.0) {
+            utterance_start_s_ = stream_time_s_;
+        }
+        speech_ms_ += duration_ms;
+        trailing_silence_ms_ = 0.0;
+    } else if (utterance_start_s_ >= 0.0) {
+        trailing_silence_ms_ += duration_ms;
+    }
+    stream_time_s_ += duration_s;
+
+    if (utterance_start_s_ >= 0.0 && trailing_silence_ms_ >= config_.endpoint_silence_ms) {
+        pending_final_ = finalize();
+        return true;
+    }
+    return false;
+}
+
+std::string SyntheticRecognizer::format_words(const std::vector<std::string>& words, bool with_confidence) const {
+    // Word list in libvosk's layout, evenly spaced from the first speech
+    std::ostringstream word_list;
+    double word_s = config_.words_per_second > 0.0 ? 1.0 / config_.words_per_second : 0.4;
+    for (size_t i = 0; i < words.size(); i++) {
+        double start = utterance_start_s_ + i * word_s;
+        word_list << (i ? ", " : "") << "{";
+        if (with_confidence) {
+            word_list << "\"conf\" : " << config_.confidence << ", ";
+        }
+        word_list << "\"end\" : " << start + word_s << ", \"start\" : " << start
+                  << ", \"word\" : \"" << escape_json(words[i]) << "\"}";
+    }
+    return word_list.str();
+}
+
+std::string SyntheticRecognizer::format_final(const std::vector<std::vector<std::string>>& hypotheses) const {
+    std::ostringstream out;
+    const std::vector<std::string>& words = hypotheses.front();
+    if (max_alternatives_ > 0) {
+        // Each hypothesis scores 1.0 below the one before it
+        size_t count = std::min(hypotheses.size(), static_cast<size_t>(max_alternatives_));
+        out << "{\"alternatives\" : [";
+        for (size_t h = 0; h < count; h++) {
+            out << (h ? ", " : "") << "{\"confidence\" : " << config_.confidence - static_cast<double>(h);
+            if (words_ && !hypotheses[h].empty()) {
+                out << ", \"result\" : [" << format_words(hypotheses[h], false) << "]";
+            }
+            out << ", \"text\" : \"" << escape_json(join_words(hypotheses[h], hypotheses[h].size())) << "\"}";
+        }
+        out << "]}";
+    } else if (words_ && !words.empty()) {
+        out << "{\"result\" : [" << format_words(words, true) << "], \"text\" : \""
+            << escape_json(join_words(words, words.size())) << "\"}";
+    } else {
+        out << "{\"text\" : \"" << escape_json(join_words(words, words.size())) << "\"}";
+    }
+    return out.str();
+}
+
+void SyntheticRecognizer::set_grammar(const std::vector<std::string>& phrases) {
+    grammar_.clear();
+    for (const std::string& phrase : phrases) {
+        std::vector<std::string> words = split_words(phrase);
+        if (!words.empty()) {
+            grammar_.push_back(join_words(words, words.size()));
+        }
+    }
+}
+
+std::string SyntheticRecognizer::finalize() {
+    if (utterance_start_s_ < 0.0) {
+        return format_final({ {} });
+    }
+    std::vector<std::vector<std::string>> hypotheses = split_hypotheses(config_.script[script_index_]);
+    const std::vector<std::string>& words = hypotheses.front();
+    if (!grammar_.empty() &&
+        std::find(grammar_.begin(), grammar_.end(), join_words(words, words.size())) == grammar_.end()) {
+        hypotheses = { { "[unk]" } };
+    }
+    std::string json = format_final(hypotheses);
+    script_index_ = (script_index_ + 1) % config_.script.size();
+    utterance_count_++;
+    speech_ms_ = 0.0;
+    trailing_silence_ms_ = 0.0;
+    utterance_start_s_ = -1.0;
+    return json;
+}
+
+const std::string& SyntheticRecognizer::result() {
+    if (!pending_final_.empty()) {
+        last_result_ = std::move(pending_final_);
+        pending_final_.clear();
+    } else {
+        last_result_ = finalize();
+    }
+    return last_result_;
+}
+
+const std::string& SyntheticRecognizer::partial_result() {
+    std::string text;
+    if (utterance_start_s_ >= 0.0) {
+        std::vector<std::string> words = split_hypotheses(config_.script[script_index_]).front();
+        size_t revealed = static_cast<size_t>(speech_ms_ * config_.words_per_second / 1000.0);
+        text = join_words(words, revealed);
+    }
+    last_result_ = "{\"partial\" : \"" + escape_json(text) + "\"}";
+    return last_result_;
+}
+
+const std::string& SyntheticRecognizer::final_result() {
+    return result();
+}
+
+void SyntheticRecognizer::reset() {
+    speech_ms_ = 0.0;
+    trailing_silence_ms_ = 0.0;
+    utterance_start_s_ = -1.0;
+    pending_final_.clear();
+}
+
+static RecognizerCapabilities synthetic_capabilities() {
+    RecognizerCapabilities capabilities;
+    capabilities.engine = "synthetic";
+    capabilities.streaming_partials = true;
+    capabilities.endpointing = true;
+    capabilities.word_timings = true;
+    capabilities.alternatives = true;
+    capabilities.grammar = true;
+    return capabilities;
+}
+
+SyntheticSpeechModel::SyntheticSpeechModel(const SyntheticRecognizerConfig& config)
+    : config_(config) {
+    // Written, not just reserved, so the pages count toward resident memory
+    if (config_.model_mb > 0.0) {
+        weights_.assign(static_cast<size_t>(config_.model_mb * 1024 * 1024), 1);
+    }
+}
+
+std::unique_ptr<StreamingRecognizer> SyntheticSpeechModel::create_recognizer(float sample_rate, std::string& error) {
+    if (sample_rate <= 0.0f) {
+        error = "Invalid sample rate";
+        return nullptr;
+    }
+    return std::make_unique<SyntheticStreamingRecognizer>(config_, sample_rate);
+}
+
+std::unique_ptr<StreamingRecognizer> SyntheticSpeechModel::create_grammar_recognizer(
+    float sample_rate, const std::vector<std::string>& phrases, std::string& error) {
+    if (phrases.empty()) {
+        error = "Grammar has no phrases";
+        return nullptr;
+    }
+    std::unique_ptr<StreamingRecognizer> recognizer = create_recognizer(sample_rate, error);
+    if (recognizer) {
+        static_cast<SyntheticStreamingRecognizer&>(*recognizer).set_grammar(phrases);
+    }
+    return recognizer;
+}
+
+RecognizerCapabilities SyntheticSpeechModel::capabilities() const {
+    return synthetic_capabilities();
+}
+
+SyntheticStreamingRecognizer::SyntheticStreamingRecognizer(const SyntheticRecognizerConfig& config, float sample_rate)
+    : recognizer_(config, sample_rate) {
+    recognizer_.set_words(true);
+}
+
+bool SyntheticStreamingRecognizer::accept_waveform(const float* samples, size_t count) {
+    pcm_.resize(count);
+    float_to_int16(samples, pcm_.data(), count);
+    return recognizer_.accept_waveform(pcm_.data(), count);
+}
+
+TranscriptionResult SyntheticStreamingRecognizer::parse(const std::string& json, bool is_final) {
+    TranscriptionResult result{};
+    {
+        ScopedTimer timer(Stage::JsonParse);
+        TraceSpan span(trace_span::kJsonParse, trace_sequence_);
+        parse_vosk_result(json, result, last_error_);
+    }
+    result.is_final = is_final;
+    return result;
+}
+
+TranscriptionResult SyntheticStreamingRecognizer::partial_result() {
+    return parse(recognizer_.partial_result(), false);
+}
+
+TranscriptionResult SyntheticStreamingRecognizer::result() {
+    return parse(recognizer_.result(), true);
+}
+
+TranscriptionResult SyntheticStreamingRecognizer::final_result() {
+    return parse(recognizer_.final_result(), true);
+}
+
+void SyntheticStreamingRecognizer::set_grammar(const std::vector<std::string>& phrases) {
+    recognizer_.set_grammar(phrases);
+}
+
+bool SyntheticStreamingRecognizer::set_max_alternatives(int max_alternatives) {
+    recognizer_.set_max_alternatives(std::max(0, max_alternatives));
+    return true;
+}
+
+void SyntheticStreamingRecognizer::reset() {
+    recognizer_.reset();
+}
+
+RecognizerCapabilities SyntheticStreamingRecognizer::capabilities() const {
+    return synthetic_capabilities();
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,113 @@
+// Vosk C API over the synthetic recognizer. Linked instead of libvosk when it
+// is missing, and in the test and benchmark builds.
+
+#include "synthetic_recognizer.h"
+#include <vosk_api.h>
+#include <rapidjson/document.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using voice_transcription::SyntheticRecognizer;
+using voice_transcription::SyntheticRecognizerConfig;
+
+struct VoskModel {
+    SyntheticRecognizerConfig config;
+};
+
+struct VoskRecognizer {
+    SyntheticRecognizer recognizer;
+};
+
+extern "C" {
+
+VoskModel* vosk_model_new(const char* model_path) {
+    if (!model_path) {
+        return nullptr;
+    }
+    auto model = std::make_unique<VoskModel>();
+    std::string error;
+    if (!SyntheticRecognizerConfig::load(model_path, model->config, error)) {
+        std::fprintf(stderr, "Synthetic recognizer: %s\n", error.c_str());
+        return nullptr;
+    }
+    return model.release();
+}
+
+void vosk_model_free(VoskModel* model) {
+    delete model;
+}
+
+VoskRecognizer* vosk_recognizer_new(VoskModel* model, float sample_rate) {
+    if (!model || sample_rate <= 0.0f) {
+        return nullptr;
+    }
+    return new VoskRecognizer{ SyntheticRecognizer(model->config, sample_rate) };
+}
+
+VoskRecognizer* vosk_recognizer_new_grm(VoskModel* model, float sample_rate, const char* grammar) {
+    rapidjson::Document document;
+    if (grammar) {
+        document.Parse(grammar);
+    }
+    if (!grammar || document.HasParseError() || !document.IsArray()) {
+        std::fprintf(stderr, "Synthetic recognizer: grammar is not a JSON array\n");
+        return nullptr;
+    }
+    std::vector<std::string> phrases;
+    for (rapidjson::SizeType i = 0; i < document.Size(); i++) {
+        if (document[i].IsString()) {
+            phrases.emplace_back(document[i].GetString(), document[i].GetStringLength());
+        }
+    }
+    VoskRecognizer* recognizer = vosk_recognizer_new(model, sample_rate);
+    if (recognizer) {
+        recognizer->recognizer.set_grammar(phrases);
+    }
+    return recognizer;
+}
+
+void vosk_recognizer_free(VoskRecognizer* recognizer) {
+    delete recognizer;
+}
+
+void vosk_recognizer_set_max_alternatives(VoskRecognizer* recognizer, int max_alternatives) {
+    if (recognizer) {
+        recognizer->recognizer.set_max_alternatives(max_alternatives);
+    }
+}
+
+void vosk_recognizer_set_words(VoskRecognizer* recognizer, int words) {
+    if (recognizer) {
+        recognizer->recognizer.set_words(words != 0);
+    }
+}
+
+int vosk_recognizer_accept_waveform(VoskRecognizer* recognizer, const char* data, int length) {
+    if (!recognizer || !data || length < 0) {
+        return -1;
+    }
+    return recognizer->recognizer.accept_waveform(reinterpret_cast<const int16_t*>(data),
+                                                  static_cast<size_t>(length) / sizeof(int16_t)) ? 1 : 0;
+}
+
+const char* vosk_recognizer_result(VoskRecognizer* recognizer) {
+    return recognizer->recognizer.result().c_str();
+}
+
+const char* vosk_recognizer_partial_result(VoskRecognizer* recognizer) {
+    return recognizer->recognizer.partial_result().c_str();
+}
+
+const char* vosk_recognizer_final_result(VoskRecognizer* recognizer) {
+    return recognizer->recognizer.final_result().c_str();
+}
+
+void vosk_recognizer_reset(VoskRecognizer* recognizer) {
+    if (recognizer) {
+        recognizer->recognizer.reset();
+    }
+}
+
+} // extern "C"
\ No newline at end of file
@@ -0,0 +1,264 @@
+#include "trace_recorder.h"
+#include "json_escape.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace voice_transcription {
+
+// Minimum spacing between automatic dumps, so one slow patch writes one file
+static constexpr int64_t kTriggerCooldownUs = 10 * 1000 * 1000;
+
+static const char* const kSpanNames[] = {
+    trace_span::kCapture,
+    trace_span::kRingWait,
+    trace_span::kVad,
+    trace_span::kNoiseFilter,
+    trace_span::kDecode,
+    trace_span::kFinalize,
+    trace_span::kJsonParse,
+    trace_span::kTextNormalization,
+    trace_span::kCommandProcessing,
+    trace_span::kOutput
+};
+
+static thread_local bool realtime_thread = false;
+
+int64_t trace_clock_us() {
+    // Both clocks are read once; after that only the steady clock is used
+    static const auto steady_base = std::chrono::steady_clock::now();
+    static const int64_t epoch_base_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    return epoch_base_us + std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - steady_base).count();
+}
+
+TraceRecorder::TraceRecorder()
+    : enabled_(false),
+      trigger_threshold_us_(0),
+      last_trigger_us_(0),
+      triggered_dumps_(0) {
+}
+
+TraceRecorder& TraceRecorder::instance() {
+    // Never destroyed, so threads still running at exit can keep recording
+    static TraceRecorder* recorder = new TraceRecorder();
+    return *recorder;
+}
+
+TraceRecorder::BufferOwner::~BufferOwner() {
+    if (buffer) {
+        TraceRecorder::instance().release_buffer(buffer);
+    }
+}
+
+TraceRecorder::ThreadBuffer& TraceRecorder::local_buffer() {
+    thread_local BufferOwner owner;
+    if (!owner.buffer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ThreadBuffer* buffer;
+        if (free_buffers_.empty()) {
+            buffers_.push_back(std::make_unique<ThreadBuffer>());
+            buffer = buffers_.back().get();
+        } else {
+            // The exited thread's spans go now
+            buffer = free_buffers_.front();
+            free_buffers_.erase(free_buffers_.begin());
+            buffer->cleared.store(buffer->head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            buffer->thread_name.clear();
+        }
+        // A fresh id, so the viewer does not put two threads on one row
+        buffer->thread_id = ++next_thread_id_;
+        owner.buffer = buffer;
+    }
+    return *owner.buffer;
+}
+
+void TraceRecorder::release_buffer(ThreadBuffer* buffer) {
+    // Its spans stay in dumps until another thread takes the ring
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_buffers_.push_back(buffer);
+}
+
+size_t TraceRecorder::buffer_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffers_.size();
+}
+
+void TraceRecorder::record(const char* name, uint64_t sequence, int64_t begin_us, int64_t end_us) {
+    if (!is_enabled() || !name) {
+        return;
+    }
+
+    ThreadBuffer& buffer = local_buffer();
+    uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index % kEventsPerThread];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.sequence.store(sequence, std::memory_order_relaxed);
+    slot.begin_us.store(begin_us, std::memory_order_relaxed);
+    slot.end_us.store(end_us, std::memory_order_relaxed);
+    buffer.head.store(index + 1, std::memory_order_release);
+
+    if (!realtime_thread) {
+        check_trigger(end_us - begin_us);
+    }
+}
+
+void TraceRecorder::set_thread_name(const std::string& name) {
+    ThreadBuffer& buffer = local_buffer();
+    std::lock_guard<std::mutex> lock(mutex_);
+    buffer.thread_name = name;
+}
+
+void TraceRecorder::mark_realtime_thread() {
+    realtime_thread = true;
+}
+
+void TraceRecorder::set_dump_trigger(int64_t threshold_us, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    trigger_path_ = path;
+    trigger_threshold_us_.store(path.empty() ? 0 : std::max<int64_t>(threshold_us, 0));
+    last_trigger_us_.store(0);
+}
+
+// Insert a timestamp before the extension, so successive dumps don't overwrite each other
+static std::string timestamped_path(const std::string& path, int64_t now_us) {
+    std::string stamp = "-" + std::to_string(now_us / 1000);
+    size_t dot = path.rfind('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return path + stamp;
+    }
+    return path.substr(0, dot) + stamp + path.substr(dot);
+}
+
+void TraceRecorder::check_trigger(int64_t duration_us) {
+    int64_t threshold = trigger_threshold_us_.load(std::memory_order_relaxed);
+    if (threshold <= 0 || duration_us < threshold) {
+        return;
+    }
+
+    int64_t now = trace_clock_us();
+    int64_t last = last_trigger_us_.load();
+    if (last != 0 && now - last < kTriggerCooldownUs) {
+        return;
+    }
+    // Only one thread wins the right to dump
+    if (!last_trigger_us_.compare_exchange_strong(last, now)) {
+        return;
+    }
+
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = trigger_path_;
+    }
+    if (!path.empty() && write_json(timestamped_path(path, now))) {
+        triggered_dumps_.fetch_add(1);
+    }
+}
+
+void TraceRecorder::collect(std::vector<std::pair<uint32_t, Event>>& events) const {
+    for (const auto& buffer : buffers_) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(buffer->cleared.load(std::memory_order_relaxed),
+                                  head > kEventsPerThread ? head - kEventsPerThread : 0);
+
+        std::vector<Event> copied;
+        copied.reserve(static_cast<size_t>(head - first));
+        for (uint64_t i = first; i < head; i++) {
+            const Slot& slot = buffer->slots[i % kEventsPerThread];
+            // Acquire loads keep the head re-check below from moving above the copy
+            copied.push_back({slot.name.load(std::memory_order_acquire),
+                              slot.sequence.load(std::memory_order_acquire),
+                              slot.begin_us.load(std::memory_order_acquire),
+                              slot.end_us.load(std::memory_order_acquire)});
+        }
+
+        // Anything the writer reached during the copy may be torn; keep only
+        // slots it cannot have touched, including the one it may be filling now
+        uint64_t head_after = buffer->head.load(std::memory_order_relaxed);
+        uint64_t safe_from = head_after + 1 > kEventsPerThread ? head_after + 1 - kEventsPerThread : 0;
+
+        for (uint64_t i = first; i < head; i++) {
+            if (i >= safe_from && copied[i - first].name) {
+                events.emplace_back(buffer->thread_id, copied[i - first]);
+            }
+        }
+    }
+}
+
+std::string TraceRecorder::to_json() const {
+    std::vector<std::pair<uint32_t, Event>> events;
+    std::vector<std::pair<uint32_t, std::string>> thread_names;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        collect(events);
+        for (const auto& buffer : buffers_) {
+            if (!buffer->thread_name.empty()) {
+                thread_names.emplace_back(buffer->thread_id, buffer->thread_name);
+            }
+        }
+    }
+
+    std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+        return a.second.begin_us < b.second.begin_us;
+    });
+
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& name : thread_names) {
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+            << name.first << ",\"args\":{\"name\":\"" << escape_json(name.second) << "\"}}";
+        first = false;
+    }
+    for (const auto& entry : events) {
+        const Event& event = entry.second;
+        out << (first ? "" : ",") << "\n{\"name\":\"" << event.name
+            << "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":" << entry.first
+            << ",\"ts\":" << event.begin_us
+            << ",\"dur\":" << std::max<int64_t>(event.end_us - event.begin_us, 0)
+            << ",\"args\":{\"chunk\":" << event.sequence << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+bool TraceRecorder::write_json(const std::string& path) const {
+    // Write then rename, so a viewer never opens a half-written file
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file << to_json();
+        if (!file) {
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& buffer : buffers_) {
+        buffer->cleared.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+const char* TraceRecorder::intern_span_name(const std::string& name) {
+    for (const char* span_name : kSpanNames) {
+        if (name == span_name) {
+            return span_name;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
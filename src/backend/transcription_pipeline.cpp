@@ -0,0 +1,130 @@
+#include "transcription_pipeline.h"
+#include "endpointer.h"
+#include "vosk_transcription_engine.h"
+#include "webrtc_vad.h"
+#include <cmath>
+
+namespace voice_transcription {
+
+// How long the decode thread waits for a chunk before checking for a stop
+static const int kChunkWaitMs = 100;
+
+TranscriptionPipeline::TranscriptionPipeline(AudioInputStream& stream, VoskTranscriber& transcriber,
+                                             const TranscriptionPipelineConfig& config)
+    : stream_(stream),
+      transcriber_(transcriber),
+      config_(config),
+      results_(std::make_shared<ResultQueue>(config.queue_capacity)) {
+}
+
+TranscriptionPipeline::~TranscriptionPipeline() {
+    stop();
+}
+
+bool TranscriptionPipeline::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        last_error_ = "Pipeline is already running";
+        return false;
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (!transcriber_.is_model_loaded()) {
+        last_error_ = transcriber_.is_loading() ? "Model is still loading" : "Model not loaded";
+        return false;
+    }
+    const int sample_rate = stream_.get_sample_rate();
+    const int frames = stream_.get_frames_per_buffer();
+    if (sample_rate <= 0 || frames <= 0) {
+        last_error_ = "Invalid stream format";
+        return false;
+    }
+
+    // The VAD looks at one 10, 20 or 30 ms frame at the start of each chunk
+    const int chunk_ms = static_cast<int>(std::lround(frames * 1000.0 / sample_rate));
+    int vad_frame_ms = chunk_ms >= 30 ? 30 : (chunk_ms >= 20 ? 20 : 10);
+    vad_ = std::make_unique<VADHandler>(sample_rate, vad_frame_ms, config_.vad_aggressiveness);
+
+    if (!stream_.is_active() && !stream_.start()) {
+        last_error_ = stream_.get_last_error();
+        return false;
+    }
+    transcriber_.reset();
+    if (results_->is_closed()) {
+        results_ = std::make_shared<ResultQueue>(config_.queue_capacity);
+    }
+    stop_requested_ = false;
+    running_ = true;
+    thread_ = std::thread(&TranscriptionPipeline::run, this, chunk_ms);
+    return true;
+}
+
+void TranscriptionPipeline::request_stop() {
+    stop_requested_ = true;
+}
+
+void TranscriptionPipeline::stop() {
+    request_stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::shared_ptr<ResultQueue> TranscriptionPipeline::get_results() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return results_;
+}
+
+std::string TranscriptionPipeline::get_last_error() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_error_;
+}
+
+void TranscriptionPipeline::publish(const TranscriptionResult& result) {
+    if (result.raw_text.empty() || (!result.is_final && !config_.partial_results)) {
+        return;
+    }
+    results_->push(result);
+}
+
+void TranscriptionPipeline::run(int chunk_ms) {
+    Endpointer endpointer(config_.hangover_ms, chunk_ms);
+    const int frames = stream_.get_frames_per_buffer();
+    uint64_t next_sequence = 0;
+
+    // Same gating as the transcription loop: utterance chunks and their hangover
+    while (!stop_requested_ && stream_.is_active()) {
+        std::optional<AudioChunk> chunk = stream_.get_next_chunk(kChunkWaitMs);
+        if (!chunk) {
+            continue;
+        }
+        next_sequence = chunk->sequence() + 1;
+        bool is_speech = vad_->is_speech(*chunk);
+        endpointer.update(is_speech);
+        if (endpointer.in_utterance()) {
+            auto owned = std::make_unique<AudioChunk>(std::move(*chunk));
+            publish(transcriber_.is_noise_filtering_enabled()
+                ? transcriber_.transcribe_with_noise_filtering(std::move(owned), is_speech)
+                : transcriber_.transcribe_with_vad(std::move(owned), is_speech));
+        }
+    }
+
+    // Speech still open is finalized with a silent chunk, as when dictation stops
+    if (endpointer.in_utterance()) {
+        auto silence = std::make_unique<AudioChunk>(static_cast<size_t>(frames));
+        silence->set_sequence(next_sequence);
+        silence->set_first_sample(next_sequence * static_cast<uint64_t>(frames));
+        publish(transcriber_.transcribe_with_vad(std::move(silence), false));
+    }
+    stream_.stop();
+    if (!stop_requested_) {
+        // The stream ended on its own: the end of a recording, or a device that failed
+        std::lock_guard<std::mutex> lock(mutex_);
+        last_error_ = stream_.get_last_error();
+    }
+    running_ = false;
+    results_->close();
+}
+
+} // namespace voice_transcription
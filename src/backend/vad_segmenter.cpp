@@ -0,0 +1,100 @@
+#include "vad_segmenter.h"
+#include "webrtc_vad.h"
+#include <algorithm>
+
+namespace voice_transcription {
+
+void SpeechTimeline::add(const SampleRange& region) {
+    if (region.end_sample <= region.start_sample) {
+        return;
+    }
+    if (!regions_.empty() && region.start_sample <= regions_.back().end_sample) {
+        SampleRange& last = regions_.back();
+        size_t end = std::max(last.end_sample, region.end_sample);
+        kept_samples_ += end - last.end_sample;
+        last.end_sample = end;
+        return;
+    }
+    regions_.push_back(region);
+    kept_before_.push_back(kept_samples_);
+    kept_samples_ += region.end_sample - region.start_sample;
+}
+
+size_t SpeechTimeline::to_original(size_t position) const {
+    if (regions_.empty()) {
+        return position;
+    }
+    // Last region starting at or before position
+    auto it = std::upper_bound(kept_before_.begin(), kept_before_.end(), position);
+    size_t index = static_cast<size_t>(it - kept_before_.begin()) - 1;
+    return std::min(regions_[index].start_sample + (position - kept_before_[index]),
+                    regions_[index].end_sample);
+}
+
+size_t SpeechTimeline::to_original_end(size_t position) const {
+    if (regions_.empty()) {
+        return position;
+    }
+    // Last region starting strictly before position
+    auto it = std::lower_bound(kept_before_.begin(), kept_before_.end(), position);
+    if (it == kept_before_.begin()) {
+        return regions_.front().start_sample;
+    }
+    size_t index = static_cast<size_t>(it - kept_before_.begin()) - 1;
+    return std::min(regions_[index].start_sample + (position - kept_before_[index]),
+                    regions_[index].end_sample);
+}
+
+SpeechTimeline SpeechTimeline::slice(const SampleRange& range) const {
+    SpeechTimeline result;
+    for (const auto& region : regions_) {
+        result.add({ std::max(region.start_sample, range.start_sample),
+                     std::min(region.end_sample, range.end_sample) });
+    }
+    return result;
+}
+
+VadSegmenter::VadSegmenter(const VadSegmenterConfig& config, int sample_rate)
+    : config_(config),
+      sample_rate_(sample_rate),
+      frame_size_(static_cast<size_t>(sample_rate) * kFrameMs / 1000) {
+}
+
+std::vector<uint8_t> VadSegmenter::classify(const float* samples, size_t count) const {
+    if (frame_size_ == 0) {
+        return {};
+    }
+    VADHandler vad(sample_rate_, kFrameMs, config_.vad_aggressiveness);
+    return vad.classify_frames(samples, count);
+}
+
+SpeechTimeline VadSegmenter::segment(const float* samples, size_t count) const {
+    return regions_from_frames(classify(samples, count), count);
+}
+
+SpeechTimeline VadSegmenter::regions_from_frames(const std::vector<uint8_t>& speech, size_t total) const {
+    SpeechTimeline timeline;
+    size_t padding = static_cast<size_t>(std::max(0, config_.padding_ms)) * sample_rate_ / 1000;
+    size_t min_frames = static_cast<size_t>(std::max(1, config_.min_speech_ms / kFrameMs));
+
+    size_t f = 0;
+    while (f < speech.size()) {
+        if (!speech[f]) {
+            f++;
+            continue;
+        }
+        size_t run_start = f;
+        while (f < speech.size() && speech[f]) {
+            f++;
+        }
+        if (f - run_start < min_frames) {
+            continue;
+        }
+        size_t start = run_start * frame_size_;
+        size_t end = std::min(f * frame_size_, total);
+        timeline.add({ start > padding ? start - padding : 0, std::min(end + padding, total) });
+    }
+    return timeline;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
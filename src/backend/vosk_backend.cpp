@@ -0,0 +1,127 @@
+#include "vosk_backend.h"
+#include "json_escape.h"
+#include "metrics.h"
+#include "sample_conversion.h"
+#include "trace_recorder.h"
+#include "vosk_result_parser.h"
+#include <algorithm>
+
+namespace voice_transcription {
+
+static RecognizerCapabilities vosk_capabilities() {
+    RecognizerCapabilities capabilities;
+    capabilities.engine = "vosk";
+    capabilities.streaming_partials = true;
+    capabilities.endpointing = true;
+    capabilities.word_timings = true;
+    capabilities.alternatives = true;
+    capabilities.grammar = true;
+    return capabilities;
+}
+
+VoskSpeechModel::VoskSpeechModel(const std::string& model_path, std::string& error)
+    : model_(vosk_model_new(model_path.c_str())) {
+    if (!model_) {
+        error = "Failed to load model from path: " + model_path;
+    }
+}
+
+VoskSpeechModel::~VoskSpeechModel() {
+    if (model_) {
+        vosk_model_free(model_);
+    }
+}
+
+std::unique_ptr<StreamingRecognizer> VoskSpeechModel::create_recognizer(float sample_rate, std::string& error) {
+    VoskRecognizer* recognizer = model_ ? vosk_recognizer_new(model_, sample_rate) : nullptr;
+    if (!recognizer) {
+        error = "Failed to create recognizer";
+        return nullptr;
+    }
+    // Any max_alternatives above 0 switches Vosk to n-best output, which has
+    // no per-word confidence, so it stays off until requested
+    vosk_recognizer_set_max_alternatives(recognizer, 0);
+    vosk_recognizer_set_words(recognizer, 1);
+    return std::make_unique<VoskStreamingRecognizer>(recognizer);
+}
+
+std::unique_ptr<StreamingRecognizer> VoskSpeechModel::create_grammar_recognizer(
+    float sample_rate, const std::vector<std::string>& phrases, std::string& error) {
+    if (phrases.empty()) {
+        error = "Grammar has no phrases";
+        return nullptr;
+    }
+    // "[unk]" absorbs speech outside the list instead of forcing the nearest phrase
+    std::string grammar = "[";
+    for (const std::string& phrase : phrases) {
+        grammar += "\"" + escape_json(phrase) + "\", ";
+    }
+    grammar += "\"[unk]\"]";
+
+    VoskRecognizer* recognizer = model_ ? vosk_recognizer_new_grm(model_, sample_rate, grammar.c_str()) : nullptr;
+    if (!recognizer) {
+        error = "Failed to create grammar recognizer";
+        return nullptr;
+    }
+    vosk_recognizer_set_max_alternatives(recognizer, 0);
+    vosk_recognizer_set_words(recognizer, 1);
+    return std::make_unique<VoskStreamingRecognizer>(recognizer);
+}
+
+RecognizerCapabilities VoskSpeechModel::capabilities() const {
+    return vosk_capabilities();
+}
+
+VoskStreamingRecognizer::VoskStreamingRecognizer(VoskRecognizer* recognizer)
+    : recognizer_(recognizer) {
+}
+
+VoskStreamingRecognizer::~VoskStreamingRecognizer() {
+    vosk_recognizer_free(recognizer_);
+}
+
+bool VoskStreamingRecognizer::accept_waveform(const float* samples, size_t count) {
+    // Vosk takes 16-bit PCM
+    pcm_.resize(count);
+    float_to_int16(samples, pcm_.data(), count);
+    return vosk_recognizer_accept_waveform(recognizer_, reinterpret_cast<const char*>(pcm_.data()),
+                                           static_cast<int>(count * sizeof(int16_t))) > 0;
+}
+
+TranscriptionResult VoskStreamingRecognizer::parse(const char* json, bool is_final) {
+    TranscriptionResult result{};
+    {
+        ScopedTimer timer(Stage::JsonParse);
+        TraceSpan span(trace_span::kJsonParse, trace_sequence_);
+        parse_vosk_result(json ? json : "", result, last_error_);
+    }
+    result.is_final = is_final;
+    return result;
+}
+
+TranscriptionResult VoskStreamingRecognizer::partial_result() {
+    return parse(vosk_recognizer_partial_result(recognizer_), false);
+}
+
+TranscriptionResult VoskStreamingRecognizer::result() {
+    return parse(vosk_recognizer_result(recognizer_), true);
+}
+
+TranscriptionResult VoskStreamingRecognizer::final_result() {
+    return parse(vosk_recognizer_final_result(recognizer_), true);
+}
+
+bool VoskStreamingRecognizer::set_max_alternatives(int max_alternatives) {
+    vosk_recognizer_set_max_alternatives(recognizer_, std::max(0, max_alternatives));
+    return true;
+}
+
+void VoskStreamingRecognizer::reset() {
+    vosk_recognizer_reset(recognizer_);
+}
+
+RecognizerCapabilities VoskStreamingRecognizer::capabilities() const {
+    return vosk_capabilities();
+}
+
+} // namespace voice_transcription
\ No newline at end of file
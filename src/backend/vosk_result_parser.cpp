@@ -0,0 +1,139 @@
+#include "vosk_result_parser.h"
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+namespace voice_transcription {
+
+static double number_member(const rapidjson::Value& object, const char* name, double fallback) {
+    auto member = object.FindMember(name);
+    return member != object.MemberEnd() && member->value.IsNumber() ? member->value.GetDouble() : fallback;
+}
+
+// Append the entries of a Vosk "result" word list to words. Words without a
+// "conf" (n-best output) get default_confidence; the others are added to
+// confidence_sum and confidence_count.
+static void parse_words(const rapidjson::Value& list, float default_confidence, TranscriptionResult& result,
+                        std::vector<WordInfo>& words, double& confidence_sum, int& confidence_count) {
+    for (const auto& entry : list.GetArray()) {
+        if (!entry.IsObject()) {
+            continue;
+        }
+        auto word = entry.FindMember("word");
+        if (word == entry.MemberEnd() || !word->value.IsString()) {
+            continue;
+        }
+
+        WordInfo info;
+        info.text_length = word->value.GetStringLength();
+        info.text_offset = result.add_text(std::string_view(word->value.GetString(), info.text_length));
+        info.start = static_cast<float>(number_member(entry, "start", 0.0));
+        info.end = static_cast<float>(number_member(entry, "end", info.start));
+        info.confidence = default_confidence;
+
+        auto conf = entry.FindMember("conf");
+        if (conf != entry.MemberEnd() && conf->value.IsNumber()) {
+            info.confidence = static_cast<float>(conf->value.GetDouble());
+            confidence_sum += conf->value.GetDouble();
+            confidence_count++;
+        }
+        words.push_back(info);
+    }
+}
+
+bool parse_vosk_result(const std::string& json, TranscriptionResult& result, std::string& error) {
+    rapidjson::Document doc;
+    rapidjson::ParseResult parse_result = doc.Parse(json.c_str(), json.size());
+
+    // Check if parsing failed
+    if (parse_result.IsError() || !doc.IsObject()) {
+        error = "JSON parse error: " + std::string(parse_result.IsError() ?
+            rapidjson::GetParseError_En(parse_result.Code()) : "result is not an object");
+        return false;
+    }
+
+    result.text_arena.clear();
+    result.words.clear();
+    result.alternatives.clear();
+    result.alternative_words.clear();
+
+    // With max_alternatives set, finals arrive as an n-best list, best first.
+    // Alternative confidences are decoder scores, not probabilities, so they
+    // only rank the list; the result confidence stays 1.0.
+    auto alternatives = doc.FindMember("alternatives");
+    if (alternatives != doc.MemberEnd() && alternatives->value.IsArray()) {
+        result.raw_text.clear();
+        result.is_final = true;
+        result.confidence = 1.0;
+
+        for (const auto& entry : alternatives->value.GetArray()) {
+            if (!entry.IsObject()) {
+                continue;
+            }
+            Alternative alternative{};
+            auto text = entry.FindMember("text");
+            if (text != entry.MemberEnd() && text->value.IsString()) {
+                alternative.text_length = text->value.GetStringLength();
+                alternative.text_offset = result.add_text(std::string_view(text->value.GetString(),
+                                                                           alternative.text_length));
+            } else {
+                alternative.text_offset = static_cast<uint32_t>(result.text_arena.size());
+            }
+            alternative.score = static_cast<float>(number_member(entry, "confidence", 0.0));
+            alternative.word_begin = static_cast<uint32_t>(result.alternative_words.size());
+
+            auto words = entry.FindMember("result");
+            if (words != entry.MemberEnd() && words->value.IsArray()) {
+                double unused_sum = 0.0;
+                int unused_count = 0;
+                parse_words(words->value, 1.0f, result, result.alternative_words, unused_sum, unused_count);
+            }
+            alternative.word_count = static_cast<uint32_t>(result.alternative_words.size()) - alternative.word_begin;
+            result.alternatives.push_back(alternative);
+        }
+
+        // The best entry is the result itself
+        if (!result.alternatives.empty()) {
+            const Alternative& best = result.alternatives.front();
+            result.raw_text.assign(result.text_of(best));
+            result.words.assign(result.alternative_words.begin() + best.word_begin,
+                                result.alternative_words.begin() + best.word_begin + best.word_count);
+        }
+        result.processed_text = result.raw_text;
+        return true;
+    }
+
+    // Check for "text" field (for final results)
+    auto text = doc.FindMember("text");
+    if (text != doc.MemberEnd() && text->value.IsString()) {
+        result.raw_text.assign(text->value.GetString(), text->value.GetStringLength());
+        result.processed_text = result.raw_text;
+        result.is_final = true;
+        result.confidence = 1.0; // Default if no words with confidence
+
+        // Word details: text, times and confidence, averaged for the result
+        auto words = doc.FindMember("result");
+        if (words != doc.MemberEnd() && words->value.IsArray()) {
+            double total_conf = 0.0;
+            int word_count = 0;
+            parse_words(words->value, 1.0f, result, result.words, total_conf, word_count);
+
+            if (word_count > 0) {
+                result.confidence = total_conf / word_count;
+            }
+        }
+        return true;
+    }
+
+    // Check for "partial" field (for partial results)
+    auto partial = doc.FindMember("partial");
+    if (partial != doc.MemberEnd() && partial->value.IsString()) {
+        result.raw_text.assign(partial->value.GetString(), partial->value.GetStringLength());
+        result.processed_text = result.raw_text;
+        result.is_final = false;
+        result.confidence = 0.5; // Default confidence for partial results
+    }
+
+    return true;
+}
+
+} // namespace voice_transcription
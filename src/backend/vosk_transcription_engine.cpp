@@ -1,168 +1,77 @@
 #include "vosk_transcription_engine.h"
 #include "webrtc_vad.h"  // Add this explicit include
+#include "noise_filter.h"
+#include "metrics.h"
+#include "model_cache.h"
+#include "trace_recorder.h"
 #include <chrono>
 #include <algorithm>
-#include <rapidjson/document.h>
-#include <rapidjson/error/en.h>
+#include <cmath>
+#include <cstring>
+#include <functional>
 namespace voice_transcription {
 
-// Simple noise filter implementation
-class NoiseFilter {
-public:
-    NoiseFilter(float threshold = 0.05f, int window_size = 10)
-        : noise_threshold_(threshold), window_size_(window_size) {
-        noise_floor_ = 0.0f;
-        calibrated_ = false;
-    }
-    
-    // Process an audio chunk to remove background noise
-    void filter(AudioChunk& chunk) {
-        if (!chunk.data() || chunk.size() == 0) {
-            return;
-        }
-        
-        // Calculate current frame energy
-        float frame_energy = calculate_energy(chunk);
-        
-        // Update noise floor estimate during silence periods
-        update_noise_floor(frame_energy);
-        
-        // Apply noise gate if energy is below threshold
-        if (frame_energy < noise_floor_ * 1.5f) {
-            // Apply soft noise gate (reduce amplitude rather than silence completely)
-            float reduction_factor = std::min(1.0f, frame_energy / (noise_floor_ * 1.5f));
-            reduction_factor = std::pow(reduction_factor, 2.0f); // Squared for more aggressive reduction
-            
-            // Apply reduction
-            for (size_t i = 0; i < chunk.size(); i++) {
-                chunk.data()[i] *= reduction_factor;
-            }
-        }
-        
-        // Apply spectral subtraction (simplified)
-        if (calibrated_) {
-            // Subtract estimated noise floor from each sample
-            for (size_t i = 0; i < chunk.size(); i++) {
-                float sample = chunk.data()[i];
-                float sign = sample >= 0 ? 1.0f : -1.0f;
-                float abs_sample = std::abs(sample);
-                
-                // Subtract noise floor (with flooring to avoid negative values)
-                float filtered = sign * std::max(0.0f, abs_sample - noise_floor_ * 0.5f);
-                
-                // Apply soft-decision filter
-                float gain = abs_sample < noise_floor_ ? 0.1f : 1.0f;
-                chunk.data()[i] = filtered * gain;
-            }
-        }
-    }
-    
-    // Calibrate the noise filter with background noise
-    void calibrate(const AudioChunk& chunk) {
-        if (!chunk.data() || chunk.size() == 0) {
-            return;
-        }
-        
-        // Calculate energy of the calibration frame
-        float frame_energy = calculate_energy(chunk);
-        
-        // Initialize noise floor with this energy
-        noise_floor_ = frame_energy;
-        noise_energy_history_.clear();
-        calibrated_ = true;
-    }
-    
-    // Auto-calibrate the noise filter with running energy estimates
-    void auto_calibrate(const AudioChunk& chunk, bool is_speech) {
-        if (!chunk.data() || chunk.size() == 0) {
-            return;
-        }
-        
-        // If this is silence (not speech), use it to calibrate
-        if (!is_speech) {
-            float frame_energy = calculate_energy(chunk);
-            
-            // Add to history
-            noise_energy_history_.push_back(frame_energy);
-            if (noise_energy_history_.size() > window_size_) {
-                noise_energy_history_.pop_front();
-            }
-            
-            // Update noise floor with average of recent silence frames
-            if (noise_energy_history_.size() >= 3) {
-                float avg_energy = 0.0f;
-                for (float e : noise_energy_history_) {
-                    avg_energy += e;
-                }
-                avg_energy /= noise_energy_history_.size();
-                
-                // Smooth transition for noise floor updates
-                if (!calibrated_) {
-                    noise_floor_ = avg_energy;
-                    calibrated_ = true;
-                } else {
-                    noise_floor_ = 0.9f * noise_floor_ + 0.1f * avg_energy;
-                }
-            }
+// Share of get_loading_progress() reached at the end of each loading phase
+static constexpr float kFilesReadProgress = 0.5f;
+static constexpr float kModelLoadedProgress = 0.9f;
+
+// About a second of voiced, syllable-paced signal between short pauses:
+// enough to run features, acoustic model, search and the final result once
+static std::vector<float> warmup_utterance(float sample_rate) {
+    const double kPi = 3.14159265358979323846;
+    size_t pause = static_cast<size_t>(0.2 * sample_rate);
+    size_t voiced = static_cast<size_t>(0.8 * sample_rate);
+    std::vector<float> samples(pause + voiced + pause, 0.0f);
+    for (size_t i = 0; i < voiced; i++) {
+        double t = i / static_cast<double>(sample_rate);
+        // 120 Hz glottal harmonics, loudest near 500 and 1500 Hz, at 4 syllables a second
+        double value = 0.0;
+        for (int harmonic = 1; harmonic <= 20; harmonic++) {
+            double frequency = 120.0 * harmonic;
+            double formants = std::exp(-std::pow((frequency - 500.0) / 300.0, 2)) +
+                              0.5 * std::exp(-std::pow((frequency - 1500.0) / 400.0, 2));
+            value += formants * std::sin(2.0 * kPi * frequency * t) / harmonic;
         }
+        double syllables = 0.5 - 0.5 * std::cos(2.0 * kPi * 4.0 * t);
+        samples[pause + i] = static_cast<float>(0.3 * syllables * value);
     }
-    
-    // Check if the filter is calibrated
-    bool is_calibrated() const {
-        return calibrated_;
-    }
-    
-    // Get the current noise floor
-    float get_noise_floor() const {
-        return noise_floor_;
-    }
-    
-    // Set the noise threshold directly
-    void set_noise_threshold(float threshold) {
-        noise_threshold_ = threshold;
-    }
-    
-private:
-    // Calculate energy of a frame
-    float calculate_energy(const AudioChunk& chunk) const {
-        float energy = 0.0f;
-        for (size_t i = 0; i < chunk.size(); i++) {
-            energy += chunk.data()[i] * chunk.data()[i];
-        }
-        return energy / chunk.size();
+    return samples;
+}
+
+// Decode the warm-up utterance so page faults in the weights and the
+// decoder's first allocations happen now rather than in the user's first
+// utterance. It runs on a scratch recognizer: the real one keeps a clean
+// stream clock, and the synthetic engine keeps its script position.
+static void warm_up_model(SpeechModel& model, float sample_rate, const std::function<void(float)>& progress) {
+    std::string error;
+    std::unique_ptr<StreamingRecognizer> recognizer = model.create_recognizer(sample_rate, error);
+    if (!recognizer) {
+        return;
     }
-    
-    // Update noise floor estimate
-    void update_noise_floor(float frame_energy) {
-        // If energy is very low, it's likely silence - use it to update noise floor
-        if (!calibrated_ || frame_energy < noise_floor_ * 1.2f) {
-            if (!calibrated_) {
-                noise_floor_ = frame_energy;
-                calibrated_ = true;
-            } else {
-                // Slowly adapt noise floor (90% old, 10% new)
-                noise_floor_ = 0.95f * noise_floor_ + 0.05f * frame_energy;
-            }
+
+    ScopedTimer timer(Stage::ModelWarmup);
+    std::vector<float> samples = warmup_utterance(sample_rate);
+    size_t chunk = std::max<size_t>(1, static_cast<size_t>(0.02 * sample_rate));
+    for (size_t offset = 0; offset < samples.size(); offset += chunk) {
+        size_t count = std::min(chunk, samples.size() - offset);
+        recognizer->accept_waveform(samples.data() + offset, count);
+        if (progress) {
+            progress(static_cast<float>(offset + count) / samples.size());
         }
     }
-    
-    float noise_threshold_;
-    float noise_floor_;
-    bool calibrated_;
-    int window_size_;
-    std::deque<float> noise_energy_history_;
-};
+    recognizer->final_result();
+}
 
 // Improved constructor with background loading
-VoskTranscriber::VoskTranscriber(const std::string& model_path, float sample_rate)
-    : model_(nullptr),
-      recognizer_(nullptr),
+VoskTranscriber::VoskTranscriber(const std::string& model_path, float sample_rate, const std::string& engine)
+    : use_noise_filtering_(false),
+      engine_(engine),
       sample_rate_(sample_rate),
       has_speech_started_(false),
       is_loading_(true),
       loading_progress_(0.0f),
-      model_path_(model_path),
-      use_noise_filtering_(false) {
+      loading_started_(std::chrono::steady_clock::now()),
+      model_path_(model_path) {
     
     // Start loading the model in a background thread
     loading_future_ = std::async(std::launch::async, 
@@ -173,63 +82,64 @@ VoskTranscriber::VoskTranscriber(const std::string& model_path, float sample_rat
 // Background model loading method
 bool VoskTranscriber::load_model_background() {
     try {
-        // Report initial progress
-        loading_progress_ = 0.1f;
-        
-        // Load model (this is the time-consuming operation)
-        loading_progress_ = 0.2f;
-        model_ = vosk_model_new(model_path_.c_str());
+        // The engines report nothing while they load, so progress comes from
+        // the file reads beforehand; a model already in memory skips them
+        loading_phase_ = LoadingPhase::ReadingFiles;
+        model_ = ModelCache::instance().acquire(engine_, model_path_, last_error_, false,
+            [this](uint64_t bytes_read, uint64_t total_bytes) {
+                if (total_bytes > 0) {
+                    loading_progress_ = kFilesReadProgress * bytes_read / total_bytes;
+                }
+                if (bytes_read == total_bytes) {
+                    loading_phase_ = LoadingPhase::LoadingModel;
+                }
+            });
         
         if (!model_) {
-            last_error_ = "Failed to load model from path: " + model_path_;
+            loading_phase_ = LoadingPhase::Failed;
             is_loading_ = false;
             loading_progress_ = 0.0f;
             return false;
         }
         
-        // Report progress
-        loading_progress_ = 0.7f;
-        
         // Create recognizer
-        recognizer_ = vosk_recognizer_new(model_, sample_rate_);
+        loading_phase_ = LoadingPhase::LoadingModel;
+        recognizer_ = model_->create_recognizer(sample_rate_, last_error_);
         
         if (!recognizer_) {
-            last_error_ = "Failed to create recognizer";
-            if (model_) {
-                vosk_model_free(model_);
-                model_ = nullptr;
-            }
+            model_.reset();
+            loading_phase_ = LoadingPhase::Failed;
             is_loading_ = false;
             loading_progress_ = 0.0f;
             return false;
         }
         
-        // Set recognizer options
-        loading_progress_ = 0.9f;
-        vosk_recognizer_set_max_alternatives(recognizer_, 1);
-        vosk_recognizer_set_words(recognizer_, 1);
+        loading_progress_ = kModelLoadedProgress;
+        loading_phase_ = LoadingPhase::WarmingUp;
+        warm_up_model(*model_, sample_rate_, [this](float done) {
+            loading_progress_ = kModelLoadedProgress + (1.0f - kModelLoadedProgress) * done;
+        });
         
         // Complete loading
         loading_progress_ = 1.0f;
+        loading_phase_ = LoadingPhase::Ready;
         is_loading_ = false;
         return true;
     } 
     catch (const std::exception& e) {
         last_error_ = "Exception during model loading: " + std::string(e.what());
-        if (model_) {
-            vosk_model_free(model_);
-            model_ = nullptr;
-        }
+        recognizer_.reset();
+        model_.reset();
+        loading_phase_ = LoadingPhase::Failed;
         is_loading_ = false;
         loading_progress_ = 0.0f;
         return false;
     }
     catch (...) {
         last_error_ = "Unknown exception during model loading";
-        if (model_) {
-            vosk_model_free(model_);
-            model_ = nullptr;
-        }
+        recognizer_.reset();
+        model_.reset();
+        loading_phase_ = LoadingPhase::Failed;
         is_loading_ = false;
         loading_progress_ = 0.0f;
         return false;
@@ -243,9 +153,8 @@ TranscriptionResult VoskTranscriber::create_empty_result() const {
     result.processed_text = "";
     result.is_final = false;
     result.confidence = 0.0;
-    result.timestamp_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+    // Same clock as trace spans, so results can be matched against a trace
+    result.timestamp_ms = trace_clock_us() / 1000;
     return result;
 }
 
@@ -269,62 +178,81 @@ VoskTranscriber::~VoskTranscriber() {
         }
     }
     
-    // Clean up resources
-    if (recognizer_) {
-        vosk_recognizer_free(recognizer_);
-        recognizer_ = nullptr;
+    // A swap in flight owns its model until it is collected
+    if (swap_future_.valid()) {
+        try {
+            swap_future_.wait();
+        } catch (...) {
+        }
     }
     
-    if (model_) {
-        vosk_model_free(model_);
-        model_ = nullptr;
-    }
+    // Recognizers hold references into the model, so they go first
+    command_recognizer_.reset();
+    recognizer_.reset();
+    model_.reset();
 }
 
 // Move constructor and assignment operators
 VoskTranscriber::VoskTranscriber(VoskTranscriber&& other) noexcept
-    : model_(other.model_),
-      recognizer_(other.recognizer_),
+    : noise_filter_(std::move(other.noise_filter_)),
+      use_noise_filtering_(other.use_noise_filtering_),
+      normalizer_(std::move(other.normalizer_)),
+      use_inverse_text_normalization_(other.use_inverse_text_normalization_),
+      max_alternatives_(other.max_alternatives_.load()),
+      applied_max_alternatives_(other.applied_max_alternatives_),
+      vocabulary_(std::move(other.vocabulary_)),
+      command_recognizer_(std::move(other.command_recognizer_)),
+      command_phrases_(std::move(other.command_phrases_)),
+      command_phrases_changed_(other.command_phrases_changed_),
+      requested_mode_(other.requested_mode_.load()),
+      active_mode_(other.active_mode_),
+      engine_(std::move(other.engine_)),
+      model_(std::move(other.model_)),
+      recognizer_(std::move(other.recognizer_)),
       sample_rate_(other.sample_rate_),
+      last_error_(std::move(other.last_error_)),
       has_speech_started_(other.has_speech_started_),
-      noise_filter_(std::move(other.noise_filter_)),
-      use_noise_filtering_(other.use_noise_filtering_),
       is_loading_(other.is_loading_.load()),
       loading_progress_(other.loading_progress_.load()),
+      loading_phase_(other.loading_phase_.load()),
+      loading_started_(other.loading_started_),
       loading_future_(std::move(other.loading_future_)),
       model_path_(std::move(other.model_path_)),
-      last_error_(std::move(other.last_error_)) {
-    
-    other.model_ = nullptr;
-    other.recognizer_ = nullptr;
+      swap_future_(std::move(other.swap_future_)) {
 }
 
 VoskTranscriber& VoskTranscriber::operator=(VoskTranscriber&& other) noexcept {
     if (this != &other) {
-        // Clean up existing resources
-        if (recognizer_) {
-            vosk_recognizer_free(recognizer_);
-        }
-        if (model_) {
-            vosk_model_free(model_);
-        }
+        // Release existing resources, recognizers first
+        command_recognizer_.reset();
+        recognizer_.reset();
         
         // Move resources from other
-        model_ = other.model_;
-        recognizer_ = other.recognizer_;
+        engine_ = std::move(other.engine_);
+        model_ = std::move(other.model_);
+        recognizer_ = std::move(other.recognizer_);
         sample_rate_ = other.sample_rate_;
         has_speech_started_ = other.has_speech_started_;
         noise_filter_ = std::move(other.noise_filter_);
         use_noise_filtering_ = other.use_noise_filtering_;
+        normalizer_ = std::move(other.normalizer_);
+        use_inverse_text_normalization_ = other.use_inverse_text_normalization_;
+        max_alternatives_ = other.max_alternatives_.load();
+        applied_max_alternatives_ = other.applied_max_alternatives_;
+        vocabulary_ = std::move(other.vocabulary_);
         is_loading_ = other.is_loading_.load();
         loading_progress_ = other.loading_progress_.load();
+        loading_phase_ = other.loading_phase_.load();
+        loading_started_ = other.loading_started_;
         loading_future_ = std::move(other.loading_future_);
         model_path_ = std::move(other.model_path_);
+        swap_future_ = std::move(other.swap_future_);
+        command_recognizer_ = std::move(other.command_recognizer_);
+        command_phrases_ = std::move(other.command_phrases_);
+        command_phrases_changed_ = other.command_phrases_changed_;
+        requested_mode_ = other.requested_mode_.load();
+        active_mode_ = other.active_mode_;
         last_error_ = std::move(other.last_error_);
-        
-        // Clear other's resources
-        other.model_ = nullptr;
-        other.recognizer_ = nullptr;
     }
     return *this;
 }
@@ -338,6 +266,14 @@ bool VoskTranscriber::is_noise_filtering_enabled() const {
     return use_noise_filtering_;
 }
 
+void VoskTranscriber::enable_inverse_text_normalization(bool enable) {
+    use_inverse_text_normalization_ = enable;
+}
+
+bool VoskTranscriber::is_inverse_text_normalization_enabled() const {
+    return use_inverse_text_normalization_;
+}
+
 void VoskTranscriber::calibrate_noise_filter(const AudioChunk& silence_chunk) {
     if (!noise_filter_) {
         noise_filter_ = std::make_unique<NoiseFilter>(0.05f, 10);
@@ -356,6 +292,7 @@ TranscriptionResult VoskTranscriber::transcribe_with_noise_filtering(
     // Make a copy of the chunk for noise filtering
     auto filtered_chunk = std::make_unique<AudioChunk>(chunk->size());
     std::memcpy(filtered_chunk->data(), chunk->data(), chunk->size() * sizeof(float));
+    filtered_chunk->copy_timeline(*chunk);
     
     // Apply noise filtering if enabled
     if (noise_filter_ && use_noise_filtering_) {
@@ -365,6 +302,8 @@ TranscriptionResult VoskTranscriber::transcribe_with_noise_filtering(
         }
         
         // Apply the filter to the chunk
+        ScopedTimer timer(Stage::NoiseFilter);
+        TraceSpan span(trace_span::kNoiseFilter, chunk->sequence());
         noise_filter_->filter(*filtered_chunk);
     }
     
@@ -381,6 +320,30 @@ bool VoskTranscriber::is_loading() const {
     return is_loading_.load();
 }
 
+double VoskTranscriber::get_loading_eta_seconds() const {
+    if (!is_loading_.load()) {
+        return 0.0;
+    }
+    float progress = loading_progress_.load();
+    if (progress <= 0.0f) {
+        return -1.0;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - loading_started_).count();
+    return elapsed * (1.0 - progress) / progress;
+}
+
+RecognizerCapabilities VoskTranscriber::get_capabilities() const {
+    if (is_loading_.load()) {
+        return RecognizerCapabilities{};
+    }
+    // adopt_swapped_model() replaces the model under the same lock
+    std::lock_guard<std::mutex> lock(recognizer_mutex_);
+    if (!model_) {
+        return RecognizerCapabilities{};
+    }
+    return model_->capabilities();
+}
+
 // Modified transcribe method that works with background loading
 TranscriptionResult VoskTranscriber::transcribe(std::unique_ptr<AudioChunk> chunk) {
     // Check if we're still loading
@@ -419,35 +382,39 @@ TranscriptionResult VoskTranscriber::transcribe(std::unique_ptr<AudioChunk> chun
     try {
         // Proceed with normal transcription
         std::lock_guard<std::mutex> lock(recognizer_mutex_);
-        
-        // Convert float samples to int16 for Vosk
-        std::vector<int16_t> pcm(chunk->size());
-        for (size_t i = 0; i < chunk->size(); i++) {
-            pcm[i] = static_cast<int16_t>(chunk->data()[i] * 32767.0f);
+
+        if (!utterance_open_) {
+            adopt_swapped_model();
+            update_recognition_mode();
+        }
+
+        // Vocabulary biasing rescores an N-best list
+        int max_alternatives = max_alternatives_;
+        if (!vocabulary_->empty()) {
+            max_alternatives = std::max(max_alternatives, kVocabularyAlternatives);
+        }
+        if (max_alternatives != applied_max_alternatives_) {
+            recognizer_->set_max_alternatives(max_alternatives);
+            applied_max_alternatives_ = max_alternatives;
         }
         
-        // Process audio data
-        std::string json_result;
-        bool is_final;
-        
-        // Process waveform through Vosk
-        const char* data_ptr = reinterpret_cast<const char*>(pcm.data());
-        int data_length = static_cast<int>(pcm.size() * sizeof(int16_t));
-        
-        if (vosk_recognizer_accept_waveform(recognizer_, data_ptr, data_length)) {
-            // End of utterance, get final result
-            json_result = vosk_recognizer_result(recognizer_);
-            is_final = true;
-        } else {
-            // Utterance continues, get partial result
-            json_result = vosk_recognizer_partial_result(recognizer_);
-            is_final = false;
+        StreamingRecognizer* recognizer = active_recognizer();
+        TranscriptionResult result;
+        {
+            ScopedTimer timer(Stage::AcceptWaveform);
+            TraceSpan span(trace_span::kDecode, chunk->sequence());
+            recognizer->set_trace_sequence(chunk->sequence());
+            extend_utterance(*chunk);
+            if (recognizer->accept_waveform(chunk->data(), chunk->size())) {
+                // End of utterance, get final result
+                result = recognizer->result();
+            } else {
+                // Utterance continues, get partial result
+                result = recognizer->partial_result();
+            }
         }
         
-        // Parse result
-        TranscriptionResult result = parse_result(json_result);
-        result.is_final = is_final;
-        return result;
+        return finish_result(std::move(result), chunk->sequence());
     } 
     catch (const std::exception& e) {
         last_error_ = "Exception during transcription: " + std::string(e.what());
@@ -470,9 +437,10 @@ TranscriptionResult VoskTranscriber::transcribe_with_vad(std::unique_ptr<AudioCh
     if (is_speech) {
         if (!has_speech_started_) {
             // Speech just started, reset the recognizer to start a new utterance
-            if (recognizer_) {
-                vosk_recognizer_reset(recognizer_);
+            if (StreamingRecognizer* recognizer = active_recognizer()) {
+                recognizer->reset();
             }
+            utterance_open_ = false;
             has_speech_started_ = true;
         }
         
@@ -486,11 +454,17 @@ TranscriptionResult VoskTranscriber::transcribe_with_vad(std::unique_ptr<AudioCh
             // Create a dummy result since there's no actual audio to process
             TranscriptionResult result = create_empty_result();
             
-            if (recognizer_) {
+            if (StreamingRecognizer* recognizer = active_recognizer()) {
                 // Get final result from recognizer
-                std::string json_result = vosk_recognizer_final_result(recognizer_);
-                result = parse_result(json_result);
-                result.is_final = true;
+                uint64_t sequence = chunk ? chunk->sequence() : 0;
+                TranscriptionResult final_result;
+                {
+                    ScopedTimer timer(Stage::AcceptWaveform);
+                    TraceSpan span(trace_span::kFinalize, sequence);
+                    recognizer->set_trace_sequence(sequence);
+                    final_result = recognizer->final_result();
+                }
+                result = finish_result(std::move(final_result), sequence);
             }
             
             return result;
@@ -501,13 +475,179 @@ TranscriptionResult VoskTranscriber::transcribe_with_vad(std::unique_ptr<AudioCh
     }
 }
 
+bool VoskTranscriber::set_max_alternatives(int max_alternatives) {
+    bool supported = true;
+    if (max_alternatives > 0 && !is_loading()) {
+        std::lock_guard<std::mutex> lock(recognizer_mutex_);
+        supported = !recognizer_ || recognizer_->capabilities().alternatives;
+    }
+    if (!supported) {
+        last_error_ = "Engine " + get_engine_name() + " has no N-best output";
+        return false;
+    }
+    // transcribe() hands it to the recognizer, which may still be loading
+    max_alternatives_ = std::max(0, max_alternatives);
+    return true;
+}
+
+bool VoskTranscriber::load_vocabulary(const std::string& path) {
+    return vocabulary_->load(path, last_error_);
+}
+
+bool VoskTranscriber::save_vocabulary(const std::string& path) {
+    return vocabulary_->save(path, last_error_);
+}
+
+bool VoskTranscriber::set_command_phrases(const std::vector<std::string>& phrases) {
+    if (!phrases.empty() && is_model_loaded() && !get_capabilities().grammar) {
+        last_error_ = "Engine " + get_engine_name() + " has no grammar mode";
+        return false;
+    }
+    // transcribe() builds the recognizer between utterances
+    std::lock_guard<std::mutex> lock(command_mutex_);
+    command_phrases_ = phrases;
+    command_phrases_changed_ = true;
+    return true;
+}
+
+void VoskTranscriber::update_recognition_mode() {
+    bool rebuild = false;
+    std::vector<std::string> phrases;
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        if (command_phrases_changed_) {
+            phrases = command_phrases_;
+            command_phrases_changed_ = false;
+            rebuild = true;
+        }
+    }
+    if (rebuild) {
+        command_recognizer_.reset();
+        if (!phrases.empty() && model_) {
+            command_recognizer_ = model_->create_grammar_recognizer(sample_rate_, phrases, last_error_);
+        }
+    }
+
+    RecognitionMode mode = requested_mode_;
+    if (mode != active_mode_ || rebuild) {
+        active_mode_ = mode;
+        active_recognizer()->reset();
+    }
+}
+
+StreamingRecognizer* VoskTranscriber::active_recognizer() const {
+    if (active_mode_ == RecognitionMode::Commands && command_recognizer_) {
+        return command_recognizer_.get();
+    }
+    return recognizer_.get();
+}
+
+bool VoskTranscriber::swap_model(const std::string& model_path, const std::string& engine) {
+    std::lock_guard<std::mutex> lock(swap_mutex_);
+    if (is_loading_.load() || swap_future_.valid()) {
+        last_error_ = "A model is already loading";
+        return false;
+    }
+
+    std::string new_engine = engine.empty() ? engine_ : engine;
+    float sample_rate = sample_rate_;
+    // Swapping to the model in use means it changed on disk, so read it again
+    bool reload = new_engine == engine_ && model_path == model_path_;
+    swap_future_ = std::async(std::launch::async, [new_engine, model_path, sample_rate, reload]() {
+        LoadedModel loaded;
+        loaded.engine = new_engine;
+        loaded.model_path = model_path;
+        try {
+            loaded.model = ModelCache::instance().acquire(new_engine, model_path, loaded.error, reload);
+            if (loaded.model) {
+                loaded.recognizer = loaded.model->create_recognizer(sample_rate, loaded.error);
+                if (!loaded.recognizer) {
+                    loaded.model.reset();
+                } else {
+                    warm_up_model(*loaded.model, sample_rate, nullptr);
+                }
+            }
+        } catch (const std::exception& e) {
+            loaded.recognizer.reset();
+            loaded.model.reset();
+            loaded.error = "Exception during model loading: " + std::string(e.what());
+        }
+        return loaded;
+    });
+    return true;
+}
+
+bool VoskTranscriber::is_swap_pending() const {
+    std::lock_guard<std::mutex> lock(swap_mutex_);
+    return swap_future_.valid();
+}
+
+std::string VoskTranscriber::get_model_path() const {
+    std::lock_guard<std::mutex> lock(swap_mutex_);
+    return model_path_;
+}
+
+std::string VoskTranscriber::get_engine_name() const {
+    std::lock_guard<std::mutex> lock(swap_mutex_);
+    return engine_;
+}
+
+void VoskTranscriber::adopt_swapped_model() {
+    LoadedModel loaded;
+    {
+        std::lock_guard<std::mutex> lock(swap_mutex_);
+        if (!swap_future_.valid() ||
+            swap_future_.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+            return;
+        }
+        loaded = swap_future_.get();
+    }
+    if (!loaded.model) {
+        last_error_ = "Model swap failed: " + loaded.error;
+        return;
+    }
+
+    // The old recognizers hold references into the old model, so they go
+    // first; the command recognizer is rebuilt on the new one
+    command_recognizer_.reset();
+    {
+        std::lock_guard<std::mutex> lock(command_mutex_);
+        command_phrases_changed_ = true;
+    }
+    recognizer_ = std::move(loaded.recognizer);
+    model_ = std::move(loaded.model);
+    std::lock_guard<std::mutex> lock(swap_mutex_);
+    engine_ = std::move(loaded.engine);
+    model_path_ = std::move(loaded.model_path);
+    // transcribe() passes max_alternatives on to the fresh recognizer
+    applied_max_alternatives_ = 0;
+}
+
 // Reset the recognizer
 void VoskTranscriber::reset() {
+    std::lock_guard<std::mutex> lock(recognizer_mutex_);
     if (recognizer_) {
-        std::lock_guard<std::mutex> lock(recognizer_mutex_);
-        vosk_recognizer_reset(recognizer_);
+        adopt_swapped_model();
+        update_recognition_mode();
+        recognizer_->reset();
+        if (command_recognizer_) {
+            command_recognizer_->reset();
+        }
     }
     has_speech_started_ = false;
+    utterance_open_ = false;
+}
+
+void VoskTranscriber::extend_utterance(const AudioChunk& chunk) {
+    if (!utterance_open_) {
+        utterance_open_ = true;
+        utterance_start_sample_ = chunk.first_sample();
+        utterance_start_us_ = chunk.capture_time_us();
+    }
+    utterance_end_sample_ = chunk.first_sample() + chunk.size();
+    utterance_end_us_ = chunk.capture_time_us() != 0 && sample_rate_ > 0
+        ? chunk.capture_time_us() + static_cast<int64_t>(chunk.size() * 1e6 / sample_rate_)
+        : 0;
 }
 
 // Modified is_model_loaded to work with background loading
@@ -516,98 +656,78 @@ bool VoskTranscriber::is_model_loaded() const {
     if (is_loading_.load() && loading_future_.valid()) {
         // Check if loading is complete without waiting
         auto status = loading_future_.wait_for(std::chrono::milliseconds(0));
-        if (status == std::future_status::ready) {
-            // It's done, but we don't change any state here - that happens in transcribe()
-            // We just report the current state
-            return model_ != nullptr && recognizer_ != nullptr;
-        } else {
+        if (status != std::future_status::ready) {
             // Still loading
             return false;
         }
+        // It's done, but we don't change any state here - that happens in transcribe()
+        // We just report the current state
     }
     
-    // Standard check
+    // Standard check; a swap replaces both under recognizer_mutex_
+    std::lock_guard<std::mutex> lock(recognizer_mutex_);
     return model_ != nullptr && recognizer_ != nullptr;
 }
 
-// Improved parse_result method with better error handling
-TranscriptionResult VoskTranscriber::parse_result(const std::string& json_result) {
-    TranscriptionResult result = create_empty_result();
+// Stamp an engine result and normalize final text
+TranscriptionResult VoskTranscriber::finish_result(TranscriptionResult result, uint64_t sequence) {
+    // Same clock as trace spans, so results can be matched against a trace
+    int64_t now_us = trace_clock_us();
+    result.timestamp_ms = now_us / 1000;
+    result.chunk_sequence = sequence;
+    result.command_mode = active_recognizer() == command_recognizer_.get();
+    if (result.command_mode && result.raw_text.find("[unk]") != std::string::npos) {
+        // Not a command; drop the text rather than guess the nearest phrase
+        TranscriptionResult rejected;
+        rejected.is_final = result.is_final;
+        rejected.confidence = 0.0;
+        rejected.command_mode = true;
+        result = std::move(rejected);
+        result.timestamp_ms = now_us / 1000;
+        result.chunk_sequence = sequence;
+    }
+    if (utterance_open_) {
+        result.start_sample = utterance_start_sample_;
+        result.end_sample = utterance_end_sample_;
+        result.start_capture_us = utterance_start_us_;
+        result.end_capture_us = utterance_end_us_;
+    }
     
     try {
-        // Parse the JSON using RapidJSON
-        rapidjson::Document doc;
-        rapidjson::ParseResult parseResult = doc.Parse(json_result.c_str());
-        
-        // Check if parsing failed
-        if (parseResult.IsError()) {
-            last_error_ = "JSON parse error: " + std::string(rapidjson::GetParseError_En(parseResult.Code()));
-            return result;
-        }
-        
-        // Check for "text" field (for final results)
-        if (doc.HasMember("text") && doc["text"].IsString()) {
-            result.raw_text = doc["text"].GetString();
-            result.processed_text = result.raw_text;
-            result.is_final = true;
-            
-            // Check for "result" field with word details
-            if (doc.HasMember("result") && doc["result"].IsArray()) {
-                const rapidjson::Value& words = doc["result"];
-                double totalConf = 0.0;
-                int wordCount = 0;
-                
-                // Iterate through words to calculate average confidence
-                for (rapidjson::SizeType i = 0; i < words.Size(); i++) {
-                    if (words[i].HasMember("conf") && words[i]["conf"].IsNumber()) {
-                        totalConf += words[i]["conf"].GetDouble();
-                        wordCount++;
-                    }
-                }
-                
-                // Calculate average confidence
-                if (wordCount > 0) {
-                    result.confidence = totalConf / wordCount;
-                } else {
-                    result.confidence = 1.0; // Default if no words with confidence
+        if (result.is_final) {
+            utterance_open_ = false;
+            if (result.end_capture_us > 0 && now_us >= result.end_capture_us) {
+                MetricsRegistry::instance().record_latency(Stage::CaptureToFinal,
+                    static_cast<uint64_t>(now_us - result.end_capture_us) * 1000);
+            }
+
+            if (!result.command_mode && !vocabulary_->empty()) {
+                vocabulary_->apply(result);
+                // The list was only needed for rescoring
+                if (max_alternatives_ == 0) {
+                    result.alternatives.clear();
+                    result.alternative_words.clear();
                 }
-            } else {
-                result.confidence = 1.0; // Default if no detailed results
             }
-        } 
-        // Check for "partial" field (for partial results)
-        else if (doc.HasMember("partial") && doc["partial"].IsString()) {
-            result.raw_text = doc["partial"].GetString();
-            result.processed_text = result.raw_text;
-            result.is_final = false;
-            result.confidence = 0.5; // Default confidence for partial results
+
+            // Only final dictation is normalized; partials keep changing under
+            // the user, and command phrases go to the command processor as is
+            if (use_inverse_text_normalization_ && !result.command_mode) {
+                ScopedTimer timer(Stage::TextNormalization);
+                TraceSpan span(trace_span::kTextNormalization, sequence);
+                result.processed_text = normalizer_.normalize(result.raw_text);
+            }
+            MetricsRegistry::instance().increment(Counter::FinalResults);
+        } else {
+            MetricsRegistry::instance().increment(Counter::PartialResults);
         }
-        
     } catch (const std::exception& e) {
-        last_error_ = "Exception during result parsing: " + std::string(e.what());
+        last_error_ = "Exception during result processing: " + std::string(e.what());
     } catch (...) {
-        last_error_ = "Unknown exception during result parsing";
+        last_error_ = "Unknown exception during result processing";
     }
     
     return result;
 }
 
-// Extract text from JSON result
-std::string VoskTranscriber::extract_text_from_json(const std::string& json) {
-    try {
-        rapidjson::Document doc;
-        doc.Parse(json.c_str());
-        
-        if (doc.HasMember("text") && doc["text"].IsString()) {
-            return doc["text"].GetString();
-        } else if (doc.HasMember("partial") && doc["partial"].IsString()) {
-            return doc["partial"].GetString();
-        }
-    } catch (...) {
-        // Ignore parsing errors and return empty string
-    }
-    
-    return "";
-}
-
 } // namespace voice_transcription
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "wav_file_stream.h"
+#include "metrics.h"
+#include "sample_conversion.h"
+#include "trace_recorder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace voice_transcription {
+
+static constexpr uint16_t kFormatPcm = 1;
+static constexpr uint16_t kFormatFloat = 3;
+static constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+// WAV fields are little-endian regardless of the host
+static uint16_t read_u16(const unsigned char* bytes) {
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+static uint32_t read_u32(const unsigned char* bytes) {
+    return static_cast<uint32_t>(bytes[0]) | (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+}
+
+static void write_u16(std::ofstream& out, uint16_t value) {
+    const char bytes[2] = { static_cast<char>(value & 0xFF), static_cast<char>(value >> 8) };
+    out.write(bytes, 2);
+}
+
+static void write_u32(std::ofstream& out, uint32_t value) {
+    const char bytes[4] = { static_cast<char>(value & 0xFF), static_cast<char>((value >> 8) & 0xFF),
+                            static_cast<char>((value >> 16) & 0xFF), static_cast<char>(value >> 24) };
+    out.write(bytes, 4);
+}
+
+bool WavFileStream::read_wav(const std::string& path, std::vector<float>& samples,
+                             int& sample_rate, std::string& error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Cannot open WAV file: " + path;
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        error = "Not a RIFF/WAVE file: " + path;
+        return false;
+    }
+
+    uint16_t format = 0;
+    uint16_t channels = 0;
+    uint16_t bits_per_sample = 0;
+    const unsigned char* data = nullptr;
+    size_t data_size = 0;
+
+    // Walk the chunk list; chunks are padded to an even size
+    size_t offset = 12;
+    while (offset + 8 <= bytes.size()) {
+        const unsigned char* header = bytes.data() + offset;
+        size_t size = read_u32(header + 4);
+        size_t body = offset + 8;
+        size_t available = std::min(size, bytes.size() - body);
+
+        if (std::memcmp(header, "fmt ", 4) == 0 && available >= 16) {
+            format = read_u16(header + 8);
+            channels = read_u16(header + 10);
+            sample_rate = static_cast<int>(read_u32(header + 12));
+            bits_per_sample = read_u16(header + 22);
+            if (format == kFormatExtensible && available >= 26) {
+                // The sub-format GUID starts with the plain format code
+                format = read_u16(header + 8 + 24);
+            }
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            data = header + 8;
+            data_size = available;
+        }
+        offset = body + size + (size & 1);
+    }
+
+    if (!data || channels == 0 || sample_rate <= 0) {
+        error = "Missing fmt or data chunk in " + path;
+        return false;
+    }
+    bool pcm16 = format == kFormatPcm && bits_per_sample == 16;
+    bool float32 = format == kFormatFloat && bits_per_sample == 32;
+    if (!pcm16 && !float32) {
+        error = "Unsupported WAV encoding (need 16-bit PCM or 32-bit float): " + path;
+        return false;
+    }
+
+    size_t bytes_per_sample = bits_per_sample / 8;
+    size_t frames = data_size / (bytes_per_sample * channels);
+    samples.assign(frames, 0.0f);
+    for (size_t frame = 0; frame < frames; frame++) {
+        float sum = 0.0f;
+        for (size_t channel = 0; channel < channels; channel++) {
+            const unsigned char* sample = data + (frame * channels + channel) * bytes_per_sample;
+            if (pcm16) {
+                sum += static_cast<int16_t>(read_u16(sample)) / 32768.0f;
+            } else {
+                uint32_t bits = read_u32(sample);
+                float value;
+                std::memcpy(&value, &bits, sizeof(value));
+                sum += value;
+            }
+        }
+        samples[frame] = sum / channels;
+    }
+    return true;
+}
+
+bool WavFileStream::write_wav(const std::string& path, const std::vector<float>& samples,
+                              int sample_rate) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    std::vector<int16_t> pcm(samples.size());
+    float_to_int16(samples.data(), pcm.data(), samples.size());
+    uint32_t data_size = static_cast<uint32_t>(pcm.size() * sizeof(int16_t));
+
+    out.write("RIFF", 4);
+    write_u32(out, 36 + data_size);
+    out.write("WAVE", 4);
+    out.write("fmt ", 4);
+    write_u32(out, 16);
+    write_u16(out, kFormatPcm);
+    write_u16(out, 1);
+    write_u32(out, static_cast<uint32_t>(sample_rate));
+    write_u32(out, static_cast<uint32_t>(sample_rate) * 2);
+    write_u16(out, 2);
+    write_u16(out, 16);
+    out.write("data", 4);
+    write_u32(out, data_size);
+    for (int16_t sample : pcm) {
+        write_u16(out, static_cast<uint16_t>(sample));
+    }
+    return static_cast<bool>(out);
+}
+
+WavFileStream::WavFileStream(const std::string& path, int frames_per_buffer, bool realtime)
+    : path_(path),
+      frames_per_buffer_(frames_per_buffer),
+      realtime_(realtime) {
+    if (frames_per_buffer_ <= 0) {
+        throw AudioStreamException("frames_per_buffer must be positive");
+    }
+    if (!read_wav(path_, samples_, sample_rate_, last_error_)) {
+        throw AudioStreamException(last_error_);
+    }
+}
+
+bool WavFileStream::start() {
+    last_error_.clear();
+    position_ = 0;
+    next_sequence_ = 0;
+    start_time_ = std::chrono::steady_clock::now();
+    start_trace_us_ = trace_clock_us();
+    active_ = true;
+    return true;
+}
+
+void WavFileStream::stop() {
+    active_ = false;
+}
+
+bool WavFileStream::is_active() const {
+    return active_;
+}
+
+double WavFileStream::get_duration_ms() const {
+    return sample_rate_ > 0 ? samples_.size() * 1000.0 / sample_rate_ : 0.0;
+}
+
+std::optional<AudioChunk> WavFileStream::get_next_chunk(int timeout_ms) {
+    if (!active_) {
+        return std::nullopt;
+    }
+    if (position_ >= samples_.size()) {
+        active_ = false;
+        return std::nullopt;
+    }
+
+    if (realtime_) {
+        // A chunk exists once its last sample has been "captured"
+        auto due = start_time_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(position_ + frames_per_buffer_) / sample_rate_));
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
+        if (due > deadline) {
+            std::this_thread::sleep_until(deadline);
+            return std::nullopt;
+        }
+        std::this_thread::sleep_until(due);
+    }
+
+    AudioChunk chunk(static_cast<size_t>(frames_per_buffer_));
+    size_t count = std::min(static_cast<size_t>(frames_per_buffer_), samples_.size() - position_);
+    std::memcpy(chunk.data(), samples_.data() + position_, count * sizeof(float));
+    chunk.set_sequence(next_sequence_++);
+    chunk.set_first_sample(position_);
+    // Real-time chunks were "captured" on schedule; others as if just now
+    int64_t offset_us = static_cast<int64_t>(position_ * 1000000ull / static_cast<uint64_t>(sample_rate_));
+    chunk.set_capture_time_us(realtime_ ? start_trace_us_ + offset_us
+                                        : trace_clock_us() - frames_per_buffer_ * 1000000ll / sample_rate_);
+    position_ += frames_per_buffer_;
+
+    MetricsRegistry::instance().increment(Counter::AudioChunks);
+    return chunk;
+}
+
+} // namespace voice_transcription
\ No newline at end of file
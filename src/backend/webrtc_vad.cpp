@@ -1,5 +1,8 @@
 #include "webrtc_vad.h"
 #include "audio_stream.h"  // Include here, not in the header
+#include "metrics.h"
+#include "trace_recorder.h"
+#include "sample_conversion.h"
 #include <cmath>
 #include <algorithm>
 #include <memory>
@@ -47,10 +50,11 @@ bool VADHandler::is_speech(const AudioChunk& chunk) {
         return false;
     }
     
+    ScopedTimer timer(Stage::Vad);
+    TraceSpan span(trace_span::kVad, chunk.sequence());
+    
     // Convert float to int16_t for WebRTC VAD
-    for (size_t i = 0; i < chunk.size() && i < temp_buffer_.size(); i++) {
-        temp_buffer_[i] = static_cast<int16_t>(chunk.data()[i] * 32767.0f);
-    }
+    float_to_int16(chunk.data(), temp_buffer_.data(), std::min(chunk.size(), temp_buffer_.size()));
     
     // Process with WebRTC VAD
     int result = WebRtcVad_Process(
@@ -61,9 +65,29 @@ bool VADHandler::is_speech(const AudioChunk& chunk) {
     );
     
     // 1 = speech detected, 0 = no speech, -1 = error
+    if (result > 0) {
+        MetricsRegistry::instance().increment(Counter::SpeechChunks);
+    }
     return result > 0;
 }
 
+// Classify every frame of a recording with one conversion pass
+std::vector<uint8_t> VADHandler::classify_frames(const float* samples, size_t count) {
+    size_t frame = temp_buffer_.size();
+    if (!vad_handle_ || frame == 0) {
+        return {};
+    }
+    size_t frames = count / frame;
+    std::vector<uint8_t> speech(frames);
+    std::vector<int16_t> pcm(frames * frame);
+    float_to_int16(samples, pcm.data(), pcm.size());
+    
+    for (size_t f = 0; f < frames; f++) {
+        speech[f] = WebRtcVad_Process(vad_handle_, sample_rate_, pcm.data() + f * frame, frame) > 0 ? 1 : 0;
+    }
+    return speech;
+}
+
 // Adjust VAD parameters
 void VADHandler::set_aggressiveness(int aggressiveness) {
     if (aggressiveness >= 0 && aggressiveness <= 3) {
@@ -0,0 +1,147 @@
+#include "whisper_backend.h"
+#include <whisper.h>
+#include <algorithm>
+#include <thread>
+
+namespace voice_transcription {
+
+static RecognizerCapabilities whisper_capabilities() {
+    RecognizerCapabilities capabilities;
+    capabilities.engine = "whisper";
+    capabilities.streaming_partials = true;
+    capabilities.endpointing = false;
+    capabilities.word_timings = false;
+    capabilities.sample_rates = { WhisperStreamingRecognizer::kSampleRate };
+    return capabilities;
+}
+
+WhisperSpeechModel::WhisperSpeechModel(const std::string& model_path, std::string& error)
+    : context_(whisper_init_from_file_with_params_no_state(model_path.c_str(), whisper_context_default_params())) {
+    if (!context_) {
+        error = "Failed to load whisper model from path: " + model_path;
+    }
+}
+
+WhisperSpeechModel::~WhisperSpeechModel() {
+    if (context_) {
+        whisper_free(context_);
+    }
+}
+
+std::unique_ptr<StreamingRecognizer> WhisperSpeechModel::create_recognizer(float sample_rate, std::string& error) {
+    if (static_cast<int>(sample_rate) != WhisperStreamingRecognizer::kSampleRate) {
+        error = "Whisper needs 16000 Hz audio, got " + std::to_string(static_cast<int>(sample_rate));
+        return nullptr;
+    }
+    // Each recognizer gets its own decoder state over the shared weights
+    whisper_state* state = context_ ? whisper_init_state(context_) : nullptr;
+    if (!state) {
+        error = "Failed to create whisper state";
+        return nullptr;
+    }
+    return std::make_unique<WhisperStreamingRecognizer>(context_, state);
+}
+
+RecognizerCapabilities WhisperSpeechModel::capabilities() const {
+    return whisper_capabilities();
+}
+
+WhisperStreamingRecognizer::WhisperStreamingRecognizer(whisper_context* context, whisper_state* state)
+    : context_(context), state_(state) {
+    audio_.reserve(kMaxUtteranceSamples);
+}
+
+WhisperStreamingRecognizer::~WhisperStreamingRecognizer() {
+    whisper_free_state(state_);
+}
+
+bool WhisperStreamingRecognizer::decode(std::string& text, double& confidence) {
+    text.clear();
+    confidence = 0.0;
+    if (audio_.empty()) {
+        return true;
+    }
+
+    whisper_full_params params = whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
+    params.n_threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    params.language = "en";
+    params.no_context = true;
+    params.single_segment = true;
+    params.print_progress = false;
+    params.print_realtime = false;
+    params.print_timestamps = false;
+    params.print_special = false;
+
+    if (whisper_full_with_state(context_, state_, params, audio_.data(), static_cast<int>(audio_.size())) != 0) {
+        last_error_ = "whisper_full failed";
+        return false;
+    }
+
+    // Text of all segments; confidence is the mean token probability
+    double probability_sum = 0.0;
+    int tokens = 0;
+    int segments = whisper_full_n_segments_from_state(state_);
+    for (int i = 0; i < segments; i++) {
+        text += whisper_full_get_segment_text_from_state(state_, i);
+        int segment_tokens = whisper_full_n_tokens_from_state(state_, i);
+        for (int j = 0; j < segment_tokens; j++) {
+            probability_sum += whisper_full_get_token_p_from_state(state_, i, j);
+            tokens++;
+        }
+    }
+    size_t begin = text.find_first_not_of(' ');
+    text = begin == std::string::npos ? std::string() : text.substr(begin);
+    confidence = tokens > 0 ? probability_sum / tokens : 0.0;
+    return true;
+}
+
+bool WhisperStreamingRecognizer::accept_waveform(const float* samples, size_t count) {
+    audio_.insert(audio_.end(), samples, samples + count);
+
+    // A full window ends the utterance; result() decodes it
+    if (audio_.size() >= kMaxUtteranceSamples) {
+        return true;
+    }
+
+    if (audio_.size() - decoded_samples_ >= kPartialIntervalSamples) {
+        double confidence;
+        if (decode(partial_text_, confidence)) {
+            decoded_samples_ = audio_.size();
+        }
+    }
+    return false;
+}
+
+TranscriptionResult WhisperStreamingRecognizer::partial_result() {
+    TranscriptionResult result{};
+    result.raw_text = partial_text_;
+    result.processed_text = partial_text_;
+    result.is_final = false;
+    result.confidence = 0.5;
+    return result;
+}
+
+TranscriptionResult WhisperStreamingRecognizer::result() {
+    TranscriptionResult result{};
+    decode(result.raw_text, result.confidence);
+    result.processed_text = result.raw_text;
+    result.is_final = true;
+    reset();
+    return result;
+}
+
+TranscriptionResult WhisperStreamingRecognizer::final_result() {
+    return result();
+}
+
+void WhisperStreamingRecognizer::reset() {
+    audio_.clear();
+    decoded_samples_ = 0;
+    partial_text_.clear();
+}
+
+RecognizerCapabilities WhisperStreamingRecognizer::capabilities() const {
+    return whisper_capabilities();
+}
+
+} // namespace voice_transcription
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "window_manager.h"
+#include "device_capability_cache.h"
 #include <dbt.h>  // For device change notifications
 #include <iostream>
 
@@ -118,6 +119,8 @@ LRESULT WindowManager::window_proc(HWND hwnd, UINT message, WPARAM wparam, LPARA
 
         case WM_DEVICECHANGE:
             if (wparam == DBT_DEVICEARRIVAL || wparam == DBT_DEVICEREMOVECOMPLETE) {
+                // Before the callback, so a refresh it triggers probes again
+                DeviceCapabilityCache::instance().invalidate();
                 if (device_change_callback_) {
                     device_change_callback_();
                 }
@@ -9,15 +9,37 @@
 #include "vosk_transcription_engine.h"  // Then this which uses VADHandler
 #include "keyboard_sim.h"
 #include "window_manager.h"
+#include "focus_tracker.h"
+#include "command_engine.h"
+#include "metrics.h"
+#include "model_cache.h"
+#include "device_capability_cache.h"
+#include "trace_recorder.h"
+#include "wav_file_stream.h"
+#include "endpointer.h"
+#include "keyword_spotter.h"
+#include "batch_transcriber.h"
+#include "result_queue.h"
+#include "transcription_pipeline.h"
 
 namespace py = pybind11;
 using namespace voice_transcription;
 
+// View a result's word or alternative array as a read-only numpy record
+// array. The view keeps the result alive instead of copying.
+template <typename T>
+py::array result_array_view(py::object owner, const std::vector<T>& items) {
+    py::array_t<T> view({items.size()}, {sizeof(T)}, items.data(), owner);
+    view.attr("setflags")(py::arg("write") = false);
+    return view;
+}
+
 // Custom wrapper for the transcribe_with_noise_filtering method
 TranscriptionResult transcribe_with_noise_filtering_wrapper(VoskTranscriber& self, AudioChunk& chunk, bool is_speech) {
     // Create a copy of the chunk and move it into a unique_ptr
     auto chunk_copy = std::make_unique<AudioChunk>(chunk.size());
     std::memcpy(chunk_copy->data(), chunk.data(), chunk.size() * sizeof(float));
+    chunk_copy->copy_timeline(chunk);
     return self.transcribe_with_noise_filtering(std::move(chunk_copy), is_speech);
 }
 
@@ -26,6 +48,7 @@ TranscriptionResult transcribe_wrapper(VoskTranscriber& self, AudioChunk& chunk)
     // Create a copy of the chunk and move it into a unique_ptr
     auto chunk_copy = std::make_unique<AudioChunk>(chunk.size());
     std::memcpy(chunk_copy->data(), chunk.data(), chunk.size() * sizeof(float));
+    chunk_copy->copy_timeline(chunk);
     return self.transcribe(std::move(chunk_copy));
 }
 
@@ -34,6 +57,7 @@ TranscriptionResult transcribe_with_vad_wrapper(VoskTranscriber& self, AudioChun
     // Create a copy of the chunk and move it into a unique_ptr
     auto chunk_copy = std::make_unique<AudioChunk>(chunk.size());
     std::memcpy(chunk_copy->data(), chunk.data(), chunk.size() * sizeof(float));
+    chunk_copy->copy_timeline(chunk);
     return self.transcribe_with_vad(std::move(chunk_copy), is_speech);
 }
 
@@ -50,13 +74,21 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
         .def_readwrite("id", &AudioDevice::id)
         .def_readwrite("raw_name", &AudioDevice::raw_name)
         .def_readwrite("label", &AudioDevice::label)
+        .def_readwrite("host_api", &AudioDevice::host_api)
         .def_readwrite("is_default", &AudioDevice::is_default)
-        .def_readwrite("supported_sample_rates", &AudioDevice::supported_sample_rates);
+        .def_readwrite("supported_sample_rates", &AudioDevice::supported_sample_rates)
+        .def_readwrite("capabilities_known", &AudioDevice::capabilities_known);
     
     // AudioChunk class
     py::class_<AudioChunk>(m, "AudioChunk")
         .def(py::init<size_t>())
         .def("size", &AudioChunk::size)
+        .def("sequence", &AudioChunk::sequence)
+        .def("set_sequence", &AudioChunk::set_sequence)
+        .def("first_sample", &AudioChunk::first_sample)
+        .def("set_first_sample", &AudioChunk::set_first_sample)
+        .def("capture_time_us", &AudioChunk::capture_time_us)
+        .def("set_capture_time_us", &AudioChunk::set_capture_time_us)
         .def("data", [](const AudioChunk& chunk) {
             return py::array_t<float>(
                 {chunk.size()},
@@ -66,11 +98,31 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
             );
         });
     
+    // Idle downshift policy for live streams
+    py::class_<IdlePolicy>(m, "IdlePolicy")
+        .def(py::init<>())
+        .def_readwrite("enabled", &IdlePolicy::enabled)
+        .def_readwrite("idle_after_ms", &IdlePolicy::idle_after_ms)
+        .def_readwrite("idle_block_ms", &IdlePolicy::idle_block_ms)
+        .def_readwrite("wake_rms", &IdlePolicy::wake_rms);
+    
     // ControlledAudioStream class
-    py::class_<ControlledAudioStream>(m, "ControlledAudioStream")
+    // Per-stream capture counts, for telling several microphones apart
+    py::class_<AudioStreamStats>(m, "AudioStreamStats")
+        .def_readonly("callbacks", &AudioStreamStats::callbacks)
+        .def_readonly("samples_captured", &AudioStreamStats::samples_captured)
+        .def_readonly("overflows", &AudioStreamStats::overflows)
+        .def_readonly("samples_dropped", &AudioStreamStats::samples_dropped)
+        .def_readonly("chunks_delivered", &AudioStreamStats::chunks_delivered)
+        .def_readonly("buffered_samples", &AudioStreamStats::buffered_samples);
+    
+    // Common base, so either stream can feed a TranscriptionPipeline
+    py::class_<AudioInputStream>(m, "AudioInputStream");
+    
+    py::class_<ControlledAudioStream, AudioInputStream>(m, "ControlledAudioStream")
         .def(py::init<int, int, int>())
-        .def("start", &ControlledAudioStream::start)
-        .def("stop", &ControlledAudioStream::stop)
+        .def("start", &ControlledAudioStream::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &ControlledAudioStream::stop, py::call_guard<py::gil_scoped_release>())
         .def("pause", &ControlledAudioStream::pause)
         .def("resume", &ControlledAudioStream::resume)
         .def("is_active", &ControlledAudioStream::is_active)
@@ -78,10 +130,97 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
         .def("get_sample_rate", &ControlledAudioStream::get_sample_rate)
         .def("get_frames_per_buffer", &ControlledAudioStream::get_frames_per_buffer)
         .def("get_last_error", &ControlledAudioStream::get_last_error)
-        .def("get_next_chunk", &ControlledAudioStream::get_next_chunk)
-        .def_static("enumerate_devices", &ControlledAudioStream::enumerate_devices)
-        .def_static("check_device_compatibility", &ControlledAudioStream::check_device_compatibility);
+        .def("get_next_chunk", &ControlledAudioStream::get_next_chunk, py::arg("timeout_ms") = 0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_idle_policy", &ControlledAudioStream::set_idle_policy)
+        .def("get_idle_policy", &ControlledAudioStream::get_idle_policy)
+        .def("is_idle", &ControlledAudioStream::is_idle)
+        .def("get_ready_fd", &ControlledAudioStream::get_ready_fd)
+        .def("get_stats", &ControlledAudioStream::get_stats)
+        .def_static("enumerate_devices", &ControlledAudioStream::enumerate_devices,
+                    py::arg("wait_for_probes") = true, py::call_guard<py::gil_scoped_release>())
+        .def_static("check_device_compatibility", &ControlledAudioStream::check_device_compatibility,
+                    py::call_guard<py::gil_scoped_release>());
+    
+    // WavFileStream class - replays a recording with the ControlledAudioStream interface
+    py::class_<WavFileStream, AudioInputStream>(m, "WavFileStream")
+        .def(py::init<const std::string&, int, bool>(),
+             py::arg("path"), py::arg("frames_per_buffer"), py::arg("realtime") = true)
+        .def("start", &WavFileStream::start)
+        .def("stop", &WavFileStream::stop)
+        .def("is_active", &WavFileStream::is_active)
+        .def("get_sample_rate", &WavFileStream::get_sample_rate)
+        .def("get_frames_per_buffer", &WavFileStream::get_frames_per_buffer)
+        .def("get_last_error", &WavFileStream::get_last_error)
+        .def("get_duration_ms", &WavFileStream::get_duration_ms)
+        .def("get_next_chunk", &WavFileStream::get_next_chunk, py::arg("timeout_ms") = 0,
+             py::call_guard<py::gil_scoped_release>());
     
+    // Endpointer class
+    py::class_<Endpointer> endpointer(m, "Endpointer");
+    py::enum_<Endpointer::Event>(endpointer, "Event")
+        .value("NONE", Endpointer::Event::None)
+        .value("SPEECH_START", Endpointer::Event::SpeechStart)
+        .value("SPEECH_END", Endpointer::Event::SpeechEnd);
+    endpointer
+        .def(py::init<int, int>(), py::arg("hangover_ms"), py::arg("chunk_ms"))
+        .def("update", &Endpointer::update)
+        .def("in_utterance", &Endpointer::in_utterance)
+        .def("reset", &Endpointer::reset)
+        .def("get_hangover_ms", &Endpointer::get_hangover_ms)
+        .def("set_hangover_ms", &Endpointer::set_hangover_ms);
+    
+    // Wake-word gate between the VAD and the transcriber
+    py::class_<KeywordSpotterConfig>(m, "KeywordSpotterConfig")
+        .def(py::init<>())
+        .def_readwrite("sample_rate", &KeywordSpotterConfig::sample_rate)
+        .def_readwrite("threshold", &KeywordSpotterConfig::threshold)
+        .def_readwrite("awake_ms", &KeywordSpotterConfig::awake_ms)
+        .def_readwrite("max_gap_ms", &KeywordSpotterConfig::max_gap_ms);
+
+    py::class_<KeywordSpotter> spotter(m, "KeywordSpotter");
+    py::enum_<KeywordSpotter::State>(spotter, "State")
+        .value("LISTENING", KeywordSpotter::State::Listening)
+        .value("AWAKE", KeywordSpotter::State::Awake);
+    spotter
+        .def(py::init<const KeywordSpotterConfig&>(), py::arg("config") = KeywordSpotterConfig())
+        .def("enroll", [](KeywordSpotter& self, py::array_t<float, py::array::c_style | py::array::forcecast> samples) {
+            std::string error;
+            if (!self.enroll(samples.data(), static_cast<size_t>(samples.size()), error)) {
+                throw std::runtime_error(error);
+            }
+        }, py::arg("samples"))
+        .def("clear_templates", &KeywordSpotter::clear_templates)
+        .def("template_count", &KeywordSpotter::template_count)
+        .def("load_templates", [](KeywordSpotter& self, const std::string& path) {
+            std::string error;
+            if (!self.load_templates(path, error)) {
+                throw std::runtime_error(error);
+            }
+        })
+        .def("save_templates", [](const KeywordSpotter& self, const std::string& path) {
+            std::string error;
+            if (!self.save_templates(path, error)) {
+                throw std::runtime_error(error);
+            }
+        })
+        .def("process", &KeywordSpotter::process, py::arg("chunk"), py::arg("is_speech"))
+        .def("get_state", &KeywordSpotter::get_state)
+        .def("is_awake", &KeywordSpotter::is_awake)
+        .def("wake", &KeywordSpotter::wake)
+        .def("sleep", &KeywordSpotter::sleep)
+        .def("report_false_accept", &KeywordSpotter::report_false_accept)
+        .def("get_best_score", &KeywordSpotter::get_best_score)
+        .def("reset_best_score", &KeywordSpotter::reset_best_score)
+        .def("get_threshold", &KeywordSpotter::get_threshold)
+        .def("set_threshold", &KeywordSpotter::set_threshold)
+        .def("get_awake_ms", &KeywordSpotter::get_awake_ms)
+        .def("set_awake_ms", &KeywordSpotter::set_awake_ms);
+    
+    // Word detail records; texts are byte spans of TranscriptionResult.text_arena
+    PYBIND11_NUMPY_DTYPE(WordInfo, text_offset, text_length, start, end, confidence);
+    PYBIND11_NUMPY_DTYPE(Alternative, text_offset, text_length, word_begin, word_count, score);
+
     // TranscriptionResult class
     py::class_<TranscriptionResult>(m, "TranscriptionResult")
         .def(py::init<>())
@@ -89,7 +228,54 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
         .def_readwrite("processed_text", &TranscriptionResult::processed_text)
         .def_readwrite("is_final", &TranscriptionResult::is_final)
         .def_readwrite("confidence", &TranscriptionResult::confidence)
-        .def_readwrite("timestamp_ms", &TranscriptionResult::timestamp_ms);
+        .def_readwrite("timestamp_ms", &TranscriptionResult::timestamp_ms)
+        .def_readwrite("chunk_sequence", &TranscriptionResult::chunk_sequence)
+        .def_readwrite("command_mode", &TranscriptionResult::command_mode)
+        .def_readwrite("start_sample", &TranscriptionResult::start_sample)
+        .def_readwrite("end_sample", &TranscriptionResult::end_sample)
+        .def_readwrite("start_capture_us", &TranscriptionResult::start_capture_us)
+        .def_readwrite("end_capture_us", &TranscriptionResult::end_capture_us)
+        .def_property_readonly("text_arena", [](const TranscriptionResult& result) {
+            return py::bytes(result.text_arena);
+        })
+        .def_property_readonly("words", [](py::object self) {
+            return result_array_view(self, self.cast<const TranscriptionResult&>().words);
+        })
+        .def_property_readonly("alternatives", [](py::object self) {
+            return result_array_view(self, self.cast<const TranscriptionResult&>().alternatives);
+        })
+        .def_property_readonly("alternative_words", [](py::object self) {
+            return result_array_view(self, self.cast<const TranscriptionResult&>().alternative_words);
+        })
+        .def("word_texts", [](const TranscriptionResult& result) {
+            std::vector<std::string> texts;
+            texts.reserve(result.words.size());
+            for (const WordInfo& word : result.words) {
+                texts.emplace_back(result.text_of(word));
+            }
+            return texts;
+        })
+        .def("alternative_texts", [](const TranscriptionResult& result) {
+            std::vector<std::string> texts;
+            texts.reserve(result.alternatives.size());
+            for (const Alternative& alternative : result.alternatives) {
+                texts.emplace_back(result.text_of(alternative));
+            }
+            return texts;
+        });
+    
+    // ResultQueue class - results from the decode thread, pollable from an event loop
+    py::class_<ResultQueue, std::shared_ptr<ResultQueue>>(m, "ResultQueue")
+        .def(py::init<size_t>(), py::arg("capacity") = 256)
+        .def("push", &ResultQueue::push)
+        .def("pop", &ResultQueue::pop)
+        .def("wait_pop", &ResultQueue::wait_pop, py::arg("timeout_ms"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("close", &ResultQueue::close)
+        .def("is_closed", &ResultQueue::is_closed)
+        .def("ready_fd", &ResultQueue::ready_fd)
+        .def("size", &ResultQueue::size)
+        .def("dropped", &ResultQueue::dropped);
     
     // VADHandler class
     py::class_<VADHandler>(m, "VADHandler")
@@ -98,20 +284,164 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
         .def("set_aggressiveness", &VADHandler::set_aggressiveness)
         .def("get_aggressiveness", &VADHandler::get_aggressiveness);
     
+    // Engine capabilities
+    py::class_<RecognizerCapabilities>(m, "RecognizerCapabilities")
+        .def(py::init<>())
+        .def_readonly("engine", &RecognizerCapabilities::engine)
+        .def_readonly("streaming_partials", &RecognizerCapabilities::streaming_partials)
+        .def_readonly("endpointing", &RecognizerCapabilities::endpointing)
+        .def_readonly("word_timings", &RecognizerCapabilities::word_timings)
+        .def_readonly("alternatives", &RecognizerCapabilities::alternatives)
+        .def_readonly("grammar", &RecognizerCapabilities::grammar)
+        .def_readonly("sample_rates", &RecognizerCapabilities::sample_rates);
+    
+    m.def("available_speech_engines", &available_speech_engines);
+    
     // VoskTranscriber class - use wrappers to handle unique_ptr
-    py::class_<VoskTranscriber>(m, "VoskTranscriber")
-        .def(py::init<const std::string&, float>())
+    py::class_<HotwordEntry>(m, "HotwordEntry")
+        .def(py::init<>())
+        .def(py::init([](const std::string& phrase, float boost) { return HotwordEntry{ phrase, boost }; }),
+             py::arg("phrase"), py::arg("boost") = 1.0f)
+        .def_readwrite("phrase", &HotwordEntry::phrase)
+        .def_readwrite("boost", &HotwordEntry::boost);
+
+    py::class_<VoskTranscriber> transcriber(m, "VoskTranscriber");
+    py::enum_<VoskTranscriber::LoadingPhase>(transcriber, "LoadingPhase")
+        .value("READING_FILES", VoskTranscriber::LoadingPhase::ReadingFiles)
+        .value("LOADING_MODEL", VoskTranscriber::LoadingPhase::LoadingModel)
+        .value("WARMING_UP", VoskTranscriber::LoadingPhase::WarmingUp)
+        .value("READY", VoskTranscriber::LoadingPhase::Ready)
+        .value("FAILED", VoskTranscriber::LoadingPhase::Failed);
+    py::enum_<VoskTranscriber::RecognitionMode>(transcriber, "RecognitionMode")
+        .value("DICTATION", VoskTranscriber::RecognitionMode::Dictation)
+        .value("COMMANDS", VoskTranscriber::RecognitionMode::Commands);
+    transcriber
+        .def(py::init<const std::string&, float, const std::string&>(),
+             py::arg("model_path"), py::arg("sample_rate"), py::arg("engine") = "vosk")
         .def("transcribe", &transcribe_wrapper)
         .def("transcribe_with_vad", &transcribe_with_vad_wrapper)
         .def("transcribe_with_noise_filtering", &transcribe_with_noise_filtering_wrapper)
         .def("enable_noise_filtering", &VoskTranscriber::enable_noise_filtering)
         .def("is_noise_filtering_enabled", &VoskTranscriber::is_noise_filtering_enabled)
+        .def("enable_inverse_text_normalization", &VoskTranscriber::enable_inverse_text_normalization)
+        .def("is_inverse_text_normalization_enabled", &VoskTranscriber::is_inverse_text_normalization_enabled)
+        .def("set_max_alternatives", &VoskTranscriber::set_max_alternatives)
+        .def("get_max_alternatives", &VoskTranscriber::get_max_alternatives)
+        .def("set_vocabulary_phrase", &VoskTranscriber::set_vocabulary_phrase,
+             py::arg("phrase"), py::arg("boost") = 1.0f)
+        .def("remove_vocabulary_phrase", &VoskTranscriber::remove_vocabulary_phrase)
+        .def("set_vocabulary", &VoskTranscriber::set_vocabulary)
+        .def("get_vocabulary", &VoskTranscriber::get_vocabulary)
+        .def("load_vocabulary", &VoskTranscriber::load_vocabulary)
+        .def("save_vocabulary", &VoskTranscriber::save_vocabulary)
+        .def("set_recognition_mode", &VoskTranscriber::set_recognition_mode)
+        .def("get_recognition_mode", &VoskTranscriber::get_recognition_mode)
+        .def("set_command_phrases", &VoskTranscriber::set_command_phrases)
         .def("calibrate_noise_filter", &VoskTranscriber::calibrate_noise_filter)
         .def("reset", &VoskTranscriber::reset)
         .def("is_loading", &VoskTranscriber::is_loading)
         .def("get_loading_progress", &VoskTranscriber::get_loading_progress)
+        .def("get_loading_phase", &VoskTranscriber::get_loading_phase)
+        .def("get_loading_eta_seconds", &VoskTranscriber::get_loading_eta_seconds)
         .def("is_model_loaded", &VoskTranscriber::is_model_loaded)
-        .def("get_last_error", &VoskTranscriber::get_last_error);
+        .def("get_last_error", &VoskTranscriber::get_last_error)
+        .def("swap_model", &VoskTranscriber::swap_model, py::arg("model_path"), py::arg("engine") = "")
+        .def("is_swap_pending", &VoskTranscriber::is_swap_pending)
+        .def("get_model_path", &VoskTranscriber::get_model_path)
+        .def("get_engine_name", &VoskTranscriber::get_engine_name)
+        .def("get_capabilities", &VoskTranscriber::get_capabilities);
+    
+    // Native transcription loop feeding a ResultQueue; see async_pipeline.py for asyncio
+    py::class_<TranscriptionPipelineConfig>(m, "TranscriptionPipelineConfig")
+        .def(py::init<>())
+        .def_readwrite("vad_aggressiveness", &TranscriptionPipelineConfig::vad_aggressiveness)
+        .def_readwrite("hangover_ms", &TranscriptionPipelineConfig::hangover_ms)
+        .def_readwrite("partial_results", &TranscriptionPipelineConfig::partial_results)
+        .def_readwrite("queue_capacity", &TranscriptionPipelineConfig::queue_capacity);
+    
+    // The pipeline borrows the stream and transcriber, so it keeps both alive
+    py::class_<TranscriptionPipeline>(m, "TranscriptionPipeline")
+        .def(py::init<AudioInputStream&, VoskTranscriber&, const TranscriptionPipelineConfig&>(),
+             py::arg("stream"), py::arg("transcriber"), py::arg("config") = TranscriptionPipelineConfig(),
+             py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
+        .def("start", &TranscriptionPipeline::start, py::call_guard<py::gil_scoped_release>())
+        .def("request_stop", &TranscriptionPipeline::request_stop)
+        .def("stop", &TranscriptionPipeline::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &TranscriptionPipeline::is_running)
+        .def("get_results", &TranscriptionPipeline::get_results)
+        .def("get_last_error", &TranscriptionPipeline::get_last_error);
+    
+    // Offline batch transcription
+    py::class_<BatchTranscriberConfig>(m, "BatchTranscriberConfig")
+        .def(py::init<>())
+        .def_readwrite("engine", &BatchTranscriberConfig::engine)
+        .def_readwrite("model_path", &BatchTranscriberConfig::model_path)
+        .def_readwrite("threads", &BatchTranscriberConfig::threads)
+        .def_readwrite("vad_aggressiveness", &BatchTranscriberConfig::vad_aggressiveness)
+        .def_readwrite("min_silence_ms", &BatchTranscriberConfig::min_silence_ms)
+        .def_readwrite("max_segment_ms", &BatchTranscriberConfig::max_segment_ms)
+        .def_readwrite("feed_ms", &BatchTranscriberConfig::feed_ms)
+        .def_readwrite("skip_silence", &BatchTranscriberConfig::skip_silence)
+        .def_readwrite("speech_padding_ms", &BatchTranscriberConfig::speech_padding_ms)
+        .def_readwrite("inverse_text_normalization", &BatchTranscriberConfig::inverse_text_normalization);
+    
+    py::class_<BatchSegment>(m, "BatchSegment")
+        .def_readonly("start_sample", &BatchSegment::start_sample)
+        .def_readonly("end_sample", &BatchSegment::end_sample)
+        .def_readonly("start_ms", &BatchSegment::start_ms)
+        .def_readonly("end_ms", &BatchSegment::end_ms)
+        .def_readonly("raw_text", &BatchSegment::raw_text)
+        .def_readonly("text", &BatchSegment::text)
+        .def_readonly("confidence", &BatchSegment::confidence);
+    
+    py::class_<BatchFileResult>(m, "BatchFileResult")
+        .def_readonly("path", &BatchFileResult::path)
+        .def_readonly("sample_rate", &BatchFileResult::sample_rate)
+        .def_readonly("sample_count", &BatchFileResult::sample_count)
+        .def_readonly("duration_ms", &BatchFileResult::duration_ms)
+        .def_readonly("speech_ms", &BatchFileResult::speech_ms)
+        .def_readonly("decode_ms", &BatchFileResult::decode_ms)
+        .def_readonly("segments", &BatchFileResult::segments)
+        .def_readonly("error", &BatchFileResult::error)
+        .def("text", &BatchFileResult::text);
+    
+    py::class_<BatchReport>(m, "BatchReport")
+        .def_readonly("threads", &BatchReport::threads)
+        .def_readonly("audio_seconds", &BatchReport::audio_seconds)
+        .def_readonly("decoded_seconds", &BatchReport::decoded_seconds)
+        .def_readonly("wall_seconds", &BatchReport::wall_seconds)
+        .def_readonly("files", &BatchReport::files)
+        .def("speed", &BatchReport::speed)
+        .def("to_json", &BatchReport::to_json)
+        .def("write_json", &BatchReport::write_json);
+    
+    py::class_<BatchTranscriber>(m, "BatchTranscriber")
+        .def(py::init<const BatchTranscriberConfig&>())
+        .def("load_model", &BatchTranscriber::load_model, py::call_guard<py::gil_scoped_release>())
+        .def("run", [](BatchTranscriber& self, const std::vector<std::string>& paths) {
+            BatchReport report;
+            bool ok;
+            {
+                py::gil_scoped_release release;
+                ok = self.run(paths, report);
+            }
+            if (!ok) {
+                throw std::runtime_error(self.get_last_error());
+            }
+            return report;
+        })
+        // The callback runs on a worker thread; pybind11 takes the GIL for it
+        .def("set_file_callback", &BatchTranscriber::set_file_callback)
+        .def("get_thread_count", &BatchTranscriber::get_thread_count)
+        .def("get_last_error", &BatchTranscriber::get_last_error)
+        .def_static("collect_audio_files", [](const std::vector<std::string>& inputs) {
+            std::vector<std::string> files;
+            std::string error;
+            if (!BatchTranscriber::collect_audio_files(inputs, files, error)) {
+                throw std::runtime_error(error);
+            }
+            return files;
+        });
             
     // Shortcut class
     py::class_<Shortcut>(m, "Shortcut")
@@ -141,6 +471,175 @@ PYBIND11_MODULE(voice_transcription_backend, m) {
         .def("set_device_change_callback", &WindowManager::set_device_change_callback)
         .def_static("get_foreground_window_title", &WindowManager::get_foreground_window_title);
     
+    // InverseTextNormalizer class
+    py::class_<InverseTextNormalizer>(m, "InverseTextNormalizer")
+        .def(py::init<>())
+        .def("normalize", &InverseTextNormalizer::normalize, py::call_guard<py::gil_scoped_release>());
+    
+    // CommandDefinition structure
+    py::class_<CommandDefinition>(m, "CommandDefinition")
+        .def(py::init<>())
+        .def_readwrite("phrase", &CommandDefinition::phrase)
+        .def_readwrite("action", &CommandDefinition::action)
+        .def_readwrite("aliases", &CommandDefinition::aliases);
+    
+    // CommandEngine class
+    py::class_<CommandEngine>(m, "CommandEngine")
+        .def(py::init<>())
+        .def(py::init<const std::vector<CommandDefinition>&>())
+        .def("load_json", &CommandEngine::load_json)
+        .def("load_commands", &CommandEngine::load_commands)
+        .def("reload_json", &CommandEngine::reload_json)
+        .def("wait_for_reload", &CommandEngine::wait_for_reload,
+             py::arg("timeout_ms") = 5000, py::call_guard<py::gil_scoped_release>())
+        .def("get_snapshot_version", &CommandEngine::get_snapshot_version)
+        .def("set_cache_path", &CommandEngine::set_cache_path)
+        .def("loaded_from_cache", &CommandEngine::loaded_from_cache)
+        .def("add_command", &CommandEngine::add_command,
+             py::arg("phrase"), py::arg("action"), py::arg("aliases") = std::vector<std::string>())
+        .def("remove_command", &CommandEngine::remove_command)
+        .def("get_commands", &CommandEngine::get_commands)
+        .def("get_phrases", &CommandEngine::get_phrases)
+        .def("get_phrase_count", &CommandEngine::get_phrase_count)
+        .def("process", &CommandEngine::process, py::call_guard<py::gil_scoped_release>())
+        .def("set_capitalization_mode", &CommandEngine::set_capitalization_mode)
+        .def("get_capitalization_mode", &CommandEngine::get_capitalization_mode)
+        .def("get_last_error", &CommandEngine::get_last_error);
+    
+    // FocusedWindow structure
+    py::class_<FocusedWindow>(m, "FocusedWindow")
+        .def(py::init<>())
+        .def_readonly("window_id", &FocusedWindow::window_id)
+        .def_readonly("title", &FocusedWindow::title)
+        .def_readonly("generation", &FocusedWindow::generation);
+    
+    py::class_<FocusScriptStep>(m, "FocusScriptStep")
+        .def(py::init<>())
+        .def(py::init([](int delay_ms, uint64_t window_id, const std::string& title) {
+            return FocusScriptStep{delay_ms, window_id, title};
+        }))
+        .def_readwrite("delay_ms", &FocusScriptStep::delay_ms)
+        .def_readwrite("window_id", &FocusScriptStep::window_id)
+        .def_readwrite("title", &FocusScriptStep::title);
+    
+    // FocusTracker class - callbacks fire on the tracker thread, so anything that
+    // can wait on that thread releases the GIL first
+    py::class_<FocusTracker>(m, "FocusTracker")
+        .def("start", &FocusTracker::start, py::call_guard<py::gil_scoped_release>())
+        .def("stop", &FocusTracker::stop, py::call_guard<py::gil_scoped_release>())
+        .def("is_running", &FocusTracker::is_running)
+        .def("get_backend_name", &FocusTracker::get_backend_name)
+        .def("generation", &FocusTracker::generation)
+        .def("current_window_id", &FocusTracker::current_window_id)
+        .def("current", &FocusTracker::current)
+        .def("current_title", &FocusTracker::current_title)
+        .def("set_focus_change_callback", &FocusTracker::set_focus_change_callback,
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_last_error", &FocusTracker::get_last_error)
+        .def_static("create_default", &FocusTracker::create_default);
+    
+    py::class_<FakeFocusTracker, FocusTracker>(m, "FakeFocusTracker")
+        .def(py::init<>())
+        .def("simulate_focus_change", &FakeFocusTracker::simulate_focus_change,
+             py::call_guard<py::gil_scoped_release>())
+        .def("load_script", &FakeFocusTracker::load_script)
+        .def("wait_for_script", &FakeFocusTracker::wait_for_script,
+             py::call_guard<py::gil_scoped_release>());
+    
+    // Pipeline metrics
+    py::class_<StageStats>(m, "StageStats")
+        .def_readonly("stage", &StageStats::stage)
+        .def_readonly("count", &StageStats::count)
+        .def_readonly("total_ms", &StageStats::total_ms)
+        .def_readonly("mean_us", &StageStats::mean_us)
+        .def_readonly("p50_us", &StageStats::p50_us)
+        .def_readonly("p90_us", &StageStats::p90_us)
+        .def_readonly("p99_us", &StageStats::p99_us)
+        .def_readonly("max_us", &StageStats::max_us);
+    
+    py::class_<MetricsSnapshot>(m, "MetricsSnapshot")
+        .def_readonly("uptime_seconds", &MetricsSnapshot::uptime_seconds)
+        .def_readonly("stages", &MetricsSnapshot::stages)
+        .def_readonly("counters", &MetricsSnapshot::counters)
+        .def_readonly("resident_bytes", &MetricsSnapshot::resident_bytes)
+        .def_readonly("cpu_seconds", &MetricsSnapshot::cpu_seconds);
+
+    py::class_<ModelCache::Stats>(m, "ModelCacheStats")
+        .def_readonly("loads", &ModelCache::Stats::loads)
+        .def_readonly("hits", &ModelCache::Stats::hits)
+        .def_readonly("load_ms", &ModelCache::Stats::load_ms)
+        .def_readonly("resident_models", &ModelCache::Stats::resident_models);
+
+    m.def("get_model_cache_stats", []() { return ModelCache::instance().stats(); });
+    
+    // Device sample-rate cache behind enumerate_devices
+    py::class_<DeviceCapabilityCache::Stats>(m, "DeviceCacheStats")
+        .def_readonly("probes", &DeviceCapabilityCache::Stats::probes)
+        .def_readonly("hits", &DeviceCapabilityCache::Stats::hits)
+        .def_readonly("misses", &DeviceCapabilityCache::Stats::misses)
+        .def_readonly("cached_devices", &DeviceCapabilityCache::Stats::cached_devices);
+    
+    m.def("get_device_cache_stats", []() { return DeviceCapabilityCache::instance().stats(); });
+    m.def("invalidate_device_cache", []() { DeviceCapabilityCache::instance().invalidate(); });
+    m.def("wait_for_device_probes", [](int timeout_ms) {
+        return DeviceCapabilityCache::instance().wait_for_probes(timeout_ms);
+    }, py::arg("timeout_ms") = -1, py::call_guard<py::gil_scoped_release>());
+    // Called on the probe thread, with the GIL taken for the call
+    m.def("set_device_cache_callback", [](std::function<void()> callback) {
+        DeviceCapabilityCache::instance().set_update_callback(std::move(callback));
+    });
+    m.def("set_device_cache_path", [](const std::string& path) {
+        std::string error;
+        if (!DeviceCapabilityCache::instance().set_cache_path(path, error)) {
+            throw std::runtime_error(error);
+        }
+    });
+    m.def("resident_memory_bytes", &resident_memory_bytes);
+    m.def("process_cpu_seconds", &process_cpu_seconds);
+    
+    m.def("get_metrics_snapshot", []() { return MetricsRegistry::instance().snapshot(); });
+    m.def("get_metrics_prometheus", []() { return MetricsRegistry::instance().to_prometheus(); });
+    m.def("write_metrics_prometheus", [](const std::string& path) {
+        return MetricsRegistry::instance().write_prometheus(path);
+    }, py::call_guard<py::gil_scoped_release>());
+    m.def("reset_metrics", []() { MetricsRegistry::instance().reset(); });
+    m.def("set_metrics_enabled", [](bool enabled) { MetricsRegistry::instance().set_enabled(enabled); });
+    m.def("is_metrics_enabled", []() { return MetricsRegistry::instance().is_enabled(); });
+    // Stages that run in Python (command processing, output) report here
+    m.def("record_stage_latency", [](const std::string& stage_name, double seconds) {
+        Stage stage;
+        if (!MetricsRegistry::stage_from_name(stage_name, stage) || seconds < 0.0) {
+            return false;
+        }
+        MetricsRegistry::instance().record_latency(stage, static_cast<uint64_t>(seconds * 1e9));
+        return true;
+    });
+    
+    // Chrome trace-event recording, off unless enabled
+    m.def("trace_clock_us", &trace_clock_us);
+    m.def("set_tracing_enabled", [](bool enabled) { TraceRecorder::instance().set_enabled(enabled); });
+    m.def("is_tracing_enabled", []() { return TraceRecorder::instance().is_enabled(); });
+    m.def("set_trace_thread_name", [](const std::string& name) {
+        TraceRecorder::instance().set_thread_name(name);
+    });
+    m.def("set_trace_dump_trigger", [](double threshold_ms, const std::string& path) {
+        TraceRecorder::instance().set_dump_trigger(static_cast<int64_t>(threshold_ms * 1000.0), path);
+    });
+    m.def("get_trace_json", []() { return TraceRecorder::instance().to_json(); },
+          py::call_guard<py::gil_scoped_release>());
+    m.def("write_trace", [](const std::string& path) { return TraceRecorder::instance().write_json(path); },
+          py::call_guard<py::gil_scoped_release>());
+    m.def("clear_trace", []() { TraceRecorder::instance().clear(); });
+    // Spans for stages that run in Python; the name must be a known pipeline span
+    m.def("record_trace_span", [](const std::string& name, uint64_t sequence, int64_t begin_us, int64_t end_us) {
+        const char* span_name = TraceRecorder::intern_span_name(name);
+        if (!span_name) {
+            return false;
+        }
+        TraceRecorder::instance().record(span_name, sequence, begin_us, end_us);
+        return true;
+    }, py::call_guard<py::gil_scoped_release>());
+    
     // ShortcutCapture class
     py::class_<ShortcutCapture>(m, "ShortcutCapture")
         .def(py::init<>())
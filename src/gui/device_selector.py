@@ -22,14 +22,40 @@ except ImportError:
 class DeviceSelector(QWidget):
     """Widget for selecting audio input devices"""
     device_selected = pyqtSignal(int)  # Emits device ID when selected
+    probes_finished = pyqtSignal()     # Emitted from the backend's probe thread
     
-    def __init__(self, parent=None):
+    # Sample rate the recognizer runs at
+    REQUIRED_SAMPLE_RATE = 16000
+    
+    def __init__(self, parent=None, cache_path=None):
         super().__init__(parent)
         self.logger = setup_logger("device_selector")
         self.available_devices = []
+        # (raw_name, host_api) of the chosen device; PortAudio renumbers
+        # devices when one is plugged in or removed, so the id is not stable
+        self._selected_key = None
         self._init_ui()
+        self._init_capability_cache(cache_path)
         self.refresh_devices()
         
+    def _init_capability_cache(self, cache_path):
+        """Reuse sample-rate probes across runs and refresh when new ones finish"""
+        if not hasattr(backend, "set_device_cache_callback"):
+            return
+        if cache_path is not None:
+            try:
+                backend.set_device_cache_path(str(cache_path))
+            except RuntimeError as e:
+                # The file is rewritten after the next probe round
+                self.logger.warning(f"Ignoring device cache: {str(e)}")
+        self.probes_finished.connect(self.refresh_devices)
+        backend.set_device_cache_callback(self.probes_finished.emit)
+        
+    def shutdown(self):
+        """Stop listening for probe results; call before the widget goes away"""
+        if hasattr(backend, "set_device_cache_callback"):
+            backend.set_device_cache_callback(None)
+        
     def _init_ui(self):
         """Initialize user interface"""
         layout = QVBoxLayout(self)
@@ -50,7 +76,7 @@ class DeviceSelector(QWidget):
         self.device_combo.currentIndexChanged.connect(self._on_device_selected)
         
         self.refresh_button = QPushButton("Refresh")
-        self.refresh_button.clicked.connect(self.refresh_devices)
+        self.refresh_button.clicked.connect(self._on_refresh_clicked)
         
         device_layout.addWidget(self.device_combo)
         device_layout.addWidget(self.refresh_button)
@@ -61,31 +87,43 @@ class DeviceSelector(QWidget):
         self.device_info.setWordWrap(True)
         layout.addWidget(self.device_info)
         
+    def _on_refresh_clicked(self):
+        """Probe every device again, in case one changed without a device-change event"""
+        if hasattr(backend, "invalidate_device_cache"):
+            backend.invalidate_device_cache()
+        self.refresh_devices()
+        
     def refresh_devices(self):
         """Refresh the list of available audio devices"""
         try:
-            # Get all devices
-            self.available_devices = backend.ControlledAudioStream.enumerate_devices()
+            # Returns at once; devices still being probed are listed until
+            # probes_finished says otherwise
+            self.available_devices = backend.ControlledAudioStream.enumerate_devices(False)
             
-            # Filter for compatible devices (16000 Hz sample rate)
             compatible_devices = [
-                device for device in self.available_devices 
-                if backend.ControlledAudioStream.check_device_compatibility(
-                    device.id, 16000  # Required sample rate
-                )
+                device for device in self.available_devices
+                if not device.capabilities_known
+                or self.REQUIRED_SAMPLE_RATE in device.supported_sample_rates
             ]
             
-            # Update combo box
+            # Keep the user's choice across refreshes, found by name since
+            # its id may have changed
+            selected_id = self.get_selected_device_id()
+            
+            # Update combo box without announcing each intermediate selection
+            self.device_combo.blockSignals(True)
             self.device_combo.clear()
             
             if not compatible_devices:
                 self.device_combo.addItem("No compatible devices found", -1)
+                self.device_combo.blockSignals(False)
                 self.device_info.setText(
                     "No compatible audio input devices found. Please connect a microphone that supports 16000 Hz sampling."
                 )
                 return
                 
             default_index = 0
+            selected_index = None
             
             for i, device in enumerate(compatible_devices):
                 # Format: "Built-in Microphone [default]"
@@ -93,11 +131,20 @@ class DeviceSelector(QWidget):
                 if device.is_default:
                     device_name += " [default]"
                     default_index = i
+                if self._device_key(device) == self._selected_key:
+                    selected_index = i
                     
                 self.device_combo.addItem(device_name, device.id)
                 
-            # Select default device
-            self.device_combo.setCurrentIndex(default_index)
+            # Select the previous choice if it is still there, else the default
+            self.device_combo.setCurrentIndex(
+                selected_index if selected_index is not None else default_index
+            )
+            self.device_combo.blockSignals(False)
+            device_id = self.get_selected_device_id()
+            self._remember_selection(device_id)
+            if device_id != selected_id:
+                self.device_selected.emit(device_id)
             
             # Show device info
             self._update_device_info()
@@ -117,6 +164,7 @@ class DeviceSelector(QWidget):
             
         device_id = self.device_combo.itemData(index)
         if device_id is not None and device_id >= 0:
+            self._remember_selection(device_id)
             self.device_selected.emit(device_id)
             self._update_device_info()
             
@@ -138,13 +186,28 @@ class DeviceSelector(QWidget):
             return
             
         # Display device info
+        if device.capabilities_known:
+            rates = f"{', '.join(str(rate) for rate in device.supported_sample_rates)} Hz"
+        else:
+            rates = "checking..."
         info_text = f"""
         <b>Device:</b> {device.raw_name}
-        <b>Sample Rates:</b> {', '.join(str(rate) for rate in device.supported_sample_rates)} Hz
+        <b>Sample Rates:</b> {rates}
         <b>Default Device:</b> {'Yes' if device.is_default else 'No'}
         """
         self.device_info.setText(info_text)
         
+    @staticmethod
+    def _device_key(device):
+        """Identity of a device that survives PortAudio renumbering"""
+        return (device.raw_name, device.host_api)
+        
+    def _remember_selection(self, device_id):
+        """Record which device the id refers to in the current list"""
+        device = next((d for d in self.available_devices if d.id == device_id), None)
+        if device is not None:
+            self._selected_key = self._device_key(device)
+            
     def get_selected_device_id(self):
         """Get the currently selected device ID"""
         index = self.device_combo.currentIndex()
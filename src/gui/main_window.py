@@ -4,10 +4,12 @@ import os
 import json
 import threading
 import time
+import numpy as np
 from pathlib import Path
 from concurrent.futures import ThreadPoolExecutor
 from .audio_level_meter import AudioLevelMeter, AudioLevelMonitor
 from utils.enhanced_command_processor import EnhancedCommandProcessor
+from utils.native_command_processor import NativeCommandProcessor
 from utils.error_recovery_system import ErrorRecoveryManager, ErrorCategory
 
 from PyQt5.QtWidgets import (
@@ -15,7 +17,7 @@ from PyQt5.QtWidgets import (
     QPushButton, QLabel, QComboBox, QCheckBox, QGroupBox,
     QSystemTrayIcon, QMenu, QAction, QMessageBox, QStatusBar
 )
-from PyQt5.QtCore import Qt, QTimer, pyqtSignal, pyqtSlot, QObject
+from PyQt5.QtCore import Qt, QTimer, pyqtSignal, pyqtSlot, QObject, QSocketNotifier
 from PyQt5.QtGui import QIcon, QFont
 
 # Import custom modules
@@ -39,6 +41,9 @@ except ImportError:
 
 # Configuration path
 CONFIG_PATH = Path(__file__).parents[2] / "config" / "settings.json"
+VOCABULARY_PATH = CONFIG_PATH.parent / "vocabulary.json"
+WAKE_WORD_PATH = CONFIG_PATH.parent / "wake_word.kws"
+DEVICE_CACHE_PATH = CONFIG_PATH.parent / "device_cache.json"
 
 class SignalEmitter(QObject):
     """Helper class for emitting signals from non-Qt threads"""
@@ -62,14 +67,22 @@ class TranscriptionController(QObject):
         self.audio_stream = None
         self.vad_handler = None
         self.transcriber = None
+        self.keyword_spotter = None
+        self.wake_word_enabled = False
+        self.wake_word_enrollment = None
         self.keyboard_simulator = None
-        self.command_processor = EnhancedCommandProcessor(
-            self.config.get("dictation_commands", {}).get("supported_commands", []),
-            config_path=CONFIG_PATH
-        )
+        # Results for a window watching the queue's descriptor; None means use transcription_signal
+        self.result_queue = None
+        supported_commands = self.config.get("dictation_commands", {}).get("supported_commands", [])
+        if hasattr(backend, "CommandEngine"):
+            # Native single-pass matcher; falls back to the regex processor on older backends
+            self.command_processor = NativeCommandProcessor(supported_commands, config_path=CONFIG_PATH)
+        else:
+            self.command_processor = EnhancedCommandProcessor(supported_commands, config_path=CONFIG_PATH)
         self.thread_pool = ThreadPoolExecutor(max_workers=3)
         self.stop_event = threading.Event()
         self.window_manager = None
+        self.focus_tracker = None
         self.error_recovery = ErrorRecoveryManager(self)
         
     def initialize(self):
@@ -83,6 +96,12 @@ class TranscriptionController(QObject):
             # Start window manager message loop in a separate thread
             self.thread_pool.submit(self.window_manager.message_loop)
             
+            # Track the foreground window from focus-change events instead of polling
+            self.focus_tracker = backend.FocusTracker.create_default()
+            self.focus_tracker.set_focus_change_callback(self._on_focus_change)
+            if not self.focus_tracker.start():
+                self.logger.warning(f"Focus tracking unavailable: {self.focus_tracker.get_last_error()}")
+            
             # Initialize keyboard simulator
             self.keyboard_simulator = backend.KeyboardSimulator()
             
@@ -92,10 +111,52 @@ class TranscriptionController(QObject):
             frame_duration_ms = 20  # 20ms frames for WebRTC VAD
             self.vad_handler = backend.VADHandler(sample_rate, frame_duration_ms, vad_aggressiveness)
             
-            # Initialize Vosk transcriber
+            # Initialize the transcriber on the configured engine; model_path
+            # is a Vosk model directory or a whisper.cpp ggml file
+            engine = self.config["transcription"].get("engine", "vosk")
+            if engine not in backend.available_speech_engines():
+                self.logger.warning(f"Speech engine '{engine}' is not available, using vosk")
+                engine = "vosk"
             model_path = str(Path(__file__).parents[2] / self.config["transcription"]["model_path"])
-            self.logger.info(f"Loading Vosk model from: {model_path}")
-            self.transcriber = backend.VoskTranscriber(model_path, sample_rate)
+            self.logger.info(f"Loading {engine} model from: {model_path}")
+            self.transcriber = backend.VoskTranscriber(model_path, sample_rate, engine)
+            self.transcriber.enable_inverse_text_normalization(
+                self.config["transcription"].get("inverse_text_normalization", True)
+            )
+            # Command mode decodes against the command phrases only; its results
+            # still go through the command processor below
+            if hasattr(self.command_processor, "engine"):
+                self.transcriber.set_command_phrases(self.command_processor.engine.get_phrases())
+            self.set_command_mode(self.config["transcription"].get("command_mode", False))
+
+            # The user's names and jargon, favored when they are close calls
+            if VOCABULARY_PATH.exists() and not self.transcriber.load_vocabulary(str(VOCABULARY_PATH)):
+                self.logger.warning(f"Could not load vocabulary: {self.transcriber.get_last_error()}")
+            
+            # Optional wake phrase gating the recognizer, instead of the hotkey toggle
+            wake_config = self.config.get("wake_word", {})
+            spotter_config = backend.KeywordSpotterConfig()
+            spotter_config.sample_rate = sample_rate
+            spotter_config.threshold = wake_config.get("threshold", spotter_config.threshold)
+            spotter_config.awake_ms = wake_config.get("awake_ms", spotter_config.awake_ms)
+            self.keyword_spotter = backend.KeywordSpotter(spotter_config)
+            if WAKE_WORD_PATH.exists():
+                try:
+                    self.keyword_spotter.load_templates(str(WAKE_WORD_PATH))
+                except RuntimeError as e:
+                    self.logger.warning(f"Could not load wake phrase: {e}")
+            self.set_wake_word_enabled(wake_config.get("enabled", False))
+            
+            metrics_config = self.config.get("metrics", {})
+            backend.set_metrics_enabled(metrics_config.get("enabled", True))
+            
+            # Optional per-chunk span tracing, dumped automatically after a slow stage
+            tracing_config = self.config.get("tracing", {})
+            if tracing_config.get("enabled", False):
+                backend.set_tracing_enabled(True)
+                threshold_ms = tracing_config.get("trigger_threshold_ms", 0)
+                if threshold_ms > 0:
+                    backend.set_trace_dump_trigger(threshold_ms, self._trace_path())
             
             # Start model loading progress monitoring
             self._start_model_loading_progress_monitoring()
@@ -108,6 +169,50 @@ class TranscriptionController(QObject):
             self.transcription_error_signal.emit({"code": "INIT_ERROR", "message": str(e)})
             return False
     
+    def set_command_mode(self, enabled):
+        """Recognize only command phrases from the next utterance on"""
+        if self.transcriber:
+            mode = backend.VoskTranscriber.RecognitionMode
+            self.transcriber.set_recognition_mode(mode.COMMANDS if enabled else mode.DICTATION)
+        return True
+
+    def add_vocabulary_phrase(self, phrase, boost=2.0):
+        """Favor a phrase in final results and save it to the user's vocabulary"""
+        if not self.transcriber:
+            return False
+        self.transcriber.set_vocabulary_phrase(phrase, boost)
+        if not self.transcriber.save_vocabulary(str(VOCABULARY_PATH)):
+            self.logger.warning(f"Could not save vocabulary: {self.transcriber.get_last_error()}")
+            return False
+        return True
+
+    def set_wake_word_enabled(self, enabled):
+        """Only pass speech to the recognizer after the wake phrase"""
+        if enabled and (not self.keyword_spotter or self.keyword_spotter.template_count() == 0):
+            self.logger.warning("No wake phrase enrolled; record one first")
+            enabled = False
+        self.wake_word_enabled = enabled
+        if self.keyword_spotter:
+            self.keyword_spotter.sleep()
+        return enabled
+
+    def record_wake_word(self):
+        """Enroll the next utterance as one recording of the wake phrase"""
+        if not self.keyword_spotter:
+            return False
+        self.wake_word_enrollment = []
+        return True
+
+    def _finish_wake_word_enrollment(self):
+        """Add the collected utterance as a wake phrase template and save all templates"""
+        chunks, self.wake_word_enrollment = self.wake_word_enrollment, None
+        try:
+            self.keyword_spotter.enroll(np.concatenate(chunks))
+            self.keyword_spotter.save_templates(str(WAKE_WORD_PATH))
+            self.logger.info(f"Enrolled wake phrase ({self.keyword_spotter.template_count()} recordings)")
+        except (RuntimeError, ValueError) as e:
+            self.logger.warning(f"Could not enroll wake phrase: {e}")
+
     def toggle_noise_filtering(self, enabled):
         """Toggle noise filtering on/off"""
         self.use_noise_filtering = enabled
@@ -128,9 +233,17 @@ class TranscriptionController(QObject):
                     if abs(progress - last_progress) >= 0.05:  # 5% change
                         last_progress = progress
                         # Emit status update signal
+                        phase = self.transcriber.get_loading_phase()
+                        if phase == backend.VoskTranscriber.LoadingPhase.WARMING_UP:
+                            message = "Warming up model..."
+                        else:
+                            message = f"Loading model... {int(progress * 100)}%"
+                        eta = self.transcriber.get_loading_eta_seconds()
+                        if eta > 0:
+                            message += f" (about {int(eta) + 1} s left)"
                         self.transcription_error_signal.emit({
                             "code": "MODEL_LOADING", 
-                            "message": f"Loading Vosk model... {int(progress * 100)}%"
+                            "message": message
                         })
                     
                     time.sleep(0.2)  # Check progress every 200ms
@@ -154,6 +267,23 @@ class TranscriptionController(QObject):
         # Start the monitoring thread
         self.thread_pool.submit(monitor_progress)
 
+    def watch_results(self):
+        """Queue results for the GUI instead of signalling each one; returns the descriptor or -1"""
+        if not hasattr(backend, "ResultQueue"):
+            return -1
+        queue = backend.ResultQueue(256)
+        if queue.ready_fd() < 0:
+            return -1
+        self.result_queue = queue
+        return queue.ready_fd()
+        
+    def _publish_result(self, result):
+        """Send a result to the GUI through the watched queue, or the signal if nobody watches it"""
+        if self.result_queue is not None:
+            self.result_queue.push(result)
+        else:
+            self.transcription_signal.emit(result)
+
     def _on_transcription_error(self, error):
         """Called when a transcription error occurs"""
         self.logger.error(f"Transcription error: {error['code']} - {error['message']}")
@@ -175,9 +305,50 @@ class TranscriptionController(QObject):
             f"Transcription error: {error['message']}"
         )
 
+    def _trace_path(self):
+        """Trace file location from the config, relative to the repository root"""
+        path = self.config.get("tracing", {}).get("trace_path", "logs/trace.json")
+        return str(Path(__file__).parents[2] / path)
+    
+    def dump_trace(self, path=None):
+        """Write buffered spans as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev)"""
+        path = path or self._trace_path()
+        Path(path).parent.mkdir(parents=True, exist_ok=True)
+        if backend.write_trace(path):
+            self.logger.info(f"Trace written to {path}")
+            return path
+        self.logger.warning(f"Could not write trace to {path}")
+        return None
+    
+    def _record_python_stage(self, stage, sequence, started_us):
+        """Report a stage that ran in Python to both the metrics registry and the trace"""
+        finished_us = backend.trace_clock_us()
+        backend.record_stage_latency(stage, (finished_us - started_us) / 1e6)
+        backend.record_trace_span(stage, sequence, started_us, finished_us)
+    
+    def get_metrics_summary(self):
+        """Per-stage latency percentiles and counters from the backend registry"""
+        snapshot = backend.get_metrics_snapshot()
+        return {
+            "uptime_seconds": snapshot.uptime_seconds,
+            "stages": {
+                stage.stage: {
+                    "count": stage.count,
+                    "p50_us": stage.p50_us,
+                    "p90_us": stage.p90_us,
+                    "p99_us": stage.p99_us,
+                    "max_us": stage.max_us,
+                }
+                for stage in snapshot.stages if stage.count
+            },
+            "counters": dict(snapshot.counters),
+        }
+    
     def cleanup(self):
         """Clean up resources"""
         self.stop_transcription()
+        if self.focus_tracker:
+            self.focus_tracker.stop()
         if self.window_manager:
             self.window_manager.destroy_hidden_window()
         self.thread_pool.shutdown(wait=False)
@@ -196,6 +367,15 @@ class TranscriptionController(QObject):
             frames_per_buffer = self.config["audio"]["frames_per_buffer"]
             self.audio_stream = backend.ControlledAudioStream(device_id, sample_rate, frames_per_buffer)
             
+            # Downshift to block wakeups and an energy gate after sustained silence
+            idle_config = self.config["audio"].get("idle", {})
+            idle_policy = backend.IdlePolicy()
+            idle_policy.enabled = idle_config.get("enabled", True)
+            idle_policy.idle_after_ms = idle_config.get("after_ms", idle_policy.idle_after_ms)
+            idle_policy.idle_block_ms = idle_config.get("block_ms", idle_policy.idle_block_ms)
+            idle_policy.wake_rms = idle_config.get("wake_rms", idle_policy.wake_rms)
+            self.audio_stream.set_idle_policy(idle_policy)
+            
             if not self.audio_stream.start():
                 error_msg = f"Failed to start audio stream: {self.audio_stream.get_last_error()}"
                 self.logger.error(error_msg)
@@ -259,44 +439,59 @@ class TranscriptionController(QObject):
     def _transcription_thread(self):
         """Thread function for audio processing and transcription"""
         self.logger.info("Transcription thread started")
+        # Utterance boundaries counted in chunks, the same endpointing the latency harness replays
         hangover_timeout_ms = self.config["audio"]["hangover_timeout_ms"]
-        hangover_counter = 0
-        silence_time = 0
-        last_speech_time = 0
-        speech_detected = False
+        chunk_ms = max(1, round(1000 * self.audio_stream.get_frames_per_buffer()
+                                / self.audio_stream.get_sample_rate()))
+        endpointer = backend.Endpointer(hangover_timeout_ms, chunk_ms)
+        chunk_wait_ms = max(100, self.audio_stream.get_idle_policy().idle_block_ms)
+        focus_generation = -1
+        current_window = ""
+        metrics_config = self.config.get("metrics", {})
+        metrics_path = metrics_config.get("prometheus_path", "")
+        metrics_interval = metrics_config.get("dump_interval_s", 15)
+        last_metrics_dump = time.monotonic()
+        backend.set_trace_thread_name("transcription")
         
         try:
             while not self.stop_event.is_set() and self.audio_stream and self.audio_stream.is_active():
-                # Check for window focus change
-                if self.config["ui"]["pause_on_active_window_change"]:
-                    current_window = backend.WindowManager.get_foreground_window_title()
-                    self.focus_changed_signal.emit(current_window)
+                # Refresh the cached window title only when the tracker saw a focus change
+                if self.focus_tracker:
+                    generation = self.focus_tracker.generation()
+                    if generation != focus_generation:
+                        focus_generation = generation
+                        current_window = self.focus_tracker.current_title()
+                
+                # Periodic Prometheus text dump for node_exporter's textfile collector
+                if metrics_path and time.monotonic() - last_metrics_dump >= metrics_interval:
+                    last_metrics_dump = time.monotonic()
+                    if not backend.write_metrics_prometheus(metrics_path):
+                        self.logger.warning(f"Could not write metrics to {metrics_path}")
                 
-                # Get next audio chunk
-                chunk = self.audio_stream.get_next_chunk()
+                # Block until the next chunk (the GIL is released while waiting);
+                # while the stream is idle this wakes once per idle block
+                chunk = self.audio_stream.get_next_chunk(chunk_wait_ms)
                 if not chunk:
-                    time.sleep(0.01)  # Small sleep to prevent CPU hogging
                     continue
                 
                 # Check for speech using VAD
                 is_speech = self.vad_handler.is_speech(chunk)
-                current_time = time.time() * 1000  # Current time in milliseconds
                 
-                if is_speech:
-                    speech_detected = True
-                    hangover_counter = hangover_timeout_ms
-                    last_speech_time = current_time
-                elif speech_detected:
-                    # Handle hangover period
-                    hangover_counter -= 20  # 20ms per frame
-                    silence_time = current_time - last_speech_time
-                    
-                    if hangover_counter <= 0 and silence_time > hangover_timeout_ms:
-                        # End of speech detected
-                        speech_detected = False
+                # Enrolling the wake phrase: keep the utterance instead of transcribing it
+                if self.wake_word_enrollment is not None:
+                    if endpointer.update(is_speech) == backend.Endpointer.Event.SPEECH_END:
+                        self._finish_wake_word_enrollment()
+                    elif endpointer.in_utterance():
+                        self.wake_word_enrollment.append(chunk.data().copy())
+                    continue
+                
+                # The recognizer only hears what follows the wake phrase
+                if self.wake_word_enabled and not self.keyword_spotter.process(chunk, is_speech):
+                    continue
+                endpointer.update(is_speech)
                 
                 # Process with transcriber - using noise filtering if enabled
-                if speech_detected or hangover_counter > 0:
+                if endpointer.in_utterance():
                     if self.use_noise_filtering:
                         result = self.transcriber.transcribe_with_noise_filtering(chunk, is_speech)
                     else:
@@ -304,20 +499,23 @@ class TranscriptionController(QObject):
 
                     # Process commands in the transcription
                     if result.raw_text:
-                        # Get foreground application for context
-                        current_window = backend.WindowManager.get_foreground_window_title()
-                        
+                        # Foreground application for context, kept current by the focus tracker
                         context = {"application_name": current_window}
+                        # Final results arrive already normalized ("23.5%", "March 5")
+                        started_us = backend.trace_clock_us()
                         result.processed_text = self.command_processor.process_with_context(
-                            result.raw_text, context
+                            result.processed_text or result.raw_text, context
                         )
+                        self._record_python_stage("command_processing", result.chunk_sequence, started_us)
                         
-                        # Emit result for GUI updates
-                        self.transcription_signal.emit(result)
+                        # Hand the result to the GUI
+                        self._publish_result(result)
                         
                         # Output text if it's a final result
                         if result.is_final and result.processed_text:
+                            started_us = backend.trace_clock_us()
                             self._output_text(result.processed_text)
+                            self._record_python_stage("output", result.chunk_sequence, started_us)
         except Exception as e:
             self.logger.error(f"Error in transcription thread: {str(e)}")
             
@@ -398,6 +596,11 @@ class TranscriptionController(QObject):
             
             self.output_error_signal.emit(error_details)
     
+    def _on_focus_change(self, window):
+        """Callback for focus change notifications (runs on the tracker thread)"""
+        if self.config["ui"]["pause_on_active_window_change"]:
+            self.focus_changed_signal.emit(window.title)
+    
     def _on_device_change(self):
         """Callback for device change notifications"""
         self.logger.info("Audio device change detected")
@@ -445,7 +648,7 @@ class MainWindow(QMainWindow):
         device_group = QGroupBox("Audio Input Device")
         device_layout = QVBoxLayout(device_group)
         
-        self.device_selector = DeviceSelector()
+        self.device_selector = DeviceSelector(cache_path=DEVICE_CACHE_PATH)
         device_layout.addWidget(self.device_selector)
         
         # Shortcut group
@@ -514,6 +717,15 @@ class MainWindow(QMainWindow):
 
         options_layout.addWidget(self.auto_recovery)
 
+        self.wake_word = QCheckBox("Listen for wake phrase")
+        self.wake_word.setChecked(self.config.get("wake_word", {}).get("enabled", False))
+        self.wake_word.stateChanged.connect(self._update_wake_word_option)
+        self.record_wake_word_button = QPushButton("Record Wake Phrase")
+        self.record_wake_word_button.clicked.connect(self._record_wake_word)
+
+        options_layout.addWidget(self.wake_word)
+        options_layout.addWidget(self.record_wake_word_button)
+
         # Add all groups to main layout
         main_layout.addWidget(device_group)
         main_layout.addWidget(shortcut_group)
@@ -554,6 +766,25 @@ class MainWindow(QMainWindow):
         self.config["error_handling"]["auto_recovery"] = enabled
         self._save_config()
 
+    def _update_wake_word_option(self, state):
+        """Gate transcription on the wake phrase"""
+        enabled = self.controller.set_wake_word_enabled(bool(state))
+        if bool(state) and not enabled:
+            self.wake_word.blockSignals(True)
+            self.wake_word.setChecked(False)
+            self.wake_word.blockSignals(False)
+            self.status_bar.showMessage("Record the wake phrase first", 5000)
+        self.config.setdefault("wake_word", {})["enabled"] = enabled
+        self._save_config()
+
+    def _record_wake_word(self):
+        """Take the next utterance as a recording of the wake phrase"""
+        if not self.controller.is_transcribing:
+            self.status_bar.showMessage("Start transcription, then record the wake phrase", 5000)
+            return
+        if self.controller.record_wake_word():
+            self.status_bar.showMessage("Say the wake phrase once; repeat for a few recordings", 5000)
+
     def _connect_signals(self):
         """Connect signals and slots"""
         # Button signals
@@ -569,6 +800,11 @@ class MainWindow(QMainWindow):
         
         # Controller signals
         self.controller.transcription_signal.connect(self._on_transcription)
+        # Results wake the event loop through a descriptor rather than a queued signal per result
+        result_fd = self.controller.watch_results()
+        if result_fd >= 0:
+            self.result_notifier = QSocketNotifier(result_fd, QSocketNotifier.Read, self)
+            self.result_notifier.activated.connect(self._drain_results)
         self.controller.audio_error_signal.connect(self._on_audio_error)
         self.controller.transcription_error_signal.connect(self._on_transcription_error)
         self.controller.output_error_signal.connect(self._on_output_error)
@@ -789,6 +1025,14 @@ class MainWindow(QMainWindow):
         else:
             self.status_text.setText(f"Partial: {result.raw_text}")
             
+    def _drain_results(self):
+        """Called when the result queue's descriptor is readable"""
+        while True:
+            result = self.controller.result_queue.pop()
+            if result is None:
+                break
+            self._on_transcription(result)
+            
     def _on_audio_error(self, error):
         """Called when an audio error occurs"""
         self.logger.error(f"Audio error: {error['code']} - {error['message']}")
@@ -881,6 +1125,7 @@ class MainWindow(QMainWindow):
                 return
                 
         # Clean up resources
+        self.device_selector.shutdown()
         if hasattr(self, 'controller'):
             self.controller.cleanup()
             
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Streaming transcription for asyncio code.
+
+    stream = backend.ControlledAudioStream(device_id, 16000, 320)
+    transcriber = backend.VoskTranscriber(model_path, 16000)
+    async with AsyncTranscriptionPipeline(stream, transcriber) as pipeline:
+        async for result in pipeline.results():
+            print(result.is_final, result.processed_text)
+
+The transcription loop runs on a native thread that never takes the GIL,
+and results are read from its ResultQueue when the queue's descriptor polls
+readable, so one event loop can serve many sessions without an executor
+thread per session. On Windows this needs a selector event loop
+(asyncio.WindowsSelectorEventLoopPolicy); under the default proactor loop
+results are waited for in the default executor instead.
+"""
+import asyncio
+import os
+import sys
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from utils.logger import setup_logger
+
+try:
+    import voice_transcription_backend as backend
+except ImportError:
+    backend = None
+
+# How long an executor wait blocks when the loop cannot watch descriptors
+_FALLBACK_WAIT_MS = 100
+
+
+async def _wait_readable(loop, fd):
+    """Wait until fd polls readable; the reader is removed on return or cancellation"""
+    ready = loop.create_future()
+
+    def on_readable():
+        # Level-triggered: stop watching at once so an undrained queue cannot spin the loop
+        loop.remove_reader(fd)
+        if not ready.done():
+            ready.set_result(None)
+
+    loop.add_reader(fd, on_readable)
+    try:
+        await ready
+    finally:
+        loop.remove_reader(fd)
+
+
+class AsyncTranscriptionPipeline:
+    """Async-iterable results from a backend.TranscriptionPipeline."""
+
+    def __init__(self, stream, transcriber, config=None):
+        if backend is None or not hasattr(backend, "TranscriptionPipeline"):
+            raise ImportError("voice_transcription_backend with TranscriptionPipeline is required")
+        self.logger = setup_logger("async_pipeline")
+        self._pipeline = backend.TranscriptionPipeline(
+            stream, transcriber, config or backend.TranscriptionPipelineConfig()
+        )
+
+    def start(self):
+        """Start the stream and the native decode thread"""
+        if not self._pipeline.start():
+            raise RuntimeError(f"Cannot start pipeline: {self._pipeline.get_last_error()}")
+
+    async def stop(self):
+        """Stop the session; speech still open is finalized into the queue first"""
+        self._pipeline.request_stop()
+        # The join is short and off the hot path, so it may block an executor thread
+        await asyncio.get_running_loop().run_in_executor(None, self._pipeline.stop)
+
+    def is_running(self):
+        return self._pipeline.is_running()
+
+    def get_last_error(self):
+        return self._pipeline.get_last_error()
+
+    async def results(self):
+        """Yield results until the session ends.
+
+        Cancelling the consuming task stops the iteration but not the
+        session; use the pipeline as an async context manager, or call
+        stop(), to end the session too.
+        """
+        loop = asyncio.get_running_loop()
+        queue = self._pipeline.get_results()
+        fd = queue.ready_fd()
+        watch_fd = fd >= 0
+        while True:
+            # Closed is read before popping: the decode thread pushes its last
+            # result and then closes, so an empty pop after seeing closed
+            # means nothing is left
+            closed = queue.is_closed()
+            result = queue.pop()
+            if result is not None:
+                yield result
+                continue
+            if closed:
+                return
+            if watch_fd:
+                try:
+                    await _wait_readable(loop, fd)
+                    continue
+                except NotImplementedError:
+                    self.logger.warning("Event loop cannot watch descriptors; waiting in the executor")
+                    watch_fd = False
+            result = await loop.run_in_executor(None, queue.wait_pop, _FALLBACK_WAIT_MS)
+            if result is not None:
+                yield result
+
+    def __aiter__(self):
+        return self.results()
+
+    async def __aenter__(self):
+        self.start()
+        return self
+
+    async def __aexit__(self, exc_type, exc, traceback):
+        await self.stop()
+        return False
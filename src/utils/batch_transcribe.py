@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Offline batch transcription of recorded WAV files.
+
+Usage:
+    python src/utils/batch_transcribe.py INPUT [INPUT ...] --output report.json
+        [--engine vosk] [--model models/vosk/vosk-model-en-us-0.22] [--threads N]
+        [--min-silence-ms 500] [--max-segment-ms 30000] [--padding-ms 300]
+        [--keep-silence] [--text-dir DIR]
+
+INPUT is a WAV file, a directory (searched recursively for .wav files) or a
+.txt/.lst file listing one path per line. Files are split at pauses and the
+segments are decoded on a pool of recognizers sharing one model. Only padded
+speech regions are decoded unless --keep-silence is given.
+"""
+import argparse
+import json
+import os
+import sys
+from pathlib import Path
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from utils.logger import setup_logger
+
+try:
+    import voice_transcription_backend as backend
+except ImportError:
+    print("Error: Could not import voice_transcription_backend module")
+    print("Make sure the C++ backend is compiled and installed correctly")
+    sys.exit(1)
+
+CONFIG_PATH = Path(__file__).parents[1] / "config" / "settings.json"
+
+
+def _load_transcription_config():
+    try:
+        with open(CONFIG_PATH, "r") as f:
+            return json.load(f).get("transcription", {})
+    except Exception:
+        return {}
+
+
+def main():
+    settings = _load_transcription_config()
+    parser = argparse.ArgumentParser(description="Transcribe recorded WAV files in parallel")
+    parser.add_argument("inputs", nargs="+", help="WAV files, directories or file lists")
+    parser.add_argument("--output", required=True, help="JSON report path")
+    parser.add_argument("--engine", default=settings.get("engine", "vosk"))
+    parser.add_argument("--model", default=settings.get("model_path", "models/vosk/vosk-model-en-us-0.22"))
+    parser.add_argument("--threads", type=int, default=0, help="0 uses every hardware thread")
+    parser.add_argument("--vad", type=int, default=2, help="VAD aggressiveness 0-3")
+    parser.add_argument("--min-silence-ms", type=int, default=500)
+    parser.add_argument("--max-segment-ms", type=int, default=30000)
+    parser.add_argument("--padding-ms", type=int, default=300, help="Audio kept around detected speech")
+    parser.add_argument("--keep-silence", action="store_true", help="Decode silence too")
+    parser.add_argument("--text-dir", help="Also write one .txt transcript per file here")
+    args = parser.parse_args()
+
+    logger = setup_logger("batch_transcribe")
+
+    config = backend.BatchTranscriberConfig()
+    config.engine = args.engine
+    config.model_path = args.model
+    config.threads = args.threads
+    config.vad_aggressiveness = args.vad
+    config.min_silence_ms = args.min_silence_ms
+    config.max_segment_ms = args.max_segment_ms
+    config.speech_padding_ms = args.padding_ms
+    config.skip_silence = not args.keep_silence
+
+    files = backend.BatchTranscriber.collect_audio_files(args.inputs)
+    if not files:
+        logger.error("No audio files found")
+        return 1
+
+    transcriber = backend.BatchTranscriber(config)
+    logger.info(f"Loading {args.engine} model from: {args.model}")
+    if not transcriber.load_model():
+        logger.error(f"Failed to load model: {transcriber.get_last_error()}")
+        return 1
+
+    text_dir = Path(args.text_dir) if args.text_dir else None
+    if text_dir:
+        text_dir.mkdir(parents=True, exist_ok=True)
+
+    def on_file(result):
+        if result.error:
+            logger.error(f"{result.path}: {result.error}")
+            return
+        logger.info(f"{result.path}: {result.duration_ms / 1000:.1f} s, {len(result.segments)} segments")
+        if text_dir:
+            (text_dir / (Path(result.path).stem + ".txt")).write_text(result.text() + "\n")
+
+    transcriber.set_file_callback(on_file)
+    logger.info(f"Transcribing {len(files)} files on {transcriber.get_thread_count()} threads")
+    report = transcriber.run(files)
+    if not report.write_json(args.output):
+        logger.error(f"Cannot write {args.output}")
+        return 1
+
+    logger.info(f"{report.audio_seconds:.1f} s of audio in {report.wall_seconds:.1f} s "
+                f"({report.speed():.1f}x real time), {report.decoded_seconds:.1f} s decoded")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
\ No newline at end of file
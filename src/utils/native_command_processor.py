@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+import json
+import sys
+import os
+
+# Import logger
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from utils.logger import setup_logger
+from utils.enhanced_command_processor import EnhancedCommandProcessor
+
+try:
+    import voice_transcription_backend as backend
+except ImportError:
+    backend = None
+
+class NativeCommandProcessor(EnhancedCommandProcessor):
+    """Enhanced command processor backed by the C++ CommandEngine.
+
+    Phrase matching, capitalization and smart spacing run in one native pass over
+    the text instead of a large alternation regex plus several re.sub passes.
+    Context-specific post-processing is inherited unchanged."""
+
+    def __init__(self, supported_commands=None, config_path=None):
+        if backend is None or not hasattr(backend, "CommandEngine"):
+            raise ImportError("voice_transcription_backend with CommandEngine is required")
+
+        # Must exist before the base constructor compiles the command table
+        self.engine = backend.CommandEngine()
+        if config_path:
+            # Reuse the compiled automaton across runs while the commands are unchanged
+            self.engine.set_cache_path(os.path.join(os.path.dirname(config_path), "command_cache.bin"))
+        self._initialized = False
+        super().__init__(supported_commands, config_path)
+        self._initialized = True
+        self.logger = setup_logger("native_command_processor")
+
+    def _compile_patterns(self):
+        """Compile the command table into the native automaton.
+
+        The first build is synchronous so the processor is ready on return; later
+        changes compile in the background while matching keeps the old snapshot."""
+        commands = json.dumps([{"phrase": phrase, "action": action} for phrase, action in self.commands.items()])
+        compile_commands = self.engine.reload_json if self._initialized else self.engine.load_json
+        if not compile_commands(commands):
+            self.logger.error(f"Failed to compile commands: {self.engine.get_last_error()}")
+        # Only the native engine matches commands
+        self.command_pattern = None
+
+    def process(self, text):
+        """Replace command phrases with their actions and apply smart formatting"""
+        if not text:
+            return text
+        return self.engine.process(text)
+
+    def set_capitalization_mode(self, mode):
+        """Set the capitalization mode"""
+        if self.engine.set_capitalization_mode(mode):
+            self.capitalization_mode = mode
+            return True
+        return False
\ No newline at end of file
@@ -1,8 +1,12 @@
 #!/usr/bin/env python3
+import asyncio
 import os
 import sys
 import time
 import unittest
+from collections import deque
+from types import SimpleNamespace
+from unittest import mock
 from pathlib import Path
 
 # Add project path to system path for imports
@@ -25,6 +29,7 @@ except ImportError:
 try:
     from utils.logger import setup_logger
     from utils.command_processor import CommandProcessor
+    from utils import async_pipeline
 except ImportError as e:
     print(f"Error importing Python modules: {e}")
     sys.exit(1)
@@ -212,6 +217,79 @@ class CommandProcessorTests(unittest.TestCase):
         self.assertEqual(processed, "hello :) goodbye")
 
 
+class _FakeResultQueue:
+    """ResultQueue whose decode thread finishes at the worst moment: the
+    final result and close() land just after a pop() finds the queue empty"""
+
+    def __init__(self):
+        self.items = deque()
+        self.closed = False
+        self.on_empty_pop = None
+
+    def ready_fd(self):
+        return -1
+
+    def is_closed(self):
+        return self.closed
+
+    def pop(self):
+        result = self.items.popleft() if self.items else None
+        if result is None and self.on_empty_pop:
+            finish, self.on_empty_pop = self.on_empty_pop, None
+            finish()
+        return result
+
+    def wait_pop(self, timeout_ms):
+        return self.items.popleft() if self.items else None
+
+
+class _FakePipeline:
+    """TranscriptionPipeline stopped mid-utterance: stopping finalizes the open speech"""
+
+    def __init__(self, stream, transcriber, config):
+        self.queue = _FakeResultQueue()
+        self.queue.items.append(SimpleNamespace(is_final=False, processed_text="hello"))
+
+    def start(self):
+        return True
+
+    def request_stop(self):
+        def finish():
+            self.queue.items.append(SimpleNamespace(is_final=True, processed_text="hello world"))
+            self.queue.closed = True
+        self.queue.on_empty_pop = finish
+
+    def stop(self):
+        pass
+
+    def get_results(self):
+        return self.queue
+
+
+class AsyncPipelineTests(unittest.TestCase):
+    """Tests for the asyncio wrapper around TranscriptionPipeline"""
+
+    def test_stop_mid_utterance_yields_final(self):
+        """Test that the result finalized by a stop is yielded before the iteration ends"""
+        fake_backend = SimpleNamespace(TranscriptionPipeline=_FakePipeline,
+                                       TranscriptionPipelineConfig=object)
+
+        async def collect():
+            results = []
+            async with async_pipeline.AsyncTranscriptionPipeline(None, None) as pipeline:
+                async for result in pipeline.results():
+                    results.append(result)
+                    if not result.is_final:
+                        pipeline._pipeline.request_stop()
+            return results
+
+        with mock.patch.object(async_pipeline, "backend", fake_backend):
+            results = asyncio.run(collect())
+
+        self.assertEqual([r.processed_text for r in results], ["hello", "hello world"])
+        self.assertTrue(results[-1].is_final)
+
+
 def run_tests():
     """Run all tests"""
     # Create test suite
@@ -223,6 +301,7 @@ def run_tests():
     test_suite.addTest(unittest.makeSuite(TranscriptionTests))
     test_suite.addTest(unittest.makeSuite(KeyboardSimulatorTests))
     test_suite.addTest(unittest.makeSuite(CommandProcessorTests))
+    test_suite.addTest(unittest.makeSuite(AsyncPipelineTests))
     
     # Run tests
     runner = unittest.TextTestRunner(verbosity=2)
@@ -1,8 +1,28 @@
 #include <gtest/gtest.h>
 #include "audio_stream.h"
+#include "metrics.h"
+#include "trace_recorder.h"
+
+#include <chrono>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 using namespace voice_transcription;
 
+// Input level of the PortAudio mock's tone
+extern "C" void PaMock_SetInputLevel(float level);
+
+static uint64_t counter_value(const std::string& name) {
+    for (const auto& entry : MetricsRegistry::instance().snapshot().counters) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
 // Test that the audio device enumeration works
 TEST(AudioStreamTest, DeviceEnumeration) {
     auto devices = ControlledAudioStream::enumerate_devices();
@@ -57,4 +77,165 @@ TEST(AudioStreamTest, AudioChunkMove) {
     for (size_t i = 0; i < chunk_size; i++) {
         EXPECT_FLOAT_EQ(moved.data()[i], static_cast<float>(i) / chunk_size);
     }
-}
\ No newline at end of file
+}
+
+// Test that chunks from a running stream carry consecutive sequence numbers
+TEST(AudioStreamTest, ChunkSequence) {
+    auto devices = ControlledAudioStream::enumerate_devices();
+    if (devices.empty()) {
+        GTEST_SKIP() << "No input device";
+    }
+
+    ControlledAudioStream stream(devices[0].id, 16000, 320);
+    if (!stream.start()) {
+        GTEST_SKIP() << "Cannot open input stream: " << stream.get_last_error();
+    }
+
+    std::vector<uint64_t> sequences;
+    std::vector<uint64_t> first_samples;
+    std::vector<int64_t> capture_times;
+    while (sequences.size() < 3) {
+        auto chunk = stream.get_next_chunk(500);
+        ASSERT_TRUE(chunk.has_value());
+        EXPECT_EQ(chunk->size(), 320u);
+        sequences.push_back(chunk->sequence());
+        first_samples.push_back(chunk->first_sample());
+        capture_times.push_back(chunk->capture_time_us());
+        EXPECT_GT(chunk->capture_time_us(), 0);
+        EXPECT_LE(chunk->capture_time_us(), trace_clock_us());
+    }
+    stream.stop();
+
+    EXPECT_EQ(sequences[1], sequences[0] + 1);
+    EXPECT_EQ(sequences[2], sequences[1] + 1);
+    EXPECT_EQ(first_samples[0], sequences[0] * 320);
+    EXPECT_EQ(first_samples[2], first_samples[1] + 320);
+    EXPECT_GT(capture_times[2], capture_times[1]);
+}
+
+// Test that reads are dated from the ADC time of the write that delivered them
+TEST(AudioStreamTest, CaptureTimeline) {
+    AudioCallbackContext context;
+    context.frames_per_buffer = 160;
+    context.sample_rate = 16000;
+    std::vector<float> block(256, 0.0f);
+    context.write_data(block.data(), block.size(), 1000000);
+    context.write_data(block.data(), block.size(), 1016000);
+
+    // 160 samples are 10 ms, so the second read starts 10 ms into the first write
+    std::vector<float> output(160);
+    uint64_t first_sample = 0;
+    int64_t capture_time_us = 0;
+    ASSERT_EQ(context.read_data(output.data(), 160, &first_sample, &capture_time_us), 160u);
+    EXPECT_EQ(first_sample, 0u);
+    EXPECT_EQ(capture_time_us, 1000000);
+    ASSERT_EQ(context.read_data(output.data(), 160, &first_sample, &capture_time_us), 160u);
+    EXPECT_EQ(first_sample, 160u);
+    EXPECT_EQ(capture_time_us, 1010000);
+    ASSERT_EQ(context.read_data(output.data(), 160, &first_sample, &capture_time_us), 160u);
+    EXPECT_EQ(first_sample, 320u);
+    EXPECT_EQ(capture_time_us, 1016000 + 4000);
+
+    // Writes without a capture time leave reads undated
+    context.clear();
+    context.write_data(block.data(), 160);
+    ASSERT_EQ(context.read_data(output.data(), 160, &first_sample, &capture_time_us), 160u);
+    EXPECT_EQ(capture_time_us, 0);
+}
+// Test that a quiet stream downshifts to block wakeups and comes back on sound
+TEST(AudioStreamTest, IdleDownshift) {
+    PaMock_SetInputLevel(0.0f);
+    ControlledAudioStream stream(0, 16000, 320);
+    IdlePolicy policy;
+    policy.enabled = true;
+    policy.idle_after_ms = 200;
+    policy.idle_block_ms = 400;
+    stream.set_idle_policy(policy);
+    ASSERT_TRUE(stream.start()) << stream.get_last_error();
+
+    uint64_t wakeups_before = counter_value("consumer_wakeups");
+    size_t delivered = 0;
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+    while (std::chrono::steady_clock::now() < until) {
+        if (stream.get_next_chunk(1000)) {
+            delivered++;
+        }
+    }
+    EXPECT_TRUE(stream.is_idle());
+    // 200 ms of chunks at full rate, then nothing; at full rate 1.5 s is 75 wakeups
+    EXPECT_LE(delivered, 13u);
+    EXPECT_LT(counter_value("consumer_wakeups") - wakeups_before, 25u);
+    EXPECT_GT(counter_value("idle_chunks_skipped"), 0u);
+
+    // The first loud chunk restores full rate, preceded by the chunk before it
+    PaMock_SetInputLevel(0.1f);
+    std::optional<AudioChunk> first;
+    for (int i = 0; i < 5 && !first; i++) {
+        first = stream.get_next_chunk(1000);
+    }
+    ASSERT_TRUE(first.has_value());
+    EXPECT_FALSE(stream.is_idle());
+    std::optional<AudioChunk> second = stream.get_next_chunk(1000);
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(second->first_sample(), first->first_sample() + 320);
+    EXPECT_GT(std::abs(second->data()[10]) + std::abs(second->data()[20]), 0.0f);
+    stream.stop();
+}
+
+#ifndef _WIN32
+// Test that the stream's descriptor wakes poll() for each chunk and settles once drained
+TEST(AudioStreamTest, ReadyDescriptor) {
+    PaMock_SetInputLevel(0.1f);
+    ControlledAudioStream stream(0, 16000, 320);
+    ASSERT_GE(stream.get_ready_fd(), 0);
+    ASSERT_TRUE(stream.start()) << stream.get_last_error();
+
+    pollfd entry = { static_cast<int>(stream.get_ready_fd()), POLLIN, 0 };
+    size_t delivered = 0;
+    for (int i = 0; i < 10; i++) {
+        entry.revents = 0;
+        ASSERT_EQ(poll(&entry, 1, 1000), 1);
+        // Everything the descriptor announced can be read without waiting
+        while (stream.get_next_chunk(0)) {
+            delivered++;
+        }
+    }
+    EXPECT_GE(delivered, 10u);
+
+    stream.stop();
+    entry.revents = 0;
+    EXPECT_EQ(poll(&entry, 1, 100), 0);
+}
+
+// Test that a descriptor-driven consumer keeps up once the stream leaves idle
+TEST(AudioStreamTest, ReadyDescriptorAfterIdle) {
+    PaMock_SetInputLevel(0.0f);
+    ControlledAudioStream stream(0, 16000, 320);
+    IdlePolicy policy;
+    policy.enabled = true;
+    policy.idle_after_ms = 200;
+    policy.idle_block_ms = 400;
+    stream.set_idle_policy(policy);
+    ASSERT_TRUE(stream.start()) << stream.get_last_error();
+
+    // One chunk per readiness event, as a QSocketNotifier or add_reader consumer reads
+    pollfd entry = { static_cast<int>(stream.get_ready_fd()), POLLIN, 0 };
+    auto read_for = [&](int ms) {
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < until) {
+            entry.revents = 0;
+            if (poll(&entry, 1, 50) == 1) {
+                stream.get_next_chunk(0);
+            }
+        }
+    };
+    read_for(800);
+    ASSERT_TRUE(stream.is_idle());
+
+    PaMock_SetInputLevel(0.1f);
+    read_for(1500);
+    EXPECT_FALSE(stream.is_idle());
+    EXPECT_LT(stream.get_stats().buffered_samples, 320u);
+    stream.stop();
+}
+#endif
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "audio_stream.h"
+#include "audio_subsystem.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+// Initialization depth and overlapping API calls seen by the PortAudio mock
+extern "C" int PaMock_GetInitCount(void);
+extern "C" int PaMock_GetOverlappingCalls(void);
+extern "C" void PaMock_SetInputLevel(float level);
+
+// Test that PortAudio is initialized once per set of references and terminated after the last
+TEST(AudioSubsystemTest, ReferenceCounting) {
+    ASSERT_EQ(AudioSubsystem::reference_count(), 0);
+    ASSERT_EQ(PaMock_GetInitCount(), 0);
+
+    std::shared_ptr<AudioSubsystem> first = AudioSubsystem::acquire();
+    std::shared_ptr<AudioSubsystem> second = AudioSubsystem::acquire();
+    EXPECT_EQ(AudioSubsystem::reference_count(), 2);
+    EXPECT_EQ(PaMock_GetInitCount(), 1);
+    first.reset();
+    EXPECT_EQ(PaMock_GetInitCount(), 1);
+    second.reset();
+    EXPECT_EQ(AudioSubsystem::reference_count(), 0);
+    EXPECT_EQ(PaMock_GetInitCount(), 0);
+
+    // A stream holds a reference for its lifetime; device queries only while they run
+    {
+        ControlledAudioStream stream(0, 16000, 320);
+        EXPECT_EQ(AudioSubsystem::reference_count(), 1);
+        EXPECT_FALSE(ControlledAudioStream::enumerate_devices().empty());
+        EXPECT_EQ(AudioSubsystem::reference_count(), 1);
+        ControlledAudioStream moved(std::move(stream));
+        EXPECT_EQ(AudioSubsystem::reference_count(), 1);
+    }
+    EXPECT_EQ(PaMock_GetInitCount(), 0);
+    EXPECT_TRUE(ControlledAudioStream::check_device_compatibility(0, 16000));
+    EXPECT_EQ(PaMock_GetInitCount(), 0);
+}
+
+// Load test: many streams opened, read and closed at once from their own threads
+TEST(AudioSubsystemTest, ConcurrentStreams) {
+    const int kStreams = 16;
+    const size_t kChunks = 25;     // Half a second of 20 ms chunks
+    PaMock_SetInputLevel(0.1f);
+    int overlapping_before = PaMock_GetOverlappingCalls();
+
+    struct Outcome {
+        bool started = false;
+        size_t chunks = 0;
+        bool contiguous = true;
+        AudioStreamStats stats;
+    };
+    std::vector<Outcome> outcomes(kStreams);
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kStreams; i++) {
+        threads.emplace_back([&, i]() {
+            Outcome& outcome = outcomes[i];
+            ControlledAudioStream stream(0, 16000, 320);
+            outcome.started = stream.start();
+            if (!outcome.started) {
+                return;
+            }
+            int now = ++running;
+            int seen = peak.load();
+            while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+            }
+
+            uint64_t expected = 0;
+            bool first = true;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (outcome.chunks < kChunks && std::chrono::steady_clock::now() < deadline) {
+                std::optional<AudioChunk> chunk = stream.get_next_chunk(200);
+                if (!chunk) {
+                    continue;
+                }
+                // Each stream's samples stay in order, with no gaps and nothing from another stream
+                if (!first && chunk->first_sample() != expected) {
+                    outcome.contiguous = false;
+                }
+                first = false;
+                expected = chunk->first_sample() + 320;
+                outcome.chunks++;
+            }
+            outcome.stats = stream.get_stats();
+            running--;
+            stream.stop();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < kStreams; i++) {
+        const Outcome& outcome = outcomes[i];
+        ASSERT_TRUE(outcome.started) << "stream " << i;
+        EXPECT_EQ(outcome.chunks, kChunks) << "stream " << i;
+        EXPECT_TRUE(outcome.contiguous) << "stream " << i;
+        EXPECT_EQ(outcome.stats.chunks_delivered, kChunks) << "stream " << i;
+        EXPECT_GE(outcome.stats.callbacks, kChunks) << "stream " << i;
+        EXPECT_EQ(outcome.stats.samples_captured, outcome.stats.callbacks * 320) << "stream " << i;
+        EXPECT_EQ(outcome.stats.overflows, 0u) << "stream " << i;
+    }
+    EXPECT_GT(peak.load(), 1);
+    EXPECT_EQ(PaMock_GetOverlappingCalls(), overlapping_before);
+    EXPECT_EQ(AudioSubsystem::reference_count(), 0);
+    EXPECT_EQ(PaMock_GetInitCount(), 0);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include "batch_transcriber.h"
+#include "wav_file_stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace voice_transcription;
+
+static constexpr int kRate = 16000;
+
+static void append_tone(std::vector<float>& samples, double seconds) {
+    size_t count = static_cast<size_t>(seconds * kRate);
+    for (size_t i = 0; i < count; i++) {
+        samples.push_back(0.3f * std::sin(2.0f * 3.14159265f * 440.0f * i / kRate));
+    }
+}
+
+static void append_silence(std::vector<float>& samples, double seconds) {
+    samples.insert(samples.end(), static_cast<size_t>(seconds * kRate), 0.0f);
+}
+
+// 1 s speech, 1 s pause, 1 s speech, 0.3 s pause, 0.5 s speech
+static std::vector<float> meeting() {
+    std::vector<float> samples;
+    append_tone(samples, 1.0);
+    append_silence(samples, 1.0);
+    append_tone(samples, 1.0);
+    append_silence(samples, 0.3);
+    append_tone(samples, 0.5);
+    return samples;
+}
+
+static BatchTranscriberConfig synthetic_config(const std::string& name) {
+    std::string script = ::testing::TempDir() + name;
+    std::ofstream out(script);
+    out << "utterance = hello world\n";
+    BatchTranscriberConfig config;
+    config.engine = "synthetic";
+    config.model_path = script;
+    config.threads = 2;
+    return config;
+}
+
+// Test that files are cut in the middle of long pauses only
+TEST(BatchTranscriberTest, SplitAtSilence) {
+    std::vector<float> samples = meeting();
+    BatchTranscriberConfig config;
+    std::vector<SampleRange> ranges = BatchTranscriber::split_at_silence(samples, kRate, config);
+
+    // The 1 s pause spans VAD frames 50..99, so the cut is at frame 75
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].start_sample, 0u);
+    EXPECT_EQ(ranges[0].end_sample, 24000u);
+    EXPECT_EQ(ranges[1].start_sample, 24000u);
+    EXPECT_EQ(ranges[1].end_sample, samples.size());
+}
+
+// Test that long speech is split and the ranges still cover every sample
+TEST(BatchTranscriberTest, SplitLongSpeech) {
+    std::vector<float> samples;
+    append_tone(samples, 5.0);
+    append_silence(samples, 0.1);
+    append_tone(samples, 5.0);
+    BatchTranscriberConfig config;
+    config.max_segment_ms = 7000;
+    std::vector<SampleRange> ranges = BatchTranscriber::split_at_silence(samples, kRate, config);
+
+    ASSERT_EQ(ranges.size(), 2u);
+    // Split inside the short pause rather than at the 7 s limit
+    EXPECT_GE(ranges[0].end_sample, 80000u);
+    EXPECT_LE(ranges[0].end_sample, 81600u);
+    EXPECT_EQ(ranges[1].start_sample, ranges[0].end_sample);
+    EXPECT_EQ(ranges[1].end_sample, samples.size());
+    for (const auto& range : ranges) {
+        EXPECT_LE(range.end_sample - range.start_sample, 7000u * kRate / 1000);
+    }
+}
+
+// Test that results come back in input order with exact timestamps
+TEST(BatchTranscriberTest, RunKeepsOrder) {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 4; i++) {
+        paths.push_back(::testing::TempDir() + "batch_" + std::to_string(i) + ".wav");
+        ASSERT_TRUE(WavFileStream::write_wav(paths.back(), meeting(), kRate));
+    }
+    paths.insert(paths.begin() + 2, ::testing::TempDir() + "batch_missing.wav");
+
+    BatchTranscriberConfig config = synthetic_config("batch_script.conf");
+    config.skip_silence = false;
+    BatchTranscriber transcriber(config);
+    std::vector<std::string> callback_order;
+    transcriber.set_file_callback([&](const BatchFileResult& result) {
+        callback_order.push_back(result.path);
+    });
+
+    BatchReport report;
+    ASSERT_TRUE(transcriber.run(paths, report)) << transcriber.get_last_error();
+    EXPECT_EQ(callback_order, paths);
+    ASSERT_EQ(report.files.size(), paths.size());
+    EXPECT_EQ(report.threads, 2);
+    EXPECT_NEAR(report.audio_seconds, 4 * 3.8, 1e-6);
+
+    for (size_t i = 0; i < paths.size(); i++) {
+        const BatchFileResult& file = report.files[i];
+        EXPECT_EQ(file.path, paths[i]);
+        if (i == 2) {
+            EXPECT_FALSE(file.error.empty());
+            EXPECT_TRUE(file.segments.empty());
+            continue;
+        }
+        EXPECT_TRUE(file.error.empty()) << file.error;
+        ASSERT_EQ(file.segments.size(), 2u);
+        EXPECT_EQ(file.segments[0].start_sample, 0u);
+        EXPECT_EQ(file.segments[0].end_sample, 24000u);
+        EXPECT_DOUBLE_EQ(file.segments[1].start_ms, 1500.0);
+        EXPECT_EQ(file.text(), "hello world hello world");
+    }
+
+    std::string json = report.to_json();
+    EXPECT_NE(json.find("\"engine\":\"synthetic\""), std::string::npos);
+    EXPECT_NE(json.find("\"start_sample\":24000"), std::string::npos);
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+// Test that skipped silence is not decoded and timestamps map back past it
+TEST(BatchTranscriberTest, SkipSilence) {
+    std::string path = ::testing::TempDir() + "batch_skip.wav";
+    ASSERT_TRUE(WavFileStream::write_wav(path, meeting(), kRate));
+
+    BatchTranscriber transcriber(synthetic_config("batch_skip.conf"));
+    BatchReport report;
+    ASSERT_TRUE(transcriber.run({ path }, report)) << transcriber.get_last_error();
+    ASSERT_EQ(report.files.size(), 1u);
+    const BatchFileResult& file = report.files[0];
+
+    // Speech at 0-1 s, 2-3 s and 3.3-3.8 s padded by 300 ms; the last two merge
+    EXPECT_NEAR(file.speech_ms, 1300.0 + 2100.0, 1e-6);
+    EXPECT_NEAR(report.decoded_seconds, 3.4, 1e-6);
+    ASSERT_EQ(file.segments.size(), 2u);
+    EXPECT_EQ(file.segments[0].start_sample, 0u);
+    EXPECT_EQ(file.segments[0].end_sample, 20800u);
+    EXPECT_EQ(file.segments[1].start_sample, 27200u);
+    EXPECT_EQ(file.segments[1].end_sample, 60800u);
+    EXPECT_EQ(file.text(), "hello world hello world");
+    EXPECT_NE(report.to_json().find("\"skipped_fraction\":0.105"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+// Test that a bad model fails the run
+TEST(BatchTranscriberTest, ModelLoadFailure) {
+    BatchTranscriberConfig config;
+    config.engine = "nonexistent";
+    BatchTranscriber transcriber(config);
+    BatchReport report;
+    EXPECT_FALSE(transcriber.run({}, report));
+    EXPECT_FALSE(transcriber.get_last_error().empty());
+}
+
+// Test expansion of directories and file lists
+TEST(BatchTranscriberTest, CollectAudioFiles) {
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(::testing::TempDir()) / "batch_collect";
+    fs::remove_all(root);
+    fs::create_directories(root / "nested");
+    std::ofstream(root / "b.wav").put('x');
+    std::ofstream(root / "nested" / "a.WAV").put('x');
+    std::ofstream(root / "notes.md").put('x');
+    fs::path list = root / "list.txt";
+    std::ofstream(list) << "# meetings\nfirst.wav\n\nsecond.wav\n";
+
+    std::vector<std::string> files;
+    std::string error;
+    ASSERT_TRUE(BatchTranscriber::collect_audio_files({ root.string(), list.string() }, files, error)) << error;
+    ASSERT_EQ(files.size(), 4u);
+    EXPECT_EQ(files[0], (root / "b.wav").string());
+    EXPECT_EQ(files[1], (root / "nested" / "a.WAV").string());
+    EXPECT_EQ(files[2], "first.wav");
+    EXPECT_EQ(files[3], "second.wav");
+    fs::remove_all(root);
+}
\ No newline at end of file
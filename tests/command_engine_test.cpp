@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include "command_engine.h"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+static std::vector<CommandDefinition> default_commands() {
+    return {
+        { "period", ".", { "full stop", "dot" } },
+        { "comma", ",", {} },
+        { "question mark", "?", {} },
+        { "exclamation point", "!", { "exclamation mark" } },
+        { "new line", "{ENTER}", {} },
+        { "new paragraph", "{ENTER}{ENTER}", {} },
+        { "tab key", "{TAB}", { "tab" } },
+        { "all caps", "{ALLCAPS_ON}", {} },
+        { "no caps", "{ALLCAPS_OFF}", {} },
+        { "open parenthesis", "(", {} },
+        { "close parenthesis", ")", {} },
+        { "quote", "\"", {} },
+        { "at sign", "@", { "at" } }
+    };
+}
+
+// Test basic phrase replacement with capitalization and spacing
+TEST(CommandEngineTest, CommandReplacement) {
+    CommandEngine engine(default_commands());
+
+    EXPECT_EQ(engine.process("end of sentence period"), "End of sentence.");
+    EXPECT_EQ(engine.process("is this working question mark"), "Is this working?");
+    EXPECT_EQ(engine.process("first line new line second line"), "First line{ENTER}second line");
+}
+
+// Test several commands in one utterance, including sentence capitalization
+TEST(CommandEngineTest, MultipleCommands) {
+    CommandEngine engine(default_commands());
+
+    EXPECT_EQ(engine.process("hello comma how are you question mark new paragraph this is great exclamation point"),
+              "Hello, how are you?{ENTER}{ENTER}This is great!");
+}
+
+// Test that the longest phrase wins when phrases share words
+TEST(CommandEngineTest, LongestMatchWins) {
+    CommandEngine engine(default_commands());
+
+    EXPECT_EQ(engine.process("press tab key now"), "Press{TAB}now");
+    EXPECT_EQ(engine.process("press tab now"), "Press{TAB}now");
+    EXPECT_EQ(engine.process("user at sign example dot com"), "User @ example. Com");
+    EXPECT_EQ(engine.process("Full Stop"), ".");
+}
+
+// Test bracket and quote spacing
+TEST(CommandEngineTest, SmartSpacing) {
+    CommandEngine engine(default_commands());
+
+    EXPECT_EQ(engine.process("call open parenthesis now close parenthesis period"), "Call (now).");
+    EXPECT_EQ(engine.process("she said quote hello quote comma then left"), "She said \"hello\", then left");
+}
+
+// Test the all caps toggle and explicit capitalization modes
+TEST(CommandEngineTest, CapitalizationModes) {
+    CommandEngine engine(default_commands());
+
+    EXPECT_EQ(engine.process("this is all caps loud no caps quiet"), "This is LOUD quiet");
+    EXPECT_EQ(engine.get_capitalization_mode(), "auto");
+
+    ASSERT_TRUE(engine.set_capitalization_mode("none"));
+    EXPECT_EQ(engine.process("lower case period stays"), "lower case. stays");
+
+    EXPECT_FALSE(engine.set_capitalization_mode("shouting"));
+}
+
+// Test adding and removing commands at runtime
+TEST(CommandEngineTest, CustomCommands) {
+    CommandEngine engine(default_commands());
+
+    ASSERT_TRUE(engine.add_command("smiley face", " :) "));
+    ASSERT_TRUE(engine.wait_for_reload());
+    EXPECT_EQ(engine.process("hello smiley face goodbye"), "Hello :) goodbye");
+
+    ASSERT_TRUE(engine.remove_command("dot"));
+    ASSERT_TRUE(engine.wait_for_reload());
+    EXPECT_EQ(engine.process("connect the dot period"), "Connect the dot.");
+
+    EXPECT_FALSE(engine.remove_command("not a command"));
+}
+
+// Test the phrase list handed to a command grammar
+TEST(CommandEngineTest, PhraseList) {
+    CommandEngine engine({ { "New Line", "{ENTER}", { "next line" } }, { "period", ".", { "new line" } } });
+    std::vector<std::string> phrases = engine.get_phrases();
+    EXPECT_EQ(phrases, (std::vector<std::string>{ "new line", "next line", "period" }));
+}
+
+// Test compiling from settings.json-style JSON, comments and all
+TEST(CommandEngineTest, LoadJson) {
+    CommandEngine engine;
+    const std::string json = R"({
+        "dictation_commands": {
+            "supported_commands": [
+                { "phrase": "period", "action": ".", "aliases": ["full stop"] },
+                { "phrase": "comma", "action": "," },
+            ],
+            // Comments are allowed in the settings file
+        }
+    })";
+
+    ASSERT_TRUE(engine.load_json(json));
+    EXPECT_EQ(engine.get_phrase_count(), 3u);
+    EXPECT_EQ(engine.process("yes comma full stop"), "Yes,.");
+
+    EXPECT_FALSE(engine.load_json("{ not json"));
+    EXPECT_FALSE(engine.get_last_error().empty());
+}
+
+// Test that background reloads publish a new snapshot without disturbing readers
+TEST(CommandEngineTest, SnapshotSwap) {
+    CommandEngine engine(default_commands());
+    std::shared_ptr<const CompiledCommandSet> before = engine.snapshot();
+    uint64_t version = engine.get_snapshot_version();
+
+    ASSERT_TRUE(engine.reload_json(R"([{ "phrase": "stop", "action": "." }])"));
+    ASSERT_TRUE(engine.wait_for_reload());
+
+    EXPECT_GT(engine.get_snapshot_version(), version);
+    EXPECT_EQ(engine.get_phrase_count(), 1u);
+    EXPECT_EQ(engine.process("done stop"), "Done.");
+
+    // A reader holding the old snapshot still sees the old commands
+    EXPECT_GT(before->phrase_count(), 1u);
+    EXPECT_NE(before->lookup_token("period"), CompiledCommandSet::kUnknownToken);
+
+    EXPECT_FALSE(engine.reload_json("[ broken"));
+}
+
+// Test that calls from several threads, as the GIL-free binding allows, do not corrupt each other
+TEST(CommandEngineTest, ConcurrentProcess) {
+    CommandEngine engine(default_commands());
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&engine, &mismatches, t]() {
+            for (int i = 0; i < 500; i++) {
+                std::string output = (t % 2)
+                    ? engine.process("hello comma how are you question mark")
+                    : engine.process("first line new line second line period");
+                if (output != ((t % 2) ? "Hello, how are you?" : "First line{ENTER}second line.")) {
+                    mismatches++;
+                }
+                engine.set_capitalization_mode("auto");
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(engine.get_capitalization_mode(), "auto");
+}
+
+// Test the binary cache round trip and its validation
+TEST(CommandEngineTest, BinaryCache) {
+    const std::string path = testing::TempDir() + "command_engine_test.bin";
+    std::remove(path.c_str());
+
+    std::vector<CommandDefinition> commands = default_commands();
+    std::string error;
+    std::shared_ptr<const CompiledCommandSet> compiled = CompiledCommandSet::compile(commands);
+    ASSERT_TRUE(compiled->save(path, error)) << error;
+
+    uint64_t hash = CompiledCommandSet::hash_commands(commands);
+    std::shared_ptr<const CompiledCommandSet> loaded = CompiledCommandSet::load(path, hash, error);
+    ASSERT_TRUE(loaded) << error;
+    EXPECT_EQ(loaded->phrase_count(), compiled->phrase_count());
+    EXPECT_EQ(loaded->serialize(), compiled->serialize());
+
+    // Stale and corrupt caches are rejected
+    EXPECT_FALSE(CompiledCommandSet::load(path, hash + 1, error));
+    std::string data = compiled->serialize();
+    data[data.size() / 2] ^= 0x5a;
+    EXPECT_FALSE(CompiledCommandSet::deserialize(data, error));
+    EXPECT_FALSE(CompiledCommandSet::deserialize(data.substr(0, 10), error));
+
+    // The engine reuses a matching cache instead of compiling
+    CommandEngine engine;
+    engine.set_cache_path(path);
+    engine.load_commands(commands);
+    EXPECT_TRUE(engine.loaded_from_cache());
+    EXPECT_EQ(engine.process("is it cached question mark"), "Is it cached?");
+
+    // Changed commands miss the cache, recompile and rewrite it
+    commands.push_back({ "semicolon", ";", {} });
+    engine.load_commands(commands);
+    EXPECT_FALSE(engine.loaded_from_cache());
+    EXPECT_TRUE(CompiledCommandSet::load(path, CompiledCommandSet::hash_commands(commands), error));
+
+    std::remove(path.c_str());
+}
\ No newline at end of file
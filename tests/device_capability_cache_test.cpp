@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "audio_stream.h"
+#include "device_capability_cache.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+extern "C" int PaMock_GetInitCount(void);
+
+namespace {
+
+// Rates the PortAudio mock accepts, out of DeviceCapabilityCache::candidate_rates()
+const std::vector<int> kMockRates = { 8000, 16000, 22050, 44100, 48000 };
+
+class DeviceCapabilityCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        DeviceCapabilityCache::instance().wait_for_probes();
+        DeviceCapabilityCache::instance().invalidate();
+    }
+
+    void TearDown() override {
+        DeviceCapabilityCache::instance().set_update_callback(nullptr);
+        DeviceCapabilityCache::instance().wait_for_probes();
+    }
+};
+
+} // namespace
+
+// Test that the first enumerate returns at once and later ones come from the cache
+TEST_F(DeviceCapabilityCacheTest, ProbesInBackground) {
+    DeviceCapabilityCache& cache = DeviceCapabilityCache::instance();
+    DeviceCapabilityCache::Stats before = cache.stats();
+
+    std::vector<AudioDevice> devices = cache.enumerate();
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_EQ(devices[0].raw_name, "Mock Microphone");
+    EXPECT_EQ(devices[0].host_api, "Mock");
+    EXPECT_TRUE(devices[0].is_default);
+    EXPECT_FALSE(devices[0].capabilities_known);
+    EXPECT_TRUE(devices[0].supported_sample_rates.empty());
+
+    ASSERT_TRUE(cache.wait_for_probes(5000));
+    devices = cache.enumerate();
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_TRUE(devices[0].capabilities_known);
+    EXPECT_EQ(devices[0].supported_sample_rates, kMockRates);
+
+    DeviceCapabilityCache::Stats after = cache.stats();
+    EXPECT_EQ(after.probes - before.probes, DeviceCapabilityCache::candidate_rates().size());
+    EXPECT_EQ(after.misses - before.misses, 1u);
+    EXPECT_EQ(after.hits - before.hits, 1u);
+    EXPECT_EQ(after.cached_devices, 1u);
+
+    // The probe thread's reference is gone once the round is over
+    EXPECT_EQ(AudioSubsystem::reference_count(), 0);
+    EXPECT_EQ(PaMock_GetInitCount(), 0);
+}
+
+// Test the blocking form used by ControlledAudioStream::enumerate_devices
+TEST_F(DeviceCapabilityCacheTest, WaitForRates) {
+    std::vector<AudioDevice> devices = ControlledAudioStream::enumerate_devices();
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_TRUE(devices[0].capabilities_known);
+    EXPECT_EQ(devices[0].supported_sample_rates, kMockRates);
+
+    // Compatibility checks are answered from the entry
+    DeviceCapabilityCache::Stats before = DeviceCapabilityCache::instance().stats();
+    EXPECT_TRUE(ControlledAudioStream::check_device_compatibility(0, 16000));
+    EXPECT_FALSE(ControlledAudioStream::check_device_compatibility(0, 96000));
+    EXPECT_FALSE(ControlledAudioStream::check_device_compatibility(3, 16000));
+    EXPECT_EQ(DeviceCapabilityCache::instance().stats().probes, before.probes);
+}
+
+// Test that invalidate() makes the next enumerate probe again
+TEST_F(DeviceCapabilityCacheTest, InvalidateReprobes) {
+    DeviceCapabilityCache& cache = DeviceCapabilityCache::instance();
+    cache.enumerate(true);
+    uint64_t probes = cache.stats().probes;
+
+    cache.invalidate();
+    EXPECT_EQ(cache.stats().cached_devices, 0u);
+    std::vector<AudioDevice> devices = cache.enumerate(true);
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_TRUE(devices[0].capabilities_known);
+    EXPECT_EQ(devices[0].supported_sample_rates, kMockRates);
+    EXPECT_EQ(cache.stats().probes - probes, DeviceCapabilityCache::candidate_rates().size());
+}
+
+// Test that the update callback fires once a round of probes is done
+TEST_F(DeviceCapabilityCacheTest, UpdateCallback) {
+    DeviceCapabilityCache& cache = DeviceCapabilityCache::instance();
+    std::atomic<int> updates{0};
+    cache.set_update_callback([&updates]() { updates++; });
+
+    cache.enumerate();
+    ASSERT_TRUE(cache.wait_for_probes(5000));
+    // The callback runs just after waiters are released
+    for (int i = 0; i < 500 && updates == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(updates, 1);
+
+    // Nothing new to probe, so no further round
+    cache.enumerate();
+    cache.set_update_callback(nullptr);
+    EXPECT_EQ(updates, 1);
+}
+
+// Test that entries survive a restart through the cache file
+TEST_F(DeviceCapabilityCacheTest, PersistsToDisk) {
+    DeviceCapabilityCache& cache = DeviceCapabilityCache::instance();
+    std::string path = ::testing::TempDir() + "device_cache_test.json";
+    std::remove(path.c_str());
+
+    std::string error;
+    ASSERT_TRUE(cache.set_cache_path(path, error)) << error;
+    cache.enumerate(true);
+    ASSERT_TRUE(cache.set_cache_path("", error));
+    {
+        std::ifstream saved(path);
+        ASSERT_TRUE(saved.good());
+    }
+
+    // A fresh start: nothing cached until the file is loaded
+    cache.invalidate();
+    ASSERT_TRUE(cache.load(path, error)) << error;
+    uint64_t probes = cache.stats().probes;
+    std::vector<AudioDevice> devices = cache.enumerate();
+    ASSERT_EQ(devices.size(), 1u);
+    EXPECT_TRUE(devices[0].capabilities_known);
+    EXPECT_EQ(devices[0].supported_sample_rates, kMockRates);
+    EXPECT_EQ(cache.stats().probes, probes);
+    std::remove(path.c_str());
+}
+
+// Test that a damaged cache file is reported rather than half-loaded
+TEST_F(DeviceCapabilityCacheTest, RejectsBadFile) {
+    DeviceCapabilityCache& cache = DeviceCapabilityCache::instance();
+    std::string path = ::testing::TempDir() + "device_cache_bad.json";
+    {
+        std::ofstream out(path);
+        out << "{ \"devices\": [ { \"name\": ";
+    }
+    std::string error;
+    EXPECT_FALSE(cache.load(path, error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_EQ(cache.stats().cached_devices, 0u);
+
+    error.clear();
+    EXPECT_FALSE(cache.load(path + ".missing", error));
+    EXPECT_FALSE(error.empty());
+    std::remove(path.c_str());
+}
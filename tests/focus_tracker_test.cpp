@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include "focus_tracker.h"
+
+#include <atomic>
+
+using namespace voice_transcription;
+
+// Test that a simulated focus change is visible through the atomic cache
+TEST(FocusTrackerTest, SimulatedFocusChange) {
+    FakeFocusTracker tracker;
+    EXPECT_EQ(tracker.generation(), 0u);
+
+    tracker.simulate_focus_change(42, "Editor");
+
+    EXPECT_EQ(tracker.generation(), 1u);
+    EXPECT_EQ(tracker.current_window_id(), 42u);
+    EXPECT_EQ(tracker.current_title(), "Editor");
+
+    FocusedWindow window = tracker.current();
+    EXPECT_EQ(window.window_id, 42u);
+    EXPECT_EQ(window.generation, 1u);
+}
+
+// Test that repeated notifications for the same window do not bump the generation
+TEST(FocusTrackerTest, DuplicateNotificationsIgnored) {
+    FakeFocusTracker tracker;
+    tracker.simulate_focus_change(1, "Terminal");
+    tracker.simulate_focus_change(1, "Terminal");
+    EXPECT_EQ(tracker.generation(), 1u);
+
+    // A title change on the same window is still a change
+    tracker.simulate_focus_change(1, "Terminal - build");
+    EXPECT_EQ(tracker.generation(), 2u);
+}
+
+// Test that change notifications are pushed to the callback
+TEST(FocusTrackerTest, CallbackReceivesChanges) {
+    FakeFocusTracker tracker;
+    std::atomic<int> calls{0};
+    std::string last_title;
+
+    tracker.set_focus_change_callback([&](const FocusedWindow& window) {
+        last_title = window.title;
+        calls++;
+    });
+
+    tracker.simulate_focus_change(7, "Browser");
+    tracker.simulate_focus_change(8, "Mail");
+
+    EXPECT_EQ(calls.load(), 2);
+    EXPECT_EQ(last_title, "Mail");
+}
+
+// Test that a loaded script is replayed on the tracker thread
+TEST(FocusTrackerTest, ScriptPlayback) {
+    FakeFocusTracker tracker;
+    tracker.load_script({
+        { 0, 10, "Word" },
+        { 5, 11, "Visual Studio Code" },
+        { 5, 12, "Terminal" }
+    });
+
+    ASSERT_TRUE(tracker.start());
+    ASSERT_TRUE(tracker.wait_for_script(1000));
+    tracker.stop();
+
+    EXPECT_EQ(tracker.generation(), 3u);
+    EXPECT_EQ(tracker.current_window_id(), 12u);
+    EXPECT_EQ(tracker.current_title(), "Terminal");
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include "hotword_biaser.h"
+#include "vosk_result_parser.h"
+#include "vosk_transcription_engine.h"
+
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+using namespace voice_transcription;
+
+// N-best final in libvosk's layout
+static TranscriptionResult nbest(const std::vector<std::pair<std::string, double>>& hypotheses) {
+    std::string json = "{\"alternatives\" : [";
+    for (size_t i = 0; i < hypotheses.size(); i++) {
+        json += std::string(i ? ", " : "") + "{\"confidence\" : " + std::to_string(hypotheses[i].second) +
+                ", \"result\" : [";
+        size_t begin = 0;
+        const std::string& text = hypotheses[i].first;
+        for (int word = 0; begin < text.size(); word++) {
+            size_t end = text.find(' ', begin);
+            end = end == std::string::npos ? text.size() : end;
+            json += std::string(word ? ", " : "") + "{\"end\" : " + std::to_string(word + 1) +
+                    ", \"start\" : " + std::to_string(word) + ", \"word\" : \"" +
+                    text.substr(begin, end - begin) + "\"}";
+            begin = end + 1;
+        }
+        json += "], \"text\" : \"" + text + "\"}";
+    }
+    json += "]}";
+    TranscriptionResult result;
+    std::string error;
+    EXPECT_TRUE(parse_vosk_result(json, result, error)) << error;
+    return result;
+}
+
+// Test that boosts reorder the N-best list and respell the winner
+TEST(HotwordBiaserTest, RescoresAlternatives) {
+    HotwordBiaser biaser;
+    biaser.set_phrase("Kubernetes", 3.0f);
+
+    TranscriptionResult result = nbest({ { "deploy to cooper netties", 210.0 },
+                                         { "deploy to kubernetes", 208.5 } });
+    ASSERT_EQ(result.raw_text, "deploy to cooper netties");
+    EXPECT_TRUE(biaser.apply(result));
+    EXPECT_EQ(result.raw_text, "deploy to Kubernetes");
+    EXPECT_EQ(result.processed_text, result.raw_text);
+    EXPECT_FLOAT_EQ(result.alternatives[0].score, 211.5f);
+    ASSERT_EQ(result.words.size(), 3u);
+    EXPECT_EQ(result.text_of(result.words[2]), "Kubernetes");
+    EXPECT_FLOAT_EQ(result.words[2].start, 2.0f);
+
+    // A boost too small for the gap leaves the decoder's choice
+    biaser.set_phrase("kubernetes", 1.0f);
+    ASSERT_EQ(biaser.size(), 1u);
+    result = nbest({ { "deploy to cooper netties", 210.0 }, { "deploy to kubernetes", 208.5 } });
+    EXPECT_FALSE(biaser.apply(result));
+    EXPECT_EQ(result.raw_text, "deploy to cooper netties");
+}
+
+// Test respelling without alternatives, longest match first
+TEST(HotwordBiaserTest, RespellsPhrases) {
+    HotwordBiaser biaser;
+    biaser.set_phrases({ { "New York", 1.0f }, { "New York City", 1.0f }, { "gRPC", 2.0f }, { "  ", 5.0f } });
+    EXPECT_EQ(biaser.size(), 3u);
+
+    TranscriptionResult result;
+    std::string error;
+    ASSERT_TRUE(parse_vosk_result("{\"text\" : \"grpc calls from new york city\"}", result, error));
+    EXPECT_TRUE(biaser.apply(result));
+    EXPECT_EQ(result.raw_text, "gRPC calls from New York City");
+
+    // Partials are left alone
+    TranscriptionResult partial;
+    ASSERT_TRUE(parse_vosk_result("{\"partial\" : \"grpc\"}", partial, error));
+    EXPECT_FALSE(biaser.apply(partial));
+
+    EXPECT_TRUE(biaser.remove_phrase("new york city"));
+    EXPECT_FALSE(biaser.remove_phrase("boston"));
+    biaser.set_phrase("gRPC", 0.0f);
+    EXPECT_EQ(biaser.size(), 1u);
+}
+
+// Test that vocabularies survive a save and load
+TEST(HotwordBiaserTest, PersistsVocabulary) {
+    std::string path = ::testing::TempDir() + "vocabulary.json";
+    HotwordBiaser biaser;
+    biaser.set_phrases({ { "Kubernetes", 4.0f }, { "say \"hi\"", 1.5f } });
+    std::string error;
+    ASSERT_TRUE(biaser.save(path, error)) << error;
+
+    HotwordBiaser loaded;
+    ASSERT_TRUE(loaded.load(path, error)) << error;
+    std::vector<HotwordEntry> entries = loaded.get_phrases();
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].phrase, "Kubernetes");
+    EXPECT_FLOAT_EQ(entries[0].boost, 4.0f);
+    EXPECT_EQ(entries[1].phrase, "say \"hi\"");
+
+    std::ofstream(path) << "{\"words\": []}";
+    EXPECT_FALSE(loaded.load(path, error));
+    EXPECT_FALSE(loaded.load(::testing::TempDir() + "no_such_vocabulary.json", error));
+    EXPECT_EQ(loaded.size(), 2u);
+}
+
+// Test biasing through the transcriber, which requests N-best lists itself
+TEST(HotwordBiaserTest, TranscriberBiasesFinals) {
+    std::string path = ::testing::TempDir() + "transcriber_vocabulary.conf";
+    std::ofstream(path) << "utterance = deploy to cooper netties | deploy to kubernetes\n";
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    transcriber.set_vocabulary_phrase("Kubernetes", 2.0f);
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    std::vector<float> speech(320, 0.3f);
+    std::vector<float> silence(320, 0.0f);
+    TranscriptionResult result;
+    for (int i = 0; i < 60 && !result.is_final; i++) {
+        const std::vector<float>& samples = i < 20 ? speech : silence;
+        result = transcriber.transcribe(std::make_unique<AudioChunk>(samples.data(), samples.size()));
+    }
+    ASSERT_TRUE(result.is_final);
+    EXPECT_EQ(result.processed_text, "deploy to Kubernetes");
+    // The list was only requested for rescoring
+    EXPECT_TRUE(result.alternatives.empty());
+    EXPECT_EQ(result.words.size(), 3u);
+}
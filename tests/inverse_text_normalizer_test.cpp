@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include "inverse_text_normalizer.h"
+
+#include <fstream>
+
+using namespace voice_transcription;
+
+// Golden set lives next to this file
+static std::string golden_path() {
+    std::string path = __FILE__;
+    return path.substr(0, path.find_last_of("/\\") + 1) + "data/itn_golden.tsv";
+}
+
+// Test every spoken/written pair in the golden set
+TEST(InverseTextNormalizerTest, GoldenSet) {
+    std::ifstream file(golden_path());
+    ASSERT_TRUE(file.is_open()) << "Missing " << golden_path();
+
+    InverseTextNormalizer normalizer;
+    std::string line;
+    int cases = 0;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        size_t tab = line.find('\t');
+        ASSERT_NE(tab, std::string::npos) << "Malformed line: " << line;
+
+        std::string spoken = line.substr(0, tab);
+        std::string written = line.substr(tab + 1);
+        EXPECT_EQ(normalizer.normalize(spoken), written) << "Input: " << spoken;
+        cases++;
+    }
+    EXPECT_GT(cases, 50);
+}
+
+// Test that case and surrounding words are preserved
+TEST(InverseTextNormalizerTest, PreservesContext) {
+    InverseTextNormalizer normalizer;
+
+    EXPECT_EQ(normalizer.normalize(""), "");
+    EXPECT_EQ(normalizer.normalize("Call Me Maybe"), "Call Me Maybe");
+    EXPECT_EQ(normalizer.normalize("Twenty Five Apples"), "25 Apples");
+    EXPECT_EQ(normalizer.normalize("  spaced   out  "), "spaced out");
+    EXPECT_EQ(normalizer.normalize("pay five dollars by june tenth"), "pay $5 by June 10");
+}
+
+// Test that very long inputs are handled in one pass
+TEST(InverseTextNormalizerTest, LongInput) {
+    InverseTextNormalizer normalizer;
+
+    std::string spoken;
+    std::string written;
+    for (int i = 0; i < 10000; i++) {
+        spoken += "twenty three percent and ";
+        written += "23% and ";
+    }
+    written.pop_back();
+
+    EXPECT_EQ(normalizer.normalize(spoken), written);
+}
@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include "keystroke_tokenizer.h"
+
+using namespace voice_transcription;
+
+// Render tokens back as text, with special keys as <COMMAND>
+static std::wstring render(const std::vector<KeystrokeToken>& tokens) {
+    std::wstring rendered;
+    for (const auto& token : tokens) {
+        if (token.kind == KeystrokeToken::Kind::SpecialKey) {
+            rendered += L"<" + token.command + L">";
+        } else {
+            rendered += token.character;
+        }
+    }
+    return rendered;
+}
+
+// Test plain text and special keys
+TEST(KeystrokeTokenizerTest, SpecialKeys) {
+    EXPECT_TRUE(tokenize_keystrokes(L"").empty());
+    EXPECT_EQ(render(tokenize_keystrokes(L"hi")), L"hi");
+    EXPECT_EQ(render(tokenize_keystrokes(L"Hello{ENTER}world")), L"Hello<ENTER>world");
+    EXPECT_EQ(render(tokenize_keystrokes(L"{CTRL+ENTER}{TAB}")), L"<CTRL+ENTER><TAB>");
+    EXPECT_EQ(tokenize_keystrokes(L"a{ENTER}b").size(), 3u);
+}
+
+// Test that malformed braces are typed literally, as the old regex did
+TEST(KeystrokeTokenizerTest, LiteralBraces) {
+    EXPECT_EQ(render(tokenize_keystrokes(L"{}")), L"{}");
+    EXPECT_EQ(render(tokenize_keystrokes(L"{ENTER")), L"{ENTER");
+    EXPECT_EQ(render(tokenize_keystrokes(L"x}")), L"x}");
+    EXPECT_EQ(render(tokenize_keystrokes(L"{}{TAB}")), L"{}<TAB>");
+    EXPECT_EQ(render(tokenize_keystrokes(L"{{TAB}")), L"<{TAB>");
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "keyword_spotter.h"
+#include "audio_stream.h"
+#include "metrics.h"
+
+#include <cmath>
+#include <random>
+
+using namespace voice_transcription;
+
+static const int kRate = 16000;
+static const size_t kChunk = 320;
+
+// A made-up "phrase": voiced segments with a pitch and formant per segment
+static std::vector<float> phrase(const std::vector<float>& formants, int segment_ms, float level,
+                                 unsigned seed = 1) {
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0.0f, 0.002f);
+    std::vector<float> samples;
+    size_t segment = static_cast<size_t>(kRate) * segment_ms / 1000;
+    for (float formant : formants) {
+        for (size_t i = 0; i < segment; i++) {
+            double t = static_cast<double>(samples.size()) / kRate;
+            double value = 0.0;
+            for (int harmonic = 1; harmonic <= 20; harmonic++) {
+                double frequency = 120.0 * harmonic;
+                double gain = std::exp(-std::pow((frequency - formant) / 250.0, 2.0));
+                value += gain * std::sin(2.0 * 3.14159265358979 * frequency * t);
+            }
+            samples.push_back(static_cast<float>(level * value / 2.0) + noise(random));
+        }
+    }
+    return samples;
+}
+
+// Feed samples in chunks, all marked as speech or all as silence; true if any chunk passed
+static bool feed(KeywordSpotter& spotter, const std::vector<float>& samples, bool is_speech) {
+    bool passed = false;
+    for (size_t at = 0; at + kChunk <= samples.size(); at += kChunk) {
+        AudioChunk chunk(samples.data() + at, kChunk);
+        passed = spotter.process(chunk, is_speech) || passed;
+    }
+    return passed;
+}
+
+static uint64_t counter(const MetricsSnapshot& snapshot, const std::string& name) {
+    for (const auto& entry : snapshot.counters) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return 0;
+}
+
+static const std::vector<float> kWakePhrase = { 400.0f, 1100.0f, 2200.0f, 700.0f };
+
+// Test that the enrolled phrase wakes the gate and other speech does not
+TEST(KeywordSpotterTest, WakesOnEnrolledPhrase) {
+    KeywordSpotter spotter;
+    std::string error;
+    std::vector<float> enrollment = phrase(kWakePhrase, 150, 0.3f);
+    // Quiet around the recording is trimmed
+    enrollment.insert(enrollment.begin(), 4000, 0.0f);
+    enrollment.insert(enrollment.end(), 4000, 0.0f);
+    ASSERT_TRUE(spotter.enroll(enrollment.data(), enrollment.size(), error)) << error;
+    ASSERT_EQ(spotter.template_count(), 1u);
+
+    // Other "words", including the phrase backwards
+    EXPECT_FALSE(feed(spotter, phrase({ 700.0f, 2200.0f, 1100.0f, 400.0f }, 150, 0.3f, 2), true));
+    EXPECT_FALSE(feed(spotter, std::vector<float>(8000, 0.0f), false));
+    EXPECT_FALSE(feed(spotter, phrase({ 1600.0f, 1600.0f, 500.0f }, 200, 0.3f, 3), true));
+    EXPECT_FALSE(feed(spotter, std::vector<float>(8000, 0.0f), false));
+    EXPECT_EQ(spotter.get_state(), KeywordSpotter::State::Listening);
+    float rejected = spotter.get_best_score();
+
+    // Said slower, louder and with different noise
+    spotter.reset_best_score();
+    feed(spotter, phrase(kWakePhrase, 180, 0.6f, 4), true);
+    EXPECT_TRUE(spotter.is_awake());
+    EXPECT_LT(spotter.get_best_score(), spotter.get_threshold());
+    EXPECT_GT(rejected, spotter.get_threshold());
+
+    // Awake, everything goes through until awake_ms of silence
+    EXPECT_TRUE(feed(spotter, phrase({ 900.0f, 1500.0f }, 300, 0.3f, 5), true));
+    EXPECT_TRUE(feed(spotter, std::vector<float>(kRate * 7, 0.0f), false));
+    EXPECT_TRUE(spotter.is_awake());
+    feed(spotter, std::vector<float>(kRate * 2, 0.0f), false);
+    EXPECT_FALSE(spotter.is_awake());
+}
+
+// Test that nothing passes without enrollment, and the manual controls
+TEST(KeywordSpotterTest, ManualWakeAndSleep) {
+    KeywordSpotter spotter;
+    EXPECT_FALSE(feed(spotter, phrase(kWakePhrase, 150, 0.3f), true));
+    spotter.wake();
+    EXPECT_TRUE(feed(spotter, std::vector<float>(kChunk, 0.0f), false));
+    spotter.sleep();
+    EXPECT_FALSE(spotter.is_awake());
+
+    std::string error;
+    std::vector<float> silence(kRate, 0.0f);
+    EXPECT_FALSE(spotter.enroll(silence.data(), silence.size(), error));
+    std::vector<float> blip = phrase({ 1000.0f }, 50, 0.3f);
+    EXPECT_FALSE(spotter.enroll(blip.data(), blip.size(), error));
+    EXPECT_EQ(spotter.template_count(), 0u);
+}
+
+// Test that wakes with nothing said afterwards count as false accepts
+TEST(KeywordSpotterTest, CountsWakesAndFalseAccepts) {
+    MetricsRegistry::instance().reset();
+    KeywordSpotterConfig config;
+    config.awake_ms = 1000;
+    KeywordSpotter spotter(config);
+    std::string error;
+    std::vector<float> enrollment = phrase(kWakePhrase, 150, 0.3f);
+    ASSERT_TRUE(spotter.enroll(enrollment.data(), enrollment.size(), error)) << error;
+
+    std::vector<float> wake = phrase(kWakePhrase, 150, 0.3f, 6);
+    feed(spotter, wake, true);
+    ASSERT_TRUE(spotter.is_awake());
+    feed(spotter, std::vector<float>(kRate * 2, 0.0f), false);
+    ASSERT_FALSE(spotter.is_awake());
+
+    feed(spotter, wake, true);
+    ASSERT_TRUE(spotter.is_awake());
+    feed(spotter, phrase({ 900.0f, 1500.0f }, 300, 0.3f, 7), true);
+    feed(spotter, std::vector<float>(kRate * 2, 0.0f), false);
+    spotter.report_false_accept();
+
+    MetricsSnapshot snapshot = MetricsRegistry::instance().snapshot();
+    EXPECT_EQ(counter(snapshot, "keyword_wakes"), 2u);
+    EXPECT_EQ(counter(snapshot, "keyword_false_accepts"), 2u);
+    bool timed_chunks = false;
+    for (const auto& stage : snapshot.stages) {
+        if (stage.stage == "keyword_spotting") {
+            timed_chunks = stage.count > 0;
+        }
+    }
+    EXPECT_TRUE(timed_chunks);
+}
+
+// Test that templates survive a save and load
+TEST(KeywordSpotterTest, PersistsTemplates) {
+    std::string path = ::testing::TempDir() + "wake_phrase.kws";
+    KeywordSpotter spotter;
+    std::string error;
+    std::vector<float> enrollment = phrase(kWakePhrase, 150, 0.3f);
+    ASSERT_TRUE(spotter.enroll(enrollment.data(), enrollment.size(), error)) << error;
+    ASSERT_TRUE(spotter.save_templates(path, error)) << error;
+
+    KeywordSpotter loaded;
+    ASSERT_TRUE(loaded.load_templates(path, error)) << error;
+    EXPECT_EQ(loaded.template_count(), 1u);
+    feed(loaded, phrase(kWakePhrase, 160, 0.4f, 8), true);
+    EXPECT_TRUE(loaded.is_awake());
+
+    KeywordSpotterConfig config;
+    config.sample_rate = 8000;
+    KeywordSpotter narrowband(config);
+    EXPECT_FALSE(narrowband.load_templates(path, error));
+    EXPECT_FALSE(loaded.load_templates(::testing::TempDir() + "no_such_phrase.kws", error));
+    EXPECT_EQ(loaded.template_count(), 1u);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include "endpointer.h"
+#include "latency_harness.h"
+#include "wav_file_stream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace voice_transcription;
+
+static std::string temp_path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+// Directory that stands in for a model; the synthetic recognizer uses its default script
+static std::string model_dir() {
+    std::string path = __FILE__;
+    return path.substr(0, path.find_last_of("/\\") + 1) + "data";
+}
+
+// Silence with 440 Hz tone bursts over the given millisecond spans
+static std::vector<float> make_recording(double duration_ms, const std::vector<std::pair<double, double>>& bursts) {
+    const int rate = 16000;
+    std::vector<float> samples(static_cast<size_t>(duration_ms * rate / 1000));
+    for (const auto& burst : bursts) {
+        size_t begin = static_cast<size_t>(burst.first * rate / 1000);
+        size_t end = std::min(samples.size(), static_cast<size_t>(burst.second * rate / 1000));
+        for (size_t i = begin; i < end; i++) {
+            samples[i] = 0.3f * std::sin(2.0f * 3.14159265f * 440.0f * i / rate);
+        }
+    }
+    return samples;
+}
+
+// Test that an utterance opens on speech and closes once the hangover runs out
+TEST(EndpointerTest, Hangover) {
+    Endpointer endpointer(60, 20);
+    EXPECT_EQ(endpointer.update(false), Endpointer::Event::None);
+    EXPECT_FALSE(endpointer.in_utterance());
+
+    EXPECT_EQ(endpointer.update(true), Endpointer::Event::SpeechStart);
+    EXPECT_TRUE(endpointer.in_utterance());
+    EXPECT_EQ(endpointer.update(true), Endpointer::Event::None);
+
+    // 60 ms of hangover keeps the utterance open for three silent chunks
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(endpointer.update(false), Endpointer::Event::None);
+        EXPECT_TRUE(endpointer.in_utterance());
+    }
+    EXPECT_EQ(endpointer.update(false), Endpointer::Event::SpeechEnd);
+    EXPECT_FALSE(endpointer.in_utterance());
+}
+
+// Test that speech during the hangover continues the same utterance
+TEST(EndpointerTest, SpeechResumesInHangover) {
+    Endpointer endpointer(60, 20);
+    EXPECT_EQ(endpointer.update(true), Endpointer::Event::SpeechStart);
+    EXPECT_EQ(endpointer.update(false), Endpointer::Event::None);
+    EXPECT_EQ(endpointer.update(false), Endpointer::Event::None);
+    EXPECT_EQ(endpointer.update(true), Endpointer::Event::None);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(endpointer.update(false), Endpointer::Event::None);
+    }
+    EXPECT_EQ(endpointer.update(false), Endpointer::Event::SpeechEnd);
+}
+
+// Test word error counting
+TEST(LatencyHarnessTest, WordErrors) {
+    size_t words = 0;
+    EXPECT_EQ(LatencyHarness::word_errors("Hello, world.", "hello world", &words), 0u);
+    EXPECT_EQ(words, 2u);
+    EXPECT_EQ(LatencyHarness::word_errors("the quick brown fox", "the quack fox jumps"), 3u);
+    EXPECT_EQ(LatencyHarness::word_errors("", "extra"), 1u);
+    EXPECT_EQ(LatencyHarness::word_errors("missing words", "", &words), 2u);
+}
+
+// Test corpus manifest parsing and path resolution
+TEST(LatencyHarnessTest, LoadCorpus) {
+    std::string manifest = temp_path("corpus.tsv");
+    {
+        std::ofstream out(manifest);
+        out << "# wav\tstart_ms\tend_ms\ttext\n"
+            << "a.wav\t1500\t2000\tsecond\n"
+            << "a.wav\t100\t900\tfirst\n"
+            << "/abs/b.wav\t0\t500\n";
+    }
+    std::vector<LabeledRecording> corpus;
+    std::string error;
+    ASSERT_TRUE(load_latency_corpus(manifest, corpus, error)) << error;
+    ASSERT_EQ(corpus.size(), 2u);
+    EXPECT_EQ(corpus[0].path, temp_path("a.wav"));
+    ASSERT_EQ(corpus[0].utterances.size(), 2u);
+    EXPECT_EQ(corpus[0].utterances[0].text, "first");
+    EXPECT_DOUBLE_EQ(corpus[0].utterances[1].start_ms, 1500.0);
+    EXPECT_EQ(corpus[1].path, "/abs/b.wav");
+    EXPECT_TRUE(corpus[1].utterances[0].text.empty());
+
+    {
+        std::ofstream out(manifest);
+        out << "a.wav\tsoon\tlater\n";
+    }
+    corpus.clear();
+    EXPECT_FALSE(load_latency_corpus(manifest, corpus, error));
+    EXPECT_NE(error.find(":1:"), std::string::npos);
+    std::remove(manifest.c_str());
+}
+
+// Test onset detection and report contents on a fast replay
+TEST(LatencyHarnessTest, FastReplay) {
+    std::string wav = temp_path("two_utterances.wav");
+    ASSERT_TRUE(WavFileStream::write_wav(wav, make_recording(2500, { { 500, 1100 }, { 1700, 2100 } }), 16000));
+
+    LabeledRecording labels{ wav, { { 500, 1100, "first" }, { 1700, 2100, "second" } } };
+    LatencyHarnessConfig config;
+    config.model_path = model_dir();
+    config.label = "fast \"replay\"";
+    config.realtime = false;
+    config.hangover_ms = 100;
+
+    LatencyHarness harness(config);
+    LatencyReport report;
+    ASSERT_TRUE(harness.run({ labels }, report)) << harness.get_last_error();
+
+    ASSERT_EQ(report.recordings.size(), 1u);
+    EXPECT_EQ(report.recordings[0].chunks, 125u);
+    EXPECT_EQ(report.recordings[0].false_starts, 0u);
+    EXPECT_GT(report.recordings[0].real_time_factor, 0.0);
+    EXPECT_LT(report.recordings[0].real_time_factor, 1.0);
+
+    // Onsets are chunk aligned, so detection lags by one chunk plus processing
+    // The synthetic recognizer reveals a word per 400 ms and finalizes when
+    // the first silent chunk reaches it
+    ASSERT_EQ(report.utterances.size(), 2u);
+    for (const auto& utterance : report.utterances) {
+        ASSERT_TRUE(utterance.onset_latency_ms.has_value());
+        EXPECT_GE(*utterance.onset_latency_ms, 20.0);
+        EXPECT_LT(*utterance.onset_latency_ms, 100.0);
+        ASSERT_TRUE(utterance.first_partial_latency_ms.has_value());
+        EXPECT_GE(*utterance.first_partial_latency_ms, 400.0);
+        EXPECT_LT(*utterance.first_partial_latency_ms, 500.0);
+        ASSERT_TRUE(utterance.final_latency_ms.has_value());
+        EXPECT_GE(*utterance.final_latency_ms, 0.0);
+        EXPECT_LT(*utterance.final_latency_ms, 100.0);
+        EXPECT_EQ(utterance.hypothesis, "the quick brown fox jumps over the lazy dog");
+    }
+
+    std::string json = report.to_json();
+    EXPECT_NE(json.find("\"label\":\"fast \\\"replay\\\"\""), std::string::npos);
+    EXPECT_NE(json.find("\"realtime\":false"), std::string::npos);
+    EXPECT_NE(json.find("\"onset_latency_ms\":{\"count\":2"), std::string::npos);
+    EXPECT_NE(json.find("\"reference\":\"second\""), std::string::npos);
+    std::remove(wav.c_str());
+}
+
+// Test that a real-time replay reports latencies against the capture clock
+TEST(LatencyHarnessTest, RealtimeReplay) {
+    std::string wav = temp_path("realtime.wav");
+    ASSERT_TRUE(WavFileStream::write_wav(wav, make_recording(600, { { 200, 400 } }), 16000));
+
+    LatencyHarnessConfig config;
+    config.model_path = model_dir();
+    LatencyHarness harness(config);
+    LatencyReport report;
+    ASSERT_TRUE(harness.run({ LabeledRecording{ wav, { { 200, 400, "" } } } }, report)) << harness.get_last_error();
+
+    ASSERT_EQ(report.utterances.size(), 1u);
+    ASSERT_TRUE(report.utterances[0].onset_latency_ms.has_value());
+    EXPECT_GE(*report.utterances[0].onset_latency_ms, 19.0);
+    EXPECT_LT(*report.utterances[0].onset_latency_ms, 200.0);
+    EXPECT_LT(report.recordings[0].max_backlog_ms, 200.0);
+    std::remove(wav.c_str());
+}
+
+// Test that a missing model fails the run with an error
+TEST(LatencyHarnessTest, MissingModel) {
+    std::string wav = temp_path("no_model.wav");
+    ASSERT_TRUE(WavFileStream::write_wav(wav, std::vector<float>(1600, 0.0f), 16000));
+
+    LatencyHarnessConfig config;
+    config.model_path = temp_path("no_such_model");
+    config.realtime = false;
+    LatencyHarness harness(config);
+    LatencyReport report;
+    EXPECT_FALSE(harness.run({ LabeledRecording{ wav, {} } }, report));
+    EXPECT_FALSE(harness.get_last_error().empty());
+    std::remove(wav.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "metrics.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+static const StageStats& find_stage(const MetricsSnapshot& snapshot, const std::string& name) {
+    for (const auto& stage : snapshot.stages) {
+        if (stage.stage == name) {
+            return stage;
+        }
+    }
+    throw std::runtime_error("Missing stage " + name);
+}
+
+// Test that every value falls inside its bucket and buckets stay within 12.5%
+TEST(MetricsTest, HistogramBuckets) {
+    for (uint64_t value : { 0ull, 1ull, 7ull, 8ull, 15ull, 16ull, 1000ull, 123456ull, 987654321ull, 1ull << 40 }) {
+        size_t index = LatencyHistogram::bucket_index(value);
+        ASSERT_LT(index, static_cast<size_t>(LatencyHistogram::kBucketCount));
+        EXPECT_LE(LatencyHistogram::bucket_lower_bound(index), value);
+        EXPECT_GT(LatencyHistogram::bucket_upper_bound(index), value);
+
+        uint64_t width = LatencyHistogram::bucket_upper_bound(index) - LatencyHistogram::bucket_lower_bound(index);
+        EXPECT_LE(width * LatencyHistogram::kSubBuckets, std::max<uint64_t>(value, LatencyHistogram::kSubBuckets));
+    }
+
+    // Out-of-range values are clamped into the last bucket
+    EXPECT_EQ(LatencyHistogram::bucket_index(~0ull), static_cast<size_t>(LatencyHistogram::kBucketCount - 1));
+}
+
+// Test percentile estimates against a known distribution
+TEST(MetricsTest, StagePercentiles) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+
+    // 1..1000 microseconds
+    for (uint64_t us = 1; us <= 1000; us++) {
+        registry.record_latency(Stage::Vad, us * 1000);
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+    const StageStats& vad = find_stage(snapshot, "vad");
+    EXPECT_EQ(vad.count, 1000u);
+    EXPECT_NEAR(vad.mean_us, 500.5, 0.1);
+    EXPECT_NEAR(vad.p50_us, 500.0, 500.0 * 0.125);
+    EXPECT_NEAR(vad.p99_us, 990.0, 990.0 * 0.125);
+    EXPECT_DOUBLE_EQ(vad.max_us, 1000.0);
+}
+
+// Test that per-thread shards are merged into one snapshot
+TEST(MetricsTest, ThreadShardsMerge) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&registry]() {
+            for (int i = 0; i < 10000; i++) {
+                ScopedTimer timer(Stage::JsonParse);
+                registry.increment(Counter::AudioChunks);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+    EXPECT_EQ(find_stage(snapshot, "json_parse").count, 40000u);
+    for (const auto& counter : snapshot.counters) {
+        if (counter.first == "audio_chunks") {
+            EXPECT_EQ(counter.second, 40000u);
+        }
+    }
+}
+
+static uint64_t counter_value(const MetricsSnapshot& snapshot, const std::string& name) {
+    for (const auto& counter : snapshot.counters) {
+        if (counter.first == name) {
+            return counter.second;
+        }
+    }
+    return 0;
+}
+
+// Test that exited threads hand their shards on and keep their counts
+TEST(MetricsTest, ShortLivedThreadsReuseShards) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+
+    std::thread([&registry]() { registry.increment(Counter::FinalResults); }).join();
+    size_t shards = registry.shard_count();
+    for (int t = 0; t < 50; t++) {
+        std::thread([&registry]() {
+            registry.increment(Counter::FinalResults);
+            registry.record_latency(Stage::ModelLoad, 1000);
+        }).join();
+    }
+
+    EXPECT_EQ(registry.shard_count(), shards);
+    MetricsSnapshot snapshot = registry.snapshot();
+    EXPECT_EQ(counter_value(snapshot, "final_results"), 51u);
+    EXPECT_EQ(find_stage(snapshot, "model_load").count, 50u);
+
+    registry.reset();
+    EXPECT_EQ(counter_value(registry.snapshot(), "final_results"), 0u);
+}
+
+// Test that a reset reaches a thread that keeps its shard and records again
+TEST(MetricsTest, ResetReachesLiveThread) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    int step = 0;
+    std::thread recorder([&]() {
+        for (int i = 0; i < 100; i++) {
+            registry.increment(Counter::PartialResults);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        step = 1;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return step == 2; });
+        registry.increment(Counter::PartialResults);
+        step = 3;
+        cv.notify_all();
+        cv.wait(lock, [&]() { return step == 4; });
+    });
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return step == 1; });
+    EXPECT_EQ(counter_value(registry.snapshot(), "partial_results"), 100u);
+    registry.reset();
+    EXPECT_EQ(counter_value(registry.snapshot(), "partial_results"), 0u);
+    step = 2;
+    cv.notify_all();
+    cv.wait(lock, [&]() { return step == 3; });
+    EXPECT_EQ(counter_value(registry.snapshot(), "partial_results"), 1u);
+    step = 4;
+    cv.notify_all();
+    lock.unlock();
+    recorder.join();
+
+    // Its count moved to the retired total when it exited
+    EXPECT_EQ(counter_value(registry.snapshot(), "partial_results"), 1u);
+}
+
+// Test the Prometheus text format and disabling the registry
+TEST(MetricsTest, PrometheusAndDisable) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+    registry.record_latency(Stage::AcceptWaveform, 2000000);
+
+    std::string text = registry.to_prometheus();
+    EXPECT_NE(text.find("# TYPE voice_transcription_stage_latency_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("voice_transcription_stage_latency_seconds_count{stage=\"accept_waveform\"} 1"),
+              std::string::npos);
+    EXPECT_NE(text.find("voice_transcription_stage_latency_seconds_bucket{stage=\"accept_waveform\",le=\"+Inf\"} 1"),
+              std::string::npos);
+    EXPECT_NE(text.find("voice_transcription_audio_overflows_total 0"), std::string::npos);
+
+    registry.set_enabled(false);
+    registry.record_latency(Stage::AcceptWaveform, 1000);
+    { ScopedTimer timer(Stage::AcceptWaveform); }
+    registry.set_enabled(true);
+    MetricsSnapshot snapshot = registry.snapshot();
+    EXPECT_EQ(find_stage(snapshot, "accept_waveform").count, 1u);
+
+    Stage stage;
+    EXPECT_TRUE(MetricsRegistry::stage_from_name("command_processing", stage));
+    EXPECT_EQ(stage, Stage::CommandProcessing);
+    EXPECT_FALSE(MetricsRegistry::stage_from_name("nonsense", stage));
+}
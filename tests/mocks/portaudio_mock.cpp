@@ -0,0 +1,231 @@
+// PortAudio stand-in for tests and benchmarks on machines without audio hardware.
+//
+// Exposes one mono input device. An open stream runs a thread that calls the
+// stream callback at the real-time block rate with a quiet 440 Hz tone, so
+// ControlledAudioStream can be exercised end to end. Tests can change the
+// tone's level with PaMock_SetInputLevel, down to 0 for silence.
+//
+// Like the real library, streams only open between Pa_Initialize and
+// Pa_Terminate. PaMock_GetInitCount reports the initialization depth, and
+// PaMock_GetOverlappingCalls counts entries into the non-thread-safe calls
+// (initialize, terminate, open, start, stop, close) while another thread
+// was inside one.
+
+#include <portaudio.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct MockStream {
+    PaStreamCallback* callback = nullptr;
+    void* user_data = nullptr;
+    double sample_rate = 16000.0;
+    unsigned long frames_per_buffer = 320;
+    std::atomic<bool> active{false};
+    std::thread thread;
+};
+
+const PaDeviceInfo kDevice = {
+    "Mock Microphone", 1, 0, 0.01, 0.1, 0.0, 0.0, 16000.0, 0
+};
+const PaHostApiInfo kHostApi = { "Mock" };
+std::atomic<float> input_level{0.1f};
+std::atomic<int> init_count{0};
+std::atomic<int> calls_in_flight{0};
+std::atomic<int> overlapping_calls{0};
+
+// Marks a call PortAudio does not allow to run concurrently with another
+struct ApiCall {
+    ApiCall() {
+        if (calls_in_flight.fetch_add(1) > 0) {
+            overlapping_calls++;
+        }
+        // Widen the window so missing synchronization shows up in tests
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    ~ApiCall() { calls_in_flight--; }
+};
+
+bool is_supported_rate(double rate) {
+    for (double supported : { 8000.0, 16000.0, 22050.0, 44100.0, 48000.0 }) {
+        if (rate == supported) {
+            return true;
+        }
+    }
+    return false;
+}
+
+PaError stop_stream(MockStream* mock) {
+    if (!mock) {
+        return paBadStreamPtr;
+    }
+    if (!mock->active.exchange(false)) {
+        return paStreamIsStopped;
+    }
+    mock->thread.join();
+    return paNoError;
+}
+
+void run_stream(MockStream* stream) {
+    std::vector<float> block(stream->frames_per_buffer);
+    const double phase_step = 2.0 * 3.14159265358979323846 * 440.0 / stream->sample_rate;
+    const auto period = std::chrono::duration<double>(stream->frames_per_buffer / stream->sample_rate);
+    double phase = 0.0;
+    auto next = std::chrono::steady_clock::now();
+
+    while (stream->active.load()) {
+        for (auto& sample : block) {
+            sample = static_cast<float>(input_level.load(std::memory_order_relaxed) * std::sin(phase));
+            phase += phase_step;
+        }
+        // The block finished capturing just now, on the Pa_GetStreamTime clock
+        PaStreamCallbackTimeInfo time_info{};
+        time_info.currentTime = Pa_GetStreamTime(nullptr);
+        time_info.inputBufferAdcTime = time_info.currentTime - period.count();
+        stream->callback(block.data(), nullptr, stream->frames_per_buffer, &time_info, 0, stream->user_data);
+
+        next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+        std::this_thread::sleep_until(next);
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+void PaMock_SetInputLevel(float level) { input_level.store(level, std::memory_order_relaxed); }
+int PaMock_GetInitCount(void) { return init_count.load(); }
+int PaMock_GetOverlappingCalls(void) { return overlapping_calls.load(); }
+
+PaError Pa_Initialize(void) {
+    ApiCall call;
+    init_count++;
+    return paNoError;
+}
+
+PaError Pa_Terminate(void) {
+    ApiCall call;
+    if (init_count.load() == 0) {
+        return paNotInitialized;
+    }
+    init_count--;
+    return paNoError;
+}
+
+int Pa_GetDeviceCount(void) { return 1; }
+
+const PaDeviceInfo* Pa_GetDeviceInfo(PaDeviceIndex device) {
+    return device == 0 ? &kDevice : nullptr;
+}
+
+const PaHostApiInfo* Pa_GetHostApiInfo(int hostApi) {
+    return hostApi == 0 ? &kHostApi : nullptr;
+}
+
+PaDeviceIndex Pa_GetDefaultInputDevice(void) { return 0; }
+PaDeviceIndex Pa_GetDefaultOutputDevice(void) { return paNoDevice; }
+
+PaError Pa_IsFormatSupported(const PaStreamParameters* inputParameters,
+                             const PaStreamParameters* outputParameters, double sampleRate) {
+    if (outputParameters || !inputParameters || inputParameters->device != 0) {
+        return paInvalidDevice;
+    }
+    if (inputParameters->channelCount != 1) {
+        return paInvalidChannelCount;
+    }
+    return is_supported_rate(sampleRate) ? paFormatIsSupported : paInvalidSampleRate;
+}
+
+PaError Pa_OpenStream(PaStream** stream, const PaStreamParameters* inputParameters,
+                      const PaStreamParameters* outputParameters, double sampleRate,
+                      unsigned long framesPerBuffer, PaStreamFlags streamFlags,
+                      PaStreamCallback* streamCallback, void* userData) {
+    (void)streamFlags;
+    ApiCall call;
+    if (init_count.load() == 0) {
+        return paNotInitialized;
+    }
+    PaError supported = Pa_IsFormatSupported(inputParameters, outputParameters, sampleRate);
+    if (supported != paFormatIsSupported) {
+        return supported;
+    }
+    if (!stream || !streamCallback || framesPerBuffer == 0) {
+        return paBadStreamPtr;
+    }
+
+    MockStream* mock = new MockStream();
+    mock->callback = streamCallback;
+    mock->user_data = userData;
+    mock->sample_rate = sampleRate;
+    mock->frames_per_buffer = framesPerBuffer;
+    *stream = mock;
+    return paNoError;
+}
+
+PaError Pa_StartStream(PaStream* stream) {
+    ApiCall call;
+    MockStream* mock = static_cast<MockStream*>(stream);
+    if (!mock) {
+        return paBadStreamPtr;
+    }
+    if (mock->active.exchange(true)) {
+        return paStreamIsNotStopped;
+    }
+    mock->thread = std::thread(run_stream, mock);
+    return paNoError;
+}
+
+PaError Pa_StopStream(PaStream* stream) {
+    ApiCall call;
+    return stop_stream(static_cast<MockStream*>(stream));
+}
+
+PaError Pa_CloseStream(PaStream* stream) {
+    ApiCall call;
+    MockStream* mock = static_cast<MockStream*>(stream);
+    if (!mock) {
+        return paBadStreamPtr;
+    }
+    stop_stream(mock);
+    delete mock;
+    return paNoError;
+}
+
+PaError Pa_IsStreamActive(PaStream* stream) {
+    MockStream* mock = static_cast<MockStream*>(stream);
+    return mock && mock->active.load() ? 1 : 0;
+}
+
+PaError Pa_IsStreamStopped(PaStream* stream) {
+    MockStream* mock = static_cast<MockStream*>(stream);
+    return mock && mock->active.load() ? 0 : 1;
+}
+
+PaTime Pa_GetStreamTime(PaStream* stream) {
+    (void)stream;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+long Pa_GetStreamReadAvailable(PaStream* stream) { (void)stream; return 0; }
+long Pa_GetStreamWriteAvailable(PaStream* stream) { (void)stream; return 0; }
+
+const char* Pa_GetErrorText(PaError errorCode) {
+    switch (errorCode) {
+        case paNoError: return "Success";
+        case paInvalidDevice: return "Invalid device";
+        case paInvalidChannelCount: return "Invalid number of channels";
+        case paInvalidSampleRate: return "Invalid sample rate";
+        case paBadStreamPtr: return "Invalid stream pointer";
+        case paStreamIsNotStopped: return "Stream is not stopped";
+        case paStreamIsStopped: return "Stream is stopped";
+        case paNotInitialized: return "PortAudio not initialized";
+        default: return "Mock PortAudio error";
+    }
+}
+
+} // extern "C"
\ No newline at end of file
@@ -0,0 +1,62 @@
+// WebRTC VAD stand-in for tests and benchmarks: an energy detector with
+// thresholds that rise with the aggressiveness mode, like the real one.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace {
+
+struct MockVad {
+    int mode = 0;
+    bool initialized = false;
+};
+
+// Mean-square thresholds in int16 units for modes 0..3
+const int64_t kEnergyThresholds[] = { 100 * 100, 200 * 200, 400 * 400, 800 * 800 };
+
+} // namespace
+
+extern "C" {
+
+void* WebRtcVad_Create() {
+    return new MockVad();
+}
+
+int WebRtcVad_Init(void* handle) {
+    if (!handle) {
+        return -1;
+    }
+    static_cast<MockVad*>(handle)->initialized = true;
+    return 0;
+}
+
+void WebRtcVad_Free(void* handle) {
+    delete static_cast<MockVad*>(handle);
+}
+
+int WebRtcVad_set_mode(void* handle, int mode) {
+    if (!handle || mode < 0 || mode > 3) {
+        return -1;
+    }
+    static_cast<MockVad*>(handle)->mode = mode;
+    return 0;
+}
+
+int WebRtcVad_Process(void* handle, int fs, const int16_t* audio_frame, size_t frame_length) {
+    MockVad* vad = static_cast<MockVad*>(handle);
+    if (!vad || !vad->initialized || !audio_frame || frame_length == 0) {
+        return -1;
+    }
+    // The real VAD accepts 10, 20 or 30 ms frames at 8, 16, 32 or 48 kHz
+    if (fs != 8000 && fs != 16000 && fs != 32000 && fs != 48000) {
+        return -1;
+    }
+
+    int64_t energy = 0;
+    for (size_t i = 0; i < frame_length; i++) {
+        energy += static_cast<int64_t>(audio_frame[i]) * audio_frame[i];
+    }
+    return energy / static_cast<int64_t>(frame_length) > kEnergyThresholds[vad->mode] ? 1 : 0;
+}
+
+} // extern "C"
\ No newline at end of file
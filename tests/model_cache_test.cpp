@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "model_cache.h"
+#include "metrics.h"
+#include "vosk_transcription_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+static std::string write_script(const std::string& name) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream out(path);
+    out << "utterance = hello world\n";
+    return path;
+}
+
+// Test that prefetching reads every file of a model directory
+TEST(ModelCacheTest, PrefetchReportsBytes) {
+    namespace fs = std::filesystem;
+    fs::path dir = fs::path(::testing::TempDir()) / "model_cache_prefetch";
+    fs::create_directories(dir / "graph");
+    std::ofstream(dir / "am.bin", std::ios::binary) << std::string(3 << 20, 'a');
+    std::ofstream(dir / "graph" / "HCLG.fst", std::ios::binary) << std::string(1000, 'g');
+
+    std::vector<uint64_t> reported;
+    uint64_t reported_total = 0;
+    uint64_t read = prefetch_model_files(dir.string(), [&](uint64_t bytes_read, uint64_t total_bytes) {
+        reported.push_back(bytes_read);
+        reported_total = total_bytes;
+    });
+    EXPECT_EQ(read, (3u << 20) + 1000u);
+    EXPECT_EQ(reported_total, read);
+    ASSERT_FALSE(reported.empty());
+    EXPECT_TRUE(std::is_sorted(reported.begin(), reported.end()));
+    EXPECT_EQ(reported.back(), read);
+    EXPECT_GT(reported.size(), 2u);
+
+    EXPECT_EQ(prefetch_model_files((dir / "missing").string(), nullptr), 0u);
+}
+
+// Test that transcribers on one model path share a single loaded model
+TEST(ModelCacheTest, SharesModelWhileHeld) {
+    ModelCache& cache = ModelCache::instance();
+    std::string path = write_script("model_cache_shared.txt");
+    ModelCache::Stats before = cache.stats();
+
+    std::string error;
+    std::shared_ptr<SpeechModel> first = cache.acquire("synthetic", path, error);
+    ASSERT_NE(first, nullptr) << error;
+    std::shared_ptr<SpeechModel> second = cache.acquire("synthetic", path, error);
+    EXPECT_EQ(first.get(), second.get());
+
+    ModelCache::Stats held = cache.stats();
+    EXPECT_EQ(held.loads, before.loads + 1);
+    EXPECT_EQ(held.hits, before.hits + 1);
+    EXPECT_EQ(held.resident_models, before.resident_models + 1);
+
+    // A reload reads the files again; the old copy stays with its holders
+    std::shared_ptr<SpeechModel> reloaded = cache.acquire("synthetic", path, error, true);
+    ASSERT_NE(reloaded, nullptr);
+    EXPECT_NE(reloaded.get(), first.get());
+    EXPECT_EQ(cache.stats().loads, before.loads + 2);
+
+    // Once everyone lets go it is freed and the next acquire loads it again
+    first.reset();
+    second.reset();
+    reloaded.reset();
+    EXPECT_EQ(cache.stats().resident_models, before.resident_models);
+    std::shared_ptr<SpeechModel> third = cache.acquire("synthetic", path, error);
+    ASSERT_NE(third, nullptr);
+    EXPECT_EQ(cache.stats().loads, before.loads + 3);
+}
+
+// Test that concurrent acquires load the model once and failures are not kept
+TEST(ModelCacheTest, ConcurrentAcquireAndFailure) {
+    ModelCache& cache = ModelCache::instance();
+    std::string path = write_script("model_cache_concurrent.txt");
+    ModelCache::Stats before = cache.stats();
+
+    std::vector<std::shared_ptr<SpeechModel>> models(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < models.size(); i++) {
+        threads.emplace_back([&, i]() {
+            std::string error;
+            models[i] = cache.acquire("synthetic", path, error);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& model : models) {
+        ASSERT_NE(model, nullptr);
+        EXPECT_EQ(model.get(), models[0].get());
+    }
+    EXPECT_EQ(cache.stats().loads, before.loads + 1);
+
+    std::string error;
+    EXPECT_EQ(cache.acquire("synthetic", ::testing::TempDir() + "no_such_script.txt", error), nullptr);
+    EXPECT_FALSE(error.empty());
+    EXPECT_EQ(cache.acquire("no_such_engine", path, error), nullptr);
+    EXPECT_EQ(cache.stats().loads, before.loads + 1);
+}
+
+// Test that two transcribers on one path share the model and loads are timed
+TEST(ModelCacheTest, TranscribersShareModel) {
+    MetricsRegistry& registry = MetricsRegistry::instance();
+    registry.reset();
+    std::string path = write_script("model_cache_transcribers.txt");
+    ModelCache::Stats before = ModelCache::instance().stats();
+
+    VoskTranscriber first(path, 16000.0f, "synthetic");
+    VoskTranscriber second(path, 16000.0f, "synthetic");
+    while (first.is_loading() || second.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(first.is_model_loaded()) << first.get_last_error();
+    ASSERT_TRUE(second.is_model_loaded()) << second.get_last_error();
+    EXPECT_EQ(ModelCache::instance().stats().loads, before.loads + 1);
+
+    MetricsSnapshot snapshot = registry.snapshot();
+    for (const auto& stage : snapshot.stages) {
+        if (stage.stage == "model_load") {
+            EXPECT_EQ(stage.count, 1u);
+        }
+    }
+#ifdef __linux__
+    EXPECT_GT(snapshot.resident_bytes, 0u);
+    EXPECT_NE(registry.to_prometheus().find("voice_transcription_resident_memory_bytes"), std::string::npos);
+#endif
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "result_queue.h"
+
+#include <chrono>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+using namespace voice_transcription;
+
+// Whether the descriptor polls readable within timeout_ms
+static bool readable(intptr_t fd, int timeout_ms = 0) {
+#ifdef _WIN32
+    (void)fd;
+    (void)timeout_ms;
+    return true;
+#else
+    pollfd entry = { static_cast<int>(fd), POLLIN, 0 };
+    return poll(&entry, 1, timeout_ms) == 1 && (entry.revents & POLLIN);
+#endif
+}
+
+static TranscriptionResult make_result(const std::string& text) {
+    TranscriptionResult result;
+    result.raw_text = text;
+    result.is_final = true;
+    return result;
+}
+
+// Test that the descriptor is readable exactly while results are queued
+TEST(ResultQueueTest, DescriptorTracksContents) {
+    ResultQueue queue;
+    ASSERT_GE(queue.ready_fd(), 0);
+    EXPECT_FALSE(readable(queue.ready_fd()));
+
+    queue.push(make_result("one"));
+    queue.push(make_result("two"));
+    EXPECT_TRUE(readable(queue.ready_fd()));
+
+    // Still readable with one left, so an event loop never strands a result
+    ASSERT_EQ(queue.pop()->raw_text, "one");
+    EXPECT_TRUE(readable(queue.ready_fd()));
+    ASSERT_EQ(queue.pop()->raw_text, "two");
+    EXPECT_FALSE(readable(queue.ready_fd()));
+    EXPECT_FALSE(queue.pop().has_value());
+    EXPECT_FALSE(readable(queue.ready_fd()));
+
+    // Closing wakes watchers for good
+    queue.close();
+    EXPECT_TRUE(readable(queue.ready_fd()));
+    EXPECT_FALSE(queue.pop().has_value());
+    EXPECT_TRUE(readable(queue.ready_fd()));
+    EXPECT_FALSE(queue.push(make_result("late")));
+}
+
+// Test that a full queue drops its oldest result
+TEST(ResultQueueTest, DropsOldestWhenFull) {
+    ResultQueue queue(2);
+    queue.push(make_result("a"));
+    queue.push(make_result("b"));
+    queue.push(make_result("c"));
+    EXPECT_EQ(queue.size(), 2u);
+    EXPECT_EQ(queue.dropped(), 1u);
+    EXPECT_EQ(queue.pop()->raw_text, "b");
+    EXPECT_EQ(queue.pop()->raw_text, "c");
+}
+
+// Test that wait_pop times out, and wakes for a push from another thread
+TEST(ResultQueueTest, WaitPop) {
+    ResultQueue queue;
+    auto started = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.wait_pop(50).has_value());
+    EXPECT_GE(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(45));
+
+    std::thread producer([&queue]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.push(make_result("late"));
+    });
+    EXPECT_TRUE(readable(queue.ready_fd(), 1000));
+    std::optional<TranscriptionResult> result = queue.wait_pop(1000);
+    producer.join();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->raw_text, "late");
+    EXPECT_FALSE(readable(queue.ready_fd()));
+
+    queue.close();
+    EXPECT_FALSE(queue.wait_pop(1000).has_value());
+}
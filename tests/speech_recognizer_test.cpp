@@ -0,0 +1,379 @@
+#include <gtest/gtest.h>
+#include "speech_recognizer.h"
+#include "vosk_transcription_engine.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+using namespace voice_transcription;
+
+static std::string write_script(const std::string& name, const std::string& text) {
+    std::string path = ::testing::TempDir() + name;
+    std::ofstream out(path);
+    out << text;
+    return path;
+}
+
+static std::vector<float> tone(size_t count, float amplitude) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = amplitude * std::sin(2.0f * 3.14159265f * 440.0f * i / 16000.0f);
+    }
+    return samples;
+}
+
+// Test that the factory reports what it can build
+TEST(SpeechRecognizerTest, AvailableEngines) {
+    std::vector<std::string> engines = available_speech_engines();
+    EXPECT_NE(std::find(engines.begin(), engines.end(), "vosk"), engines.end());
+    EXPECT_NE(std::find(engines.begin(), engines.end(), "synthetic"), engines.end());
+}
+
+// Test that unknown engines and missing models fail with an error
+TEST(SpeechRecognizerTest, LoadErrors) {
+    std::string error;
+    EXPECT_EQ(load_speech_model("nonexistent", "model", error), nullptr);
+    EXPECT_NE(error.find("Unknown speech engine"), std::string::npos);
+
+    error.clear();
+    EXPECT_EQ(load_speech_model("synthetic", ::testing::TempDir() + "no_such_model", error), nullptr);
+    EXPECT_FALSE(error.empty());
+
+#ifndef USE_WHISPER
+    error.clear();
+    EXPECT_EQ(load_speech_model("whisper", "model.bin", error), nullptr);
+    EXPECT_NE(error.find("not compiled"), std::string::npos);
+#endif
+}
+
+// Test a full utterance through the engine interface
+TEST(SpeechRecognizerTest, SyntheticEngineStreams) {
+    std::string path = write_script("speech_engine.conf", "words_per_second = 10\nutterance = hello engine world\n");
+    std::string error;
+    auto model = load_speech_model("synthetic", path, error);
+    ASSERT_NE(model, nullptr) << error;
+    EXPECT_EQ(model->capabilities().engine, "synthetic");
+    EXPECT_TRUE(model->capabilities().streaming_partials);
+
+    auto recognizer = model->create_recognizer(16000.0f, error);
+    ASSERT_NE(recognizer, nullptr) << error;
+
+    // 200 ms of speech reveals two words at 10 words per second
+    std::vector<float> speech = tone(320, 0.3f);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_FALSE(recognizer->accept_waveform(speech.data(), speech.size()));
+    }
+    TranscriptionResult partial = recognizer->partial_result();
+    EXPECT_FALSE(partial.is_final);
+    EXPECT_EQ(partial.raw_text, "hello engine");
+
+    TranscriptionResult final_result = recognizer->final_result();
+    EXPECT_TRUE(final_result.is_final);
+    EXPECT_EQ(final_result.raw_text, "hello engine world");
+    EXPECT_EQ(final_result.processed_text, final_result.raw_text);
+}
+
+// Test that grammar recognizers only hear their phrases, on both engines
+TEST(SpeechRecognizerTest, GrammarRecognizer) {
+    std::string path = write_script("speech_grammar.conf", "utterance = new line\nutterance = hello there\n");
+    std::vector<float> speech = tone(320, 0.3f);
+    for (const char* engine : { "synthetic", "vosk" }) {
+        std::string error;
+        auto model = load_speech_model(engine, path, error);
+        ASSERT_NE(model, nullptr) << error;
+        EXPECT_TRUE(model->capabilities().grammar);
+        EXPECT_EQ(model->create_grammar_recognizer(16000.0f, {}, error), nullptr);
+
+        auto recognizer = model->create_grammar_recognizer(16000.0f, { "new line", "caps on" }, error);
+        ASSERT_NE(recognizer, nullptr) << engine << ": " << error;
+        for (const char* expected : { "new line", "[unk]" }) {
+            for (int i = 0; i < 10; i++) {
+                recognizer->accept_waveform(speech.data(), speech.size());
+            }
+            EXPECT_EQ(recognizer->final_result().raw_text, expected) << engine;
+        }
+    }
+}
+
+// Test that the transcriber picks the engine by name
+TEST(SpeechRecognizerTest, TranscriberUsesEngine) {
+    std::string path = write_script("transcriber_engine.conf", "utterance = twenty three percent\n");
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+    EXPECT_EQ(transcriber.get_engine_name(), "synthetic");
+    EXPECT_EQ(transcriber.get_capabilities().engine, "synthetic");
+
+    std::vector<float> speech = tone(320, 0.3f);
+    for (int i = 0; i < 25; i++) {
+        auto chunk = std::make_unique<AudioChunk>(speech.data(), speech.size());
+        transcriber.transcribe_with_vad(std::move(chunk), true);
+    }
+    auto silence = std::make_unique<AudioChunk>(320);
+    silence->set_sequence(42);
+    TranscriptionResult result = transcriber.transcribe_with_vad(std::move(silence), false);
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "twenty three percent");
+    EXPECT_EQ(result.processed_text, "23%");
+    EXPECT_EQ(result.chunk_sequence, 42u);
+}
+
+// Test that word timings and N-best lists reach transcriber results
+TEST(SpeechRecognizerTest, TranscriberWordDetail) {
+    std::string path = write_script("transcriber_words.conf", "confidence = 0.8\nutterance = scroll down\n");
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    EXPECT_TRUE(transcriber.set_max_alternatives(3));
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+    EXPECT_TRUE(transcriber.get_capabilities().alternatives);
+
+    // 200 ms of silence, then speech
+    for (int i = 0; i < 10; i++) {
+        transcriber.transcribe(std::make_unique<AudioChunk>(320));
+    }
+    std::vector<float> speech = tone(320, 0.3f);
+    for (int i = 0; i < 25; i++) {
+        transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(speech.data(), speech.size()), true);
+    }
+    TranscriptionResult result = transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(320), false);
+    EXPECT_EQ(result.raw_text, "scroll down");
+    ASSERT_EQ(result.alternatives.size(), 1u);
+    EXPECT_FLOAT_EQ(result.alternatives[0].score, 0.8f);
+    ASSERT_EQ(result.words.size(), 2u);
+    EXPECT_EQ(result.text_of(result.words[0]), "scroll");
+    EXPECT_NEAR(result.words[0].start, 0.2f, 1e-4f);
+    EXPECT_LT(result.words[0].end, result.words[1].end);
+
+    // Without N-best the words carry the engine's confidence
+    EXPECT_TRUE(transcriber.set_max_alternatives(0));
+    for (int i = 0; i < 25; i++) {
+        transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(speech.data(), speech.size()), true);
+    }
+    result = transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(320), false);
+    EXPECT_TRUE(result.alternatives.empty());
+    ASSERT_EQ(result.words.size(), 2u);
+    EXPECT_FLOAT_EQ(result.words[1].confidence, 0.8f);
+    EXPECT_DOUBLE_EQ(result.confidence, 0.8);
+}
+
+// Test that results report their utterance in sample time and capture time
+TEST(SpeechRecognizerTest, TranscriberUtteranceTimeline) {
+    std::string path = write_script("transcriber_timeline.conf", "utterance = go to line ten\n");
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    // Chunk i holds samples [320 i, 320 i + 320), captured 20 ms apart from t = 5 s
+    std::vector<float> speech = tone(320, 0.3f);
+    auto make_chunk = [&](uint64_t index, bool is_speech) {
+        auto chunk = is_speech ? std::make_unique<AudioChunk>(speech.data(), speech.size())
+                               : std::make_unique<AudioChunk>(320);
+        chunk->set_sequence(index);
+        chunk->set_first_sample(index * 320);
+        chunk->set_capture_time_us(5000000 + static_cast<int64_t>(index) * 20000);
+        return chunk;
+    };
+
+    TranscriptionResult partial;
+    for (uint64_t i = 10; i < 35; i++) {
+        partial = transcriber.transcribe_with_vad(make_chunk(i, true), true);
+    }
+    EXPECT_FALSE(partial.is_final);
+    EXPECT_EQ(partial.start_sample, 3200u);
+    EXPECT_EQ(partial.end_sample, 35u * 320);
+
+    transcriber.transcribe_with_vad(make_chunk(35, false), true);
+    TranscriptionResult result = transcriber.transcribe_with_vad(make_chunk(36, false), false);
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "go to line ten");
+    EXPECT_EQ(result.start_sample, 3200u);
+    EXPECT_EQ(result.end_sample, 36u * 320);
+    EXPECT_EQ(result.start_capture_us, 5200000);
+    EXPECT_EQ(result.end_capture_us, 5720000);
+
+    // The next utterance starts where its own audio does
+    for (uint64_t i = 50; i < 60; i++) {
+        partial = transcriber.transcribe_with_vad(make_chunk(i, true), true);
+    }
+    EXPECT_EQ(partial.start_sample, 50u * 320);
+    EXPECT_EQ(partial.start_capture_us, 6000000);
+}
+
+// Test that a swapped-in model takes over at the next utterance boundary
+TEST(SpeechRecognizerTest, TranscriberSwapsModel) {
+    std::string small_model = write_script("swap_small.conf", "utterance = small model\n");
+    std::string large_model = write_script("swap_large.conf", "utterance = large model\n");
+    VoskTranscriber transcriber(small_model, 16000.0f, "synthetic");
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    std::vector<float> speech = tone(320, 0.3f);
+    auto speak = [&](int chunks) {
+        for (int i = 0; i < chunks; i++) {
+            transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(speech.data(), speech.size()), true);
+        }
+    };
+    auto finish = [&]() {
+        return transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(320), false);
+    };
+
+    // The swap is requested mid-utterance; that utterance stays on the old model
+    speak(10);
+    ASSERT_TRUE(transcriber.swap_model(large_model));
+    EXPECT_FALSE(transcriber.swap_model(large_model));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    speak(10);
+    EXPECT_TRUE(transcriber.is_swap_pending());
+    EXPECT_EQ(transcriber.get_model_path(), small_model);
+    EXPECT_EQ(finish().raw_text, "small model");
+
+    speak(10);
+    EXPECT_EQ(finish().raw_text, "large model");
+    EXPECT_EQ(transcriber.get_model_path(), large_model);
+    EXPECT_FALSE(transcriber.is_swap_pending());
+
+    // A failed swap keeps the current model
+    ASSERT_TRUE(transcriber.swap_model(::testing::TempDir() + "no_such_model"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    speak(10);
+    EXPECT_EQ(finish().raw_text, "large model");
+    EXPECT_FALSE(transcriber.is_swap_pending());
+    EXPECT_NE(transcriber.get_last_error().find("Model swap failed"), std::string::npos);
+}
+
+// Test that the accessors are safe to call while a swap is adopted on the decode thread
+TEST(SpeechRecognizerTest, TranscriberAccessorsDuringSwap) {
+    std::string small_model = write_script("swap_race_small.conf", "utterance = small model\n");
+    std::string large_model = write_script("swap_race_large.conf", "utterance = large model\n");
+    VoskTranscriber transcriber(small_model, 16000.0f, "synthetic");
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    std::atomic<bool> done{false};
+    std::thread caller([&]() {
+        while (!done) {
+            EXPECT_TRUE(transcriber.is_model_loaded());
+            EXPECT_TRUE(transcriber.get_capabilities().grammar);
+            EXPECT_TRUE(transcriber.set_max_alternatives(0));
+            EXPECT_TRUE(transcriber.set_command_phrases({}));
+        }
+    });
+
+    // Each round adopts a new model at the utterance boundary
+    std::vector<float> speech = tone(320, 0.3f);
+    for (int round = 0; round < 20; round++) {
+        ASSERT_TRUE(transcriber.swap_model(round % 2 == 0 ? large_model : small_model));
+        while (transcriber.is_swap_pending()) {
+            transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(speech.data(), speech.size()), true);
+            transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(320), false);
+        }
+    }
+    done = true;
+    caller.join();
+    EXPECT_EQ(transcriber.get_model_path(), small_model);
+}
+
+// Feed an utterance of speech and silence until the transcriber finalizes it
+static TranscriptionResult speak(VoskTranscriber& transcriber) {
+    std::vector<float> speech = tone(320, 0.3f);
+    std::vector<float> silence(320, 0.0f);
+    TranscriptionResult result;
+    for (int i = 0; i < 60 && !result.is_final; i++) {
+        const std::vector<float>& samples = i < 20 ? speech : silence;
+        result = transcriber.transcribe(std::make_unique<AudioChunk>(samples.data(), samples.size()));
+    }
+    return result;
+}
+
+// Test switching between dictation and the command grammar per utterance
+TEST(SpeechRecognizerTest, TranscriberCommandMode) {
+    std::string path = write_script("transcriber_commands.conf",
+                                    "utterance = new line\nutterance = twenty three percent\n");
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    EXPECT_TRUE(transcriber.set_command_phrases({ "new line", "caps on" }));
+    transcriber.set_recognition_mode(VoskTranscriber::RecognitionMode::Commands);
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    TranscriptionResult command = speak(transcriber);
+    ASSERT_TRUE(command.is_final);
+    EXPECT_TRUE(command.command_mode);
+    EXPECT_EQ(command.processed_text, "new line");
+
+    // Speech outside the grammar is dropped rather than forced onto a phrase
+    TranscriptionResult rejected = speak(transcriber);
+    ASSERT_TRUE(rejected.is_final);
+    EXPECT_TRUE(rejected.command_mode);
+    EXPECT_EQ(rejected.raw_text, "");
+    EXPECT_TRUE(rejected.words.empty());
+
+    // Dictation has its own recognizer, so its script starts at the top
+    transcriber.set_recognition_mode(VoskTranscriber::RecognitionMode::Dictation);
+    EXPECT_EQ(speak(transcriber).processed_text, "new line");
+    TranscriptionResult dictation = speak(transcriber);
+    EXPECT_FALSE(dictation.command_mode);
+    EXPECT_EQ(dictation.processed_text, "23%");
+}
+
+// Test that a bad engine name surfaces as a load failure
+TEST(SpeechRecognizerTest, TranscriberUnknownEngine) {
+    VoskTranscriber transcriber("model", 16000.0f, "nonexistent");
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_FALSE(transcriber.is_model_loaded());
+    EXPECT_EQ(transcriber.get_loading_phase(), VoskTranscriber::LoadingPhase::Failed);
+    EXPECT_NE(transcriber.get_last_error().find("Unknown speech engine"), std::string::npos);
+}
+
+// Test that loading ends with a warm-up that leaves the first utterance intact
+TEST(SpeechRecognizerTest, TranscriberWarmsUp) {
+    MetricsRegistry::instance().reset();
+    std::string path = write_script("transcriber_warmup.conf", "utterance = first\nutterance = second\n");
+    VoskTranscriber transcriber(path, 16000.0f, "synthetic");
+    float last_progress = 0.0f;
+    while (transcriber.is_loading()) {
+        float progress = transcriber.get_loading_progress();
+        EXPECT_GE(progress, last_progress);
+        last_progress = progress;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+    EXPECT_EQ(transcriber.get_loading_phase(), VoskTranscriber::LoadingPhase::Ready);
+    EXPECT_FLOAT_EQ(transcriber.get_loading_progress(), 1.0f);
+    EXPECT_EQ(transcriber.get_loading_eta_seconds(), 0.0);
+
+    MetricsSnapshot snapshot = MetricsRegistry::instance().snapshot();
+    auto warmup = std::find_if(snapshot.stages.begin(), snapshot.stages.end(),
+                               [](const StageStats& stage) { return stage.stage == "model_warmup"; });
+    ASSERT_NE(warmup, snapshot.stages.end());
+    EXPECT_EQ(warmup->count, 1u);
+
+    // The warm-up ran on its own recognizer, so the script starts at the top
+    std::vector<float> speech = tone(320, 0.3f);
+    std::vector<float> silence(320, 0.0f);
+    TranscriptionResult final_result;
+    for (int i = 0; i < 60 && !final_result.is_final; i++) {
+        const std::vector<float>& samples = i < 20 ? speech : silence;
+        final_result = transcriber.transcribe(std::make_unique<AudioChunk>(samples.data(), samples.size()));
+    }
+    ASSERT_TRUE(final_result.is_final);
+    EXPECT_EQ(final_result.raw_text, "first");
+}
\ No newline at end of file
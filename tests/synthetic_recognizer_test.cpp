@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include "synthetic_recognizer.h"
+#include "vosk_result_parser.h"
+#include "vosk_transcription_engine.h"
+
+#include <vosk_api.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+using namespace voice_transcription;
+
+static std::vector<int16_t> tone(size_t count, double amplitude) {
+    std::vector<int16_t> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<int16_t>(amplitude * 32767.0 * std::sin(2.0 * 3.14159265 * 440.0 * i / 16000.0));
+    }
+    return samples;
+}
+
+// Feed 20 ms blocks and return how many ended an utterance
+static int feed(SyntheticRecognizer& recognizer, double amplitude, int blocks) {
+    std::vector<int16_t> block = tone(320, amplitude);
+    int endpoints = 0;
+    for (int i = 0; i < blocks; i++) {
+        endpoints += recognizer.accept_waveform(block.data(), block.size()) ? 1 : 0;
+    }
+    return endpoints;
+}
+
+static TranscriptionResult parse(const std::string& json) {
+    TranscriptionResult result{};
+    std::string error;
+    EXPECT_TRUE(parse_vosk_result(json, result, error)) << error << " in " << json;
+    return result;
+}
+
+// Test parsing of the script file format
+TEST(SyntheticRecognizerTest, ParseConfig) {
+    SyntheticRecognizerConfig config;
+    std::string error;
+    ASSERT_TRUE(SyntheticRecognizerConfig::parse(
+        "# comment\n"
+        "cpu_cost = 0.25\n"
+        "jitter = lognormal 4 2\n"
+        "words_per_second = 5\n"
+        "endpoint_silence_ms = 200\n"
+        "seed = 7\n"
+        "model_mb = 1.5\n"
+        "utterance = hello world\n"
+        "utterance = second line\n", config, error)) << error;
+    EXPECT_DOUBLE_EQ(config.cpu_cost, 0.25);
+    EXPECT_EQ(config.jitter.kind, JitterDistribution::Kind::LogNormal);
+    EXPECT_DOUBLE_EQ(config.jitter.a_ms, 4.0);
+    EXPECT_DOUBLE_EQ(config.jitter.b_ms, 2.0);
+    EXPECT_DOUBLE_EQ(config.words_per_second, 5.0);
+    EXPECT_EQ(config.seed, 7u);
+    EXPECT_DOUBLE_EQ(config.model_mb, 1.5);
+    ASSERT_EQ(config.script.size(), 2u);
+    EXPECT_EQ(config.script[1], "second line");
+
+    SyntheticRecognizerConfig bad;
+    EXPECT_FALSE(SyntheticRecognizerConfig::parse("jitter = gamma 1 2\n", bad, error));
+    EXPECT_NE(error.find("gamma"), std::string::npos);
+    EXPECT_FALSE(SyntheticRecognizerConfig::parse("cpu_cost = lots\n", bad, error));
+    EXPECT_FALSE(SyntheticRecognizerConfig::parse("no equals sign\n", bad, error));
+    EXPECT_FALSE(SyntheticRecognizerConfig::parse("colour = blue\n", bad, error));
+}
+
+// Test the jitter distributions against their parameters
+TEST(SyntheticRecognizerTest, JitterDistributions) {
+    JitterDistribution uniform{ JitterDistribution::Kind::Uniform, 2.0, 6.0 };
+    EXPECT_DOUBLE_EQ(uniform.sample_ms(0.0, 0.0), 2.0);
+    EXPECT_DOUBLE_EQ(uniform.sample_ms(0.5, 0.0), 4.0);
+
+    JitterDistribution normal{ JitterDistribution::Kind::Normal, 5.0, 2.0 };
+    EXPECT_DOUBLE_EQ(normal.sample_ms(0.5, 1.0), 7.0);
+    EXPECT_DOUBLE_EQ(normal.sample_ms(0.5, -10.0), 0.0);
+
+    JitterDistribution exponential{ JitterDistribution::Kind::Exponential, 3.0, 0.0 };
+    EXPECT_NEAR(exponential.sample_ms(std::exp(-1.0), 0.0), 3.0, 1e-9);
+
+    // Log-normal is parameterized by its own mean: check the mean of many draws
+    JitterDistribution lognormal{ JitterDistribution::Kind::LogNormal, 4.0, 2.0 };
+    double sum = 0.0;
+    const int draws = 20000;
+    for (int i = 0; i < draws; i++) {
+        // Deterministic normal quantiles via Box-Muller on a lattice
+        double u1 = (i + 0.5) / draws;
+        double u2 = std::fmod(i * 0.6180339887, 1.0);
+        double normal_value = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * 3.14159265358979 * u2);
+        sum += lognormal.sample_ms(0.5, normal_value);
+    }
+    EXPECT_NEAR(sum / draws, 4.0, 0.2);
+
+    JitterDistribution none;
+    EXPECT_DOUBLE_EQ(none.sample_ms(0.3, 1.0), 0.0);
+}
+
+// Test that partials reveal the script word by word and silence ends the utterance
+TEST(SyntheticRecognizerTest, ScriptedResults) {
+    SyntheticRecognizerConfig config;
+    config.script = { "one two three four", "five six" };
+    config.words_per_second = 5.0;
+    config.endpoint_silence_ms = 100.0;
+    SyntheticRecognizer recognizer(config, 16000.0f);
+    recognizer.set_words(true);
+
+    EXPECT_EQ(parse(recognizer.partial_result()).raw_text, "");
+    EXPECT_EQ(feed(recognizer, 0.3, 10), 0);   // 200 ms of speech = one word
+    EXPECT_EQ(parse(recognizer.partial_result()).raw_text, "one");
+    EXPECT_EQ(feed(recognizer, 0.3, 10), 0);
+    EXPECT_EQ(parse(recognizer.partial_result()).raw_text, "one two");
+
+    // Silence shorter than the endpoint keeps the utterance open
+    EXPECT_EQ(feed(recognizer, 0.0, 4), 0);
+    EXPECT_EQ(feed(recognizer, 0.0, 1), 1);
+    TranscriptionResult final_result = parse(recognizer.result());
+    EXPECT_TRUE(final_result.is_final);
+    EXPECT_EQ(final_result.raw_text, "one two three four");
+    EXPECT_EQ(recognizer.get_utterance_count(), 1u);
+
+    // The next utterance is forced final; then the script wraps around
+    feed(recognizer, 0.3, 5);
+    EXPECT_EQ(parse(recognizer.final_result()).raw_text, "five six");
+    EXPECT_EQ(parse(recognizer.final_result()).raw_text, "");
+    feed(recognizer, 0.3, 5);
+    EXPECT_EQ(parse(recognizer.final_result()).raw_text, "one two three four");
+
+    // Reset drops the utterance in progress without advancing the script
+    feed(recognizer, 0.3, 20);
+    recognizer.reset();
+    EXPECT_EQ(parse(recognizer.partial_result()).raw_text, "");
+    feed(recognizer, 0.3, 5);
+    EXPECT_EQ(parse(recognizer.final_result()).raw_text, "five six");
+}
+
+// Test that n-best output is read as the top alternative
+TEST(SyntheticRecognizerTest, Alternatives) {
+    SyntheticRecognizerConfig config;
+    config.script = { "hello there" };
+    SyntheticRecognizer recognizer(config, 16000.0f);
+    recognizer.set_max_alternatives(1);
+    recognizer.set_words(true);
+    feed(recognizer, 0.3, 5);
+
+    std::string json = recognizer.final_result();
+    EXPECT_NE(json.find("\"alternatives\""), std::string::npos);
+    TranscriptionResult result = parse(json);
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "hello there");
+}
+
+// Test that the CPU cost scales with the audio duration
+TEST(SyntheticRecognizerTest, CpuCost) {
+    SyntheticRecognizerConfig config;
+    config.cpu_cost = 0.1;
+    SyntheticRecognizer recognizer(config, 16000.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    feed(recognizer, 0.3, 50);  // One second of audio
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed_ms, 100.0);
+    EXPECT_LT(elapsed_ms, 1000.0);
+}
+
+// Test that the same seed gives the same jitter and that the delay is applied
+TEST(SyntheticRecognizerTest, DeterministicJitter) {
+    SyntheticRecognizerConfig config;
+    config.jitter = { JitterDistribution::Kind::Uniform, 1.0, 4.0 };
+    config.seed = 3;
+
+    SyntheticRecognizer first(config, 16000.0f);
+    SyntheticRecognizer second(config, 16000.0f);
+    for (int i = 0; i < 100; i++) {
+        double delay = first.draw_jitter_ms();
+        EXPECT_DOUBLE_EQ(delay, second.draw_jitter_ms());
+        EXPECT_GE(delay, 1.0);
+        EXPECT_LE(delay, 4.0);
+    }
+    SyntheticRecognizer reseeded(config, 16000.0f);
+    config.seed = 4;
+    SyntheticRecognizer other(config, 16000.0f);
+    bool differs = false;
+    for (int i = 0; i < 10; i++) {
+        differs = differs || reseeded.draw_jitter_ms() != other.draw_jitter_ms();
+    }
+    EXPECT_TRUE(differs);
+
+    auto start = std::chrono::steady_clock::now();
+    feed(first, 0.3, 10);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_GE(elapsed_ms, 10.0);
+}
+
+// Test the Vosk C API through VoskTranscriber with a script in the model directory
+TEST(SyntheticRecognizerTest, DrivesVoskTranscriber) {
+    std::string model = ::testing::TempDir() + "synthetic_model.conf";
+    {
+        std::ofstream out(model);
+        out << "utterance = turn on the lights\n";
+    }
+    VoskTranscriber transcriber(model, 16000.0f);
+    while (transcriber.is_loading()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+
+    std::vector<int16_t> pcm = tone(320, 0.3);
+    std::vector<float> speech(pcm.size());
+    for (size_t i = 0; i < pcm.size(); i++) {
+        speech[i] = pcm[i] / 32768.0f;
+    }
+    std::string partial;
+    for (int i = 0; i < 25; i++) {
+        auto chunk = std::make_unique<AudioChunk>(speech.data(), speech.size());
+        TranscriptionResult result = transcriber.transcribe_with_vad(std::move(chunk), true);
+        EXPECT_FALSE(result.is_final);
+        partial = result.raw_text;
+    }
+    EXPECT_EQ(partial, "turn");
+
+    TranscriptionResult final_result = transcriber.transcribe_with_vad(std::make_unique<AudioChunk>(320), false);
+    EXPECT_TRUE(final_result.is_final);
+    EXPECT_EQ(final_result.raw_text, "turn on the lights");
+    std::remove(model.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "trace_recorder.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace voice_transcription;
+
+static size_t count_occurrences(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+// Test that the trace clock is steady and matches epoch milliseconds
+TEST(TraceRecorderTest, ClockAlignment) {
+    int64_t first = trace_clock_us();
+    int64_t second = trace_clock_us();
+    EXPECT_LE(first, second);
+
+    int64_t system_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    EXPECT_NEAR(static_cast<double>(second / 1000), static_cast<double>(system_ms), 1000.0);
+}
+
+// Test that spans are keyed by chunk and exported as complete events
+TEST(TraceRecorderTest, SpansAndJson) {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.set_enabled(false);
+    recorder.clear();
+
+    {
+        TraceSpan ignored(trace_span::kVad, 1);
+    }
+    EXPECT_EQ(recorder.to_json().find("\"vad\""), std::string::npos);
+
+    recorder.set_enabled(true);
+    recorder.set_thread_name("test \"main\"");
+    {
+        TraceSpan span(trace_span::kDecode, 42);
+    }
+    recorder.record(trace_span::kOutput, 42, 1000, 1500);
+
+    std::string json = recorder.to_json();
+    EXPECT_NE(json.find("\"name\":\"decode\""), std::string::npos);
+    EXPECT_NE(json.find("\"chunk\":42"), std::string::npos);
+    EXPECT_NE(json.find("\"ts\":1000,\"dur\":500"), std::string::npos);
+    EXPECT_NE(json.find("test \\\"main\\\""), std::string::npos);
+
+    // Events are sorted by start time
+    EXPECT_LT(json.find("\"name\":\"output\""), json.find("\"name\":\"decode\""));
+
+    EXPECT_EQ(TraceRecorder::intern_span_name("output"), trace_span::kOutput);
+    EXPECT_EQ(TraceRecorder::intern_span_name("bogus"), nullptr);
+
+    recorder.clear();
+    EXPECT_EQ(recorder.to_json().find("\"decode\""), std::string::npos);
+    recorder.set_enabled(false);
+}
+
+// Test that a full ring keeps only the newest events
+TEST(TraceRecorderTest, RingWrapsAround) {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.clear();
+    recorder.set_enabled(true);
+
+    std::thread writer([&recorder]() {
+        for (uint64_t i = 0; i < TraceRecorder::kEventsPerThread + 100; i++) {
+            recorder.record(trace_span::kCapture, 1000000 + i, 0, 1);
+        }
+    });
+    writer.join();
+
+    // The oldest surviving slot is also the next one to be written, so it is left out
+    std::string json = recorder.to_json();
+    EXPECT_EQ(json.find("\"chunk\":1000100}"), std::string::npos);
+    EXPECT_NE(json.find("\"chunk\":1000101}"), std::string::npos);
+    EXPECT_NE(json.find("\"chunk\":" + std::to_string(1000099 + TraceRecorder::kEventsPerThread) + "}"),
+              std::string::npos);
+    EXPECT_EQ(count_occurrences(json, "\"name\":\"capture\""), TraceRecorder::kEventsPerThread - 1);
+
+    recorder.clear();
+    recorder.set_enabled(false);
+}
+
+// Test that rings of exited threads are reused rather than kept per thread
+TEST(TraceRecorderTest, ExitedThreadsRecycleRings) {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.clear();
+    recorder.set_enabled(true);
+
+    std::thread([&recorder]() { recorder.record(trace_span::kDecode, 2000000, 0, 1); }).join();
+    size_t rings = recorder.buffer_count();
+    for (uint64_t t = 1; t <= 20; t++) {
+        std::thread([&recorder, t]() {
+            recorder.set_thread_name("worker " + std::to_string(t));
+            recorder.record(trace_span::kDecode, 2000000 + t, 0, 1);
+        }).join();
+    }
+    EXPECT_EQ(recorder.buffer_count(), rings);
+
+    // The last thread's spans outlive it, until another thread takes its ring
+    std::string json = recorder.to_json();
+    EXPECT_NE(json.find("\"chunk\":2000020}"), std::string::npos);
+    EXPECT_NE(json.find("worker 20"), std::string::npos);
+    EXPECT_LE(count_occurrences(json, "\"name\":\"decode\""), rings);
+
+    recorder.clear();
+    recorder.set_enabled(false);
+}
+
+// Test dumping while several threads record
+TEST(TraceRecorderTest, ConcurrentDump) {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.clear();
+    recorder.set_enabled(true);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; t++) {
+        writers.emplace_back([&recorder, &stop]() {
+            uint64_t sequence = 0;
+            while (!stop.load()) {
+                TraceSpan span(trace_span::kVad, sequence++);
+            }
+        });
+    }
+
+    for (int i = 0; i < 5; i++) {
+        std::string json = recorder.to_json();
+        EXPECT_EQ(json.compare(0, 2, "{\""), 0);
+        EXPECT_EQ(json.find("\"name\":\"\""), std::string::npos);
+    }
+    stop = true;
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    recorder.clear();
+    recorder.set_enabled(false);
+}
+
+// Test that a slow span writes a trace file once per cooldown
+TEST(TraceRecorderTest, LatencyTrigger) {
+    TraceRecorder& recorder = TraceRecorder::instance();
+    recorder.clear();
+    recorder.set_enabled(true);
+
+    std::string base = ::testing::TempDir() + "trace_trigger.json";
+    recorder.set_dump_trigger(1000, base);
+    uint64_t dumps = recorder.get_triggered_dump_count();
+
+    int64_t now = trace_clock_us();
+    recorder.record(trace_span::kDecode, 7, now - 10, now);
+    EXPECT_EQ(recorder.get_triggered_dump_count(), dumps);
+
+    // Audio callback threads never dump
+    std::thread callback([&recorder, now]() {
+        recorder.mark_realtime_thread();
+        recorder.record(trace_span::kCapture, 7, now - 5000, now);
+    });
+    callback.join();
+    EXPECT_EQ(recorder.get_triggered_dump_count(), dumps);
+
+    recorder.record(trace_span::kDecode, 8, now - 2000, now);
+    EXPECT_EQ(recorder.get_triggered_dump_count(), dumps + 1);
+    recorder.record(trace_span::kDecode, 9, now - 2000, now);
+    EXPECT_EQ(recorder.get_triggered_dump_count(), dumps + 1);
+
+    recorder.set_dump_trigger(0, "");
+    recorder.clear();
+    recorder.set_enabled(false);
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "transcription_pipeline.h"
+#include "vosk_transcription_engine.h"
+#include "wav_file_stream.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+using namespace voice_transcription;
+
+// Directory that stands in for a model; the synthetic recognizer uses its default script
+static std::string model_dir() {
+    std::string path = __FILE__;
+    return path.substr(0, path.find_last_of("/\\") + 1) + "data";
+}
+
+// Silence with 440 Hz tone bursts over the given millisecond spans, written as a WAV
+static std::string write_recording(const std::string& name, double duration_ms,
+                                   const std::vector<std::pair<double, double>>& bursts) {
+    const int rate = 16000;
+    std::vector<float> samples(static_cast<size_t>(duration_ms * rate / 1000));
+    for (const auto& burst : bursts) {
+        size_t begin = static_cast<size_t>(burst.first * rate / 1000);
+        size_t end = std::min(samples.size(), static_cast<size_t>(burst.second * rate / 1000));
+        for (size_t i = begin; i < end; i++) {
+            samples[i] = 0.3f * std::sin(2.0f * 3.14159265f * 440.0f * i / rate);
+        }
+    }
+    std::string path = ::testing::TempDir() + name;
+    EXPECT_TRUE(WavFileStream::write_wav(path, samples, rate));
+    return path;
+}
+
+static void wait_for_model(VoskTranscriber& transcriber) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (transcriber.is_loading() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(transcriber.is_model_loaded()) << transcriber.get_last_error();
+}
+
+// Test that a replayed recording yields its results and then closes the queue
+TEST(TranscriptionPipelineTest, RunsToEndOfStream) {
+    std::string wav = write_recording("pipeline.wav", 2500, { { 500, 1100 }, { 1700, 2100 } });
+    WavFileStream stream(wav, 320, false);
+    VoskTranscriber transcriber(model_dir(), 16000.0f);
+    wait_for_model(transcriber);
+
+    TranscriptionPipelineConfig config;
+    config.hangover_ms = 100;
+    TranscriptionPipeline pipeline(stream, transcriber, config);
+    std::shared_ptr<ResultQueue> results = pipeline.get_results();
+    ASSERT_TRUE(pipeline.start()) << pipeline.get_last_error();
+
+    std::vector<std::string> finals;
+    size_t partials = 0;
+    while (true) {
+        std::optional<TranscriptionResult> result = results->wait_pop(5000);
+        if (!result) {
+            break;
+        }
+        if (result->is_final) {
+            finals.push_back(result->raw_text);
+        } else {
+            partials++;
+        }
+    }
+    EXPECT_TRUE(results->is_closed());
+    pipeline.stop();
+    EXPECT_FALSE(pipeline.is_running());
+    ASSERT_EQ(finals.size(), 2u);
+    EXPECT_EQ(finals[0], "the quick brown fox jumps over the lazy dog");
+    EXPECT_GT(partials, 0u);
+    std::remove(wav.c_str());
+}
+
+// Test that stop() finalizes open speech and closes the queue promptly
+TEST(TranscriptionPipelineTest, StopFinalizesOpenSpeech) {
+    std::string wav = write_recording("pipeline_stop.wav", 5000, { { 100, 5000 } });
+    WavFileStream stream(wav, 320, true);
+    VoskTranscriber transcriber(model_dir(), 16000.0f);
+    wait_for_model(transcriber);
+
+    TranscriptionPipelineConfig config;
+    config.partial_results = false;
+    TranscriptionPipeline pipeline(stream, transcriber, config);
+    ASSERT_TRUE(pipeline.start()) << pipeline.get_last_error();
+    EXPECT_FALSE(pipeline.start());
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    auto started = std::chrono::steady_clock::now();
+    pipeline.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::milliseconds(500));
+    std::shared_ptr<ResultQueue> results = pipeline.get_results();
+    EXPECT_TRUE(results->is_closed());
+    std::optional<TranscriptionResult> result = results->pop();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->is_final);
+    EXPECT_FALSE(results->pop().has_value());
+    std::remove(wav.c_str());
+}
+
+#ifndef _WIN32
+// Test that the queue's descriptor wakes poll() for results from the decode thread
+TEST(TranscriptionPipelineTest, ResultsWakePoll) {
+    std::string wav = write_recording("pipeline_poll.wav", 1500, { { 200, 900 } });
+    WavFileStream stream(wav, 320, false);
+    VoskTranscriber transcriber(model_dir(), 16000.0f);
+    wait_for_model(transcriber);
+
+    TranscriptionPipeline pipeline(stream, transcriber);
+    std::shared_ptr<ResultQueue> results = pipeline.get_results();
+    ASSERT_TRUE(pipeline.start()) << pipeline.get_last_error();
+
+    pollfd entry = { static_cast<int>(results->ready_fd()), POLLIN, 0 };
+    size_t received = 0;
+    while (!results->is_closed() || results->size() > 0) {
+        entry.revents = 0;
+        ASSERT_EQ(poll(&entry, 1, 5000), 1);
+        while (results->pop()) {
+            received++;
+        }
+    }
+    EXPECT_GT(received, 0u);
+    pipeline.stop();
+}
+#endif
+
+// Test that a pipeline will not start without a loaded model
+TEST(TranscriptionPipelineTest, RequiresModel) {
+    std::string wav = write_recording("pipeline_no_model.wav", 200, {});
+    WavFileStream stream(wav, 320, false);
+    VoskTranscriber transcriber(::testing::TempDir() + "no_such_model", 16000.0f);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (transcriber.is_loading() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    TranscriptionPipeline pipeline(stream, transcriber);
+    EXPECT_FALSE(pipeline.start());
+    EXPECT_FALSE(pipeline.get_last_error().empty());
+    EXPECT_FALSE(stream.is_active());
+    std::remove(wav.c_str());
+}
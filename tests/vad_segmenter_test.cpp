@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "vad_segmenter.h"
+
+#include <cmath>
+
+using namespace voice_transcription;
+
+static void append_tone(std::vector<float>& samples, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        samples.push_back(0.3f * std::sin(2.0f * 3.14159265f * 440.0f * i / 16000.0f));
+    }
+}
+
+// Test mapping between the compacted stream and the recording
+TEST(VadSegmenterTest, TimelineMapping) {
+    SpeechTimeline timeline;
+    timeline.add({ 100, 200 });
+    timeline.add({ 150, 300 });     // Overlaps, so it extends the first region
+    timeline.add({ 1000, 1100 });
+    ASSERT_EQ(timeline.regions().size(), 2u);
+    EXPECT_EQ(timeline.kept_samples(), 300u);
+
+    EXPECT_EQ(timeline.to_original(0), 100u);
+    EXPECT_EQ(timeline.to_original(199), 299u);
+    EXPECT_EQ(timeline.to_original(200), 1000u);
+    EXPECT_EQ(timeline.to_original_end(200), 300u);
+    EXPECT_EQ(timeline.to_original_end(300), 1100u);
+
+    SpeechTimeline slice = timeline.slice({ 250, 1050 });
+    ASSERT_EQ(slice.regions().size(), 2u);
+    EXPECT_EQ(slice.regions()[0].start_sample, 250u);
+    EXPECT_EQ(slice.regions()[1].end_sample, 1050u);
+    EXPECT_EQ(slice.kept_samples(), 100u);
+}
+
+// Test that speech is padded, nearby regions merge and blips are dropped
+TEST(VadSegmenterTest, SegmentPadsAndMerges) {
+    std::vector<float> samples(16000, 0.0f);   // 1 s silence
+    append_tone(samples, 8000);                 // 0.5 s speech
+    samples.resize(samples.size() + 4800);      // 0.3 s pause
+    append_tone(samples, 8000);
+    samples.resize(samples.size() + 16000);
+    append_tone(samples, 320);                  // One 20 ms frame of noise
+    samples.resize(samples.size() + 16000);
+
+    VadSegmenterConfig config;
+    config.padding_ms = 200;
+    config.min_speech_ms = 60;
+    VadSegmenter segmenter(config, 16000);
+    SpeechTimeline timeline = segmenter.segment(samples.data(), samples.size());
+
+    ASSERT_EQ(timeline.regions().size(), 1u);
+    EXPECT_EQ(timeline.regions()[0].start_sample, 16000u - 3200u);
+    EXPECT_EQ(timeline.regions()[0].end_sample, 16000u + 8000u + 4800u + 8000u + 3200u);
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include "vosk_result_parser.h"
+#include "sample_conversion.h"
+
+using namespace voice_transcription;
+
+// Test a final result with word confidences
+TEST(VoskResultParserTest, FinalResult) {
+    TranscriptionResult result{};
+    std::string error;
+    ASSERT_TRUE(parse_vosk_result(
+        "{\"result\" : [{\"conf\" : 1.0, \"end\" : 0.6, \"start\" : 0.4, \"word\" : \"hello\"},"
+        " {\"conf\" : 0.5, \"end\" : 0.9, \"start\" : 0.6, \"word\" : \"world\"}],"
+        " \"text\" : \"hello world\"}", result, error));
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "hello world");
+    EXPECT_EQ(result.processed_text, "hello world");
+    EXPECT_DOUBLE_EQ(result.confidence, 0.75);
+
+    ASSERT_EQ(result.words.size(), 2u);
+    EXPECT_EQ(result.text_of(result.words[0]), "hello");
+    EXPECT_EQ(result.text_of(result.words[1]), "world");
+    EXPECT_FLOAT_EQ(result.words[1].start, 0.6f);
+    EXPECT_FLOAT_EQ(result.words[1].end, 0.9f);
+    EXPECT_FLOAT_EQ(result.words[1].confidence, 0.5f);
+    EXPECT_TRUE(result.alternatives.empty());
+
+    // No word list means full confidence
+    ASSERT_TRUE(parse_vosk_result("{\"text\" : \"\"}", result, error));
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "");
+    EXPECT_DOUBLE_EQ(result.confidence, 1.0);
+    EXPECT_TRUE(result.words.empty());
+    EXPECT_TRUE(result.text_arena.empty());
+}
+
+// Test partial results and malformed input
+TEST(VoskResultParserTest, PartialAndErrors) {
+    TranscriptionResult result{};
+    std::string error;
+    ASSERT_TRUE(parse_vosk_result("{\"partial\" : \"hello wor\"}", result, error));
+    EXPECT_FALSE(result.is_final);
+    EXPECT_EQ(result.raw_text, "hello wor");
+    EXPECT_DOUBLE_EQ(result.confidence, 0.5);
+
+    EXPECT_FALSE(parse_vosk_result("{\"text\" : ", result, error));
+    EXPECT_FALSE(error.empty());
+    error.clear();
+    EXPECT_FALSE(parse_vosk_result("[1, 2]", result, error));
+    EXPECT_FALSE(error.empty());
+}
+
+// Test n-best output, as produced when max_alternatives is set
+TEST(VoskResultParserTest, Alternatives) {
+    TranscriptionResult result{};
+    std::string error;
+    ASSERT_TRUE(parse_vosk_result(
+        "{\"alternatives\" : [{\"confidence\" : 312.5, \"text\" : \"recognize speech\"},"
+        " {\"confidence\" : 309.1, \"text\" : \"wreck a nice beach\"}]}", result, error));
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "recognize speech");
+    EXPECT_DOUBLE_EQ(result.confidence, 1.0);
+
+    ASSERT_EQ(result.alternatives.size(), 2u);
+    EXPECT_EQ(result.text_of(result.alternatives[1]), "wreck a nice beach");
+    EXPECT_FLOAT_EQ(result.alternatives[0].score, 312.5f);
+    EXPECT_EQ(result.alternatives[0].word_count, 0u);
+    EXPECT_TRUE(result.words.empty());
+
+    ASSERT_TRUE(parse_vosk_result("{\"alternatives\" : []}", result, error));
+    EXPECT_TRUE(result.is_final);
+    EXPECT_EQ(result.raw_text, "");
+    EXPECT_TRUE(result.alternatives.empty());
+}
+
+// Test n-best output with word timings; the entries have no word confidence
+TEST(VoskResultParserTest, AlternativeWords) {
+    TranscriptionResult result{};
+    std::string error;
+    ASSERT_TRUE(parse_vosk_result(
+        "{\"alternatives\" : [{\"confidence\" : 12.0, \"result\" : ["
+        "{\"end\" : 0.5, \"start\" : 0.1, \"word\" : \"new\"}, {\"end\" : 0.9, \"start\" : 0.5, \"word\" : \"line\"}],"
+        " \"text\" : \"new line\"},"
+        " {\"confidence\" : 9.5, \"result\" : [{\"end\" : 0.9, \"start\" : 0.1, \"word\" : \"newline\"}],"
+        " \"text\" : \"newline\"}]}", result, error));
+    EXPECT_EQ(result.raw_text, "new line");
+    ASSERT_EQ(result.alternatives.size(), 2u);
+    ASSERT_EQ(result.alternative_words.size(), 3u);
+
+    // The best entry doubles as the word list
+    ASSERT_EQ(result.words.size(), 2u);
+    EXPECT_EQ(result.text_of(result.words[1]), "line");
+    EXPECT_FLOAT_EQ(result.words[1].start, 0.5f);
+    EXPECT_FLOAT_EQ(result.words[1].confidence, 1.0f);
+
+    const Alternative& second = result.alternatives[1];
+    EXPECT_EQ(second.word_begin, 2u);
+    EXPECT_EQ(second.word_count, 1u);
+    EXPECT_EQ(result.text_of(result.alternative_words[second.word_begin]), "newline");
+    EXPECT_FLOAT_EQ(result.alternative_words[second.word_begin].end, 0.9f);
+
+    // A later result replaces the detail of the earlier one
+    ASSERT_TRUE(parse_vosk_result("{\"partial\" : \"new\"}", result, error));
+    EXPECT_TRUE(result.words.empty());
+    EXPECT_TRUE(result.alternatives.empty());
+    EXPECT_TRUE(result.text_arena.empty());
+}
+
+// Test float to PCM conversion, including clipping
+TEST(VoskResultParserTest, SampleConversion) {
+    const float input[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 1.5f, -1.5f };
+    int16_t output[7];
+    float_to_int16(input, output, 7);
+    EXPECT_EQ(output[0], 0);
+    EXPECT_EQ(output[1], 16383);
+    EXPECT_EQ(output[2], -16383);
+    EXPECT_EQ(output[3], 32767);
+    EXPECT_EQ(output[4], -32767);
+    EXPECT_EQ(output[5], 32767);
+    EXPECT_EQ(output[6], -32768);
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "wav_file_stream.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace voice_transcription;
+
+static std::string temp_path(const std::string& name) {
+    return ::testing::TempDir() + name;
+}
+
+static std::vector<float> ramp(size_t count) {
+    std::vector<float> samples(count);
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = static_cast<float>(i % 200) / 200.0f - 0.5f;
+    }
+    return samples;
+}
+
+// Test that written files read back to within 16-bit quantization
+TEST(WavFileStreamTest, RoundTrip) {
+    std::string path = temp_path("round_trip.wav");
+    std::vector<float> samples = ramp(1000);
+    ASSERT_TRUE(WavFileStream::write_wav(path, samples, 16000));
+
+    std::vector<float> decoded;
+    int sample_rate = 0;
+    std::string error;
+    ASSERT_TRUE(WavFileStream::read_wav(path, decoded, sample_rate, error)) << error;
+    EXPECT_EQ(sample_rate, 16000);
+    ASSERT_EQ(decoded.size(), samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        EXPECT_NEAR(decoded[i], samples[i], 1e-4f);
+    }
+    std::remove(path.c_str());
+}
+
+// Test that stereo float files are mixed down to mono
+TEST(WavFileStreamTest, StereoFloat) {
+    std::string path = temp_path("stereo_float.wav");
+    const float frames[][2] = { { 0.5f, -0.5f }, { 0.25f, 0.75f }, { -1.0f, -0.5f } };
+    const uint32_t data_size = sizeof(frames);
+    auto u16 = [](std::ofstream& out, uint16_t v) { out.put(v & 0xFF); out.put(v >> 8); };
+    auto u32 = [&](std::ofstream& out, uint32_t v) { u16(out, v & 0xFFFF); u16(out, v >> 16); };
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write("RIFF", 4); u32(out, 36 + data_size); out.write("WAVE", 4);
+        out.write("fmt ", 4); u32(out, 16); u16(out, 3); u16(out, 2);
+        u32(out, 8000); u32(out, 8000 * 8); u16(out, 8); u16(out, 32);
+        out.write("data", 4); u32(out, data_size);
+        out.write(reinterpret_cast<const char*>(frames), data_size);
+    }
+
+    std::vector<float> decoded;
+    int sample_rate = 0;
+    std::string error;
+    ASSERT_TRUE(WavFileStream::read_wav(path, decoded, sample_rate, error)) << error;
+    EXPECT_EQ(sample_rate, 8000);
+    ASSERT_EQ(decoded.size(), 3u);
+    EXPECT_FLOAT_EQ(decoded[0], 0.0f);
+    EXPECT_FLOAT_EQ(decoded[1], 0.5f);
+    EXPECT_FLOAT_EQ(decoded[2], -0.75f);
+    std::remove(path.c_str());
+}
+
+// Test that unreadable files are rejected at construction
+TEST(WavFileStreamTest, InvalidFile) {
+    std::string path = temp_path("not_a_wav.wav");
+    std::ofstream(path) << "plain text";
+    EXPECT_THROW(WavFileStream(path, 320, false), AudioStreamException);
+    EXPECT_THROW(WavFileStream(temp_path("missing.wav"), 320, false), AudioStreamException);
+    std::remove(path.c_str());
+}
+
+// Test chunking, sequence numbers and silence padding of the last chunk
+TEST(WavFileStreamTest, Chunks) {
+    std::string path = temp_path("chunks.wav");
+    std::vector<float> samples = ramp(1000);
+    ASSERT_TRUE(WavFileStream::write_wav(path, samples, 16000));
+
+    WavFileStream stream(path, 320, false);
+    EXPECT_EQ(stream.get_sample_rate(), 16000);
+    EXPECT_DOUBLE_EQ(stream.get_duration_ms(), 62.5);
+    EXPECT_FALSE(stream.is_active());
+    ASSERT_TRUE(stream.start());
+
+    std::vector<AudioChunk> chunks;
+    while (stream.is_active()) {
+        auto chunk = stream.get_next_chunk();
+        if (chunk) {
+            chunks.push_back(std::move(*chunk));
+        }
+    }
+    ASSERT_EQ(chunks.size(), 4u);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        EXPECT_EQ(chunks[i].sequence(), i);
+        EXPECT_EQ(chunks[i].size(), 320u);
+    }
+    EXPECT_NEAR(chunks[3].data()[999 - 960], samples[999], 1e-4f);
+    EXPECT_FLOAT_EQ(chunks[3].data()[319], 0.0f);
+
+    // Restarting replays from the beginning
+    ASSERT_TRUE(stream.start());
+    auto first = stream.get_next_chunk();
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->sequence(), 0u);
+    std::remove(path.c_str());
+}
+
+// Test that real-time replay releases chunks at the capture pace
+TEST(WavFileStreamTest, RealtimePacing) {
+    std::string path = temp_path("pacing.wav");
+    ASSERT_TRUE(WavFileStream::write_wav(path, std::vector<float>(3200, 0.0f), 16000));
+
+    WavFileStream stream(path, 320, true);
+    ASSERT_TRUE(stream.start());
+
+    // The first chunk is not complete until 20 ms after start
+    EXPECT_FALSE(stream.get_next_chunk(0).has_value());
+
+    size_t count = 0;
+    while (stream.is_active()) {
+        if (stream.get_next_chunk(100)) {
+            count++;
+        }
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - stream.get_start_time()).count();
+    EXPECT_EQ(count, 10u);
+    EXPECT_GE(elapsed_ms, 199.0);
+    EXPECT_LT(elapsed_ms, 1000.0);
+    std::remove(path.c_str());
+}
\ No newline at end of file